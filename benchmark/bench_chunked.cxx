@@ -0,0 +1,249 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <cstdio>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_array_chunked.hxx>
+#ifdef HasHDF5
+#include <vigra/multi_array_chunked_hdf5.hxx>
+#endif
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::benchmark;
+
+typedef ChunkedArray<3, float>         Chunked;
+typedef VIGRA_UNIQUE_PTR<Chunked>      ChunkedPtr;
+
+static const char * hdf5FileName = "bench_chunked.h5";
+
+ChunkedPtr createArray(std::string const & backend, Shape3 const & shape,
+                       Shape3 const & chunk_shape)
+{
+    ChunkedArrayOptions options;
+    if(backend == "full")
+        return ChunkedPtr(new ChunkedArrayFull<3, float>(shape, options));
+    if(backend == "lazy")
+        return ChunkedPtr(new ChunkedArrayLazy<3, float>(shape, chunk_shape, options));
+    if(backend == "lz4")
+        return ChunkedPtr(new ChunkedArrayCompressed<3, float>(shape, chunk_shape,
+                                                               options.compression(LZ4)));
+    if(backend == "zlib")
+        return ChunkedPtr(new ChunkedArrayCompressed<3, float>(shape, chunk_shape,
+                                                               options.compression(ZLIB_FAST)));
+    if(backend == "tmpfile")
+        return ChunkedPtr(new ChunkedArrayTmpFile<3, float>(shape, chunk_shape, options, ""));
+#ifdef HasHDF5
+    if(backend == "hdf5")
+    {
+        HDF5File file(hdf5FileName, HDF5File::New);
+        return ChunkedPtr(new ChunkedArrayHDF5<3, float>(file, "data", HDF5File::New,
+                                                         shape, chunk_shape,
+                                                         options.compression(ZLIB_FAST)));
+    }
+#endif
+    vigra_fail("bench_chunked: unknown backend '" + backend + "'.");
+    return ChunkedPtr();
+}
+
+ChunkedPtr filledArray(std::string const & backend, Shape3 const & shape,
+                       Shape3 const & chunk_shape)
+{
+    ChunkedPtr array = createArray(backend, shape, chunk_shape);
+    array->commitSubarray(Shape3(), blobArray<3, float>(shape));
+    return array;
+}
+
+std::string label(Chunked const & array)
+{
+    return shapeString(array.shape()) + ", chunks " + shapeString(array.chunkShape());
+}
+
+void scanWrite(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape)
+{
+    ChunkedPtr array = createArray(backend, shape, chunk_shape);
+
+    while(state.keepRunning())
+    {
+        float v = 0.0f;
+        Chunked::iterator i = array->begin(), end = array->end();
+        for(; i != end; ++i, v += 1.0f)
+            *i = v;
+    }
+
+    state.setItemsProcessed(array->size());
+    state.setBytesProcessed(array->size() * sizeof(float));
+    state.setLabel(label(*array));
+}
+
+void scanRead(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape)
+{
+    ChunkedPtr array = filledArray(backend, shape, chunk_shape);
+
+    while(state.keepRunning())
+    {
+        double sum = 0.0;
+        Chunked::const_iterator i = array->cbegin(), end = array->cend();
+        for(; i != end; ++i)
+            sum += *i;
+        doNotOptimize(sum);
+    }
+
+    state.setItemsProcessed(array->size());
+    state.setBytesProcessed(array->size() * sizeof(float));
+    state.setLabel(label(*array));
+}
+
+void chunkRead(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape)
+{
+    ChunkedPtr array = filledArray(backend, shape, chunk_shape);
+
+    while(state.keepRunning())
+    {
+        double sum = 0.0;
+        Chunked::chunk_const_iterator i = array->chunk_cbegin(Shape3(), shape),
+                                      end = array->chunk_cend(Shape3(), shape);
+        for(; i != end; ++i)
+            sum += i->sum<double>();
+        doNotOptimize(sum);
+    }
+
+    state.setItemsProcessed(array->size());
+    state.setBytesProcessed(array->size() * sizeof(float));
+    state.setLabel(label(*array));
+}
+
+void blockCheckout(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape,
+                   int threads)
+{
+    ChunkedPtr array = filledArray(backend, shape, chunk_shape);
+    // blocks deliberately straddle chunk borders
+    Shape3 block_shape = chunk_shape * 3 / 4;
+    MultiArray<3, float> block(block_shape);
+    ParallelOptions options;
+    options.numThreads(threads);
+
+    while(state.keepRunning())
+    {
+        MultiCoordinateIterator<3> i(shape / block_shape), end(i.getEndIterator());
+        for(; i != end; ++i)
+            array->checkoutSubarray(*i * block_shape, block, options);
+    }
+
+    MultiArrayIndex count = prod(shape / block_shape) * prod(block_shape);
+    state.setItemsProcessed(count);
+    state.setBytesProcessed(count * sizeof(float));
+    state.setLabel(label(*array) + ", blocks " + shapeString(block_shape) +
+                   ", " + asString(options.getActualNumThreads()) + " threads");
+}
+
+void wholeCheckout(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape,
+                   int threads)
+{
+    ChunkedPtr array = filledArray(backend, shape, chunk_shape);
+    MultiArray<3, float> data(shape);
+    ParallelOptions options;
+    options.numThreads(threads);
+
+    while(state.keepRunning())
+        array->checkoutSubarray(Shape3(), data, options);
+
+    state.setItemsProcessed(data.size());
+    state.setBytesProcessed(data.size() * sizeof(float));
+    state.setLabel(label(*array) + ", " + asString(options.getActualNumThreads()) + " threads");
+}
+
+void randomRead(State & state, std::string backend, Shape3 shape, Shape3 chunk_shape)
+{
+    ChunkedPtr array = filledArray(backend, shape, chunk_shape);
+
+    int count = 100000;
+    RandomMT19937 random(42);
+    ArrayVector<Shape3> points(count);
+    for(int k=0; k<count; ++k)
+        for(int d=0; d<3; ++d)
+            points[k][d] = random.uniformInt((UInt32)shape[d]);
+
+    while(state.keepRunning())
+    {
+        double sum = 0.0;
+        for(int k=0; k<count; ++k)
+            sum += array->getItem(points[k]);
+        doNotOptimize(sum);
+    }
+
+    state.setItemsProcessed(count);
+    state.setLabel(label(*array));
+}
+
+int main(int argc, char ** argv)
+{
+    using namespace std::placeholders;
+
+    Suite suite("chunked", argc, argv);
+
+    Shape3 shape       = suite.quick() ? Shape3(64) : Shape3(256),
+           chunk_shape = suite.quick() ? Shape3(16) : Shape3(64);
+
+    std::vector<std::string> backends;
+    backends.push_back("full");
+    backends.push_back("lazy");
+    backends.push_back("lz4");
+    backends.push_back("zlib");
+    backends.push_back("tmpfile");
+#ifdef HasHDF5
+    backends.push_back("hdf5");
+#endif
+
+    for(std::size_t k=0; k<backends.size(); ++k)
+    {
+        std::string const & b = backends[k];
+        suite.add("chunked/" + b + "/scanWrite",   std::bind(&scanWrite,  _1, b, shape, chunk_shape));
+        suite.add("chunked/" + b + "/scanRead",    std::bind(&scanRead,   _1, b, shape, chunk_shape));
+        suite.add("chunked/" + b + "/chunkRead",   std::bind(&chunkRead,  _1, b, shape, chunk_shape));
+        suite.add("chunked/" + b + "/randomRead",  std::bind(&randomRead, _1, b, shape, chunk_shape));
+        suite.add("chunked/" + b + "/blockCheckout",
+                  std::bind(&blockCheckout, _1, b, shape, chunk_shape, 1));
+        suite.add("chunked/" + b + "/checkout/1thread",
+                  std::bind(&wholeCheckout, _1, b, shape, chunk_shape, 1));
+        suite.add("chunked/" + b + "/checkout/threads",
+                  std::bind(&wholeCheckout, _1, b, shape, chunk_shape, ParallelOptions::Auto));
+    }
+
+    int res = suite.run();
+    std::remove(hdf5FileName);
+    return res;
+}
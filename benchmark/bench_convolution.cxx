@@ -0,0 +1,125 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <type_traits>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_convolution.hxx>
+#include <vigra/separableconvolution.hxx>
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::benchmark;
+
+    // integer data are smoothed into float32, floating point data keep their type
+template <class T>
+struct SmoothingResult
+{
+    typedef typename std::conditional<std::is_same<T, double>::value,
+                                      double, float>::type type;
+};
+
+template <unsigned int N, class T>
+void gaussianSmoothing(State & state, typename MultiArrayShape<N>::type shape, double sigma)
+{
+    typedef typename SmoothingResult<T>::type R;
+    MultiArray<N, T> src = noiseArray<N, T>(shape);
+    MultiArray<N, R> dest(shape);
+
+    while(state.keepRunning())
+        gaussianSmoothMultiArray(src, dest, sigma);
+
+    state.setItemsProcessed(src.size());
+    state.setLabel(shapeString(shape) + ", sigma=" + asString(sigma));
+}
+
+template <unsigned int N, class T>
+void separableConvolution(State & state, typename MultiArrayShape<N>::type shape, int radius)
+{
+    typedef typename SmoothingResult<T>::type R;
+    MultiArray<N, T> src = noiseArray<N, T>(shape);
+    MultiArray<N, R> dest(shape);
+
+    Kernel1D<double> kernel;
+    kernel.initAveraging(radius);
+
+    while(state.keepRunning())
+        separableConvolveMultiArray(src, dest, kernel);
+
+    state.setItemsProcessed(src.size());
+    state.setLabel(shapeString(shape) + ", kernel size=" + asString(2*radius+1));
+}
+
+template <unsigned int N, class T>
+void gaussianGradient(State & state, typename MultiArrayShape<N>::type shape, double sigma)
+{
+    typedef typename SmoothingResult<T>::type R;
+    MultiArray<N, T> src = noiseArray<N, T>(shape);
+    MultiArray<N, TinyVector<R, (int)N> > dest(shape);
+
+    while(state.keepRunning())
+        gaussianGradientMultiArray(src, dest, sigma);
+
+    state.setItemsProcessed(src.size());
+    state.setLabel(shapeString(shape) + ", sigma=" + asString(sigma));
+}
+
+template <class T>
+void addPerType(Suite & suite, Shape2 const & shape2, Shape3 const & shape3)
+{
+    using namespace std::placeholders;
+    std::string t = dtypeName<T>();
+
+    suite.add("gaussianSmooth/2D/" + t, std::bind(&gaussianSmoothing<2, T>, _1, shape2, 2.0));
+    suite.add("gaussianSmooth/3D/" + t, std::bind(&gaussianSmoothing<3, T>, _1, shape3, 2.0));
+    suite.add("separableConvolve/2D/" + t, std::bind(&separableConvolution<2, T>, _1, shape2, 3));
+    suite.add("separableConvolve/3D/" + t, std::bind(&separableConvolution<3, T>, _1, shape3, 3));
+    suite.add("gaussianGradient/2D/" + t, std::bind(&gaussianGradient<2, T>, _1, shape2, 2.0));
+    suite.add("gaussianGradient/3D/" + t, std::bind(&gaussianGradient<3, T>, _1, shape3, 2.0));
+}
+
+int main(int argc, char ** argv)
+{
+    Suite suite("convolution", argc, argv);
+
+    Shape2 shape2 = suite.quick() ? Shape2(256)  : Shape2(2048);
+    Shape3 shape3 = suite.quick() ? Shape3(48)   : Shape3(192);
+
+    addPerType<UInt8>(suite, shape2, shape3);
+    addPerType<float>(suite, shape2, shape3);
+    addPerType<double>(suite, shape2, shape3);
+
+    return suite.run();
+}
@@ -0,0 +1,89 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <vigra/multi_array.hxx>
+#include <vigra/accumulator.hxx>
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::benchmark;
+using namespace vigra::acc;
+
+typedef Select<DataArg<1>, LabelArg<2>,
+               Count, Mean, Variance, Minimum, Maximum>       BasicFeatures;
+typedef Select<DataArg<1>, LabelArg<2>,
+               Count, RegionCenter, RegionRadii, RegionAxes>  GeometryFeatures;
+typedef Select<DataArg<1>, LabelArg<2>,
+               Minimum, Maximum, AutoRangeHistogram<64>,
+               StandardQuantiles<AutoRangeHistogram<64> > >   HistogramFeatures;
+
+template <unsigned int N, class SELECTED>
+void regionFeatures(State & state, typename MultiArrayShape<N>::type shape)
+{
+    MultiArray<N, float> data = blobArray<N, float>(shape);
+    MultiArray<N, UInt32> labels(shape);
+    UInt32 count = regionArray(labels, 8.0);
+
+    while(state.keepRunning())
+    {
+        // the accumulator chain is part of the measurement because its
+        // per-region allocation is done by extractFeatures() itself
+        AccumulatorChainArray<CoupledArrays<N, float, UInt32>, SELECTED> a;
+        extractFeatures(data, labels, a);
+        doNotOptimize(a);
+    }
+
+    state.setItemsProcessed(data.size());
+    state.setLabel(shapeString(shape) + ", " + asString(count) + " regions");
+}
+
+int main(int argc, char ** argv)
+{
+    using namespace std::placeholders;
+
+    Suite suite("features", argc, argv);
+
+    Shape2 shape2 = suite.quick() ? Shape2(256) : Shape2(2048);
+    Shape3 shape3 = suite.quick() ? Shape3(48)  : Shape3(192);
+
+    suite.add("extractFeatures/2D/basic",     std::bind(&regionFeatures<2, BasicFeatures>, _1, shape2));
+    suite.add("extractFeatures/3D/basic",     std::bind(&regionFeatures<3, BasicFeatures>, _1, shape3));
+    suite.add("extractFeatures/2D/geometry",  std::bind(&regionFeatures<2, GeometryFeatures>, _1, shape2));
+    suite.add("extractFeatures/3D/geometry",  std::bind(&regionFeatures<3, GeometryFeatures>, _1, shape3));
+    suite.add("extractFeatures/2D/histogram", std::bind(&regionFeatures<2, HistogramFeatures>, _1, shape2));
+    suite.add("extractFeatures/3D/histogram", std::bind(&regionFeatures<3, HistogramFeatures>, _1, shape3));
+
+    return suite.run();
+}
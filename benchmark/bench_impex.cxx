@@ -0,0 +1,131 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <cstdio>
+#include <sstream>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/rgbvalue.hxx>
+#include <vigra/impex.hxx>
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::benchmark;
+
+struct Format
+{
+    const char * name;
+    const char * extension;
+    bool supportsFloat;
+};
+
+static const Format formats[] = {
+    { "BMP",  "bmp",  false },
+    { "PNM",  "pnm",  false },
+    { "SUN",  "ras",  false },
+    { "VIFF", "xv",   true  },
+    { "PNG",  "png",  false },
+    { "JPEG", "jpg",  false },
+    { "TIFF", "tif",  true  }
+};
+
+bool formatAvailable(std::string const & name)
+{
+    std::istringstream available(impexListFormats());
+    std::string f;
+    while(available >> f)
+        if(f == name)
+            return true;
+    return false;
+}
+
+template <class T>
+MultiArray<2, T> testImage(Shape2 const & shape)
+{
+    return blobArray<2, T>(shape);
+}
+
+template <>
+MultiArray<2, RGBValue<UInt8> > testImage(Shape2 const & shape)
+{
+    MultiArray<2, RGBValue<UInt8> > res(shape);
+    for(int c=0; c<3; ++c)
+        res.bindElementChannel(c) = blobArray<2, UInt8>(shape, 4.0, 42 + c);
+    return res;
+}
+
+template <class T>
+void decode(State & state, Format format, Shape2 shape)
+{
+    std::string filename = std::string("bench_impex.") + format.extension;
+    MultiArray<2, T> image = testImage<T>(shape);
+    exportImage(image, ImageExportInfo(filename.c_str()).setFileType(format.name));
+
+    MultiArray<2, T> result(shape);
+    while(state.keepRunning())
+    {
+        // header parsing is part of decoding
+        ImageImportInfo info(filename.c_str());
+        importImage(info, result);
+    }
+
+    std::remove(filename.c_str());
+    state.setItemsProcessed(image.size());
+    state.setBytesProcessed(image.size() * sizeof(T));
+    state.setLabel(shapeString(shape));
+}
+
+int main(int argc, char ** argv)
+{
+    using namespace std::placeholders;
+
+    Suite suite("impex", argc, argv);
+
+    Shape2 shape = suite.quick() ? Shape2(256) : Shape2(2048);
+
+    for(std::size_t k=0; k<sizeof(formats) / sizeof(Format); ++k)
+    {
+        Format const & f = formats[k];
+        if(!formatAvailable(f.name))
+            continue;
+        std::string name = std::string("decode/") + f.name;
+        suite.add(name + "/uint8", std::bind(&decode<UInt8>, _1, f, shape));
+        suite.add(name + "/rgb8",  std::bind(&decode<RGBValue<UInt8> >, _1, f, shape));
+        if(f.supportsFloat)
+            suite.add(name + "/float32", std::bind(&decode<float>, _1, f, shape));
+    }
+
+    return suite.run();
+}
@@ -0,0 +1,114 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <thread>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/random_forest_3.hxx>
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::rf3;
+using namespace vigra::benchmark;
+
+typedef MultiArray<2, float> Features;
+typedef MultiArray<1, int>   Labels;
+
+void train(State & state, int samples, int features, int classes,
+           int trees, int threads)
+{
+    Features x;
+    Labels y;
+    classificationData(samples, features, classes, x, y);
+
+    RandomForestOptions options;
+    options.tree_count(trees).n_threads(threads);
+
+    while(state.keepRunning())
+    {
+        // a fixed seed makes all repetitions grow the same forest
+        RandomMT19937 random(42);
+        RFStopVisiting stop;
+        RandomForest<Features, Labels> rf = random_forest(x, y, options, stop, random);
+        doNotOptimize(rf);
+    }
+
+    state.setItemsProcessed((double)samples * trees);
+    state.setLabel(asString(samples) + " samples, " + asString(features) +
+                   " features, " + asString(trees) + " trees, " +
+                   asString(threads) + " threads");
+}
+
+void predict(State & state, int samples, int features, int classes,
+             int trees, int threads)
+{
+    Features x, xtest;
+    Labels y, ytest;
+    classificationData(samples, features, classes, x, y);
+    classificationData(samples, features, classes, xtest, ytest, 43);
+
+    RandomForestOptions options;
+    options.tree_count(trees);
+    RandomMT19937 random(42);
+    RFStopVisiting stop;
+    RandomForest<Features, Labels> rf = random_forest(x, y, options, stop, random);
+
+    MultiArray<2, double> probabilities(Shape2(samples, classes));
+    while(state.keepRunning())
+        rf.predict_probabilities(xtest, probabilities, threads);
+
+    state.setItemsProcessed((double)samples);
+    state.setLabel(asString(samples) + " samples, " + asString(features) +
+                   " features, " + asString(trees) + " trees, " +
+                   asString(threads) + " threads");
+}
+
+int main(int argc, char ** argv)
+{
+    using namespace std::placeholders;
+
+    Suite suite("rf3", argc, argv);
+
+    int samples = suite.quick() ? 2000 : 50000,
+        trees   = suite.quick() ? 8    : 64,
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    suite.add("rf3/train/1thread",    std::bind(&train,   _1, samples, 20, 4, trees, 1));
+    suite.add("rf3/train/threads",    std::bind(&train,   _1, samples, 20, 4, trees, threads));
+    suite.add("rf3/predict/1thread",  std::bind(&predict, _1, samples, 20, 4, trees, 1));
+    suite.add("rf3/predict/threads",  std::bind(&predict, _1, samples, 20, 4, trees, threads));
+
+    return suite.run();
+}
@@ -0,0 +1,169 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_labeling.hxx>
+#include <vigra/multi_watersheds.hxx>
+#include <vigra/multi_distance.hxx>
+#include <vigra/slic.hxx>
+
+#include "benchmark.hxx"
+#include "synthetic_data.hxx"
+
+using namespace vigra;
+using namespace vigra::benchmark;
+
+template <unsigned int N>
+void labeling(State & state, typename MultiArrayShape<N>::type shape,
+              NeighborhoodType neighborhood, bool withBackground)
+{
+    MultiArray<N, UInt8> mask = maskArray<N>(shape);
+    MultiArray<N, UInt32> labels(shape);
+    LabelOptions options;
+    options.neighborhood(neighborhood);
+    if(withBackground)
+        options.ignoreBackgroundValue(0);
+
+    UInt32 count = 0;
+    while(state.keepRunning())
+        count = labelMultiArray(mask, labels, options);
+
+    state.setItemsProcessed(mask.size());
+    state.setLabel(shapeString(shape) + ", " + asString(count) + " regions");
+}
+
+template <unsigned int N>
+void watersheds(State & state, typename MultiArrayShape<N>::type shape,
+                NeighborhoodType neighborhood, bool regionGrowing)
+{
+    MultiArray<N, float> data = blobArray<N, float>(shape);
+    MultiArray<N, UInt32> labels(shape);
+    WatershedOptions options;
+    if(regionGrowing)
+        options.regionGrowing();
+    else
+        options.unionFind();
+
+    UInt32 count = 0;
+    while(state.keepRunning())
+    {
+        // seeds are computed afresh in every iteration
+        state.pauseTiming();
+        labels.init(0);
+        state.resumeTiming();
+        count = watershedsMultiArray(data, labels, neighborhood, options);
+    }
+
+    state.setItemsProcessed(data.size());
+    state.setLabel(shapeString(shape) + ", " + asString(count) + " regions");
+}
+
+template <unsigned int N>
+void distanceTransform(State & state, typename MultiArrayShape<N>::type shape)
+{
+    // large objects, but the smoothing kernel must fit into the array
+    MultiArray<N, UInt8> mask = maskArray<N>(shape, std::min(16.0, shape[0] / 8.0));
+    MultiArray<N, float> dist(shape);
+
+    while(state.keepRunning())
+        separableMultiDistance(mask, dist, true);
+
+    state.setItemsProcessed(mask.size());
+    state.setLabel(shapeString(shape));
+}
+
+template <unsigned int N>
+void boundaryDistanceTransform(State & state, typename MultiArrayShape<N>::type shape)
+{
+    MultiArray<N, UInt32> labels(shape);
+    regionArray(labels, 8.0);
+    MultiArray<N, float> dist(shape);
+
+    while(state.keepRunning())
+        boundaryMultiDistance(labels, dist);
+
+    state.setItemsProcessed(labels.size());
+    state.setLabel(shapeString(shape));
+}
+
+template <unsigned int N>
+void slic(State & state, typename MultiArrayShape<N>::type shape)
+{
+    MultiArray<N, float> data = blobArray<N, float>(shape);
+    MultiArray<N, UInt32> labels(shape);
+
+    unsigned int count = 0;
+    while(state.keepRunning())
+    {
+        // seeds are computed afresh in every iteration
+        state.pauseTiming();
+        labels.init(0);
+        state.resumeTiming();
+        count = slicSuperpixels(data, labels, 10.0f, 8, SlicOptions().iterations(10));
+    }
+
+    state.setItemsProcessed(data.size());
+    state.setLabel(shapeString(shape) + ", " + asString(count) + " regions");
+}
+
+int main(int argc, char ** argv)
+{
+    using namespace std::placeholders;
+
+    Suite suite("segmentation", argc, argv);
+
+    Shape2 shape2 = suite.quick() ? Shape2(256) : Shape2(2048);
+    Shape3 shape3 = suite.quick() ? Shape3(48)  : Shape3(192);
+
+    suite.add("labelMultiArray/2D/direct",   std::bind(&labeling<2>, _1, shape2, DirectNeighborhood, false));
+    suite.add("labelMultiArray/2D/indirect", std::bind(&labeling<2>, _1, shape2, IndirectNeighborhood, false));
+    suite.add("labelMultiArray/3D/direct",   std::bind(&labeling<3>, _1, shape3, DirectNeighborhood, false));
+    suite.add("labelMultiArray/3D/indirect", std::bind(&labeling<3>, _1, shape3, IndirectNeighborhood, false));
+    suite.add("labelMultiArray/2D/background", std::bind(&labeling<2>, _1, shape2, DirectNeighborhood, true));
+    suite.add("labelMultiArray/3D/background", std::bind(&labeling<3>, _1, shape3, DirectNeighborhood, true));
+
+    suite.add("watersheds/2D/unionFind",     std::bind(&watersheds<2>, _1, shape2, DirectNeighborhood, false));
+    suite.add("watersheds/3D/unionFind",     std::bind(&watersheds<3>, _1, shape3, DirectNeighborhood, false));
+    suite.add("watersheds/2D/regionGrowing", std::bind(&watersheds<2>, _1, shape2, DirectNeighborhood, true));
+    suite.add("watersheds/3D/regionGrowing", std::bind(&watersheds<3>, _1, shape3, DirectNeighborhood, true));
+
+    suite.add("distanceTransform/2D", std::bind(&distanceTransform<2>, _1, shape2));
+    suite.add("distanceTransform/3D", std::bind(&distanceTransform<3>, _1, shape3));
+    suite.add("boundaryDistanceTransform/2D", std::bind(&boundaryDistanceTransform<2>, _1, shape2));
+    suite.add("boundaryDistanceTransform/3D", std::bind(&boundaryDistanceTransform<3>, _1, shape3));
+
+    suite.add("slicSuperpixels/2D", std::bind(&slic<2>, _1, shape2));
+    suite.add("slicSuperpixels/3D", std::bind(&slic<3>, _1, shape3));
+
+    return suite.run();
+}
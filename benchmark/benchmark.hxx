@@ -0,0 +1,427 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_BENCHMARK_HXX
+#define VIGRA_BENCHMARK_HXX
+
+/*
+    Minimal benchmark driver for the programs in this directory.
+
+    A benchmark is a function 'void f(State &)' which prepares its data and
+    then runs the code to be timed in a 'while(state.keepRunning())' loop.
+    The first iteration is an untimed warm-up. Afterwards, each repetition
+    executes as many iterations as needed to fill the minimum time, and the
+    average time per iteration of each repetition becomes one sample.
+
+    Command line options (common to all benchmark programs):
+
+        --filter=<text>       run only benchmarks whose name contains <text>
+        --repetitions=<n>     number of samples per benchmark (default: 5)
+        --min-time=<seconds>  minimum duration of each sample (default: 0.1)
+        --quick               use small problem sizes (smoke test)
+        --output=<file>       write JSON results to <file> instead of stdout
+        --list                print the benchmark names and exit
+
+    The human-readable summary goes to stderr when the JSON is written to
+    stdout, and to stdout otherwise.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <vigra/config.hxx>
+#include <vigra/config_version.hxx>
+#include <vigra/error.hxx>
+#include <vigra/threading.hxx>
+
+namespace vigra {
+
+namespace benchmark {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options
+{
+    Options()
+    : repetitions(5)
+    , min_time(0.1)
+    , quick(false)
+    , list(false)
+    {}
+
+    int repetitions;
+    double min_time;
+    bool quick, list;
+    std::string filter, output;
+};
+
+class State
+{
+  public:
+    State(Options const & options)
+    : repetitions_(options.repetitions)
+    , min_time_(options.min_time)
+    , items_(0.0)
+    , bytes_(0.0)
+    , iterations_(0)
+    , total_iterations_(0)
+    , elapsed_(0.0)
+    , phase_(NotStarted)
+    , paused_(false)
+    {}
+
+        // Returns true as long as the benchmark loop shall continue.
+    bool keepRunning()
+    {
+        Clock::time_point now = Clock::now();
+        switch(phase_)
+        {
+          case NotStarted:
+            phase_ = WarmUp;
+            break;
+          case WarmUp:
+            phase_ = Measuring;
+            break;
+          case Measuring:
+            if(!paused_)
+                elapsed_ += std::chrono::duration<double>(now - start_).count();
+            paused_ = false;
+            ++iterations_;
+            if(elapsed_ >= min_time_)
+            {
+                samples_.push_back(elapsed_ / iterations_);
+                total_iterations_ += iterations_;
+                iterations_ = 0;
+                elapsed_ = 0.0;
+                if((int)samples_.size() == repetitions_)
+                    return false;
+            }
+            break;
+        }
+        start_ = Clock::now();
+        return true;
+    }
+
+        // Exclude per-iteration setup (e.g. re-initialization of the
+        // output) from the measurement.
+    void pauseTiming()
+    {
+        elapsed_ += std::chrono::duration<double>(Clock::now() - start_).count();
+        paused_ = true;
+    }
+
+    void resumeTiming()
+    {
+        start_ = Clock::now();
+        paused_ = false;
+    }
+
+        // Number of items (e.g. pixels) processed per iteration.
+    void setItemsProcessed(double items)
+    {
+        items_ = items;
+    }
+
+        // Number of bytes processed per iteration.
+    void setBytesProcessed(double bytes)
+    {
+        bytes_ = bytes;
+    }
+
+        // Free-form annotation (e.g. the problem size) for the report.
+    void setLabel(std::string const & label)
+    {
+        label_ = label;
+    }
+
+    std::vector<double> const & samples() const
+    {
+        return samples_;
+    }
+
+    int repetitions_;
+    double min_time_, items_, bytes_;
+    long iterations_, total_iterations_;
+    double elapsed_;
+    enum { NotStarted, WarmUp, Measuring } phase_;
+    bool paused_;
+    std::string label_;
+    Clock::time_point start_;
+    std::vector<double> samples_;
+};
+
+struct Result
+{
+    std::string name, label;
+    long iterations;
+    double min, median, mean, stddev;
+    double items_per_second, bytes_per_second;
+};
+
+inline std::string jsonString(std::string const & s)
+{
+    std::string res("\"");
+    for(std::size_t k=0; k<s.size(); ++k)
+    {
+        char c = s[k];
+        if(c == '"' || c == '\\')
+        {
+            res += '\\';
+            res += c;
+        }
+        else if(c == '\n')
+            res += "\\n";
+        else if((unsigned char)c < 0x20)
+            res += ' ';
+        else
+            res += c;
+    }
+    return res + "\"";
+}
+
+inline std::string compilerName()
+{
+    std::ostringstream s;
+#if defined(__clang__)
+    s << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined(__GNUC__)
+    s << "gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+    s << "msvc " << _MSC_VER;
+#else
+    s << "unknown";
+#endif
+    return s.str();
+}
+
+class Suite
+{
+  public:
+    typedef std::function<void (State &)> Function;
+
+    Suite(std::string const & name, int argc, char ** argv)
+    : name_(name)
+    {
+        for(int k=1; k<argc; ++k)
+        {
+            std::string arg(argv[k]);
+            if(arg.compare(0, 9, "--filter=") == 0)
+                options_.filter = arg.substr(9);
+            else if(arg.compare(0, 14, "--repetitions=") == 0)
+                options_.repetitions = std::max(1, std::atoi(arg.substr(14).c_str()));
+            else if(arg.compare(0, 11, "--min-time=") == 0)
+                options_.min_time = std::atof(arg.substr(11).c_str());
+            else if(arg.compare(0, 9, "--output=") == 0)
+                options_.output = arg.substr(9);
+            else if(arg == "--quick")
+                options_.quick = true;
+            else if(arg == "--list")
+                options_.list = true;
+            else
+                vigra_fail("benchmark: unknown option '" + arg + "'.");
+        }
+    }
+
+    Options const & options() const
+    {
+        return options_;
+    }
+
+        // Problem sizes shall be reduced when this is true.
+    bool quick() const
+    {
+        return options_.quick;
+    }
+
+    void add(std::string const & name, Function f)
+    {
+        names_.push_back(name);
+        functions_.push_back(f);
+    }
+
+    int run()
+    {
+        bool toStdout = options_.output.empty();
+        std::ostream & log = toStdout ? std::cerr : std::cout;
+
+        std::vector<Result> results;
+        for(std::size_t k=0; k<functions_.size(); ++k)
+        {
+            if(names_[k].find(options_.filter) == std::string::npos)
+                continue;
+            if(options_.list)
+            {
+                std::cout << names_[k] << "\n";
+                continue;
+            }
+            State state(options_);
+            functions_[k](state);
+            vigra_postcondition(state.samples().size() > 0,
+                "benchmark: '" + names_[k] + "' did not run the benchmark loop.");
+            results.push_back(evaluate(names_[k], state));
+            report(log, results.back());
+        }
+        if(options_.list)
+            return 0;
+
+        if(toStdout)
+        {
+            writeJSON(std::cout, results);
+        }
+        else
+        {
+            std::ofstream out(options_.output.c_str());
+            vigra_precondition(out.good(),
+                "benchmark: unable to open '" + options_.output + "'.");
+            writeJSON(out, results);
+        }
+        return 0;
+    }
+
+  private:
+    static Result evaluate(std::string const & name, State const & state)
+    {
+        std::vector<double> s(state.samples());
+        std::sort(s.begin(), s.end());
+
+        Result r;
+        r.name = name;
+        r.label = state.label_;
+        r.iterations = state.total_iterations_;
+        r.min = s.front();
+        r.median = (s.size() % 2 == 1)
+                      ? s[s.size()/2]
+                      : 0.5*(s[s.size()/2-1] + s[s.size()/2]);
+        double sum = 0.0, sum2 = 0.0;
+        for(std::size_t k=0; k<s.size(); ++k)
+        {
+            sum += s[k];
+            sum2 += s[k]*s[k];
+        }
+        r.mean = sum / s.size();
+        r.stddev = std::sqrt(std::max(0.0, sum2 / s.size() - r.mean*r.mean));
+        r.items_per_second = state.items_ / r.median;
+        r.bytes_per_second = state.bytes_ / r.median;
+        return r;
+    }
+
+    static void report(std::ostream & log, Result const & r)
+    {
+        log << std::left << std::setw(56) << r.name << std::right
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << r.median*1e3 << " ms"
+            << " (min " << r.min*1e3 << ", +-" << r.stddev*1e3 << ")";
+        if(r.items_per_second > 0.0)
+            log << std::setprecision(1) << "  " << r.items_per_second*1e-6 << " Mitems/s";
+        if(!r.label.empty())
+            log << "  [" << r.label << "]";
+        log << std::endl;
+    }
+
+    void writeJSON(std::ostream & out, std::vector<Result> const & results) const
+    {
+        std::time_t now = std::time(0);
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n"
+            << "  \"context\": {\n"
+            << "    \"suite\": " << jsonString(name_) << ",\n"
+            << "    \"date\": " << jsonString(date) << ",\n"
+            << "    \"vigra_version\": " << jsonString(VIGRA_VERSION) << ",\n"
+            << "    \"compiler\": " << jsonString(compilerName()) << ",\n"
+#ifdef NDEBUG
+            << "    \"assertions\": false,\n"
+#else
+            << "    \"assertions\": true,\n"
+#endif
+            << "    \"hardware_threads\": " << threading::thread::hardware_concurrency() << ",\n"
+            << "    \"repetitions\": " << options_.repetitions << ",\n"
+            << "    \"min_time\": " << options_.min_time << ",\n"
+            << "    \"quick\": " << (options_.quick ? "true" : "false") << "\n"
+            << "  },\n"
+            << "  \"benchmarks\": [";
+        out << std::setprecision(9);
+        for(std::size_t k=0; k<results.size(); ++k)
+        {
+            Result const & r = results[k];
+            out << (k == 0 ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": " << jsonString(r.name) << ",\n"
+                << "      \"label\": " << jsonString(r.label) << ",\n"
+                << "      \"iterations\": " << r.iterations << ",\n"
+                << "      \"real_time\": " << r.median << ",\n"
+                << "      \"min_time\": " << r.min << ",\n"
+                << "      \"mean_time\": " << r.mean << ",\n"
+                << "      \"stddev_time\": " << r.stddev << ",\n"
+                << "      \"time_unit\": \"s\",\n"
+                << "      \"items_per_second\": " << r.items_per_second << ",\n"
+                << "      \"bytes_per_second\": " << r.bytes_per_second << "\n"
+                << "    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    std::string name_;
+    Options options_;
+    std::vector<std::string> names_;
+    std::vector<Function> functions_;
+};
+
+    // Prevent the compiler from optimizing away a computed value.
+template <class T>
+inline void doNotOptimize(T const & value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static void const * volatile sink;
+    sink = &value;
+#endif
+}
+
+} // namespace benchmark
+
+} // namespace vigra
+
+#endif // VIGRA_BENCHMARK_HXX
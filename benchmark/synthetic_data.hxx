@@ -0,0 +1,191 @@
+/************************************************************************/
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_BENCHMARK_SYNTHETIC_DATA_HXX
+#define VIGRA_BENCHMARK_SYNTHETIC_DATA_HXX
+
+/*
+    Reproducible synthetic inputs for the benchmarks. All generators are
+    deterministic for a given seed, so that timings of different builds
+    refer to identical data.
+*/
+
+#include <sstream>
+#include <string>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_convolution.hxx>
+#include <vigra/multi_watersheds.hxx>
+#include <vigra/multi_pointoperators.hxx>
+#include <vigra/random.hxx>
+#include <vigra/utilities.hxx>
+
+namespace vigra {
+
+namespace benchmark {
+
+template <class T>
+struct DTypeName;
+
+#define VIGRA_BENCHMARK_DTYPE_NAME(type, name) \
+template <> \
+struct DTypeName<type> \
+{ \
+    static std::string get() { return name; } \
+};
+
+VIGRA_BENCHMARK_DTYPE_NAME(UInt8,  "uint8")
+VIGRA_BENCHMARK_DTYPE_NAME(UInt16, "uint16")
+VIGRA_BENCHMARK_DTYPE_NAME(UInt32, "uint32")
+VIGRA_BENCHMARK_DTYPE_NAME(Int32,  "int32")
+VIGRA_BENCHMARK_DTYPE_NAME(float,  "float32")
+VIGRA_BENCHMARK_DTYPE_NAME(double, "float64")
+
+#undef VIGRA_BENCHMARK_DTYPE_NAME
+
+template <class T>
+inline std::string dtypeName()
+{
+    return DTypeName<T>::get();
+}
+
+    // "256x256x64"
+template <class SHAPE>
+std::string shapeString(SHAPE const & shape)
+{
+    std::ostringstream s;
+    for(int k=0; k<(int)shape.size(); ++k)
+        s << (k == 0 ? "" : "x") << shape[k];
+    return s.str();
+}
+
+    // Largest value used by the generators: the maximum of integer
+    // types, 1.0 for floating point types.
+template <class T>
+inline double dataRangeMax()
+{
+    return NumericTraits<T>::isIntegral::value
+               ? (double)NumericTraits<T>::max()
+               : 1.0;
+}
+
+    // Uniform noise in [0, dataRangeMax<T>()].
+template <unsigned int N, class T>
+MultiArray<N, T>
+noiseArray(typename MultiArrayShape<N>::type const & shape, UInt32 seed = 42)
+{
+    RandomMT19937 random(seed);
+    double hi = dataRangeMax<T>();
+    MultiArray<N, T> res(shape);
+    for(typename MultiArray<N, T>::iterator i = res.begin(); i != res.end(); ++i)
+        *i = NumericTraits<T>::fromRealPromote(random.uniform(0.0, hi));
+    return res;
+}
+
+    // Smooth random landscape: noise smoothed at the given scale and
+    // stretched to [0, dataRangeMax<T>()]. Its local minima are about
+    // 'scale' pixels apart, which controls the number of regions found
+    // by watersheds and the number of blobs after thresholding.
+template <unsigned int N, class T>
+MultiArray<N, T>
+blobArray(typename MultiArrayShape<N>::type const & shape, double scale = 4.0,
+          UInt32 seed = 42)
+{
+    MultiArray<N, float> noise = noiseArray<N, float>(shape, seed),
+                         smooth(shape);
+    gaussianSmoothMultiArray(noise, smooth, scale);
+
+    float lo = 0.0f, hi = 0.0f;
+    smooth.minmax(&lo, &hi);
+    double factor = dataRangeMax<T>() / std::max<double>(hi - lo, 1e-10);
+
+    MultiArray<N, T> res(shape);
+    transformMultiArray(smooth, res,
+        [lo, factor](float v) { return NumericTraits<T>::fromRealPromote((v - lo) * factor); });
+    return res;
+}
+
+    // Binary mask (1 = foreground) of blobArray() thresholded at the
+    // median value, i.e. about half of the pixels are foreground.
+template <unsigned int N>
+MultiArray<N, UInt8>
+maskArray(typename MultiArrayShape<N>::type const & shape, double scale = 4.0,
+          UInt32 seed = 42)
+{
+    MultiArray<N, float> blobs = blobArray<N, float>(shape, scale, seed);
+    MultiArray<N, UInt8> res(shape);
+    transformMultiArray(blobs, res,
+        [](float v) { return v > 0.5f ? UInt8(1) : UInt8(0); });
+    return res;
+}
+
+    // Tessellation into regions of roughly 'scale'^N pixels (the watershed
+    // regions of blobArray()). Returns the largest label.
+template <unsigned int N>
+UInt32
+regionArray(MultiArrayView<N, UInt32> labels, double scale = 4.0, UInt32 seed = 42)
+{
+    MultiArray<N, float> blobs = blobArray<N, float>(labels.shape(), scale, seed);
+    return watershedsMultiArray(blobs, labels, IndirectNeighborhood,
+                                WatershedOptions().unionFind());
+}
+
+    // Classification problem: 'classes' Gaussian clusters with unit
+    // variance, whose centers are drawn uniformly from [0, 4]^features.
+    // Features are stored with one sample per row.
+inline void
+classificationData(int samples, int features, int classes,
+                   MultiArray<2, float> & x, MultiArray<1, int> & y,
+                   UInt32 seed = 42)
+{
+    RandomMT19937 random(seed);
+    MultiArray<2, float> centers(Shape2(classes, features));
+    for(auto & c : centers)
+        c = (float)random.uniform(0.0, 4.0);
+
+    x.reshape(Shape2(samples, features));
+    y.reshape(Shape1(samples));
+    for(int i=0; i<samples; ++i)
+    {
+        int label = random.uniformInt(classes);
+        y(i) = label;
+        for(int j=0; j<features; ++j)
+            x(i, j) = centers(label, j) + (float)random.normal();
+    }
+}
+
+} // namespace benchmark
+
+} // namespace vigra
+
+#endif // VIGRA_BENCHMARK_SYNTHETIC_DATA_HXX
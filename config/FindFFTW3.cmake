@@ -2,15 +2,18 @@
 # Find the native FFTW3 includes and library
 # This module defines
 #  FFTW3_INCLUDE_DIR, where to find FFTW3lib.h, etc.
-#  FFTW3_LIBRARIES, the libraries needed to use FFTW3.
+#  FFTW3_LIBRARIES, the libraries needed to use FFTW3 (including fftw3_threads, if found).
+#  FFTW3_THREADS_FOUND, true if the multi-threaded FFTW3 library was found.
 #  JFFTW3_FOUND, If false, do not try to use FFTW3.
 # also defined, but not for general use are
 #  FFTW3_LIBRARY, where to find the FFTW3 library.
+#  FFTW3_THREADS_LIBRARY, where to find the multi-threaded FFTW3 library.
 
 FIND_PATH(FFTW3_INCLUDE_DIR fftw3.h)
 
 SET(FFTW3_NAMES ${FFTW3_NAMES} fftw3)
 FIND_LIBRARY(FFTW3_LIBRARY NAMES ${FFTW3_NAMES} )
+FIND_LIBRARY(FFTW3_THREADS_LIBRARY NAMES fftw3_threads )
 
 # handle the QUIETLY and REQUIRED arguments and set FFTW3_FOUND to TRUE if 
 # all listed variables are TRUE
@@ -19,6 +22,10 @@ FIND_PACKAGE_HANDLE_STANDARD_ARGS(FFTW3 DEFAULT_MSG FFTW3_LIBRARY FFTW3_INCLUDE_
 
 IF(FFTW3_FOUND)
   SET(FFTW3_LIBRARIES ${FFTW3_LIBRARY})
+  IF(FFTW3_THREADS_LIBRARY)
+    SET(FFTW3_THREADS_FOUND TRUE)
+    SET(FFTW3_LIBRARIES ${FFTW3_THREADS_LIBRARY} ${FFTW3_LIBRARY})
+  ENDIF(FFTW3_THREADS_LIBRARY)
 ENDIF(FFTW3_FOUND)
 
 # Deprecated declarations.
@@ -2,15 +2,18 @@
 # Find the single-precision FFTW3 includes and library
 # This module defines
 #  FFTW3F_INCLUDE_DIR, where to find fftw3.h, etc.
-#  FFTW3F_LIBRARIES, the libraries needed to use single-precision FFTW3.
+#  FFTW3F_LIBRARIES, the libraries needed to use single-precision FFTW3 (including fftw3f_threads, if found).
+#  FFTW3F_THREADS_FOUND, true if the multi-threaded single-precision FFTW3 library was found.
 #  JFFTW3_FOUND, If false, do not try to use FFTW3.
 # also defined, but not for general use are
 #  FFTW3F_LIBRARY, where to find the single-precision FFTW3 library.
+#  FFTW3F_THREADS_LIBRARY, where to find the multi-threaded single-precision FFTW3 library.
 
 FIND_PATH(FFTW3F_INCLUDE_DIR fftw3.h)
 
 SET(FFTW3F_NAMES ${FFTW3F_NAMES} fftw3f)
 FIND_LIBRARY(FFTW3F_LIBRARY NAMES ${FFTW3F_NAMES} )
+FIND_LIBRARY(FFTW3F_THREADS_LIBRARY NAMES fftw3f_threads )
 
 # handle the QUIETLY and REQUIRED arguments and set FFTW3F_FOUND to TRUE if 
 # all listed variables are TRUE
@@ -19,6 +22,10 @@ FIND_PACKAGE_HANDLE_STANDARD_ARGS(FFTW3F DEFAULT_MSG FFTW3F_LIBRARY FFTW3F_INCLU
 
 IF(FFTW3F_FOUND)
   SET(FFTW3F_LIBRARIES ${FFTW3F_LIBRARY})
+  IF(FFTW3F_THREADS_LIBRARY)
+    SET(FFTW3F_THREADS_FOUND TRUE)
+    SET(FFTW3F_LIBRARIES ${FFTW3F_THREADS_LIBRARY} ${FFTW3F_LIBRARY})
+  ENDIF(FFTW3F_THREADS_LIBRARY)
 ENDIF(FFTW3F_FOUND)
 
 # Deprecated declarations.
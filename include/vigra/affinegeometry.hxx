@@ -40,7 +40,10 @@
 #include "matrix.hxx"
 #include "tinyvector.hxx"
 #include "splineimageview.hxx"
+#include "multi_splineview.hxx"
 #include "multi_shape.hxx"
+#include "multi_blocking.hxx"
+#include "threadpool.hxx"
 
 #include <cmath>
 
@@ -412,6 +415,371 @@ affineWarpImage(SplineImageView<ORDER, T> const & src,
     affineWarpImage(src, destImageRange(dest), affineMatrix);
 }
 
+namespace detail {
+
+    // Common implementation of the parallel warps: the destination is processed in
+    // tiles (for locality of the source accesses), and the source coordinates of
+    // each tile that lie inside the source are evaluated in one batch.
+template <class SplineView, unsigned int N, class T2, class S2,
+          class CoordinateFunctor, class InsideFunctor>
+void
+splineWarpMultiArray(SplineView const & src, MultiArrayView<N, T2, S2> dest,
+                     CoordinateFunctor const & coordinate, InsideFunctor const & inside,
+                     ParallelOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename SplineView::difference_type Point;
+    typedef typename SplineView::value_type Value;
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+
+    Shape tileShape(1);
+    tileShape[0] = 64;
+    if(N > 1)
+        tileShape[1] = 16;
+    MultiArrayIndex tileSize = prod(tileShape);
+
+    int threads = options.getActualNumThreads();
+    ArrayVector<ArrayVector<Point> >  points(threads, ArrayVector<Point>(tileSize));
+    ArrayVector<ArrayVector<Shape> >  targets(threads, ArrayVector<Shape>(tileSize));
+    ArrayVector<ArrayVector<Value> >  values(threads, ArrayVector<Value>(tileSize));
+
+    Blocking blocking(dest.shape(), tileShape);
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](int threadId, Block const & tile)
+        {
+            Point * p = points[threadId].begin();
+            Shape * t = targets[threadId].begin();
+            MultiArrayIndex count = 0;
+            MultiCoordinateIterator<N> i(tile.size()), end = i.getEndIterator();
+            for(; i != end; ++i)
+            {
+                Shape target = tile.begin() + *i;
+                Point s = coordinate(target);
+                if(inside(s))
+                {
+                    p[count] = s;
+                    t[count++] = target;
+                }
+            }
+            src.evaluate(MultiArrayView<1, Point>(Shape1(count), p),
+                         MultiArrayView<1, Value>(Shape1(count), values[threadId].begin()));
+            for(MultiArrayIndex k=0; k<count; ++k)
+                dest[t[k]] = detail::RequiresExplicitCast<T2>::cast(values[threadId][k]);
+        },
+        blocking.numBlocks()
+    );
+}
+
+template <class SplineView>
+struct SplineImageViewInside
+{
+    SplineView const & src;
+
+    SplineImageViewInside(SplineView const & s)
+    : src(s)
+    {}
+
+    bool operator()(TinyVector<double, 2> const & p) const
+    {
+        return src.isInside(p[0], p[1]);
+    }
+};
+
+template <class SplineView>
+struct SplineMultiArrayViewInside
+{
+    SplineView const & src;
+
+    SplineMultiArrayViewInside(SplineView const & s)
+    : src(s)
+    {}
+
+    template <class Point>
+    bool operator()(Point const & p) const
+    {
+        return src.isInside(p);
+    }
+};
+
+} // namespace detail
+
+/** \brief Warp an image according to an affine transformation, using several threads.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <int ORDER, class T,
+                  class T2, class S2,
+                  class C>
+        void
+        affineWarpImage(SplineImageView<ORDER, T> const & src,
+                        MultiArrayView<2, T2, S2> dest,
+                        MultiArrayView<2, double, C> const & affineMatrix,
+                        ParallelOptions const & options);
+    }
+    \endcode
+
+    Same as the serial \ref affineWarpImage(), but the destination is processed in
+    tiles by the number of threads given in <tt>options</tt>, and the source points
+    of each tile are interpolated in one batch (see \ref SplineImageView::evaluate()).
+*/
+template <int ORDER, class T,
+          class T2, class S2,
+          class C>
+void
+affineWarpImage(SplineImageView<ORDER, T> const & src,
+                MultiArrayView<2, T2, S2> dest,
+                MultiArrayView<2, double, C> const & affineMatrix,
+                ParallelOptions const & options)
+{
+    vigra_precondition(rowCount(affineMatrix) == 3 && columnCount(affineMatrix) == 3 &&
+                       affineMatrix(2,0) == 0.0 && affineMatrix(2,1) == 0.0 && affineMatrix(2,2) == 1.0,
+        "affineWarpImage(): matrix doesn't represent an affine transformation with homogeneous 2D coordinates.");
+
+    double m[6] = { affineMatrix(0,0), affineMatrix(0,1), affineMatrix(0,2),
+                    affineMatrix(1,0), affineMatrix(1,1), affineMatrix(1,2) };
+    detail::splineWarpMultiArray(src, dest,
+        [&m](Shape2 const & p)
+        {
+            double x = (double)p[0], y = (double)p[1];
+            return TinyVector<double, 2>(x*m[0] + y*m[1] + m[2],
+                                         x*m[3] + y*m[4] + m[5]);
+        },
+        detail::SplineImageViewInside<SplineImageView<ORDER, T> >(src), options);
+}
+
+/** \brief Rotate an image by the given angle, using several threads.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <int ORDER, class T,
+                  class T2, class S2>
+        void
+        rotateImage(SplineImageView<ORDER, T> const & src,
+                    MultiArrayView<2, T2, S2> dest,
+                    double angleInDegree, TinyVector<double, 2> const & center,
+                    ParallelOptions const & options);
+
+        template <int ORDER, class T,
+                  class T2, class S2>
+        void
+        rotateImage(SplineImageView<ORDER, T> const & src,
+                    MultiArrayView<2, T2, S2> dest,
+                    double angleInDegree,
+                    ParallelOptions const & options);
+    }
+    \endcode
+
+    Same as the serial \ref rotateImage(), but the destination is processed in
+    tiles by the number of threads given in <tt>options</tt>. The default center
+    of rotation is the image center.
+*/
+template <int ORDER, class T,
+          class T2, class S2>
+void
+rotateImage(SplineImageView<ORDER, T> const & src,
+            MultiArrayView<2, T2, S2> dest,
+            double angleInDegree, TinyVector<double, 2> const & center,
+            ParallelOptions const & options)
+{
+    double angle = angleInDegree/180.0;
+    double c = cos_pi(angle); // avoid round-off errors for simple rotations
+    double s = sin_pi(angle);
+
+    detail::splineWarpMultiArray(src, dest,
+        [&](Shape2 const & p)
+        {
+            double x = (double)p[0], y = (double)p[1];
+            return TinyVector<double, 2>(
+                 (x - center[0])*c - (y - center[1])*s + center[0],
+                 (x - center[0])*s + (y - center[1])*c + center[1]);
+        },
+        detail::SplineImageViewInside<SplineImageView<ORDER, T> >(src), options);
+}
+
+template <int ORDER, class T,
+          class T2, class S2>
+inline void
+rotateImage(SplineImageView<ORDER, T> const & src,
+            MultiArrayView<2, T2, S2> dest,
+            double angleInDegree,
+            ParallelOptions const & options)
+{
+    TinyVector<double, 2> center((src.width()-1.0) / 2.0, (src.height()-1.0) / 2.0);
+    rotateImage(src, dest, angleInDegree, center, options);
+}
+
+/** \brief Warp an image according to a coordinate map, using several threads.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <int ORDER, class T,
+                  class S1, class T2, class S2>
+        void
+        coordinateWarpImage(SplineImageView<ORDER, T> const & src,
+                            MultiArrayView<2, TinyVector<double, 2>, S1> const & coordinates,
+                            MultiArrayView<2, T2, S2> dest,
+                            ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    For every destination pixel <tt>p</tt>, the source image is interpolated at
+    <tt>coordinates[p]</tt>. Destination pixels whose source coordinates are outside the
+    source image are left unchanged. This is the general form of \ref affineWarpImage()
+    for arbitrary (e.g. non-rigid) transformations.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/affinegeometry.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<2, float> src(width, height), dest(width, height);
+    SplineImageView<3, float> spline(src);
+
+    MultiArray<2, TinyVector<double, 2> > coordinates(dest.shape());
+    ... // e.g. identity plus a displacement field
+
+    coordinateWarpImage(spline, coordinates, dest, ParallelOptions().numThreads(8));
+    \endcode
+*/
+template <int ORDER, class T,
+          class S1, class T2, class S2>
+void
+coordinateWarpImage(SplineImageView<ORDER, T> const & src,
+                    MultiArrayView<2, TinyVector<double, 2>, S1> const & coordinates,
+                    MultiArrayView<2, T2, S2> dest,
+                    ParallelOptions const & options = ParallelOptions())
+{
+    vigra_precondition(coordinates.shape() == dest.shape(),
+        "coordinateWarpImage(): shape mismatch between coordinates and destination.");
+
+    detail::splineWarpMultiArray(src, dest,
+        [&coordinates](Shape2 const & p)
+        {
+            return coordinates[p];
+        },
+        detail::SplineImageViewInside<SplineImageView<ORDER, T> >(src), options);
+}
+
+/** \brief Warp an N-dimensional array according to an affine transformation, using several threads.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, int ORDER, class T,
+                  class T2, class S2,
+                  class C>
+        void
+        affineWarpMultiArray(SplineMultiArrayView<N, ORDER, T> const & src,
+                             MultiArrayView<N, T2, S2> dest,
+                             MultiArrayView<2, double, C> const & affineMatrix,
+                             ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    The N-dimensional counterpart of \ref affineWarpImage(): the matrix is applied to the
+    destination coordinates (in homogeneous form, i.e. it must be an <tt>(N+1)x(N+1)</tt>
+    matrix whose last row is <tt>(0, ..., 0, 1)</tt>), and the source is interpolated
+    at the resulting coordinate if that is inside the source array. Otherwise, the
+    destination element is left unchanged.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/affinegeometry.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(200, 200, 100)), dest(volume.shape());
+    SplineMultiArrayView<3, 3, float> spline(volume);
+
+    Matrix<double> transform(identityMatrix<double>(4));
+    ... // e.g. from a registration
+
+    affineWarpMultiArray(spline, dest, transform, ParallelOptions().numThreads(8));
+    \endcode
+*/
+template <unsigned int N, int ORDER, class T,
+          class T2, class S2,
+          class C>
+void
+affineWarpMultiArray(SplineMultiArrayView<N, ORDER, T> const & src,
+                     MultiArrayView<N, T2, S2> dest,
+                     MultiArrayView<2, double, C> const & affineMatrix,
+                     ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    bool isAffine = rowCount(affineMatrix) == N+1 && columnCount(affineMatrix) == N+1 &&
+                    affineMatrix(N, N) == 1.0;
+    for(unsigned int k=0; k<N && isAffine; ++k)
+        isAffine = affineMatrix(N, k) == 0.0;
+    vigra_precondition(isAffine,
+        "affineWarpMultiArray(): matrix doesn't represent an affine transformation with homogeneous coordinates.");
+
+    Matrix<double> m(affineMatrix);
+    detail::splineWarpMultiArray(src, dest,
+        [&m](Shape const & p)
+        {
+            TinyVector<double, N> res;
+            for(unsigned int i=0; i<N; ++i)
+            {
+                res[i] = m(i, N);
+                for(unsigned int j=0; j<N; ++j)
+                    res[i] += p[j]*m(i, j);
+            }
+            return res;
+        },
+        detail::SplineMultiArrayViewInside<SplineMultiArrayView<N, ORDER, T> >(src), options);
+}
+
+/** \brief Warp an N-dimensional array according to a coordinate map, using several threads.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, int ORDER, class T,
+                  class S1, class T2, class S2>
+        void
+        coordinateWarpMultiArray(SplineMultiArrayView<N, ORDER, T> const & src,
+                                 MultiArrayView<N, TinyVector<double, int(N)>, S1> const & coordinates,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    The N-dimensional counterpart of \ref coordinateWarpImage().
+*/
+template <unsigned int N, int ORDER, class T,
+          class S1, class T2, class S2>
+void
+coordinateWarpMultiArray(SplineMultiArrayView<N, ORDER, T> const & src,
+                         MultiArrayView<N, TinyVector<double, int(N)>, S1> const & coordinates,
+                         MultiArrayView<N, T2, S2> dest,
+                         ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(coordinates.shape() == dest.shape(),
+        "coordinateWarpMultiArray(): shape mismatch between coordinates and destination.");
+
+    detail::splineWarpMultiArray(src, dest,
+        [&coordinates](Shape const & p)
+        {
+            return coordinates[p];
+        },
+        detail::SplineMultiArrayViewInside<SplineMultiArrayView<N, ORDER, T> >(src), options);
+}
+
 
 //@}
 
@@ -0,0 +1,414 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_ALIGNED_ALLOCATOR_HXX
+#define VIGRA_ALIGNED_ALLOCATOR_HXX
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <new>
+
+#if !defined(_WIN32)
+#  include <unistd.h>
+#  include <sys/mman.h>
+#endif
+
+#include "config.hxx"
+#include "error.hxx"
+#include "memory.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+inline std::size_t systemPageSize()
+{
+#if defined(_WIN32)
+    return 4096;
+#else
+    static const std::size_t pageSize = (std::size_t)sysconf(_SC_PAGESIZE);
+    return pageSize;
+#endif
+}
+
+} // namespace detail
+
+/** \addtogroup MultiArrayClasses
+*/
+//@{
+
+    /** \brief Options for \ref vigra::AlignedAllocator.
+
+        The default settings align all allocations to 64 bytes (the cache line size of
+        current CPUs) and initialize the memory serially, as <tt>std::allocator</tt> does.
+        All setters return <tt>*this</tt>, so that settings can be chained:
+
+        \code
+        // page-aligned storage backed by transparent huge pages, whose pages are
+        // first touched by the same threads that later process the array in parallel
+        AlignedAllocator<float> alloc(AllocationOptions().pageAlignment()
+                                                         .hugePages()
+                                                         .parallelInitialization(ParallelOptions()));
+        MultiArray<3, float, AlignedAllocator<float> > volume(Shape3(1000, 1000, 500), alloc);
+        \endcode
+
+        <b>\#include</b> \<vigra/aligned_allocator.hxx\><br/>
+        Namespace: vigra
+    */
+class AllocationOptions
+{
+  public:
+
+        /** Size constants (in bytes).
+        */
+    enum {
+        HugePageSize = 2*1024*1024,                     ///< size of a transparent huge page
+        MinimumParallelInitializationSize = 1024*1024   ///< smaller allocations are always initialized serially
+    };
+
+        /** Memory initialization policies.
+        */
+    enum InitializationMode {
+        SerialInitialization,    ///< construct all elements in the calling thread (default)
+        ParallelInitialization,  ///< construct elements in parallel (see \ref parallelInitialization())
+        NoInitialization         ///< leave memory uninitialized (see \ref skipInitialization())
+    };
+
+    AllocationOptions()
+    : alignment_(64)
+    , huge_page_threshold_(0)
+    , initialization_(SerialInitialization)
+    , parallel_options_(ParallelOptions().numThreads(ParallelOptions::NoThreads))
+    {}
+
+        /** \brief Align all allocations to \a a bytes.
+
+            \a a must be a power of two. Values smaller than <tt>sizeof(void*)</tt>
+            are rounded up.
+
+            Default: 64
+        */
+    AllocationOptions & alignment(std::size_t a)
+    {
+        vigra_precondition(a > 0 && (a & (a - 1)) == 0,
+            "AllocationOptions::alignment(): alignment must be a power of two.");
+        alignment_ = std::max(a, sizeof(void*));
+        return *this;
+    }
+
+        /** \brief Align all allocations to the system's page size.
+        */
+    AllocationOptions & pageAlignment()
+    {
+        return alignment(detail::systemPageSize());
+    }
+
+        /** \brief Back large allocations by transparent huge pages.
+
+            Allocations of at least \a minimumSize bytes are aligned to 2 MB and
+            marked with <tt>madvise(MADV_HUGEPAGE)</tt>, which reduces TLB misses when
+            large arrays are traversed. The kernel may still fall back to normal pages.
+            Passing <tt>0</tt> switches huge pages off. On systems without
+            transparent huge pages, the setting only affects the alignment.
+
+            Default: off
+        */
+    AllocationOptions & hugePages(std::size_t minimumSize = (std::size_t)HugePageSize)
+    {
+        huge_page_threshold_ = minimumSize;
+        return *this;
+    }
+
+        /** \brief Construct the elements of large allocations in parallel.
+
+            On NUMA systems, a memory page is placed on the node of the thread that
+            first writes to it. When a single thread initializes a large array, all
+            pages end up on one node, and parallel algorithms running on the other
+            nodes are limited by remote-memory traffic. Parallel initialization
+            splits the array into one contiguous part per thread, so that the pages
+            are distributed over the nodes in the same way as the contiguous blocks
+            processed by parallel algorithms. Applies to allocations of at least 1 MB
+            whose elements are POD types. Otherwise, initialization is serial.
+
+            Default: serial initialization
+        */
+    AllocationOptions & parallelInitialization(ParallelOptions const & options = ParallelOptions())
+    {
+        initialization_ = ParallelInitialization;
+        parallel_options_ = options;
+        return *this;
+    }
+
+        /** \brief Do not initialize the elements of new allocations.
+
+            Applies to POD element types only, which are left with undefined values.
+            Pages are then first touched by whoever writes the array first, e.g. a
+            parallel filter. Other element types are still default constructed.
+            Only allocations without an explicit initial value are affected, i.e.
+            <tt>MultiArray(shape, alloc)</tt> and its variants. Values passed by the
+            caller, as in <tt>MultiArray(shape, value, alloc)</tt> or
+            <tt>reshape(shape, value)</tt>, and the fill value of chunked arrays
+            are always written.
+        */
+    AllocationOptions & skipInitialization(bool skip = true)
+    {
+        initialization_ = skip
+                             ? NoInitialization
+                             : SerialInitialization;
+        return *this;
+    }
+
+    std::size_t getAlignment() const
+    {
+        return alignment_;
+    }
+
+    std::size_t getHugePageThreshold() const
+    {
+        return huge_page_threshold_;
+    }
+
+    InitializationMode getInitialization() const
+    {
+        return initialization_;
+    }
+
+    ParallelOptions const & getParallelOptions() const
+    {
+        return parallel_options_;
+    }
+
+  private:
+    std::size_t alignment_, huge_page_threshold_;
+    InitializationMode initialization_;
+    ParallelOptions parallel_options_;
+};
+
+    /** \brief Allocator for aligned, optionally huge-page backed memory.
+
+        This allocator can be passed to all containers that accept an allocator,
+        in particular \ref vigra::MultiArray and the chunk storage of
+        \ref vigra::ChunkedArrayFull and \ref vigra::ChunkedArrayLazy. Its behavior
+        is controlled by \ref vigra::AllocationOptions. In addition to alignment and
+        huge pages, these containers honour the allocator's initialization policy
+        when they fill new memory, so that the first touch of each page can be
+        parallelized or left to the algorithm that writes the array first.
+
+        All instances are interchangeable, i.e. memory allocated by one instance can
+        be released by any other.
+
+        <b>\#include</b> \<vigra/aligned_allocator.hxx\><br/>
+        Namespace: vigra
+    */
+template <class T>
+class AlignedAllocator
+{
+  public:
+    typedef T                 value_type;
+    typedef T *               pointer;
+    typedef T const *         const_pointer;
+    typedef T &               reference;
+    typedef T const &         const_reference;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U> other;
+    };
+
+    AlignedAllocator(AllocationOptions const & options = AllocationOptions())
+    : options_(options)
+    {}
+
+    template <class U>
+    AlignedAllocator(AlignedAllocator<U> const & other)
+    : options_(other.options())
+    {}
+
+    pointer allocate(size_type n, void const * = 0)
+    {
+        if(n == 0)
+            return 0;
+        if(n > std::numeric_limits<size_type>::max() / sizeof(T))
+            throw std::bad_alloc();
+
+        std::size_t bytes = n*sizeof(T),
+                    alignment = std::max(options_.getAlignment(), (std::size_t)alignof(T));
+        bool hugePages = options_.getHugePageThreshold() > 0 &&
+                         bytes >= options_.getHugePageThreshold();
+        if(hugePages)
+            alignment = std::max(alignment, (std::size_t)AllocationOptions::HugePageSize);
+
+        void * p = detail::alignedMalloc(bytes, alignment);
+
+#if defined(MADV_HUGEPAGE)
+        if(hugePages)
+            madvise(p, bytes, MADV_HUGEPAGE); // only a hint, failure is harmless
+#endif
+        return static_cast<pointer>(p);
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        detail::alignedFree(p);
+    }
+
+    void construct(pointer p, T const & initial)
+    {
+        new(p) T(initial);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    size_type max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    AllocationOptions const & options() const
+    {
+        return options_;
+    }
+
+  private:
+    AllocationOptions options_;
+};
+
+template <class T, class U>
+inline bool operator==(AlignedAllocator<T> const &, AlignedAllocator<U> const &)
+{
+    return true;
+}
+
+template <class T, class U>
+inline bool operator!=(AlignedAllocator<T> const &, AlignedAllocator<U> const &)
+{
+    return false;
+}
+
+//@}
+
+namespace detail {
+
+template <class T>
+inline void
+uninitializedFillAligned(T * p, std::size_t n, T const & initial,
+                         AlignedAllocator<T> & alloc, VigraFalseType /* isPOD */)
+{
+    construct_n(p, n, initial, alloc);
+}
+
+template <class T>
+void
+uninitializedFillAligned(T * p, std::size_t n, T const & initial,
+                         AlignedAllocator<T> & alloc, VigraTrueType /* isPOD */)
+{
+    AllocationOptions const & options = alloc.options();
+
+    int nThreads = options.getParallelOptions().getActualNumThreads();
+    if(options.getInitialization() != AllocationOptions::ParallelInitialization ||
+       options.getParallelOptions().getNumThreads() == 0 ||
+       nThreads < 2 ||
+       n*sizeof(T) < (std::size_t)AllocationOptions::MinimumParallelInitializationSize)
+    {
+        std::fill(p, p + n, initial);
+        return;
+    }
+
+    // one contiguous part per thread
+    std::size_t partSize = (n + nThreads - 1) / nThreads;
+    parallel_foreach(nThreads, nThreads,
+        [p, n, partSize, &initial](int /* threadId */, std::ptrdiff_t k)
+        {
+            std::size_t begin = std::min(n, k*partSize),
+                        end   = std::min(n, begin + partSize);
+            std::fill(p + begin, p + end, initial);
+        });
+}
+
+    // the initialization policy of AlignedAllocator, used by MultiArray,
+    // ChunkedArrayLazy and friends via uninitializedFillAlloc(),
+    // uninitializedDefaultFillAlloc() and alloc_initialize_n()
+template <class T>
+struct AllocatorInitialization<AlignedAllocator<T> >
+{
+    static void
+    fill(T * p, std::size_t n, T const & initial, AlignedAllocator<T> & alloc)
+    {
+        uninitializedFillAligned(p, n, initial, alloc, typename TypeTraits<T>::isPOD());
+    }
+
+        // only value-less allocations honour skipInitialization()
+    static void
+    fillDefault(T * p, std::size_t n, AlignedAllocator<T> & alloc)
+    {
+        if(TypeTraits<T>::isPOD::value &&
+           alloc.options().getInitialization() == AllocationOptions::NoInitialization)
+            return;
+        fill(p, n, T(), alloc);
+    }
+
+    static T *
+    allocate(std::size_t n, T const & initial, AlignedAllocator<T> & alloc)
+    {
+        T * p = alloc.allocate(n);
+        try
+        {
+            fill(p, n, initial, alloc);
+        }
+        catch (...)
+        {
+            alloc.deallocate(p, n);
+            throw;
+        }
+        return p;
+    }
+};
+
+} // namespace detail
+
+} // namespace vigra
+
+#endif // VIGRA_ALIGNED_ALLOCATOR_HXX
@@ -39,6 +39,7 @@
 #include <algorithm>
 
 #include "threadpool.hxx"
+#include "profiling_macros.hxx"
 #include "counting_iterator.hxx"
 #include "multi_gridgraph.hxx"
 #include "multi_labeling.hxx"
@@ -175,6 +176,7 @@ blockwiseLabeling(DataBlocksIterator data_blocks_begin, DataBlocksIterator data_
 
         parallel_foreach(options.getNumThreads(), d,
             [&](const int /*threadId*/, const uint64_t i){
+                VIGRA_PROFILE_SCOPE_ID("blockwise", "label block", i);
                 Label resVal = labelMultiArray(data_blocks_it[i], label_blocks_it[i],
                                                options, equal);
                 if(has_background) // FIXME: reversed condition?
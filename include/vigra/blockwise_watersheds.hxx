@@ -37,6 +37,7 @@
 #define VIGRA_BLOCKWISE_WATERSHEDS_HXX
 
 #include "threadpool.hxx"
+#include "profiling_macros.hxx"
 #include "multi_array.hxx"
 #include "multi_gridgraph.hxx"
 #include "blockify.hxx"
@@ -75,6 +76,7 @@ void prepareBlockwiseWatersheds(const Overlaps<DataArray>& overlaps,
     parallel_foreach(options.getNumThreads(),
         itBegin,end,
         [&](const int /*threadId*/, const Coordinate  iterVal){
+            VIGRA_PROFILE_SCOPE("blockwise", "watershed directions block");
 
             DirectionsBlock directions_block = directions_blocks_begin[iterVal];
             OverlappingBlock<DataArray> data_block = overlaps[iterVal];
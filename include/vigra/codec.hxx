@@ -47,6 +47,7 @@
 #ifndef VIGRA_CODEC_HXX
 #define VIGRA_CODEC_HXX
 
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -54,6 +55,7 @@
 #include "array_vector.hxx"
 #include "config.hxx"
 #include "diff2d.hxx"
+#include "error.hxx"
 #include "sized_int.hxx"
 
 // possible pixel types:
@@ -137,6 +139,30 @@ namespace vigra
         std::vector<int> bandNumbers;
     };
 
+    namespace detail
+    {
+        // merge N band scanlines into one interleaved scanline, handling all
+        // bands of a pixel in the same iteration (vectorizes for planar input)
+        template <int N, class T>
+        inline void
+        interleaveScanline(const T * const * bands, unsigned int offset,
+                           unsigned int width, T * dest)
+        {
+            if(offset == 1)
+            {
+                for(unsigned int x = 0; x < width; ++x, dest += N)
+                    for(int b = 0; b < N; ++b)
+                        dest[b] = bands[b][x];
+            }
+            else
+            {
+                for(unsigned int x = 0; x < width; ++x, dest += N)
+                    for(int b = 0; b < N; ++b)
+                        dest[b] = bands[b][x*offset];
+            }
+        }
+    } // namespace detail
+
     // Decoder and Encoder are virtual types that define a common
     // interface for all image file formats impex supports.
 
@@ -203,6 +229,92 @@ namespace vigra
         virtual const void * currentScanlineOfBand( unsigned int ) const = 0;
         virtual void nextScanline() = 0;
 
+        // region of interest interface
+        //
+        // readRegion() copies the pixels in [x0, x0+w) x [y0, y0+h) to 'dest'
+        // in interleaved order (bands vary fastest, then x, then y), using the
+        // sample type reported by getPixelType(). Codecs with random access
+        // to the file (e.g. tiled or stripped TIFF) override this function and
+        // decode only the required tiles/strips, using up to 'numThreads' threads
+        // (ParallelOptions semantics: -1 = Auto, 0/1 = sequential).
+        // The default implementation falls back to the scanline interface and
+        // must therefore be called before any scanline has been consumed.
+
+        virtual bool canReadRegion() const
+        {
+            return false;
+        }
+
+        virtual void readRegion( unsigned int x0, unsigned int y0,
+                                 unsigned int w, unsigned int h,
+                                 void * dest, int /* numThreads */ = 1 )
+        {
+            vigra_precondition(x0 + w <= getWidth() && y0 + h <= getHeight(),
+                "Decoder::readRegion(): region exceeds image bounds.");
+
+            // only the sample size matters when moving the data
+            const std::string pixeltype = getPixelType();
+            if(pixeltype == "INT16" || pixeltype == "UINT16")
+                readRegionImpl(x0, y0, w, h, static_cast<UInt16 *>(dest));
+            else if(pixeltype == "INT32" || pixeltype == "UINT32" || pixeltype == "FLOAT")
+                readRegionImpl(x0, y0, w, h, static_cast<UInt32 *>(dest));
+            else if(pixeltype == "DOUBLE")
+                readRegionImpl(x0, y0, w, h, static_cast<UInt64 *>(dest));
+            else
+                readRegionImpl(x0, y0, w, h, static_cast<UInt8 *>(dest));
+        }
+
+      protected:
+
+        template <class T>
+        void readRegionImpl( unsigned int x0, unsigned int y0,
+                             unsigned int w, unsigned int h, T * dest )
+        {
+            const unsigned int bands = getNumBands();
+            const unsigned int offset = getOffset();
+            ArrayVector<const T *> scanlines(bands);
+
+            for(unsigned int y = 0; y < y0 + h; ++y)
+            {
+                nextScanline();
+                if(y < y0)
+                    continue;
+                for(unsigned int b = 0; b < bands; ++b)
+                    scanlines[b] = static_cast<const T *>(currentScanlineOfBand(b)) + x0 * offset;
+
+                if(offset == bands && scanlines[bands-1] == scanlines[0] + bands - 1)
+                {
+                    // interleaved scanline => plain copy
+                    std::memcpy(dest, scanlines[0], sizeof(T) * w * bands);
+                }
+                else
+                {
+                    switch(bands)
+                    {
+                      case 1:
+                        detail::interleaveScanline<1>(scanlines.begin(), offset, w, dest);
+                        break;
+                      case 2:
+                        detail::interleaveScanline<2>(scanlines.begin(), offset, w, dest);
+                        break;
+                      case 3:
+                        detail::interleaveScanline<3>(scanlines.begin(), offset, w, dest);
+                        break;
+                      case 4:
+                        detail::interleaveScanline<4>(scanlines.begin(), offset, w, dest);
+                        break;
+                      default:
+                        for(unsigned int b = 0; b < bands; ++b)
+                            for(unsigned int x = 0; x < w; ++x)
+                                dest[x*bands+b] = scanlines[b][x*offset];
+                    }
+                }
+                dest += w * bands;
+            }
+        }
+
+      public:
+
         typedef ArrayVector<unsigned char> ICCProfile;
 
         const ICCProfile & getICCProfile() const
@@ -259,6 +371,32 @@ namespace vigra
         virtual void * currentScanlineOfBand( unsigned int ) = 0;
         virtual void nextScanline() = 0;
 
+        // tiled (streaming) output interface
+        //
+        // Codecs that store the image in independently compressed tiles
+        // (currently TIFF) accept a tile size before finalizeSettings().
+        // The image can then be written in arbitrary order by writeRegion().
+        // Each region must consist of complete tiles (except at the right and
+        // bottom image border), and 'src' is interleaved as in Decoder::readRegion().
+        // Up to 'numThreads' threads are used to compress the tiles
+        // (ParallelOptions semantics: -1 = Auto, 0/1 = sequential).
+
+        virtual bool canWriteRegion() const
+        {
+            return false;
+        }
+
+        virtual void setTileSize( unsigned int /* width */, unsigned int /* height */ )
+        {
+        }
+
+        virtual void writeRegion( unsigned int, unsigned int,
+                                  unsigned int, unsigned int,
+                                  const void *, int /* numThreads */ = 1 )
+        {
+            vigra_fail("Encoder::writeRegion(): not supported by this codec.");
+        }
+
         struct TIFFCompressionException {};
     };
 
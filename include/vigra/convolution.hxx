@@ -1055,6 +1055,9 @@ gaussianGradient(MultiArrayView<2, T1, S1> const & src,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -655,11 +655,30 @@ struct MultiMathOperand<FFTWComplex<Real> >
     void reset(unsigned int /*LEVEL*/) const
     {}
 
+    void move(unsigned int /*LEVEL*/, MultiArrayIndex /*k*/) const
+    {}
+
+    bool unitStride(unsigned int /*LEVEL*/) const
+    {
+        return true;
+    }
+
+    template <class SHAPE>
+    bool sameStrides(SHAPE const &, SHAPE const &) const
+    {
+        return true;
+    }
+
     FFTWComplex<Real> const & operator*() const
     {
         return v_;
     }
 
+    FFTWComplex<Real> const & flat(MultiArrayIndex /*k*/) const
+    {
+        return v_;
+    }
+
     FFTWComplex<Real> v_;
 };
 
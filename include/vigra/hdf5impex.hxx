@@ -38,6 +38,7 @@
 
 #include <string>
 #include <algorithm>
+#include <map>
 #include <utility>
 
 #define H5Gcreate_vers 2
@@ -985,6 +986,14 @@ class HDF5File
 
     bool read_only_;
 
+    // raw data chunk cache settings per dataset (absolute path), see setChunkCache()
+    struct ChunkCacheSettings
+    {
+        std::size_t bytes, slots;
+        double w0;
+    };
+    std::map<std::string, ChunkCacheSettings> chunk_cache_;
+
     // helper classes for ls() and listAttributes()
     struct ls_closure
     {
@@ -1126,7 +1135,8 @@ class HDF5File
     HDF5File(HDF5File const & other)
     : fileHandle_(other.fileHandle_),
       track_time(other.track_time),
-      read_only_(other.read_only_)
+      read_only_(other.read_only_),
+      chunk_cache_(other.chunk_cache_)
     {
         cGroupHandle_ = HDF5Handle(openCreateGroup_(other.currentGroupName_()), &H5Gclose,
                                    "HDF5File(HDF5File const &): Failed to open group.");
@@ -1157,6 +1167,7 @@ class HDF5File
                                        "HDF5File::operator=(): Failed to open group.");
             track_time = other.track_time;
             read_only_ = other.read_only_;
+            chunk_cache_ = other.chunk_cache_;
         }
         return *this;
     }
@@ -1530,6 +1541,66 @@ class HDF5File
         return HDF5HandleShared(getDatasetHandle_(get_absolute_path(datasetName)), &H5Dclose, errorMessage.c_str());
     }
 
+        /** \brief Configure the raw data chunk cache of a dataset.
+
+            HDF5 keeps recently accessed chunks of a chunked dataset in uncompressed form in a
+            cache that belongs to the open dataset handle. The default cache (1 MB) is often
+            smaller than a single chunk or a row of chunks, so that consecutive block reads
+            decompress the same chunks over and over again. This function sets the cache
+            size in \a bytes, the number of hash table \a slots (ideally a prime about
+            100 times the number of chunks fitting into the cache), and the
+            preemption policy \a w0 (see <tt>H5Pset_chunk_cache()</tt>). The settings apply
+            whenever \a datasetName is subsequently opened or created through this HDF5File
+            (and copies of it), i.e. by getDatasetHandleShared(), readBlock(), readBlocks(),
+            writeBlock(), createDataset(), and \ref ChunkedArrayHDF5. Handles that are
+            already open are not affected.
+
+            If the first character of datasetName is a "/", the path will be interpreted as absolute path,
+            otherwise it will be interpreted as path relative to the current group.
+        */
+    void setChunkCache(std::string datasetName, std::size_t bytes,
+                       std::size_t slots = 10007, double w0 = 0.75)
+    {
+        vigra_precondition(0.0 <= w0 && w0 <= 1.0,
+            "HDF5File::setChunkCache(): w0 must be in [0, 1].");
+        ChunkCacheSettings settings = { bytes, slots, w0 };
+        chunk_cache_[get_absolute_path(datasetName)] = settings;
+    }
+
+        /** \brief Check whether setChunkCache() was called for a dataset.
+
+            This distinguishes an explicitly disabled cache (size 0) from
+            the HDF5 default.
+        */
+    bool hasChunkCache(std::string datasetName) const
+    {
+        return chunk_cache_.find(get_absolute_path(datasetName)) != chunk_cache_.end();
+    }
+
+        /** \brief Query the chunk cache size in bytes that was configured for a dataset
+            by setChunkCache(), or 0 if the HDF5 default is used (see hasChunkCache()).
+        */
+    std::size_t getChunkCacheSize(std::string datasetName) const
+    {
+        std::map<std::string, ChunkCacheSettings>::const_iterator
+            i = chunk_cache_.find(get_absolute_path(datasetName));
+        return i == chunk_cache_.end()
+                   ? 0
+                   : i->second.bytes;
+    }
+
+        /** \brief Query the number of hash table slots of the chunk cache that was
+            configured for a dataset by setChunkCache(), or 0 if the HDF5 default is used.
+        */
+    std::size_t getChunkCacheSlots(std::string datasetName) const
+    {
+        std::map<std::string, ChunkCacheSettings>::const_iterator
+            i = chunk_cache_.find(get_absolute_path(datasetName));
+        return i == chunk_cache_.end()
+                   ? 0
+                   : i->second.slots;
+    }
+
         /** \brief Obtain the HDF5 handle of a group (create the group if it doesn't exist).
          */
     HDF5Handle getGroupHandle(std::string group_name,
@@ -2088,6 +2159,50 @@ class HDF5File
                           TypeTraits::getH5DataType(), TypeTraits::numberOfBands());
     }
 
+        /** \brief Read several blocks of data into multi arrays.
+
+            This is equivalent to calling readBlock() for each pair
+            <tt>(blockOffsets[k], blocks[k])</tt> (the block shapes are given by the arrays),
+            but opens the dataset only once. Thus, the dataset's chunk cache (see
+            setChunkCache()) is retained between the blocks, and chunks shared by
+            neighboring blocks are decompressed only once, provided the cache is
+            large enough. Blocks should therefore be passed in scan order.
+
+            If the first character of datasetName is a "/", the path will be interpreted as absolute path,
+            otherwise it will be interpreted as path relative to the current group.
+        */
+    template<unsigned int N, class T, class Stride>
+    void readBlocks(std::string datasetName,
+                    ArrayVector<typename MultiArrayShape<N>::type> const & blockOffsets,
+                    ArrayVector<MultiArrayView<N, T, Stride> > const & blocks)
+    {
+        // make datasetName clean
+        datasetName = get_absolute_path(datasetName);
+        std::string errorMessage ("HDF5File::readBlocks(): Unable to open dataset '" + datasetName + "'.");
+        HDF5HandleShared dataset(getDatasetHandle_(datasetName), &H5Dclose, errorMessage.c_str());
+        herr_t status = readBlocks(dataset, blockOffsets, blocks);
+        vigra_postcondition(status >= 0,
+            "HDF5File::readBlocks(): read from dataset '" + datasetName + "' via H5Dread() failed.");
+    }
+
+    template<unsigned int N, class T, class Stride>
+    herr_t readBlocks(HDF5HandleShared dataset,
+                      ArrayVector<typename MultiArrayShape<N>::type> const & blockOffsets,
+                      ArrayVector<MultiArrayView<N, T, Stride> > const & blocks)
+    {
+        vigra_precondition(blockOffsets.size() == blocks.size(),
+            "HDF5File::readBlocks(): need as many block offsets as blocks.");
+        typedef detail::HDF5TypeTraits<T> TypeTraits;
+        herr_t status = 0;
+        for(unsigned int k = 0; k < blocks.size() && status >= 0; ++k)
+        {
+            typename MultiArrayShape<N>::type offset(blockOffsets[k]), shape(blocks[k].shape());
+            status = readBlock_(dataset, offset, shape, blocks[k],
+                                TypeTraits::getH5DataType(), TypeTraits::numberOfBands());
+        }
+        return status;
+    }
+
     // non-scalar (TinyVector) and unstrided target MultiArrayView
     template<unsigned int N, class T, int SIZE, class Stride>
     inline void read(std::string datasetName, MultiArrayView<N, TinyVector<T, SIZE>, Stride> array)
@@ -2545,7 +2660,23 @@ class HDF5File
         // Open parent group
         HDF5Handle groupHandle(openGroup_(groupname), &H5Gclose, "HDF5File::getDatasetHandle_(): Internal error");
 
-        return H5Dopen(groupHandle, setname.c_str(), H5P_DEFAULT);
+        HDF5Handle access(datasetAccessProperties_(datasetName));
+        return H5Dopen(groupHandle, setname.c_str(), access);
+    }
+
+        /* get the dataset access property list (including the chunk cache settings)
+           of a dataset specified by its absolute path
+         */
+    HDF5Handle datasetAccessProperties_(std::string const & datasetName) const
+    {
+        std::map<std::string, ChunkCacheSettings>::const_iterator
+            i = chunk_cache_.find(datasetName);
+        if(i == chunk_cache_.end())
+            return HDF5Handle(H5P_DEFAULT, 0, "");
+        HDF5Handle plist(H5Pcreate(H5P_DATASET_ACCESS), &H5Pclose,
+                         "HDF5File::datasetAccessProperties_(): unable to create property list.");
+        H5Pset_chunk_cache(plist, i->second.slots, i->second.bytes, i->second.w0);
+        return plist;
     }
 
         /* get the type of an object specified by a string
@@ -2821,9 +2952,10 @@ HDF5File::createDataset(std::string datasetName,
     }
 
     //create the dataset.
+    HDF5Handle access(datasetAccessProperties_(datasetName));
     HDF5HandleShared datasetHandle(H5Dcreate(parent, setname.c_str(),
                                              TypeTraits::getH5DataType(),
-                                             dataspaceHandle, H5P_DEFAULT, plist, H5P_DEFAULT),
+                                             dataspaceHandle, H5P_DEFAULT, plist, access),
                                    &H5Dclose,
                                    "HDF5File::createDataset(): unable to create dataset.");
     if(parent != cGroupHandle_)
@@ -146,7 +146,8 @@ class ImageExportInfo
 
             If the data is exported to TIFF, the \a mode may be "a", in which case
             the exported image is appended to the existing file, resulting in a
-            multi-page TIFF image.
+            multi-page TIFF image. Mode "w8" enforces the BigTIFF format, which
+            is otherwise chosen automatically for images larger than 4 GB.
          **/
     VIGRA_EXPORT ImageExportInfo( const char * filename, const char * mode = "w" );
     VIGRA_EXPORT ~ImageExportInfo();
@@ -345,6 +346,20 @@ class ImageExportInfo
          **/
     VIGRA_EXPORT ImageExportInfo & setCanvasSize(const Size2D & size);
 
+        /** Store the image in tiles of the given size.
+
+            Currently only supported by TIFF files, where the tile width and height
+            must be multiples of 16. Other file types ignore this setting.
+            Tiled files can be written in arbitrary order via Encoder::writeRegion(),
+            see \ref exportImage() for \ref vigra::ChunkedArray. The default
+            <tt>Size2D(0,0)</tt> means that the image is stored in strips.
+         **/
+    VIGRA_EXPORT ImageExportInfo & setTileSize(const Size2D & size);
+
+        /** Get the tile size (<tt>Size2D(0,0)</tt> if the image is not tiled).
+         **/
+    VIGRA_EXPORT Size2D getTileSize() const;
+
         /**
           ICC profiles (handled as raw data so far).
           see getICCProfile()/setICCProfile()
@@ -366,7 +381,7 @@ class ImageExportInfo
     float m_x_res, m_y_res;
     Diff2D m_pos;
     ICCProfile m_icc_profile;
-    Size2D m_canvas_size;
+    Size2D m_canvas_size, m_tile_size;
     double fromMin_, fromMax_, toMin_, toMax_;
 };
 
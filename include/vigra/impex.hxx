@@ -52,6 +52,7 @@
 #include "imageinfo.hxx"
 #include "impexbase.hxx"
 #include "multi_shape.hxx"
+#include "threadpool.hxx"
 
 namespace vigra
 {
@@ -195,88 +196,143 @@ namespace vigra
         }
 
 
+        // read the current image of an open decoder, the decoder is not closed
         template <class ImageIterator, class ImageAccessor>
         void
-        importImage(const ImageImportInfo& import_info,
-                    ImageIterator image_iterator, ImageAccessor image_accessor,
-                    /* isScalar? */ VigraTrueType)
+        readImage(Decoder * decoder,
+                  ImageIterator image_iterator, ImageAccessor image_accessor,
+                  /* isScalar? */ VigraTrueType)
         {
-            VIGRA_UNIQUE_PTR<Decoder> decoder(vigra::decoder(import_info));
-
             switch (pixel_t_of_string(decoder->getPixelType()))
             {
             case UNSIGNED_INT_8:
-                read_image_band<UInt8>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<UInt8>(decoder, image_iterator, image_accessor);
                 break;
             case UNSIGNED_INT_16:
-                read_image_band<UInt16>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<UInt16>(decoder, image_iterator, image_accessor);
                 break;
             case UNSIGNED_INT_32:
-                read_image_band<UInt32>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<UInt32>(decoder, image_iterator, image_accessor);
                 break;
             case SIGNED_INT_16:
-                read_image_band<Int16>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<Int16>(decoder, image_iterator, image_accessor);
                 break;
             case SIGNED_INT_32:
-                read_image_band<Int32>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<Int32>(decoder, image_iterator, image_accessor);
                 break;
             case IEEE_FLOAT_32:
-                read_image_band<float>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<float>(decoder, image_iterator, image_accessor);
                 break;
             case IEEE_FLOAT_64:
-                read_image_band<double>(decoder.get(), image_iterator, image_accessor);
+                read_image_band<double>(decoder, image_iterator, image_accessor);
                 break;
             default:
                 vigra_fail("detail::importImage<scalar>: not reached");
             }
-
-            decoder->close();
         }
 
 
         template <class ImageIterator, class ImageAccessor>
         void
-        importImage(const ImageImportInfo& import_info,
-                    ImageIterator image_iterator, ImageAccessor image_accessor,
-                    /* isScalar? */ VigraFalseType)
+        readImage(Decoder * decoder,
+                  ImageIterator image_iterator, ImageAccessor image_accessor,
+                  /* isScalar? */ VigraFalseType)
         {
-            vigra_precondition((static_cast<unsigned int>(import_info.numBands())
+            vigra_precondition((decoder->getNumBands()
                                 == image_accessor.size(image_iterator)) ||
-                               import_info.numBands() == 1,
+                               decoder->getNumBands() == 1,
                 "importImage(): Number of channels in input and destination image don't match.");
 
-            VIGRA_UNIQUE_PTR<Decoder> decoder(vigra::decoder(import_info));
-
             switch (pixel_t_of_string(decoder->getPixelType()))
             {
             case UNSIGNED_INT_8:
-                read_image_bands<UInt8>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<UInt8>(decoder, image_iterator, image_accessor);
                 break;
             case UNSIGNED_INT_16:
-                read_image_bands<UInt16>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<UInt16>(decoder, image_iterator, image_accessor);
                 break;
             case UNSIGNED_INT_32:
-                read_image_bands<UInt32>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<UInt32>(decoder, image_iterator, image_accessor);
                 break;
             case SIGNED_INT_16:
-                read_image_bands<Int16>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<Int16>(decoder, image_iterator, image_accessor);
                 break;
             case SIGNED_INT_32:
-                read_image_bands<Int32>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<Int32>(decoder, image_iterator, image_accessor);
                 break;
             case IEEE_FLOAT_32:
-                read_image_bands<float>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<float>(decoder, image_iterator, image_accessor);
                 break;
             case IEEE_FLOAT_64:
-                read_image_bands<double>(decoder.get(), image_iterator, image_accessor);
+                read_image_bands<double>(decoder, image_iterator, image_accessor);
                 break;
             default:
                 vigra_fail("vigra::detail::importImage<non-scalar>: not reached");
             }
+        }
+
 
+        template <class ImageIterator, class ImageAccessor, class IsScalar>
+        void
+        importImage(const ImageImportInfo& import_info,
+                    ImageIterator image_iterator, ImageAccessor image_accessor,
+                    IsScalar isScalar)
+        {
+            VIGRA_UNIQUE_PTR<Decoder> decoder(vigra::decoder(import_info));
+            readImage(decoder.get(), image_iterator, image_accessor, isScalar);
             decoder->close();
         }
 
+        // Fast path for importImage(): when pixel type and band count of the
+        // file match the destination and the destination is contiguous,
+        // the decoder writes directly into the destination memory.
+        template <class T, class S>
+        bool
+        isDirectlyReadable(std::string const & pixeltype, int numBands,
+                           MultiArrayView<2, T, S> const & image)
+        {
+            typedef typename NumericTraits<T>::ValueType ValueType;
+            const int bands = static_cast<int>(sizeof(T) / sizeof(ValueType));
+
+            return image.isUnstrided() &&
+                   sizeof(T) == bands * sizeof(ValueType) &&
+                   numBands == bands &&
+                   TypeAsString<ValueType>::result() == pixeltype;
+        }
+
+        template <class T, class S>
+        bool
+        importImageDirect(const ImageImportInfo& import_info,
+                          MultiArrayView<2, T, S> image)
+        {
+            if (!isDirectlyReadable(import_info.getPixelType(), import_info.numBands(), image))
+                return false;
+
+            VIGRA_UNIQUE_PTR<Decoder> decoder(vigra::decoder(import_info));
+            decoder->readRegion(0U, 0U, decoder->getWidth(), decoder->getHeight(),
+                                image.data());
+            decoder->close();
+            return true;
+        }
+
+        // read the current image of an open decoder into 'image', using the
+        // fast path when possible (the decoder is not closed)
+        template <class T, class S>
+        void
+        readImage(Decoder * decoder, MultiArrayView<2, T, S> image)
+        {
+            typedef typename NumericTraits<T>::isScalar is_scalar;
+
+            vigra_precondition(image.shape() == Shape2(decoder->getWidth(), decoder->getHeight()),
+                "importImage(): shape mismatch between input and output.");
+            if (isDirectlyReadable(decoder->getPixelType(), decoder->getNumBands(), image))
+                decoder->readRegion(0U, 0U, decoder->getWidth(), decoder->getHeight(),
+                                    image.data());
+            else
+                readImage(decoder, destImage(image).first,
+                          typename AccessorTraits<T>::default_accessor(), is_scalar());
+        }
+
         template<class ValueType,
                  class ImageIterator, class ImageAccessor, class ImageScaler>
         void
@@ -643,6 +699,11 @@ namespace vigra
     destination array, only the first band is read. Any other mismatch between the number of bands in
     input and output is an error and will throw a precondition exception.
 
+    When the destination is an unstrided \ref vigra::MultiArrayView whose element type matches
+    the file's pixel type and number of bands (e.g. <tt>MultiArray<2, RGBValue<UInt8> ></tt> for
+    an 8-bit RGB file), the decoder writes the pixels directly into the destination's memory,
+    bypassing the per-pixel accessor and type conversion.
+
     <B>Declarations</B>
 
     pass 2D array views:
@@ -816,7 +877,8 @@ namespace vigra
     {
         vigra_precondition(import_info.shape() == image.shape(),
             "importImage(): shape mismatch between input and output.");
-        importImage(import_info, destImage(image));
+        if (!detail::importImageDirect(import_info, image))
+            importImage(import_info, destImage(image));
     }
 
     template <class T, class A>
@@ -826,7 +888,7 @@ namespace vigra
     {
         ImageImportInfo info(name);
         image.reshape(info.shape());
-        importImage(info, destImage(image));
+        importImage(info, image);
     }
 
     template <class T, class A>
@@ -895,6 +957,30 @@ namespace vigra
     }
     \endcode
 
+    stream a \ref vigra::ChunkedArray into a tiled TIFF file:
+    \code
+    namespace vigra {
+        template <class T>
+        void
+        exportImage(ChunkedArray<2, T> const & image,
+                    ImageExportInfo const & export_info,
+                    ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+    This variant is meant for images that do not fit into memory. It checks out one row of
+    chunks at a time and passes it to the encoder's tiled output interface (see
+    \ref vigra::ImageExportInfo::setTileSize()), so that the memory
+    consumption is bounded by <tt>width * tile_height</tt> pixels. Unless the export info
+    already specifies a tile size, the chunk shape (rounded up to a multiple of 16) is used.
+    The tiles are compressed in parallel according to \a options when the compression
+    is "NONE" or "DEFLATE". All other compressions, including TIFF's default "LZW",
+    are encoded sequentially by libtiff, so pass <tt>setCompression("DEFLATE")</tt>
+    to make use of multiple threads. If the requested compression fails, the image is
+    written again without compression.
+    Files exceeding 4 GB are automatically written as BigTIFF.
+    The pixel type is written without conversion, i.e. a requested
+    pixel type must match the array's value type.
+
     \deprecatedAPI{exportImage}
     pass \ref ImageIterators and \ref DataAccessors :
     \code
@@ -933,6 +1019,12 @@ namespace vigra
     // exception will be thrown.
     exportImage(image,
                 ImageExportInfo("my-INT16-image.tif").setPixelType("INT16"));
+
+    // write a huge chunked image as a tiled and compressed TIFF
+    ChunkedArrayCompressed<2, float> big(Shape2(100000, 100000));
+    ...
+    exportImage(big, ImageExportInfo("big.tif").setCompression("DEFLATE"),
+                ParallelOptions().numThreads(8));
     \endcode
 
     \deprecatedUsage{exportImage}
@@ -1020,6 +1112,74 @@ namespace vigra
         exportImage(srcImageRange(image), export_info);
     }
 
+namespace detail {
+
+    template <class T>
+    void
+    exportChunkedImage(ChunkedArray<2, T> const & image,
+                       ImageExportInfo const & export_info,
+                       ParallelOptions const & options)
+    {
+        typedef typename NumericTraits<T>::ValueType ValueType;
+        typedef typename ChunkedArray<2, T>::shape_type Shape;
+
+        const Shape shape = image.shape();
+        ImageExportInfo info(export_info);
+        if(info.getTileSize().area() == 0)
+        {
+            // round the chunk shape up to the multiple of 16 required by TIFF
+            Shape tile = ((image.chunkShape() + Shape(15)) / 16) * 16;
+            info.setTileSize(Size2D(tile[0], tile[1]));
+        }
+        if(std::string(info.getPixelType()) == "")
+            info.setPixelType(TypeAsString<ValueType>::result().c_str());
+        vigra_precondition(info.getPixelType() == TypeAsString<ValueType>::result(),
+            "exportImage(ChunkedArray): requested pixel type must match the array's value type.");
+
+        VIGRA_UNIQUE_PTR<Encoder> enc = encoder(info);
+        vigra_precondition(enc->canWriteRegion(),
+            "exportImage(ChunkedArray): file type does not support tiled output.");
+        enc->setWidth(shape[0]);
+        enc->setHeight(shape[1]);
+        enc->setNumBands(sizeof(T) / sizeof(ValueType));
+        enc->finalizeSettings();
+
+        // stream one row of tiles at a time
+        const MultiArrayIndex tileHeight = info.getTileSize().height();
+        ArrayVector<T> buffer(shape[0]*std::min(tileHeight, shape[1]));
+        for(MultiArrayIndex y = 0; y < shape[1]; y += tileHeight)
+        {
+            MultiArrayView<2, T> strip(Shape(shape[0], std::min(tileHeight, shape[1] - y)),
+                                       buffer.data());
+            image.checkoutSubarray(Shape(0, y), strip);
+            enc->writeRegion(0, y, strip.shape(0), strip.shape(1), strip.data(),
+                             options.getNumThreads());
+        }
+        enc->close();
+    }
+
+} // namespace detail
+
+    template <class T>
+    void
+    exportImage(ChunkedArray<2, T> const & image,
+                ImageExportInfo const & export_info,
+                ParallelOptions const & options = ParallelOptions())
+    {
+        try
+        {
+            detail::exportChunkedImage(image, export_info, options);
+        }
+        catch (Encoder::TIFFCompressionException&)
+        {
+            ImageExportInfo info(export_info);
+
+            // "" would select TIFF's default compression (LZW), so ask for "NONE" explicitly
+            info.setCompression("NONE");
+            detail::exportChunkedImage(image, info, options);
+        }
+    }
+
 /** @} */
 
 } // end namespace vigra
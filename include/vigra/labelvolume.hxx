@@ -36,6 +36,7 @@
 #ifndef VIGRA_LABELVOLUME_HXX
 #define VIGRA_LABELVOLUME_HXX
 
+#include <iostream>
 
 #include "voxelneighborhood.hxx"
 #include "multi_array.hxx"
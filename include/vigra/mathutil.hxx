@@ -42,6 +42,7 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <cstddef>
 #include <complex>
 #include "config.hxx"
 #include "error.hxx"
@@ -782,6 +783,243 @@ void symmetric3x3Eigenvalues(T a00, T a01, T a02, T a11, T a12, T a22,
         std::swap(*r1, *r2);
 }
 
+    /** \brief Compute the eigenvalues of many 2x2 real symmetric matrices at once.
+
+        The matrices are passed in structure-of-arrays form: <tt>a[0]</tt>, <tt>a[1]</tt> and
+        <tt>a[2]</tt> point to <tt>n</tt> consecutive values of the elements a00, a01, and a11
+        respectively. The eigenvalues of matrix <tt>i</tt> are written in descending order
+        to <tt>r[0][i]</tt> and <tt>r[1][i]</tt>. The loop body contains no branches, so that
+        the compiler can vectorize it. As in \ref symmetric2x2Eigenvalues(), the computations
+        are done in double precision.
+
+        <b>\#include</b> \<vigra/mathutil.hxx\><br>
+        Namespace: vigra
+    */
+template <class T>
+void symmetric2x2EigenvaluesBatch(std::ptrdiff_t n, T const * const * a, T * const * r)
+{
+    T const * a00 = a[0], * a01 = a[1], * a11 = a[2];
+    T * r0 = r[0], * r1 = r[1];
+    for(std::ptrdiff_t i = 0; i < n; ++i)
+    {
+        double s = (double)a00[i] + (double)a11[i],
+               t = (double)a00[i] - (double)a11[i],
+               d = std::sqrt(t*t + 4.0*(double)a01[i]*(double)a01[i]);
+        r0[i] = static_cast<T>(0.5*(s + d));
+        r1[i] = static_cast<T>(0.5*(s - d));
+    }
+}
+
+    /** \brief Compute the eigenvalues of many 3x3 real symmetric matrices at once.
+
+        The matrices are passed in structure-of-arrays form: <tt>a[0]</tt> ... <tt>a[5]</tt>
+        point to <tt>n</tt> consecutive values of the elements a00, a01, a02, a11, a12, a22
+        respectively. The eigenvalues of matrix <tt>i</tt> are written in descending order
+        to <tt>r[0][i]</tt>, <tt>r[1][i]</tt>, and <tt>r[2][i]</tt>. The same formula as in
+        \ref symmetric3x3Eigenvalues() is used, but the sorting is implied by the
+        ordering of the roots, so that the loops contain no branches and can be
+        vectorized. Vectorization of the trigonometric functions requires a vector math
+        library, e.g. glibc's libmvec, which gcc only uses with <tt>-ffast-math</tt>.
+
+        <b>\#include</b> \<vigra/mathutil.hxx\><br>
+        Namespace: vigra
+    */
+template <class T>
+void symmetric3x3EigenvaluesBatch(std::ptrdiff_t n, T const * const * a, T * const * r)
+{
+    enum { BatchSize = 64 };
+    double inv3 = 1.0 / 3.0;
+#ifdef __FAST_MATH__
+    double twoPiDiv3 = 2.0*M_PI / 3.0;
+#else
+    double root3 = std::sqrt(3.0);
+#endif
+    double center[BatchSize], magnitude[BatchSize], angle[BatchSize];
+
+    // The computation is split into two loops communicating via local buffers,
+    // so that neither loop needs more runtime alias checks than compilers
+    // are willing to insert for vectorization.
+    for(std::ptrdiff_t start = 0; start < n; start += BatchSize)
+    {
+        std::ptrdiff_t count = std::min<std::ptrdiff_t>(BatchSize, n - start);
+        T const * p00 = a[0] + start, * p01 = a[1] + start, * p02 = a[2] + start,
+                * p11 = a[3] + start, * p12 = a[4] + start, * p22 = a[5] + start;
+        for(std::ptrdiff_t i = 0; i < count; ++i)
+        {
+            double a00 = p00[i], a01 = p01[i], a02 = p02[i], a11 = p11[i], a12 = p12[i], a22 = p22[i];
+            double c0 = a00*a11*a22 + 2.0*a01*a02*a12 - a00*a12*a12 - a11*a02*a02 - a22*a01*a01;
+            double c1 = a00*a11 - a01*a01 + a00*a22 - a02*a02 + a11*a22 - a12*a12;
+            double c2 = a00 + a11 + a22;
+            double c2Div3 = c2*inv3;
+            double aDiv3 = (c1 - c2*c2Div3)*inv3;
+            aDiv3 = aDiv3 > 0.0 ? 0.0 : aDiv3;
+            double mbDiv2 = 0.5*(c0 + c2Div3*(2.0*c2Div3*c2Div3 - c1));
+            double q = mbDiv2*mbDiv2 + aDiv3*aDiv3*aDiv3;
+            q = q > 0.0 ? 0.0 : q;
+            center[i] = c2Div3;
+            magnitude[i] = 2.0*std::sqrt(-aDiv3);
+            angle[i] = std::atan2(std::sqrt(-q), mbDiv2)*inv3;
+        }
+
+        // angle is in [0, pi/3], hence the roots come out as r0 >= r1 >= r2
+        T * r0 = r[0] + start, * r1 = r[1] + start, * r2 = r[2] + start;
+        for(std::ptrdiff_t i = 0; i < count; ++i)
+        {
+#ifdef __FAST_MATH__
+            // cos() only: vector math libraries have no vectorized sincos(), into
+            // which sin() and cos() of the same argument would be fused
+            r0[i] = static_cast<T>(center[i] + magnitude[i]*std::cos(angle[i]));
+            r1[i] = static_cast<T>(center[i] + magnitude[i]*std::cos(angle[i] - twoPiDiv3));
+            r2[i] = static_cast<T>(center[i] + magnitude[i]*std::cos(angle[i] + twoPiDiv3));
+#else
+            double cs = std::cos(angle[i]), sn = std::sin(angle[i]);
+            r0[i] = static_cast<T>(center[i] + magnitude[i]*cs);
+            r1[i] = static_cast<T>(center[i] - 0.5*magnitude[i]*(cs - root3*sn));
+            r2[i] = static_cast<T>(center[i] - 0.5*magnitude[i]*(cs + root3*sn));
+#endif
+        }
+    }
+}
+
+    /** \brief Compute eigenvalues and eigenvectors of many 2x2 real symmetric matrices at once.
+
+        Input and eigenvalues are passed as in \ref symmetric2x2EigenvaluesBatch(). The
+        unit eigenvector belonging to eigenvalue <tt>k</tt> of matrix <tt>i</tt> is written to
+        <tt>(e[2*k][i], e[2*k+1][i])</tt>. For multiples of the identity matrix, the
+        coordinate axes are returned. The loop body contains no branches.
+
+        <b>\#include</b> \<vigra/mathutil.hxx\><br>
+        Namespace: vigra
+    */
+template <class T>
+void symmetric2x2EigensystemBatch(std::ptrdiff_t n, T const * const * a,
+                                  T * const * r, T * const * e)
+{
+    T const * p00 = a[0], * p01 = a[1], * p11 = a[2];
+    for(std::ptrdiff_t i = 0; i < n; ++i)
+    {
+        double a00 = p00[i], a01 = p01[i], a11 = p11[i];
+        double s = a00 + a11,
+               t = a00 - a11,
+               d = std::sqrt(t*t + 4.0*a01*a01),
+               l0 = 0.5*(s + d);
+        // null vectors of the two rows of (A - l0*I), take the longer one
+        double ux = a01, uy = l0 - a00,
+               vx = l0 - a11, vy = a01,
+               nu = ux*ux + uy*uy,
+               nv = vx*vx + vy*vy;
+        bool useU = nu > nv;
+        double x = useU ? ux : vx,
+               y = useU ? uy : vy,
+               nn = useU ? nu : nv;
+        bool isotropic = nn == 0.0;
+        double f = 1.0 / std::sqrt(isotropic ? 1.0 : nn);
+        x = isotropic ? 1.0 : x*f;
+        y = isotropic ? 0.0 : y*f;
+        r[0][i] = static_cast<T>(l0);
+        r[1][i] = static_cast<T>(0.5*(s - d));
+        e[0][i] = static_cast<T>(x);
+        e[1][i] = static_cast<T>(y);
+        e[2][i] = static_cast<T>(-y);
+        e[3][i] = static_cast<T>(x);
+    }
+}
+
+    /** \brief Compute eigenvalues and eigenvectors of many 3x3 real symmetric matrices at once.
+
+        Input and eigenvalues are passed as in \ref symmetric3x3EigenvaluesBatch(). The
+        unit eigenvector belonging to eigenvalue <tt>k</tt> of matrix <tt>i</tt> is written to
+        <tt>(e[3*k][i], e[3*k+1][i], e[3*k+2][i])</tt>, and the three vectors form a
+        right-handed orthonormal basis.
+
+        The eigenvector of the eigenvalue farthest from the middle one is computed first
+        (as the longest cross product of two rows of <tt>A - lambda*I</tt>), the middle one
+        by solving a 2x2 problem in its orthogonal complement, and the last one as a
+        cross product. This remains accurate for repeated eigenvalues, see
+
+        David Eberly: <a href="https://www.geometrictools.com/Documentation/RobustEigenSymmetric3x3.pdf">
+        <em>"A Robust Eigensolver for 3 x 3 Symmetric Matrices"</em></a>, Geometric Tools Documentation, 2014
+
+        <b>\#include</b> \<vigra/mathutil.hxx\><br>
+        Namespace: vigra
+    */
+template <class T>
+void symmetric3x3EigensystemBatch(std::ptrdiff_t n, T const * const * a,
+                                  T * const * r, T * const * e)
+{
+    symmetric3x3EigenvaluesBatch(n, a, r);
+
+    T const * p00 = a[0], * p01 = a[1], * p02 = a[2], * p11 = a[3], * p12 = a[4], * p22 = a[5];
+    for(std::ptrdiff_t i = 0; i < n; ++i)
+    {
+        double a00 = p00[i], a01 = p01[i], a02 = p02[i], a11 = p11[i], a12 = p12[i], a22 = p22[i];
+        double l0 = r[0][i], l1 = r[1][i], l2 = r[2][i];
+
+        bool firstIsSeparated = (l0 - l1) >= (l1 - l2);
+        double l = firstIsSeparated ? l0 : l2;
+
+        // rows of A - l*I and their cross products
+        double b00 = a00 - l, b11 = a11 - l, b22 = a22 - l;
+        double c0x = a01*a12 - a02*b11,  c0y = a02*a01 - b00*a12, c0z = b00*b11 - a01*a01,
+               c1x = a01*b22 - a02*a12,  c1y = a02*a02 - b00*b22, c1z = b00*a12 - a01*a02,
+               c2x = b11*b22 - a12*a12,  c2y = a12*a02 - a01*b22, c2z = a01*a12 - b11*a02;
+        double n0 = c0x*c0x + c0y*c0y + c0z*c0z,
+               n1 = c1x*c1x + c1y*c1y + c1z*c1z,
+               n2 = c2x*c2x + c2y*c2y + c2z*c2z;
+        bool use1 = n1 > n0;
+        double ux = use1 ? c1x : c0x, uy = use1 ? c1y : c0y, uz = use1 ? c1z : c0z,
+               nu = use1 ? n1 : n0;
+        bool use2 = n2 > nu;
+        ux = use2 ? c2x : ux; uy = use2 ? c2y : uy; uz = use2 ? c2z : uz;
+        nu = use2 ? n2 : nu;
+        // all eigenvalues equal => A is a multiple of the identity
+        bool isotropic = nu == 0.0;
+        double f = 1.0 / std::sqrt(isotropic ? 1.0 : nu);
+        ux = isotropic ? 1.0 : ux*f;
+        uy = isotropic ? 0.0 : uy*f;
+        uz = isotropic ? 0.0 : uz*f;
+
+        // orthonormal basis (v, w) of the complement of u
+        bool xLarger = std::abs(ux) > std::abs(uy);
+        double vx = xLarger ? -uz : 0.0,
+               vy = xLarger ? 0.0 : uz,
+               vz = xLarger ? ux : -uy;
+        f = 1.0 / std::sqrt(vx*vx + vy*vy + vz*vz);
+        vx *= f; vy *= f; vz *= f;
+        double wx = uy*vz - uz*vy, wy = uz*vx - ux*vz, wz = ux*vy - uy*vx;
+
+        // restriction of A - l1*I to span(v, w) and its null vector
+        double avx = a00*vx + a01*vy + a02*vz, avy = a01*vx + a11*vy + a12*vz, avz = a02*vx + a12*vy + a22*vz,
+               awx = a00*wx + a01*wy + a02*wz, awy = a01*wx + a11*wy + a12*wz, awz = a02*wx + a12*wy + a22*wz;
+        double m00 = vx*avx + vy*avy + vz*avz - l1,
+               m01 = vx*awx + vy*awy + vz*awz,
+               m11 = wx*awx + wy*awy + wz*awz - l1;
+        bool row0 = std::abs(m00) + std::abs(m01) >= std::abs(m01) + std::abs(m11);
+        double s = row0 ? -m01 : m11,
+               t = row0 ?  m00 : -m01;
+        double nst = s*s + t*t;
+        bool degenerate = nst == 0.0;
+        f = 1.0 / std::sqrt(degenerate ? 1.0 : nst);
+        s = degenerate ? 1.0 : s*f;
+        t = degenerate ? 0.0 : t*f;
+        double mx = s*vx + t*wx, my = s*vy + t*wy, mz = s*vz + t*wz;
+
+        // the remaining vector completes a right-handed basis (e0, e1, e2)
+        double ox = firstIsSeparated ? uy*mz - uz*my : my*uz - mz*uy,
+               oy = firstIsSeparated ? uz*mx - ux*mz : mz*ux - mx*uz,
+               oz = firstIsSeparated ? ux*my - uy*mx : mx*uy - my*ux;
+        e[0][i] = static_cast<T>(firstIsSeparated ? ux : ox);
+        e[1][i] = static_cast<T>(firstIsSeparated ? uy : oy);
+        e[2][i] = static_cast<T>(firstIsSeparated ? uz : oz);
+        e[3][i] = static_cast<T>(mx);
+        e[4][i] = static_cast<T>(my);
+        e[5][i] = static_cast<T>(mz);
+        e[6][i] = static_cast<T>(firstIsSeparated ? ox : ux);
+        e[7][i] = static_cast<T>(firstIsSeparated ? oy : uy);
+        e[8][i] = static_cast<T>(firstIsSeparated ? oz : uz);
+    }
+}
+
 namespace detail {
 
 template <class T>
@@ -45,7 +45,12 @@
 #  include <memory>
 #endif
 
+#include <cstdlib>
 #include <cstring>
+#include <new>
+#if defined(_WIN32)
+#  include <malloc.h>
+#endif
 #include "metaprogramming.hxx"
 
 namespace vigra {
@@ -115,34 +120,126 @@ destroy_n(T * p, std::size_t n)
     destroy_n(p, n, typename TypeTraits<T>::isPOD());
 }
 
+    // Get raw memory aligned to 'alignment' bytes (a power of two and a
+    // multiple of sizeof(void *)). Release it with alignedFree().
+inline void *
+alignedMalloc(std::size_t bytes, std::size_t alignment)
+{
+    void * p = 0;
+    if(bytes == 0)
+        bytes = 1;
+#if defined(_WIN32)
+    p = _aligned_malloc(bytes, alignment);
+#else
+    if(posix_memalign(&p, alignment, bytes) != 0)
+        p = 0;
+#endif
+    if(p == 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+inline void
+alignedFree(void * p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+    // Copy-construct 'initial' into n uninitialized elements. If a constructor
+    // throws, the elements constructed so far are destroyed before rethrowing.
 template <class T, class Alloc>
-inline T *
-alloc_initialize_n(std::size_t n, T const & initial, Alloc & alloc)
+inline void
+construct_n(T * p, std::size_t n, T const & initial, Alloc & alloc)
+{
+    std::size_t i=0;
+    try
+    {
+        for (; i < n; ++i)
+            std::allocator_traits<Alloc>::construct(alloc, p+i, initial);
+    }
+    catch (...)
+    {
+        for (std::size_t j=0; j < i; ++j)
+            std::allocator_traits<Alloc>::destroy(alloc, p+j);
+        throw;
+    }
+}
+
+    // Initialization of newly allocated memory. Allocators with their own
+    // initialization policy (e.g. AlignedAllocator) specialize this class.
+    // fill() always writes 'initial', fillDefault() is used when the caller
+    // did not request a particular value and may skip the initialization.
+template <class Alloc>
+struct AllocatorInitialization
 {
-    T * p = alloc.allocate(n);
-    bool useMemset = TypeTraits<T>::isPOD::value &&
-                     (initial == T());
-    if(useMemset)
+    template <class T>
+    static void
+    fill(T * p, std::size_t n, T const & initial, Alloc & alloc)
+    {
+        construct_n(p, n, initial, alloc);
+    }
+
+    template <class T>
+    static void
+    fillDefault(T * p, std::size_t n, Alloc & alloc)
     {
-        std::memset(p, 0, n*sizeof(T));
+        fill(p, n, T(), alloc);
     }
-    else
+
+    template <class T>
+    static T *
+    allocate(std::size_t n, T const & initial, Alloc & alloc)
     {
-        std::size_t i=0;
-        try
+        T * p = alloc.allocate(n);
+        bool useMemset = TypeTraits<T>::isPOD::value &&
+                         (initial == T());
+        if(useMemset)
         {
-            for (; i < n; ++i)
-                alloc.construct(p+i, initial);
+            std::memset((void *)p, 0, n*sizeof(T));
         }
-        catch (...)
+        else
         {
-            for (std::size_t j=0; j < i; ++j)
-                alloc.destroy(p+j);
-            alloc.deallocate(p, n);
-            throw;
+            try
+            {
+                construct_n(p, n, initial, alloc);
+            }
+            catch (...)
+            {
+                alloc.deallocate(p, n);
+                throw;
+            }
         }
+        return p;
     }
-    return p;
+};
+
+    // Fill n uninitialized elements with 'initial' according to the allocator's policy.
+template <class T, class Alloc>
+inline void
+uninitializedFillAlloc(T * p, std::size_t n, T const & initial, Alloc & alloc)
+{
+    AllocatorInitialization<Alloc>::fill(p, n, initial, alloc);
+}
+
+    // Default-initialize n uninitialized elements according to the allocator's
+    // policy. Unlike uninitializedFillAlloc(), this may leave POD elements
+    // uninitialized when the allocator asks for it.
+template <class T, class Alloc>
+inline void
+uninitializedDefaultFillAlloc(T * p, std::size_t n, Alloc & alloc)
+{
+    AllocatorInitialization<Alloc>::fillDefault(p, n, alloc);
+}
+
+template <class T, class Alloc>
+inline T *
+alloc_initialize_n(std::size_t n, T const & initial, Alloc & alloc)
+{
+    return AllocatorInitialization<Alloc>::allocate(n, initial, alloc);
 }
 
 template <class T>
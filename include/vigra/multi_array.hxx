@@ -519,7 +519,23 @@ swapDataImpl(SrcIterator s, Shape const & shape, DestIterator d, MetaInt<N>)
     \endcode
 
     Expressions are expanded so that no temporary arrays have to be created. To optimize cache locality,
-    loops are executed in the stride ordering of the left-hand-side array.
+    loops are executed in the stride ordering of the left-hand-side array. When the left-hand-side array
+    is contiguous and all right-hand-side arrays share its memory layout, the expression is evaluated
+    in a single flat loop; otherwise, the innermost loop is flat whenever all arrays are unstrided along
+    the inner axis. Both cases allow the compiler to vectorize the evaluation.
+
+    Large arrays can be processed with several threads by the functions <tt>parallel_assign()</tt>,
+    <tt>parallel_plusAssign()</tt>, <tt>parallel_minusAssign()</tt>, <tt>parallel_multiplyAssign()</tt>,
+    and <tt>parallel_divideAssign()</tt>, which take a \ref vigra::ParallelOptions object
+    as an optional third argument:
+    \code
+    MultiArray<3, float> v(Shape3(1000, 1000, 1000)), w(v.shape());
+
+    parallel_assign(w, (v - 100.0f) / 50.0f);                  // w = (v - 100) / 50, default number of threads
+    parallel_plusAssign(w, sq(v), ParallelOptions().numThreads(4));    // w += v*v, four threads
+    \endcode
+    Since the array is split into independent parts, the right-hand side must not refer to elements of
+    the left-hand-side array other than the one being assigned.
 
     <b>\#include</b> \<vigra/multi_math.hxx\>
 
@@ -2469,6 +2485,16 @@ The template parameters are as follows
        (default: std::allocator<T>)
 \endcode
 
+Pass a \ref vigra::AlignedAllocator (from \<vigra/aligned_allocator.hxx\>) to get cache-line or page aligned storage,
+transparent huge pages for large arrays, and control over how new memory is
+initialized (serially, in parallel for NUMA-friendly first touch, or not at all):
+
+\code
+typedef AlignedAllocator<float> Alloc;
+MultiArray<3, float, Alloc> a(Shape3(1000, 1000, 500),
+                              Alloc(AllocationOptions().hugePages().parallelInitialization()));
+\endcode
+
 <b>\#include</b> \<vigra/multi_array.hxx\> <br/>
 Namespace: vigra
 */
@@ -2566,6 +2592,12 @@ protected:
         */
     void allocate (pointer &ptr, difference_type_1 s, const_reference init);
 
+        /** allocate memory for s pixels, write its address into the given
+            pointer and default-initialize the pixels. The allocator may
+            skip the initialization of POD types (see AllocationOptions::skipInitialization()).
+        */
+    void allocate (pointer &ptr, difference_type_1 s);
+
         /** allocate memory for s pixels, write its address into the given
             pointer and initialize the linearized pixels to the values of init.
         */
@@ -2928,7 +2960,7 @@ MultiArray <N, T, A>::MultiArray (difference_type_1 length,
             0),
   m_alloc(alloc)
 {
-    allocate (this->m_ptr, this->elementCount (), value_type());
+    allocate (this->m_ptr, this->elementCount ());
 }
 
 template <unsigned int N, class T, class A>
@@ -2939,7 +2971,7 @@ MultiArray <N, T, A>::MultiArray (difference_type_1 width, difference_type_1 hei
             0),
   m_alloc(alloc)
 {
-    allocate (this->m_ptr, this->elementCount (), value_type());
+    allocate (this->m_ptr, this->elementCount ());
 }
 
 template <unsigned int N, class T, class A>
@@ -2955,7 +2987,7 @@ MultiArray <N, T, A>::MultiArray (const difference_type &shape,
         this->m_shape [0] = 1;
         this->m_stride [0] = 1;
     }
-    allocate (this->m_ptr, this->elementCount (), value_type());
+    allocate (this->m_ptr, this->elementCount ());
 }
 
 template <unsigned int N, class T, class A>
@@ -3087,14 +3119,28 @@ void MultiArray <N, T, A>::allocate (pointer & ptr, difference_type_1 s,
         return;
     }
     ptr = m_alloc.allocate ((typename A::size_type)s);
-    difference_type_1 i = 0;
     try {
-        for (; i < s; ++i)
-            std::allocator_traits<allocator_type>::construct (m_alloc, ptr + i, init);
+        detail::uninitializedFillAlloc (ptr, (std::size_t)s, init, m_alloc);
+    }
+    catch (...) {
+        m_alloc.deallocate (ptr, (typename A::size_type)s);
+        throw;
+    }
+}
+
+template <unsigned int N, class T, class A>
+void MultiArray <N, T, A>::allocate (pointer & ptr, difference_type_1 s)
+{
+    if(s == 0)
+    {
+        ptr = 0;
+        return;
+    }
+    ptr = m_alloc.allocate ((typename A::size_type)s);
+    try {
+        detail::uninitializedDefaultFillAlloc (ptr, (std::size_t)s, m_alloc);
     }
     catch (...) {
-        for (difference_type_1 j = 0; j < i; ++j)
-            std::allocator_traits<allocator_type>::destroy (m_alloc, ptr + j);
         m_alloc.deallocate (ptr, (typename A::size_type)s);
         throw;
     }
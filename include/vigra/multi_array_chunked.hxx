@@ -35,6 +35,9 @@
 
 /* benchmark results for a simple loop 'if(iter.get<1>() != count++)'
 
+    (Historical numbers. Current measurements for all backends and access
+     patterns are produced by benchmark/bench_chunked.cxx, see 'make benchmark'.)
+
     ********************
     image size: 200^3, chunk size: 64^3, i.e. chunk count: 4^3
     times in msec, excluding time to store file on disk
@@ -138,6 +141,8 @@
 #include "memory.hxx"
 #include "metaprogramming.hxx"
 #include "threading.hxx"
+#include "threadpool.hxx"
+#include "profiling_macros.hxx"
 #include "compression.hxx"
 
 #ifdef _WIN32
@@ -1325,6 +1330,113 @@ class ChunkedArrayOptions
     CompressionMethod compression_method;
 };
 
+/** \brief Reference-counted handle that keeps a single chunk of a ChunkedArray active.
+
+    Objects of this class are obtained from <tt>ChunkedArray::pinChunk()</tt>.
+    As long as the handle (or any copy of it) is alive, the chunk will neither be
+    unloaded nor compressed, so that <tt>view()</tt> can be used as an ordinary
+    \ref MultiArrayView of the chunk's data without copying. Copies share
+    the same reference. The chunk becomes eligible for unloading again when
+    the last copy has been destroyed or <tt>release()</tt>d.
+
+    When <tt>U</tt> is <tt>T const</tt>, the handle refers to a read-only chunk.
+    If such a chunk has never been written, the view points to the array's
+    fill value with zero strides.
+
+    <b>\#include</b> \<vigra/multi_array_chunked.hxx\> <br/>
+    Namespace: vigra
+*/
+template <unsigned int N, class U>
+class PinnedChunk
+{
+  public:
+    typedef typename UnqualifiedType<U>::type       T;
+    typedef typename MultiArrayShape<N>::type       shape_type;
+    typedef MultiArrayView<N, U>                    view_type;
+
+    PinnedChunk()
+    : data_(0)
+    {}
+
+    PinnedChunk(ChunkedArray<N, T> const * array, SharedChunkHandle<N, T> * handle,
+                shape_type const & chunk_index, view_type const & view)
+    : pin_(new Pin(array, handle))
+    , chunk_index_(chunk_index)
+    , chunk_start_(chunk_index*array->chunkShape())
+    , shape_(view.shape())
+    , strides_(view.stride())
+    , data_(view.data())
+    {}
+
+        /** The chunk's data (only valid while <tt>isValid()</tt> is true).
+        */
+    view_type view() const
+    {
+        return view_type(shape_, strides_, data_);
+    }
+
+        /** Index of the chunk in the array of chunks.
+        */
+    shape_type const & chunkIndex() const
+    {
+        return chunk_index_;
+    }
+
+        /** Global coordinate of the chunk's first element.
+        */
+    shape_type const & chunkStart() const
+    {
+        return chunk_start_;
+    }
+
+        /** Global coordinate beyond the chunk's last element.
+        */
+    shape_type chunkStop() const
+    {
+        return chunk_start_ + shape_;
+    }
+
+    bool isValid() const
+    {
+        return pin_ != 0;
+    }
+
+        /** Drop this handle's reference to the chunk. The chunk is unpinned
+            when no other copy of the handle holds a reference.
+        */
+    void release()
+    {
+        pin_.reset();
+        shape_ = shape_type();
+        data_ = 0;
+    }
+
+  private:
+    struct Pin
+    {
+        Pin(ChunkedArray<N, T> const * array, SharedChunkHandle<N, T> * handle)
+        : array_(array)
+        , handle_(handle)
+        {}
+
+        ~Pin()
+        {
+            array_->unrefChunk(handle_);
+        }
+
+        ChunkedArray<N, T> const * array_;
+        SharedChunkHandle<N, T> * handle_;
+
+      private:
+        Pin(Pin const &);
+        Pin & operator=(Pin const &);
+    };
+
+    VIGRA_SHARED_PTR<Pin> pin_;
+    shape_type chunk_index_, chunk_start_, shape_, strides_;
+    U * data_;
+};
+
 /** \weakgroup ParallelProcessing
     \sa ChunkedArray
  */
@@ -1459,6 +1571,21 @@ individual elements are synchronized between threads. This is usually
 achieved by ensuring that the threads are responsible for non-overlapping
 regions of the output array.
 
+When chunks must be handed to code that runs outside the iteration loop
+(e.g. a task scheduler or a Python binding), they can be pinned
+individually. The returned \ref PinnedChunk keeps the chunk active until
+the last copy of the handle is gone:
+\code
+    PinnedChunk<3, float> chunk = chunked_array.pinChunk(Shape3(1, 2, 0));
+    MultiArrayView<3, float> chunk_view = chunk.view();  // no copy
+
+    ... // work phase, possibly in another thread
+
+    chunk.release();
+\endcode
+Finally, <tt>checkoutSubarray()</tt> and <tt>commitSubarray()</tt> accept
+a \ref ParallelOptions object to copy the chunks of a large ROI concurrently.
+
 An even simpler method is direct element access via indexing. However, the
 chunked array has no control over the access order in this case, so it must
 potentially activate the present chunk upon each access. This is rather
@@ -1885,9 +2012,15 @@ class ChunkedArray
                 }
                 else if(rc == chunk_locked)
                 {
-                    // cache management in progress => try again later
-                    threading::this_thread::yield();
-                    rc = handle->chunk_state_.load(threading::memory_order_acquire);
+                    // cache management in progress => wait until the state changes,
+                    // recording the whole wait as a single profiling event
+                    VIGRA_PROFILE_SCOPE("ChunkedArray", "chunk wait");
+                    do
+                    {
+                        threading::this_thread::yield();
+                        rc = handle->chunk_state_.load(threading::memory_order_acquire);
+                    }
+                    while(rc == chunk_locked);
                 }
                 else if(handle->chunk_state_.compare_exchange_weak(rc, chunk_locked, threading::memory_order_seq_cst))
                 {
@@ -1906,10 +2039,25 @@ class ChunkedArray
         if(rc >= 0)
             return handle->pointer_->pointer_;
 
+#ifdef VIGRA_PROFILING
+        // record contention on the chunk lock
+        threading::unique_lock<threading::mutex> guard(*chunk_lock_, threading::try_to_lock);
+        if(!guard.owns_lock())
+        {
+            VIGRA_PROFILE_SCOPE("ChunkedArray", "lock wait");
+            guard.lock();
+        }
+#else
         threading::lock_guard<threading::mutex> guard(*chunk_lock_);
+#endif
         try
         {
-            T * p = self->loadChunk(&handle->pointer_, chunk_index);
+            T * p = 0;
+            {
+                VIGRA_PROFILE_SCOPE_ID("ChunkedArray", "chunk load",
+                                       handle_array_.coordinateToScanOrderIndex(chunk_index));
+                p = self->loadChunk(&handle->pointer_, chunk_index);
+            }
             Chunk * chunk = handle->pointer_;
             if(!isConst && rc == chunk_uninitialized)
                 std::fill(p, p + prod(chunkShape(chunk_index)), this->fill_value_);
@@ -2009,6 +2157,7 @@ class ChunkedArray
                    "ChunkedArray::releaseChunk(): attempt to release fill_value_handle_.");
                 Chunk * chunk = handle->pointer_;
                 this->data_bytes_ -= dataBytes(chunk);
+                VIGRA_PROFILE_SCOPE_ID("ChunkedArray", "chunk unload", handle - handle_array_.data());
                 int didDestroy = unloadChunk(chunk, destroy);
                 this->data_bytes_ += dataBytes(chunk);
                 if(didDestroy)
@@ -2127,6 +2276,115 @@ class ChunkedArray
         }
     }
 
+    /** \brief Copy an ROI of the chunked array into an ordinary MultiArrayView,
+        processing several chunks concurrently.
+
+        Same as the serial version, but the chunks intersecting the ROI are
+        activated and copied in parallel as specified by 'options'.
+    */
+    template <class U, class Stride>
+    void
+    checkoutSubarray(shape_type const & start,
+                     MultiArrayView<N, U, Stride> & subarray,
+                     ParallelOptions const & options) const
+    {
+        shape_type stop   = start + subarray.shape();
+
+        checkSubarrayBounds(start, stop, "ChunkedArray::checkoutSubarray()");
+
+        shape_type first_chunk = chunkStart(start);
+        MultiCoordinateIterator<N> chunks(chunkStop(stop) - first_chunk);
+        parallel_foreach(options.getNumThreads(), prod(chunks.shape()),
+            [&](int /* threadId */, MultiArrayIndex k)
+            {
+                shape_type chunk_index = first_chunk + chunks[k],
+                           chunk_start = max(start, chunk_index*this->chunk_shape_),
+                           chunk_stop  = min(stop, (chunk_index+shape_type(1))*this->chunk_shape_);
+                MultiArrayView<N, U, StridedArrayTag> part =
+                    subarray.subarray(chunk_start-start, chunk_stop-start);
+                this->checkoutSubarray(chunk_start, part);
+            });
+    }
+
+    /** \brief Copy an ordinary MultiArrayView into an ROI of the chunked array,
+        processing several chunks concurrently.
+
+        Same as the serial version, but the chunks intersecting the ROI are
+        activated and written in parallel as specified by 'options'.
+    */
+    template <class U, class Stride>
+    void
+    commitSubarray(shape_type const & start,
+                   MultiArrayView<N, U, Stride> const & subarray,
+                   ParallelOptions const & options)
+    {
+        shape_type stop   = start + subarray.shape();
+
+        vigra_precondition(!this->isReadOnly(),
+                           "ChunkedArray::commitSubarray(): array is read-only.");
+        checkSubarrayBounds(start, stop, "ChunkedArray::commitSubarray()");
+
+        shape_type first_chunk = chunkStart(start);
+        MultiCoordinateIterator<N> chunks(chunkStop(stop) - first_chunk);
+        parallel_foreach(options.getNumThreads(), prod(chunks.shape()),
+            [&](int /* threadId */, MultiArrayIndex k)
+            {
+                shape_type chunk_index = first_chunk + chunks[k],
+                           chunk_start = max(start, chunk_index*this->chunk_shape_),
+                           chunk_stop  = min(stop, (chunk_index+shape_type(1))*this->chunk_shape_);
+                this->commitSubarray(chunk_start,
+                                     subarray.subarray(chunk_start-start, chunk_stop-start));
+            });
+    }
+
+    /** \brief Activate the chunk with index 'chunk_index' and keep it active
+        while the returned handle exists.
+
+        'chunk_index' refers to the array of chunks (see <tt>chunkArrayShape()</tt>).
+        The chunk is allocated and initialized with the fill value if it has never
+        been used before. <tt>PinnedChunk::view()</tt> provides direct access
+        to the chunk's data.
+    */
+    PinnedChunk<N, T>
+    pinChunk(shape_type const & chunk_index)
+    {
+        vigra_precondition(!this->isReadOnly(),
+                           "ChunkedArray::pinChunk(): array is read-only.");
+        vigra_precondition(allLessEqual(shape_type(), chunk_index) &&
+                           allLess(chunk_index, chunkArrayShape()),
+                           "ChunkedArray::pinChunk(): chunk index out of bounds.");
+
+        Handle * handle = lookupHandle(chunk_index);
+        pointer p = getChunk(handle, false, true, chunk_index);
+        return PinnedChunk<N, T>(this, handle, chunk_index,
+                   MultiArrayView<N, T>(chunkShape(chunk_index), handle->strides(), p));
+    }
+
+    /** \brief Activate the chunk with index 'chunk_index' for reading.
+
+        Chunks that have never been written are not allocated. Instead, the
+        handle's view refers to the fill value (with zero strides).
+    */
+    PinnedChunk<N, T const>
+    pinChunk(shape_type const & chunk_index) const
+    {
+        vigra_precondition(allLessEqual(shape_type(), chunk_index) &&
+                           allLess(chunk_index, chunkArrayShape()),
+                           "ChunkedArray::pinChunk(): chunk index out of bounds.");
+
+        ChunkedArray * self = const_cast<ChunkedArray*>(this);
+        Handle * handle = self->lookupHandle(chunk_index);
+        bool insertInCache = true;
+        if(handle->chunk_state_.load() == chunk_uninitialized)
+        {
+            handle = &self->fill_value_handle_;
+            insertInCache = false;
+        }
+        pointer p = getChunk(handle, true, insertInCache, chunk_index);
+        return PinnedChunk<N, T const>(this, handle, chunk_index,
+                   MultiArrayView<N, T const>(chunkShape(chunk_index), handle->strides(), p));
+    }
+
     // helper function for subarray()
     template <class View>
     void subarrayImpl(shape_type const & start, shape_type const & stop,
@@ -2517,6 +2775,9 @@ createCoupledIterator(ChunkedArray<N, T> const & m)
 
 /** Implement ChunkedArray as an ordinary MultiArray with a single chunk.
 
+    The storage is obtained from \a Alloc. Use \ref vigra::AlignedAllocator
+    for aligned, huge-page backed or NUMA-friendly initialized storage.
+
     <b>\#include</b> \<vigra/multi_array_chunked.hxx\> <br/>
     Namespace: vigra
 */
@@ -2685,6 +2946,7 @@ class ChunkedArrayFull
     This optimizes over an ordinary MultiArray by allocating chunks only
     upon the first write. This is especially useful when only a small
     part of the entire array is actually needed, e.g. in a data viewer.
+    Chunks are obtained from \a Alloc, e.g. \ref vigra::AlignedAllocator.
 
     <b>\#include</b> \<vigra/multi_array_chunked.hxx\> <br/>
     Namespace: vigra
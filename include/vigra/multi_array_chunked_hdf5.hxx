@@ -51,6 +51,18 @@
 
 namespace vigra {
 
+namespace detail {
+
+    // HDF5 libraries built without thread-safety must not be called concurrently.
+    // ChunkedArrayHDF5 therefore makes all its HDF5 calls under this global lock.
+inline threading::recursive_mutex & chunkedArrayHDF5Mutex()
+{
+    static threading::recursive_mutex mutex;
+    return mutex;
+}
+
+} // namespace detail
+
 /** \addtogroup ChunkedArrayClasses
 */
 //@{
@@ -67,6 +79,15 @@ namespace vigra {
     This uses the native chunking and compression functionality provided by the
     HDF5 library. Note: This file must only be included when the HDF5 headers
     and libraries are installed on the system.
+
+    Chunks may be loaded and written back from several threads, and different
+    ChunkedArrayHDF5 objects may be used concurrently, even when the HDF5 library
+    was built without thread-safety: all HDF5 calls of this class (including
+    construction, flushToDisk(), close(), and destruction) are serialized by a
+    global lock. This does not cover other uses of \ref HDF5File, which must not
+    run concurrently with a ChunkedArrayHDF5 unless the HDF5 library is thread-safe.
+    Since HDF5 serializes its API calls even in thread-safe builds, the lock
+    costs no parallelism; chunk I/O is sequential either way.
 */
 template <unsigned int N, class T, class Alloc = std::allocator<T> >
 class ChunkedArrayHDF5
@@ -117,6 +138,7 @@ class ChunkedArrayHDF5
             {
                 if(!array_->file_.isReadOnly())
                 {
+                    threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
                     herr_t status = array_->file_.writeBlock(array_->dataset_, start_,
                                           MultiArrayView<N, T>(shape_, this->strides_, this->pointer_));
                     vigra_postcondition(status >= 0,
@@ -135,6 +157,7 @@ class ChunkedArrayHDF5
             if(this->pointer_ == 0)
             {
                 this->pointer_ = alloc_.allocate(this->size());
+                threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
                 herr_t status = array_->file_.readBlock(array_->dataset_, start_, shape_,
                                      MultiArrayView<N, T>(shape_, this->strides_, this->pointer_));
                 vigra_postcondition(status >= 0,
@@ -191,13 +214,12 @@ class ChunkedArrayHDF5
                      ChunkedArrayOptions const & options = ChunkedArrayOptions(),
                      Alloc const & alloc = Alloc())
     : ChunkedArray<N, T>(shape, chunk_shape, options),
-      file_(file),
       dataset_name_(dataset),
       dataset_(),
       compression_(options.compression_method),
       alloc_(alloc)
     {
-        init(mode);
+        init(file, mode);
     }
 
     /** \brief Construct for an already existing dataset with given 'options',
@@ -226,35 +248,39 @@ class ChunkedArrayHDF5
                      HDF5File::OpenMode mode = HDF5File::ReadOnly,
                      ChunkedArrayOptions const & options = ChunkedArrayOptions(),
                      Alloc const & alloc = Alloc())
-    : ChunkedArray<N, T>(shape_type(),
-            ceilPower2<N>(shape_type(file.getChunkShape(dataset).begin())),
-            options),
-      file_(file),
+    : ChunkedArray<N, T>(shape_type(), fileChunkShape(file, dataset), options),
       dataset_name_(dataset),
       dataset_(),
       compression_(options.compression_method),
       alloc_(alloc)
     {
-        init(mode);
+        init(file, mode);
     }
 
 
     // copy constructor
     ChunkedArrayHDF5(const ChunkedArrayHDF5 & src)
     : ChunkedArray<N, T>(src),
-    file_(src.file_),
     dataset_name_(src.dataset_name_),
     compression_(src.compression_),
     alloc_(src.alloc_)
     {
-        if( file_.isReadOnly() )
-            init(HDF5File::ReadOnly);
+        if( src.file_.isReadOnly() )
+            init(src.file_, HDF5File::ReadOnly);
         else
-            init(HDF5File::ReadWrite);
+            init(src.file_, HDF5File::ReadWrite);
     }
 
-    void init(HDF5File::OpenMode mode)
+    static shape_type fileChunkShape(HDF5File const & file, std::string const & dataset)
     {
+        threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
+        return ceilPower2<N>(shape_type(file.getChunkShape(dataset).begin()));
+    }
+
+    void init(HDF5File const & file, HDF5File::OpenMode mode)
+    {
+        threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
+        file_ = file;
         bool exists = file_.existsDataset(dataset_name_);
 
         if(mode == HDF5File::Replace)
@@ -280,23 +306,9 @@ class ChunkedArrayHDF5
 
         if(!exists || mode == HDF5File::New)
         {
-            // FIXME: set rdcc_nbytes to 0 (disable cache, because we don't
-            //        need two caches
-            // H5Pset_chunk_cache (dapl, rdcc_nslots, rdcc_nbytes, rdcc_w0);
-            // Chunk cache size (rdcc_nbytes) should be large
-            // enough to hold all the chunks in a selection
-            // * If this is not possible, it may be best to disable chunk
-            // caching altogether (set rdcc_nbytes to 0)
-            // * rdcc_slots should be a prime number that is at
-            // least 10 to 100 times the number of chunks that can fit
-            // into rdcc_nbytes
-            // * rdcc_w0 should be set to 1 if chunks that have been
-            // fully read/written will never be read/written again
-            //
-            // the above may be WRONG in general - it may only apply if the
-            // chunk size in the file matches the chunk size in the CachedArray.
-            // Otherwise, make sure that the file cache can hold at least as many
-            // chunks as are needed for a single array chunk.
+            // file chunks coincide with the array's chunks (see initChunkCache())
+            if(file_.getChunkCacheSize(dataset_name_) == 0)
+                file_.setChunkCache(dataset_name_, 0);
             if(compression_ == DEFAULT_COMPRESSION)
                 compression_ = ZLIB_FAST;
             vigra_precondition(compression_ != LZ4,
@@ -313,8 +325,6 @@ class ChunkedArrayHDF5
         }
         else
         {
-            dataset_ = file_.getDatasetHandleShared(dataset_name_);
-
             // check shape
             ArrayVector<hsize_t> fileShape(file_.getDatasetShape(dataset_name_));
             typedef detail::HDF5TypeTraits<T> TypeTraits;
@@ -357,7 +367,54 @@ class ChunkedArrayHDF5
             {
                 i->chunk_state_.store(base_type::chunk_asleep);
             }
+
+            initChunkCache();
+            dataset_ = file_.getDatasetHandleShared(dataset_name_);
+        }
+    }
+
+    // The array keeps complete chunks in its own cache, so that HDF5's chunk cache
+    // is useless when the file's chunks coincide with the array's. Otherwise, HDF5's
+    // cache must hold all file chunks overlapping an array chunk (plus the neighbors
+    // shared with the next array chunk), or these file chunks would be decompressed
+    // repeatedly. Settings made by HDF5File::setChunkCache() take precedence.
+    void initChunkCache()
+    {
+        if(file_.hasChunkCache(dataset_name_))
+            return;
+
+        ArrayVector<hsize_t> fileChunkShape(file_.getChunkShape(dataset_name_));
+        const unsigned int bandsDim = fileChunkShape.size() - N;
+        std::size_t chunkCount = 1, chunkBytes = sizeof(T);
+        bool aligned = true;
+        for(unsigned int k = 0; k < N; ++k)
+        {
+            MultiArrayIndex c = fileChunkShape[k + bandsDim];
+            if(c == 0)
+                return; // contiguous dataset
+            aligned = aligned && c == this->chunk_shape_[k];
+            chunkBytes *= c;
+            chunkCount *= std::min((this->chunk_shape_[k] + c - 1) / c + 1,
+                                   (this->shape_[k] + c - 1) / c);
+        }
+        if(aligned)
+        {
+            file_.setChunkCache(dataset_name_, 0);
+            return;
+        }
+        // HDF5 recommends a prime number of hash slots, about 100 times
+        // the number of chunks in the cache
+        std::size_t slots = std::max<std::size_t>(521, 100*chunkCount) | 1;
+        for(std::size_t d = 3; d*d <= slots; d += 2)
+        {
+            if(slots % d == 0)
+            {
+                slots += 2;
+                d = 1;
+            }
         }
+        file_.setChunkCache(dataset_name_,
+                            std::max<std::size_t>(chunkCount * chunkBytes, 1 << 20), slots);
     }
 
     ~ChunkedArrayHDF5()
@@ -373,6 +430,8 @@ class ChunkedArrayHDF5
     void closeImpl(bool force_destroy)
     {
         flushToDiskImpl(true, force_destroy);
+        threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
+        dataset_.close();
         file_.close();
     }
 
@@ -413,6 +472,7 @@ class ChunkedArrayHDF5
                 chunk->write(false);
             }
         }
+        threading::lock_guard<threading::recursive_mutex> hdf5_guard(detail::chunkedArrayHDF5Mutex());
         file_.flushToDisk();
     }
 
@@ -443,7 +503,7 @@ class ChunkedArrayHDF5
 
     virtual std::string backend() const
     {
-        return "ChunkedArrayHDF5<'" + file_.filename() + "/" + dataset_name_ + "'>";
+        return "ChunkedArrayHDF5<'" + fileName() + "/" + dataset_name_ + "'>";
     }
 
     virtual std::size_t dataBytes(ChunkBase<N,T> * c) const
@@ -460,6 +520,7 @@ class ChunkedArrayHDF5
 
     std::string fileName() const
     {
+        threading::lock_guard<threading::recursive_mutex> guard(detail::chunkedArrayHDF5Mutex());
         return file_.filename();
     }
 
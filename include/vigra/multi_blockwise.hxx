@@ -43,7 +43,10 @@
 #include "multi_convolution.hxx"
 #include "multi_tensorutilities.hxx"
 #include "threadpool.hxx"
+#include "profiling_macros.hxx"
 #include "array_vector.hxx"
+#include "scratch_arena.hxx"
+#include "multi_array_chunked.hxx"
 
 namespace vigra{
 
@@ -60,6 +63,7 @@ public:
     BlockwiseOptions()
     :   ParallelOptions()
     ,   blockShape_()
+    ,   scratchArenas_()
     {}
 
         /** Retrieve block shape as a std::vector.
@@ -147,8 +151,38 @@ public:
         ParallelOptions::numThreads(n);
     }
 
+        /** Keep the per-thread scratch memory across calls.
+
+            Blockwise filters take their block buffers and convolution temporaries
+            from one \ref vigra::ScratchArena per thread, which is reused for all blocks
+            of a call. By default, the arenas are released when the call returns.
+            If <tt>keep</tt> is true, the options object (and all its copies) holds on
+            to the arenas, so that subsequent calls (e.g. computing several features in
+            a row) don't need to allocate memory again. An options object with
+            this setting must not be used by concurrent calls.
+
+            Default: <tt>false</tt>
+        */
+    BlockwiseOptions & keepScratchMemory(bool keep = true)
+    {
+        if(keep)
+            scratchArenas_.reset(new ScratchArenaPool());
+        else
+            scratchArenas_.reset();
+        return *this;
+    }
+
+        /** Get the arenas kept by this options object (or a NULL pointer if
+            <tt>keepScratchMemory()</tt> was not set).
+        */
+    VIGRA_SHARED_PTR<ScratchArenaPool> getScratchArenas() const
+    {
+        return scratchArenas_;
+    }
+
 private:
     Shape blockShape_;
+    VIGRA_SHARED_PTR<ScratchArenaPool> scratchArenas_;
 };
 
     /** Option class for blockwise convolution algorithms.
@@ -170,6 +204,20 @@ public:
 
 namespace blockwise{
 
+    /**
+        helper function to get one scratch arena per thread
+        for a blockwise computation with the given options.
+    */
+    inline VIGRA_SHARED_PTR<ScratchArenaPool>
+    scratchArenas(const BlockwiseOptions & options)
+    {
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas = options.getScratchArenas();
+        if(!arenas)
+            arenas.reset(new ScratchArenaPool());
+        arenas->resize(options.getActualNumThreads());
+        return arenas;
+    }
+
     /**
         helper function to create blockwise parallel filters.
         This implementation should be used if the filter functor
@@ -196,23 +244,31 @@ namespace blockwise{
         auto beginIter  =  blocking.blockWithBorderBegin(borderWidth);
         auto endIter   =  blocking.blockWithBorderEnd(borderWidth);
 
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas = scratchArenas(options);
+
         parallel_foreach(options.getNumThreads(),
             beginIter, endIter,
-            [&](const int /*threadId*/, const BlockWithBorder bwb)
+            [&](const int threadId, const BlockWithBorder bwb)
             {
-                // get the input of the block as a view
-                vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
-                                                                             bwb.border().end());
-                // get the output as NEW allocated array
-                vigra::MultiArray<DIM, T_OUT> destSub(sourceSub.shape());
-                // call the functor
-                functor(sourceSub, destSub);
-                 // write the core global out
-                vigra::MultiArrayView<DIM, T_OUT, ST_OUT> destSubCore = destSub.subarray(bwb.localCore().begin(),
-                                                                                bwb.localCore().end());
-                // write the core global out
-                dest.subarray(bwb.core().begin()-blocking.roiBegin(),
-                              bwb.core().end()  -blocking.roiBegin()  ) = destSubCore;
+                VIGRA_PROFILE_SCOPE("blockwise", "block");
+                ScratchArena & arena = (*arenas)[threadId];
+                {
+                    ScratchArena::Scope scope(arena);
+                    // get the input of the block as a view
+                    vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
+                                                                                 bwb.border().end());
+                    // get the output as array from the thread's scratch memory
+                    vigra::MultiArray<DIM, T_OUT, ScratchAllocator<T_OUT> > destSub(sourceSub.shape());
+                    // call the functor
+                    functor(sourceSub, destSub);
+                     // write the core global out
+                    vigra::MultiArrayView<DIM, T_OUT, StridedArrayTag> destSubCore = destSub.subarray(bwb.localCore().begin(),
+                                                                                    bwb.localCore().end());
+                    // write the core global out
+                    dest.subarray(bwb.core().begin()-blocking.roiBegin(),
+                                  bwb.core().end()  -blocking.roiBegin()  ) = destSubCore;
+                }
+                arena.reset();
             },
             blocking.numBlocks()
         );
@@ -248,19 +304,28 @@ namespace blockwise{
         auto beginIter  =  blocking.blockWithBorderBegin(borderWidth);
         auto endIter   =  blocking.blockWithBorderEnd(borderWidth);
 
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas = scratchArenas(options);
+
         parallel_foreach(options.getNumThreads(),
             beginIter, endIter,
-            [&](const int /*threadId*/, const BlockWithBorder bwb)
+            [&](const int threadId, const BlockWithBorder bwb)
             {
-                // get the input of the block as a view
-                vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
-                                                                            bwb.border().end());
-                // get the output of the blocks core as a view
-                vigra::MultiArrayView<DIM, T_OUT, ST_OUT> destCore = dest.subarray(bwb.core().begin(),
-                                                                            bwb.core().end());
-                const Block localCore =  bwb.localCore();
-                // call the functor
-                functor(sourceSub, destCore, localCore.begin(), localCore.end());
+                VIGRA_PROFILE_SCOPE("blockwise", "block");
+                ScratchArena & arena = (*arenas)[threadId];
+                {
+                    // temporaries of the functor are taken from the thread's scratch memory
+                    ScratchArena::Scope scope(arena);
+                    // get the input of the block as a view
+                    vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
+                                                                                bwb.border().end());
+                    // get the output of the blocks core as a view
+                    vigra::MultiArrayView<DIM, T_OUT, ST_OUT> destCore = dest.subarray(bwb.core().begin(),
+                                                                                bwb.core().end());
+                    const Block localCore =  bwb.localCore();
+                    // call the functor
+                    functor(sourceSub, destCore, localCore.begin(), localCore.end());
+                }
+                arena.reset();
             },
             blocking.numBlocks()
         );
@@ -268,6 +333,237 @@ namespace blockwise{
 
     }
 
+    /**
+        helper function to get the block shape for blockwise filters
+        on chunked arrays: the block shape from the options is rounded up
+        to a multiple of the chunk shape, so that every block covers
+        complete chunks of the destination.
+    */
+    template<unsigned int DIM, class T>
+    typename MultiArrayShape<DIM>::type
+    chunkAlignedBlockShape(
+        const ChunkedArray<DIM, T> & array,
+        const BlockwiseOptions & options
+    ){
+        typedef typename MultiArrayShape<DIM>::type Shape;
+        const Shape chunkShape = array.chunkShape();
+        Shape res = options.template getBlockShapeN<DIM>();
+        for(unsigned int d=0; d<DIM; ++d)
+            res[d] = std::max<MultiArrayIndex>(1, (res[d] + chunkShape[d] - 1) / chunkShape[d]) * chunkShape[d];
+        return res;
+    }
+
+    /**
+        helper function to create blockwise parallel filters
+        on chunked arrays. The filter functor must support the
+        ROI/sub array options.
+
+        The input of each block (including its border) is read through
+        the source's chunk cache. When a block coincides with a single
+        chunk of the destination, its core is written directly into that
+        chunk, otherwise it is computed into scratch memory and committed.
+    */
+    template<
+        unsigned int DIM,
+        class T_IN, class T_OUT,
+        class FILTER_FUNCTOR,
+        class C
+    >
+    void blockwiseCaller(
+        const ChunkedArray<DIM, T_IN> & source,
+        ChunkedArray<DIM, T_OUT> & dest,
+        FILTER_FUNCTOR & functor,
+        const vigra::MultiBlocking<DIM, C> & blocking,
+        const typename vigra::MultiBlocking<DIM, C>::Shape & borderWidth,
+        const BlockwiseConvolutionOptions<DIM>  & options
+    ){
+        typedef typename MultiBlocking<DIM, C>::BlockWithBorder BlockWithBorder;
+        typedef typename MultiBlocking<DIM, C>::Block Block;
+        typedef typename ChunkedArray<DIM, T_OUT>::chunk_iterator ChunkIter;
+
+        vigra_precondition(source.shape() == dest.shape(),
+            "blockwiseCaller(): shape mismatch between source and destination.");
+        vigra_precondition(!dest.isReadOnly(),
+            "blockwiseCaller(): destination array is read-only.");
+
+        auto beginIter  =  blocking.blockWithBorderBegin(borderWidth);
+        auto endIter   =  blocking.blockWithBorderEnd(borderWidth);
+
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas = scratchArenas(options);
+
+        parallel_foreach(options.getNumThreads(),
+            beginIter, endIter,
+            [&](const int threadId, const BlockWithBorder bwb)
+            {
+                VIGRA_PROFILE_SCOPE("blockwise", "block");
+                ScratchArena & arena = (*arenas)[threadId];
+                {
+                    ScratchArena::Scope scope(arena);
+                    // read the input of the block including its border
+                    vigra::MultiArray<DIM, T_IN, ScratchAllocator<T_IN> > sourceSub(bwb.border().size());
+                    source.checkoutSubarray(bwb.border().begin(), sourceSub);
+
+                    const Block localCore =  bwb.localCore();
+                    ChunkIter chunk = dest.chunk_begin(bwb.core().begin(), bwb.core().end());
+                    if(chunk.chunkStart() == bwb.core().begin() && chunk.chunkStop() == bwb.core().end())
+                    {
+                        // the core is a complete chunk => write into the chunk
+                        vigra::MultiArrayView<DIM, T_OUT> destCore(*chunk);
+                        functor(sourceSub, destCore, localCore.begin(), localCore.end());
+                    }
+                    else
+                    {
+                        vigra::MultiArray<DIM, T_OUT, ScratchAllocator<T_OUT> > destCore(bwb.core().size());
+                        functor(sourceSub, destCore, localCore.begin(), localCore.end());
+                        dest.commitSubarray(bwb.core().begin(), destCore);
+                    }
+                }
+                arena.reset();
+            },
+            blocking.numBlocks()
+        );
+    }
+
+    /**
+        helper function to add one task per block of \a blocking to a
+        \ref vigra::TaskGraph. The task of each block calls
+        <tt>f(threadId, blockWithBorder)</tt>.
+
+        If \a previousStage is not empty, it must contain the task IDs of a
+        previous stage over the same blocking (in the order returned by this
+        function). The task of a block then depends on those tasks of the
+        previous stage whose blocks intersect the block's border, i.e. it
+        starts as soon as its input is complete, while other blocks of
+        the previous stage may still be running.
+
+        Returns the IDs of the new tasks in block scan order.
+    */
+    template<unsigned int DIM, class C, class F>
+    std::vector<TaskGraph::TaskId>
+    addBlockwiseTasks(
+        TaskGraph & graph,
+        const vigra::MultiBlocking<DIM, C> & blocking,
+        const typename vigra::MultiBlocking<DIM, C>::Shape & borderWidth,
+        F f,
+        const std::vector<TaskGraph::TaskId> & previousStage = std::vector<TaskGraph::TaskId>()
+    ){
+        typedef typename MultiBlocking<DIM, C>::Shape Shape;
+        typedef typename MultiBlocking<DIM, C>::BlockWithBorder BlockWithBorder;
+
+        vigra_precondition(previousStage.empty() || previousStage.size() == blocking.numBlocks(),
+            "addBlockwiseTasks(): previous stage must have one task per block.");
+
+        const Shape blocksPerAxis = blocking.blocksPerAxis();
+        const Shape blockShape = blocking.blockShape();
+        const Shape roiBegin = blocking.roiBegin();
+        const Shape roiEnd = blocking.roiEnd();
+        Shape stride(1);
+        for(unsigned int d=1; d<DIM; ++d)
+            stride[d] = stride[d-1] * blocksPerAxis[d-1];
+
+        // all tasks share one copy of the functor
+        VIGRA_SHARED_PTR<F> functor(new F(f));
+
+        std::vector<TaskGraph::TaskId> res;
+        res.reserve(blocking.numBlocks());
+        auto iter = blocking.blockWithBorderBegin(borderWidth);
+        auto endIter = blocking.blockWithBorderEnd(borderWidth);
+        for(; iter != endIter; ++iter)
+        {
+            const BlockWithBorder bwb = *iter;
+            std::vector<TaskGraph::TaskId> dependencies;
+            if(!previousStage.empty())
+            {
+                // range of blocks covered by the border
+                Shape first, last;
+                for(unsigned int d=0; d<DIM; ++d)
+                {
+                    first[d] = (std::max(bwb.border().begin()[d], roiBegin[d]) - roiBegin[d]) / blockShape[d];
+                    last[d]  = (std::min(bwb.border().end()[d], roiEnd[d]) - 1 - roiBegin[d]) / blockShape[d];
+                }
+                MultiCoordinateIterator<DIM> c(last - first + Shape(1)),
+                                             cend = c.getEndIterator();
+                for(; c != cend; ++c)
+                    dependencies.push_back(previousStage[dot(first + *c, stride)]);
+            }
+            res.push_back(graph.add(
+                [functor, bwb](int threadId)
+                {
+                    (*functor)(threadId, bwb);
+                },
+                dependencies));
+        }
+        return res;
+    }
+
+    /**
+        helper function to add the tasks of a blockwise parallel filter
+        to a \ref vigra::TaskGraph. The filter functor must support the
+        ROI/sub array options. The block computations are the same as in
+        blockwiseCaller(), and the per-block dependencies on \a previousStage
+        are set up as in addBlockwiseTasks().
+
+        This allows to pipeline multi-stage filters, where the \a source of
+        one stage is the \a dest of the previous one: a block of the next
+        stage starts as soon as the blocks of the previous stage that cover
+        its border are finished. \a source, \a dest, \a functor, and \a arenas
+        must stay alive until the graph was run, and \a arenas must hold one
+        arena per thread of the pool the graph is run on (see scratchArenas()).
+
+        Only read-after-write dependencies are tracked: a block waits for the
+        blocks of the previous stage that produce its input, but no stage
+        waits for later stages to finish reading. Therefore, the \a dest of
+        each stage must not alias (or overlap) the \a source of any earlier
+        stage, i.e. in-place stages and ping-pong buffers are not allowed.
+    */
+    template<
+        unsigned int DIM,
+        class T_IN, class ST_IN,
+        class T_OUT, class ST_OUT,
+        class FILTER_FUNCTOR,
+        class C
+    >
+    std::vector<TaskGraph::TaskId>
+    addBlockwiseFilterTasks(
+        TaskGraph & graph,
+        const vigra::MultiArrayView<DIM, T_IN,  ST_IN > & source,
+        const vigra::MultiArrayView<DIM, T_OUT, ST_OUT> & dest,
+        FILTER_FUNCTOR & functor,
+        const vigra::MultiBlocking<DIM, C> & blocking,
+        const typename vigra::MultiBlocking<DIM, C>::Shape & borderWidth,
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas,
+        const std::vector<TaskGraph::TaskId> & previousStage = std::vector<TaskGraph::TaskId>()
+    ){
+        typedef typename MultiBlocking<DIM, C>::BlockWithBorder BlockWithBorder;
+        typedef typename MultiBlocking<DIM, C>::Block Block;
+
+        vigra::MultiArrayView<DIM, T_IN,  ST_IN > src(source);
+        vigra::MultiArrayView<DIM, T_OUT, ST_OUT> dst(dest);
+        FILTER_FUNCTOR * func = &functor;
+
+        return addBlockwiseTasks(graph, blocking, borderWidth,
+            [src, dst, func, arenas](const int threadId, const BlockWithBorder & bwb)
+            {
+                VIGRA_PROFILE_SCOPE("blockwise", "block");
+                ScratchArena & arena = (*arenas)[threadId];
+                {
+                    // temporaries of the functor are taken from the thread's scratch memory
+                    ScratchArena::Scope scope(arena);
+                    // get the input of the block as a view
+                    vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = src.subarray(bwb.border().begin(),
+                                                                             bwb.border().end());
+                    // get the output of the blocks core as a view
+                    vigra::MultiArrayView<DIM, T_OUT, ST_OUT> destCore = dst.subarray(bwb.core().begin(),
+                                                                              bwb.core().end());
+                    const Block localCore =  bwb.localCore();
+                    // call the functor
+                    (*func)(sourceSub, destCore, localCore.begin(), localCore.end());
+                }
+                arena.reset();
+            },
+            previousStage);
+    }
+
     #define CONVOLUTION_FUNCTOR(FUNCTOR_NAME, FUNCTION_NAME) \
     template<unsigned int DIM> \
     class FUNCTOR_NAME{ \
@@ -310,14 +606,16 @@ namespace blockwise{
         template<class S, class D>
         void operator()(const S & s, D & d)const{
             typedef typename vigra::NumericTraits<typename S::value_type>::RealPromote RealType;
-            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)> >  hessianOfGaussianRes(d.shape());
+            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)>,
+                              ScratchAllocator<TinyVector<RealType, int(DIM*(DIM+1)/2)> > >  hessianOfGaussianRes(d.shape());
             vigra::hessianOfGaussianMultiArray(s, hessianOfGaussianRes, sharedOpt_);
             vigra::tensorEigenvaluesMultiArray(hessianOfGaussianRes, d);
         }
         template<class S, class D,class SHAPE>
         void operator()(const S & s, D & d, const SHAPE & roiBegin, const SHAPE & roiEnd){
             typedef typename vigra::NumericTraits<typename S::value_type>::RealPromote RealType;
-            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)> >  hessianOfGaussianRes(roiEnd-roiBegin);
+            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)>,
+                              ScratchAllocator<TinyVector<RealType, int(DIM*(DIM+1)/2)> > >  hessianOfGaussianRes(roiEnd-roiBegin);
             ConvOpt localOpt(sharedOpt_);
             localOpt.subarray(roiBegin, roiEnd);
             vigra::hessianOfGaussianMultiArray(s, hessianOfGaussianRes, localOpt);
@@ -338,10 +636,12 @@ namespace blockwise{
             typedef typename vigra::NumericTraits<typename S::value_type>::RealPromote RealType;
 
             // compute the hessian of gaussian and extract eigenvalue
-            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)> >  hessianOfGaussianRes(s.shape());
+            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)>,
+                              ScratchAllocator<TinyVector<RealType, int(DIM*(DIM+1)/2)> > >  hessianOfGaussianRes(s.shape());
             vigra::hessianOfGaussianMultiArray(s, hessianOfGaussianRes, sharedOpt_);
 
-            vigra::MultiArray<DIM, TinyVector<RealType, DIM > >  allEigenvalues(s.shape());
+            vigra::MultiArray<DIM, TinyVector<RealType, DIM >,
+                              ScratchAllocator<TinyVector<RealType, DIM > > >  allEigenvalues(s.shape());
             vigra::tensorEigenvaluesMultiArray(hessianOfGaussianRes, allEigenvalues);
 
             d = allEigenvalues.bindElementChannel(EV);
@@ -352,12 +652,14 @@ namespace blockwise{
             typedef typename vigra::NumericTraits<typename S::value_type>::RealPromote RealType;
 
             // compute the hessian of gaussian and extract eigenvalue
-            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)> >  hessianOfGaussianRes(roiEnd-roiBegin);
+            vigra::MultiArray<DIM, TinyVector<RealType, int(DIM*(DIM+1)/2)>,
+                              ScratchAllocator<TinyVector<RealType, int(DIM*(DIM+1)/2)> > >  hessianOfGaussianRes(roiEnd-roiBegin);
             ConvOpt localOpt(sharedOpt_);
             localOpt.subarray(roiBegin, roiEnd);
             vigra::hessianOfGaussianMultiArray(s, hessianOfGaussianRes, localOpt);
 
-            vigra::MultiArray<DIM, TinyVector<RealType, DIM > >  allEigenvalues(roiEnd-roiBegin);
+            vigra::MultiArray<DIM, TinyVector<RealType, DIM >,
+                              ScratchAllocator<TinyVector<RealType, DIM > > >  allEigenvalues(roiEnd-roiBegin);
             vigra::tensorEigenvaluesMultiArray(hessianOfGaussianRes, allEigenvalues);
 
             d = allEigenvalues.bindElementChannel(EV);
@@ -432,6 +734,23 @@ void FUNCTION( \
     const Blocking blocking(source.shape(), options.template getBlockShapeN<N>()); \
     blockwise::FUNCTOR<N> f(subOptions); \
     blockwise::blockwiseCaller(source, dest, f, blocking, border, options); \
+} \
+\
+template <unsigned int N, class T1, class T2> \
+void FUNCTION( \
+    ChunkedArray<N, T1> const & source, \
+    ChunkedArray<N, T2> & dest, \
+    BlockwiseConvolutionOptions<N> const & options \
+) \
+{  \
+    typedef  MultiBlocking<N, vigra::MultiArrayIndex> Blocking; \
+    typedef typename Blocking::Shape Shape; \
+    const Shape border = blockwise::getBorder(options, ORDER, USES_OUTER_SCALE); \
+    BlockwiseConvolutionOptions<N> subOptions(options); \
+    subOptions.subarray(Shape(0), Shape(0));  \
+    const Blocking blocking(source.shape(), blockwise::chunkAlignedBlockShape(dest, options)); \
+    blockwise::FUNCTOR<N> f(subOptions); \
+    blockwise::blockwiseCaller(source, dest, f, blocking, border, options); \
 }
 
 VIGRA_BLOCKWISE(GaussianSmoothFunctor,                   gaussianSmoothMultiArray,                   0, false );
@@ -459,6 +778,16 @@ gaussianGradientMagnitude(
     gaussianGradientMagnitudeMultiArray(source, dest, options);
 }
 
+template <unsigned int N, class T1, class T2>
+inline void
+gaussianGradientMagnitude(
+    ChunkedArray<N, T1> const & source,
+    ChunkedArray<N, T2> & dest,
+    BlockwiseConvolutionOptions<N> const & options)
+{
+    gaussianGradientMagnitudeMultiArray(source, dest, options);
+}
+
 
 } // end namespace vigra
 
@@ -47,9 +47,11 @@
 #include "metaprogramming.hxx"
 #include "multi_pointoperators.hxx"
 #include "multi_math.hxx"
+#include "recursiveconvolution.hxx"
 #include "functorexpression.hxx"
 #include "tinyvector.hxx"
 #include "algorithm.hxx"
+#include "scratch_arena.hxx"
 
 
 #include <iostream>
@@ -243,6 +245,18 @@ struct multiArrayScaleParam
       member_name.vec = vec; \
     }
 
+/** \brief Implementation of the Gaussian filters.
+
+    Selects how the Gaussian filters (e.g. \ref gaussianSmoothMultiArray())
+    are computed, see \ref vigra::ConvolutionOptions::filterMethod().
+*/
+enum GaussianFilterMethod
+{
+    GaussianFilterFIR,       ///< always convolve with a sampled Gaussian kernel
+    GaussianFilterAuto,      ///< use the recursive filter when the scale is large
+    GaussianFilterRecursive  ///< always use the recursive filter (see \ref recursiveGaussianFilterMultiArray())
+};
+
 /** \brief  Options class template for convolutions.
 
   <b>\#include</b> \<vigra/multi_convolution.hxx\><br/>
@@ -345,13 +359,17 @@ class ConvolutionOptions
     ParamVec outer_scale;
     double window_ratio;
     Shape from_point, to_point;
+    GaussianFilterMethod filter_method;
+    double recursive_threshold;
 
     ConvolutionOptions()
     : sigma_eff(0.0),
       sigma_d(0.0),
       step_size(1.0),
       outer_scale(0.0),
-      window_ratio(0.0)
+      window_ratio(0.0),
+      filter_method(GaussianFilterFIR),
+      recursive_threshold(8.0)
     {}
 
     typedef typename detail::WrapDoubleIteratorTriple<ParamIt, ParamIt, ParamIt>
@@ -485,6 +503,65 @@ class ConvolutionOptions
       return window_ratio;
     }
 
+        /** Choose the implementation of the Gaussian filters and their derivatives.
+
+            <tt>GaussianFilterFIR</tt> convolves with sampled Gaussian kernels, whose
+            cost grows linearly with the scale. <tt>GaussianFilterRecursive</tt> uses
+            the recursive filter of Young and van Vliet (see \ref recursiveGaussianFilterMultiArray()),
+            whose cost is independent of the scale, but which is only an approximation
+            of the Gaussian (derivatives are computed by central differences of the
+            recursively smoothed data). Its impulse response has the correct
+            variance, but deviates from the Gaussian by up to 10% of the peak value,
+            and border treatment is only approximately reflective. <tt>GaussianFilterAuto</tt>
+            uses the recursive filter along all axes whose scale is at least
+            \ref recursiveFilterThreshold(), unless an explicit
+            \ref filterWindowSize() was requested.
+
+            Default: <tt>GaussianFilterFIR</tt>
+        */
+    ConvolutionOptions<dim> & filterMethod(GaussianFilterMethod method)
+    {
+        filter_method = method;
+        return *this;
+    }
+
+    GaussianFilterMethod getFilterMethod() const {
+      return filter_method;
+    }
+
+        /** Smallest scale (in pixels) for which <tt>GaussianFilterAuto</tt>
+            switches to the recursive filter.
+
+            Default: <tt>8.0</tt>
+        */
+    ConvolutionOptions<dim> & recursiveFilterThreshold(double sigma)
+    {
+        vigra_precondition(sigma >= 0.0,
+            "ConvolutionOptions::recursiveFilterThreshold(): threshold must not be negative.");
+        recursive_threshold = sigma;
+        return *this;
+    }
+
+    double getRecursiveFilterThreshold() const {
+      return recursive_threshold;
+    }
+
+        /** Check whether a Gaussian with the given scale (in pixels) is to be
+            computed by the recursive filter.
+        */
+    bool useRecursiveFilter(double sigma) const
+    {
+        switch(filter_method)
+        {
+          case GaussianFilterRecursive:
+            return true;
+          case GaussianFilterAuto:
+            return window_ratio == 0.0 && sigma >= recursive_threshold;
+          default:
+            return false;
+        }
+    }
+
         /** Restrict the filter to a subregion of the input array.
 
             This is useful for speeding up computations by ignoring irrelevant
@@ -532,7 +609,7 @@ internalSeparableConvolveMultiArrayTmp(
     typedef typename AccessorTraits<TmpType>::default_accessor TmpAcessor;
 
     // temporary array to hold the current line to enable in-place operation
-    ArrayVector<TmpType> tmp( shape[0] );
+    ArrayVector<TmpType, ScratchAllocator<TmpType> > tmp( shape[0] );
 
     typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
     typedef MultiArrayNavigator<DestIterator, N> DNavigator;
@@ -615,7 +692,7 @@ internalSeparableConvolveSubarray(
     dstop[axisorder[0]]  = stop[axisorder[0]] - start[axisorder[0]];
 
     // temporary array to hold the current line to enable in-place operation
-    MultiArray<N, TmpType> tmp(dstop);
+    MultiArray<N, TmpType, ScratchAllocator<TmpType> > tmp(dstop);
 
     typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
     typedef MultiArrayNavigator<TmpIterator, N> TNavigator;
@@ -627,7 +704,7 @@ internalSeparableConvolveSubarray(
         SNavigator snav( si, sstart, sstop, axisorder[0]);
         TNavigator tnav( tmp.traverser_begin(), dstart, dstop, axisorder[0]);
 
-        ArrayVector<TmpType> tmpline(sstop[axisorder[0]] - sstart[axisorder[0]]);
+        ArrayVector<TmpType, ScratchAllocator<TmpType> > tmpline(sstop[axisorder[0]] - sstart[axisorder[0]]);
 
         int lstart = start[axisorder[0]] - sstart[axisorder[0]];
         int lstop  = lstart + (stop[axisorder[0]] - start[axisorder[0]]);
@@ -648,7 +725,7 @@ internalSeparableConvolveSubarray(
     {
         TNavigator tnav( tmp.traverser_begin(), dstart, dstop, axisorder[d]);
 
-        ArrayVector<TmpType> tmpline(dstop[axisorder[d]] - dstart[axisorder[d]]);
+        ArrayVector<TmpType, ScratchAllocator<TmpType> > tmpline(dstop[axisorder[d]] - dstart[axisorder[d]]);
 
         int lstart = start[axisorder[d]] - sstart[axisorder[d]];
         int lstop  = lstart + (stop[axisorder[d]] - start[axisorder[d]]);
@@ -887,7 +964,7 @@ separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor
     else if(!IsSameType<TmpType, typename DestAccessor::value_type>::boolResult)
     {
         // need a temporary array to avoid rounding errors
-        MultiArray<SrcShape::static_size, TmpType> tmpArray(shape);
+        MultiArray<SrcShape::static_size, TmpType, ScratchAllocator<TmpType> > tmpArray(shape);
         detail::internalSeparableConvolveMultiArrayTmp( s, shape, src,
              tmpArray.traverser_begin(), typename AccessorTraits<TmpType>::default_accessor(), kernels );
         copyMultiArray(srcMultiArrayRange(tmpArray), destIter(d, dest));
@@ -1108,7 +1185,7 @@ convolveMultiArrayOneDimension(SrcIterator s, SrcShape const & shape, SrcAccesso
 
     typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
     typedef typename AccessorTraits<TmpType>::default_const_accessor TmpAccessor;
-    ArrayVector<TmpType> tmp( shape[dim] );
+    ArrayVector<TmpType, ScratchAllocator<TmpType> > tmp( shape[dim] );
 
     typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
     typedef MultiArrayNavigator<DestIterator, N> DNavigator;
@@ -1192,6 +1269,75 @@ convolveMultiArrayOneDimension(MultiArrayView<N, T1, S1> const & source,
     convolveMultiArrayOneDimension(source, dest, dim, kernel, SHAPE(), SHAPE());
 }
 
+namespace detail {
+
+    // Gaussian filtering (with derivative 'orders[k]' along axis k) which
+    // replaces the convolution with the kernel 'kernels[k]' by the recursive filter
+    // along all axes where this is requested by the options (see
+    // ConvolutionOptions::filterMethod()).
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class KernelIterator>
+void
+gaussianConvolveMultiArray(SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                           DestIterator d, DestAccessor dest, KernelIterator kernels,
+                           SrcShape const & orders,
+                           ConvolutionOptions<SrcShape::static_size> const & opt,
+                           const char *const function_name)
+{
+    static const int N = SrcShape::static_size;
+    typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
+    typedef typename AccessorTraits<TmpType>::default_accessor TmpAccessor;
+
+    typename ConvolutionOptions<N>::ScaleIterator params = opt.scaleParams();
+    ArrayVector<double> sigmas(N), steps(N);
+    ArrayVector<bool> recursive(N);
+    bool useRecursiveFilter = false;
+    for(int k=0; k<N; ++k, ++params)
+    {
+        sigmas[k] = params.sigma_scaled(function_name, true);
+        steps[k] = params.step_size();
+        recursive[k] = shape[k] >= 4 && opt.useRecursiveFilter(sigmas[k]);
+        useRecursiveFilter = useRecursiveFilter || recursive[k];
+    }
+
+    if(!useRecursiveFilter)
+    {
+        separableConvolveMultiArray(s, shape, src, d, dest, kernels, opt.from_point, opt.to_point);
+        return;
+    }
+
+    SrcShape start(opt.from_point), stop(opt.to_point);
+    if(stop != SrcShape())
+    {
+        RelativeToAbsoluteCoordinate<N-1>::exec(shape, start);
+        RelativeToAbsoluteCoordinate<N-1>::exec(shape, stop);
+        for(int k=0; k<N; ++k)
+            vigra_precondition(0 <= start[k] && start[k] < stop[k] && stop[k] <= shape[k],
+              std::string(function_name) + "(): invalid subarray shape.");
+    }
+    else
+    {
+        stop = shape;
+    }
+
+    MultiArray<N, TmpType, ScratchAllocator<TmpType> > tmp(shape);
+    copyMultiArray(s, shape, src, tmp.traverser_begin(), TmpAccessor());
+
+    for(int k=0; k<N; ++k, ++kernels)
+    {
+        if(recursive[k])
+            recursiveGaussianFilterInPlace(tmp, k, sigmas[k], orders[k],
+                                           std::pow(steps[k], -(double)orders[k]));
+        else
+            convolveMultiArrayOneDimension(tmp.traverser_begin(), shape, TmpAccessor(),
+                                           tmp.traverser_begin(), TmpAccessor(), k, *kernels);
+    }
+
+    copyMultiArray(tmp.traverser_begin() + start, stop - start, TmpAccessor(), d, dest);
+}
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*             gaussianSmoothMultiArray                 */
@@ -1222,6 +1368,9 @@ convolveMultiArrayOneDimension(MultiArrayView<N, T1, S1> const & source,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -1252,6 +1401,13 @@ convolveMultiArrayOneDimension(MultiArrayView<N, T1, S1> const & source,
         gaussianSmoothMultiArray(MultiArrayView<N, T1, S1> const & source,
                                  MultiArrayView<N, T2, S2> dest,
                                  BlockwiseConvolutionOptions<N> opt);
+
+        // as above, but operate on chunked arrays
+        template <unsigned int N, class T1, class T2>
+        void
+        gaussianSmoothMultiArray(ChunkedArray<N, T1> const & source,
+                                 ChunkedArray<N, T2> & dest,
+                                 BlockwiseConvolutionOptions<N> const & opt);
     }
     \endcode
 
@@ -1347,7 +1503,8 @@ gaussianSmoothMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor src
         kernels[dim].initGaussian(params.sigma_scaled(function_name, true),
                                   1.0, opt.window_ratio);
 
-    separableConvolveMultiArray(s, shape, src, d, dest, kernels.begin(), opt.from_point, opt.to_point);
+    detail::gaussianConvolveMultiArray(s, shape, src, d, dest, kernels.begin(),
+                                       SrcShape(), opt, function_name);
 }
 
 template <class SrcIterator, class SrcShape, class SrcAccessor,
@@ -1449,6 +1606,9 @@ gaussianSmoothMultiArray(MultiArrayView<N, T1, S1> const & source,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -1582,8 +1742,10 @@ gaussianGradientMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor s
         ArrayVector<Kernel1D<KernelType> > kernels(plain_kernels);
         kernels[dim].initGaussianDerivative(params2.sigma_scaled(), 1, 1.0, opt.window_ratio);
         detail::scaleKernel(kernels[dim], 1.0 / params2.step_size());
-        separableConvolveMultiArray(si, shape, src, di, ElementAccessor(dim, dest), kernels.begin(),
-                                    opt.from_point, opt.to_point);
+        SrcShape orders;
+        orders[dim] = 1;
+        detail::gaussianConvolveMultiArray(si, shape, src, di, ElementAccessor(dim, dest), kernels.begin(),
+                                           orders, opt, function_name);
     }
 }
 
@@ -1687,7 +1849,7 @@ gaussianGradientMagnitudeImpl(MultiArrayView<N+1, T1, S1> const & src,
     dest.init(0.0);
 
     typedef typename NumericTraits<T1>::RealPromote TmpType;
-    MultiArray<N, TinyVector<TmpType, int(N)> > grad(dest.shape());
+    MultiArray<N, TinyVector<TmpType, int(N)>, ScratchAllocator<TinyVector<TmpType, int(N)> > > grad(dest.shape());
 
     using namespace multi_math;
 
@@ -1794,6 +1956,9 @@ gaussianGradientMagnitude(MultiArrayView<N+1, Multiband<T1>, S1> const & src,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -1977,6 +2142,9 @@ symmetricGradientMultiArray(MultiArrayView<N, T1, S1> const & source,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -2099,7 +2267,7 @@ laplacianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccesso
     if(opt.to_point != SrcShape())
         dshape = opt.to_point - opt.from_point;
 
-    MultiArray<N, KernelType> derivative(dshape);
+    MultiArray<N, KernelType, ScratchAllocator<KernelType> > derivative(dshape);
 
     // compute 2nd derivatives and sum them up
     for (int dim = 0; dim < N; ++dim, ++params2)
@@ -2107,17 +2275,21 @@ laplacianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccesso
         ArrayVector<Kernel1D<KernelType> > kernels(plain_kernels);
         kernels[dim].initGaussianDerivative(params2.sigma_scaled(), 2, 1.0, opt.window_ratio);
         detail::scaleKernel(kernels[dim], 1.0 / sq(params2.step_size()));
+        SrcShape orders;
+        orders[dim] = 2;
 
         if (dim == 0)
         {
-            separableConvolveMultiArray( si, shape, src,
-                                         di, dest, kernels.begin(), opt.from_point, opt.to_point);
+            detail::gaussianConvolveMultiArray( si, shape, src,
+                                                di, dest, kernels.begin(), orders, opt,
+                                                "laplacianOfGaussianMultiArray");
         }
         else
         {
-            separableConvolveMultiArray( si, shape, src,
-                                         derivative.traverser_begin(), DerivativeAccessor(),
-                                         kernels.begin(), opt.from_point, opt.to_point);
+            detail::gaussianConvolveMultiArray( si, shape, src,
+                                                derivative.traverser_begin(), DerivativeAccessor(),
+                                                kernels.begin(), orders, opt,
+                                                "laplacianOfGaussianMultiArray");
             combineTwoMultiArrays(di, dshape, dest, derivative.traverser_begin(), DerivativeAccessor(),
                                   di, dest, Arg1() + Arg2() );
         }
@@ -2222,6 +2394,9 @@ laplacianOfGaussianMultiArray(MultiArrayView<N, T1, S1> const & source,
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -2326,7 +2501,7 @@ gaussianDivergenceMultiArray(Iterator vectorField, Iterator vectorFieldEnd,
         kernels[k].initGaussian(sigmas[k], 1.0, opt.window_ratio);
     }
 
-    MultiArray<N, TmpType> tmpDeriv(divergence.shape());
+    MultiArray<N, TmpType, ScratchAllocator<TmpType> > tmpDeriv(divergence.shape());
 
     for(unsigned int k=0; k < N; ++k, ++vectorField)
     {
@@ -2410,6 +2585,9 @@ gaussianDivergenceMultiArray(MultiArrayView<N, TinyVector<T1, int(N)>, S1> const
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -2555,8 +2733,12 @@ hessianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor
             }
             detail::scaleKernel(kernels[i], 1 / params_i.step_size());
             detail::scaleKernel(kernels[j], 1 / params_j.step_size());
-            separableConvolveMultiArray(si, shape, src, di, ElementAccessor(b, dest),
-                                        kernels.begin(), opt.from_point, opt.to_point);
+            SrcShape orders;
+            ++orders[i];
+            ++orders[j];
+            detail::gaussianConvolveMultiArray(si, shape, src, di, ElementAccessor(b, dest),
+                                               kernels.begin(), orders, opt,
+                                               "hessianOfGaussianMultiArray");
         }
     }
 }
@@ -2686,6 +2868,9 @@ struct StructurTensorFunctor
     customized via <tt>BlockwiseConvolutionOptions::blockShape()</tt>, but the defaults
     usually work reasonably. By default, the number of threads equals the capabilities
     of your hardware, but you can change this via <tt>BlockwiseConvolutionOptions::numThreads()</tt>.
+    The parallel version also accepts \ref vigra::ChunkedArray "ChunkedArrays" as source
+    and destination. Then, the blocks are aligned with the destination's chunks, so that
+    arrays larger than the available memory can be processed.
 
     <b> Declarations:</b>
 
@@ -2825,8 +3010,8 @@ structureTensorMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor sr
         gradientShape = innerOptions.to_point - innerOptions.from_point;
     }
 
-    MultiArray<N, GradientVector> gradient(gradientShape);
-    MultiArray<N, DestType> gradientTensor(gradientShape);
+    MultiArray<N, GradientVector, ScratchAllocator<GradientVector> > gradient(gradientShape);
+    MultiArray<N, DestType, ScratchAllocator<DestType> > gradientTensor(gradientShape);
     gaussianGradientMultiArray(si, shape, src,
                                gradient.traverser_begin(), GradientAccessor(),
                                innerOptions,
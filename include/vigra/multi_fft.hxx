@@ -43,6 +43,9 @@
 #include "navigator.hxx"
 #include "copyimage.hxx"
 #include "threading.hxx"
+#include <map>
+#include <string>
+#include <vector>
 
 namespace vigra {
 
@@ -204,11 +207,12 @@ inline fftw_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<double> * in,  int* instrides,  int instep,
                FFTWComplex<double> * out, int* outstrides, int outstep,
-               int sign, unsigned int planner_flags)
+               int sign, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftw_plan_many_dft(N, shape, 1,
-                              (fftw_complex *)in, instrides, instep, 0,
-                              (fftw_complex *)out, outstrides, outstep, 0,
+    return fftw_plan_many_dft(N, shape, howmany,
+                              (fftw_complex *)in, instrides, instep, indist,
+                              (fftw_complex *)out, outstrides, outstep, outdist,
                               sign, planner_flags);
 }
 
@@ -216,11 +220,12 @@ inline fftw_plan
 fftwPlanCreate(unsigned int N, int* shape,
                double * in,  int* instrides,  int instep,
                FFTWComplex<double> * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftw_plan_many_dft_r2c(N, shape, 1,
-                                   in, instrides, instep, 0,
-                                   (fftw_complex *)out, outstrides, outstep, 0,
+    return fftw_plan_many_dft_r2c(N, shape, howmany,
+                                   in, instrides, instep, indist,
+                                   (fftw_complex *)out, outstrides, outstep, outdist,
                                    planner_flags);
 }
 
@@ -228,11 +233,12 @@ inline fftw_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<double> * in,  int* instrides,  int instep,
                double * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftw_plan_many_dft_c2r(N, shape, 1,
-                                  (fftw_complex *)in, instrides, instep, 0,
-                                  out, outstrides, outstep, 0,
+    return fftw_plan_many_dft_c2r(N, shape, howmany,
+                                  (fftw_complex *)in, instrides, instep, indist,
+                                  out, outstrides, outstep, outdist,
                                   planner_flags);
 }
 
@@ -240,11 +246,12 @@ inline fftwf_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<float> * in,  int* instrides,  int instep,
                FFTWComplex<float> * out, int* outstrides, int outstep,
-               int sign, unsigned int planner_flags)
+               int sign, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwf_plan_many_dft(N, shape, 1,
-                               (fftwf_complex *)in, instrides, instep, 0,
-                               (fftwf_complex *)out, outstrides, outstep, 0,
+    return fftwf_plan_many_dft(N, shape, howmany,
+                               (fftwf_complex *)in, instrides, instep, indist,
+                               (fftwf_complex *)out, outstrides, outstep, outdist,
                                sign, planner_flags);
 }
 
@@ -252,11 +259,12 @@ inline fftwf_plan
 fftwPlanCreate(unsigned int N, int* shape,
                float * in,  int* instrides,  int instep,
                FFTWComplex<float> * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwf_plan_many_dft_r2c(N, shape, 1,
-                                    in, instrides, instep, 0,
-                                    (fftwf_complex *)out, outstrides, outstep, 0,
+    return fftwf_plan_many_dft_r2c(N, shape, howmany,
+                                    in, instrides, instep, indist,
+                                    (fftwf_complex *)out, outstrides, outstep, outdist,
                                     planner_flags);
 }
 
@@ -264,11 +272,12 @@ inline fftwf_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<float> * in,  int* instrides,  int instep,
                float * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwf_plan_many_dft_c2r(N, shape, 1,
-                                   (fftwf_complex *)in, instrides, instep, 0,
-                                   out, outstrides, outstep, 0,
+    return fftwf_plan_many_dft_c2r(N, shape, howmany,
+                                   (fftwf_complex *)in, instrides, instep, indist,
+                                   out, outstrides, outstep, outdist,
                                    planner_flags);
 }
 
@@ -276,11 +285,12 @@ inline fftwl_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<long double> * in,  int* instrides,  int instep,
                FFTWComplex<long double> * out, int* outstrides, int outstep,
-               int sign, unsigned int planner_flags)
+               int sign, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwl_plan_many_dft(N, shape, 1,
-                               (fftwl_complex *)in, instrides, instep, 0,
-                               (fftwl_complex *)out, outstrides, outstep, 0,
+    return fftwl_plan_many_dft(N, shape, howmany,
+                               (fftwl_complex *)in, instrides, instep, indist,
+                               (fftwl_complex *)out, outstrides, outstep, outdist,
                                sign, planner_flags);
 }
 
@@ -288,11 +298,12 @@ inline fftwl_plan
 fftwPlanCreate(unsigned int N, int* shape,
                long double * in,  int* instrides,  int instep,
                FFTWComplex<long double> * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwl_plan_many_dft_r2c(N, shape, 1,
-                                    in, instrides, instep, 0,
-                                    (fftwl_complex *)out, outstrides, outstep, 0,
+    return fftwl_plan_many_dft_r2c(N, shape, howmany,
+                                    in, instrides, instep, indist,
+                                    (fftwl_complex *)out, outstrides, outstep, outdist,
                                     planner_flags);
 }
 
@@ -300,11 +311,12 @@ inline fftwl_plan
 fftwPlanCreate(unsigned int N, int* shape,
                FFTWComplex<long double> * in,  int* instrides,  int instep,
                long double * out, int* outstrides, int outstep,
-               int /*sign is ignored*/, unsigned int planner_flags)
+               int /*sign is ignored*/, unsigned int planner_flags,
+               int howmany = 1, int indist = 0, int outdist = 0)
 {
-    return fftwl_plan_many_dft_c2r(N, shape, 1,
-                                   (fftwl_complex *)in, instrides, instep, 0,
-                                   out, outstrides, outstep, 0,
+    return fftwl_plan_many_dft_c2r(N, shape, howmany,
+                                   (fftwl_complex *)in, instrides, instep, indist,
+                                   out, outstrides, outstep, outdist,
                                    planner_flags);
 }
 
@@ -398,6 +410,290 @@ fftwPlanExecute(fftwl_plan plan, FFTWComplex<long double> * in,  long double * o
     fftwl_execute_dft_c2r(plan, (fftwl_complex *)in, out);
 }
 
+inline int fftwAlignmentOf(double * p)
+{
+    return fftw_alignment_of(p);
+}
+
+inline int fftwAlignmentOf(float * p)
+{
+    return fftwf_alignment_of(p);
+}
+
+inline int fftwAlignmentOf(long double * p)
+{
+    return fftwl_alignment_of(p);
+}
+
+template <class Real>
+inline int fftwAlignmentOf(FFTWComplex<Real> * p)
+{
+    return fftwAlignmentOf((Real *)p);
+}
+
+inline bool fftwImportWisdom(const char * filename, double)
+{
+    return fftw_import_wisdom_from_filename(filename) != 0;
+}
+
+inline bool fftwImportWisdom(const char * filename, float)
+{
+    return fftwf_import_wisdom_from_filename(filename) != 0;
+}
+
+inline bool fftwImportWisdom(const char * filename, long double)
+{
+    return fftwl_import_wisdom_from_filename(filename) != 0;
+}
+
+inline bool fftwExportWisdom(const char * filename, double)
+{
+    return fftw_export_wisdom_to_filename(filename) != 0;
+}
+
+inline bool fftwExportWisdom(const char * filename, float)
+{
+    return fftwf_export_wisdom_to_filename(filename) != 0;
+}
+
+inline bool fftwExportWisdom(const char * filename, long double)
+{
+    return fftwl_export_wisdom_to_filename(filename) != 0;
+}
+
+#ifdef HasFFTW3Threads
+
+inline void fftwInitThreads(double)
+{
+    fftw_init_threads();
+}
+
+inline void fftwInitThreads(float)
+{
+    fftwf_init_threads();
+}
+
+inline void fftwInitThreads(long double)
+{
+    fftwl_init_threads();
+}
+
+inline void fftwPlanWithThreads(int n, double)
+{
+    fftw_plan_with_nthreads(n);
+}
+
+inline void fftwPlanWithThreads(int n, float)
+{
+    fftwf_plan_with_nthreads(n);
+}
+
+inline void fftwPlanWithThreads(int n, long double)
+{
+    fftwl_plan_with_nthreads(n);
+}
+
+#endif // HasFFTW3Threads
+
+    // Process-wide planner state for one precision: cached plans and the
+    // number of threads. All members must be accessed under FFTWLock.
+    // Each cached plan counts the plan objects currently using it. When the
+    // cache is full, the least recently used plan without users is destroyed.
+    // When all plans are in use, new plans are not cached.
+template <class Real>
+class FFTWPlanCacheImpl
+{
+  public:
+    typedef typename FFTWReal2Complex<Real>::plan_type PlanType;
+    typedef std::vector<std::ptrdiff_t>                Key;
+
+    struct Entry
+    {
+        PlanType plan;
+        std::size_t users, last_use;
+    };
+    typedef std::map<Key, Entry>                       Plans;
+
+    enum { DefaultCapacity = 64 };
+
+    Plans plans;
+    bool enabled;
+    int threads;
+    bool threads_initialized;
+    std::size_t capacity, use_count;
+
+    FFTWPlanCacheImpl()
+    : enabled(true),
+      threads(1),
+      threads_initialized(false),
+      capacity(DefaultCapacity),
+      use_count(0)
+    {}
+
+    ~FFTWPlanCacheImpl()
+    {
+        for(typename Plans::iterator i = plans.begin(); i != plans.end(); ++i)
+            fftwPlanDestroy(i->second.plan);
+    }
+
+    static FFTWPlanCacheImpl & instance()
+    {
+        static FFTWPlanCacheImpl cache;
+        return cache;
+    }
+
+        // return a cached plan and register a new user, or 0 if there is none
+    PlanType acquire(Key const & key)
+    {
+        typename Plans::iterator i = plans.find(key);
+        if(i == plans.end())
+            return 0;
+        ++i->second.users;
+        i->second.last_use = ++use_count;
+        return i->second.plan;
+    }
+
+        // add a new plan with one user, returns false if the cache is full
+    bool insert(Key const & key, PlanType plan)
+    {
+        if(plans.size() >= capacity)
+            evict(plans.size() - capacity + 1);
+        if(plans.size() >= capacity)
+            return false;
+        Entry entry = { plan, 1, ++use_count };
+        plans[key] = entry;
+        return true;
+    }
+
+    void release(PlanType plan)
+    {
+        if(plan == 0)
+            return;
+        for(typename Plans::iterator i = plans.begin(); i != plans.end(); ++i)
+        {
+            if(i->second.plan != plan)
+                continue;
+            --i->second.users;
+            if(i->second.users == 0 && plans.size() > capacity)
+            {
+                fftwPlanDestroy(plan);
+                plans.erase(i);
+            }
+            return;
+        }
+    }
+
+        // destroy up to 'n' unused plans, least recently used first
+    void evict(std::size_t n)
+    {
+        for(; n > 0; --n)
+        {
+            typename Plans::iterator oldest = plans.end();
+            for(typename Plans::iterator i = plans.begin(); i != plans.end(); ++i)
+                if(i->second.users == 0 &&
+                   (oldest == plans.end() || i->second.last_use < oldest->second.last_use))
+                    oldest = i;
+            if(oldest == plans.end())
+                return;
+            fftwPlanDestroy(oldest->second.plan);
+            plans.erase(oldest);
+        }
+    }
+
+    void setCapacity(std::size_t n)
+    {
+        capacity = n;
+        if(plans.size() > capacity)
+            evict(plans.size() - capacity);
+    }
+
+    void clear()
+    {
+        evict(plans.size());
+    }
+
+    void prepareThreads()
+    {
+#ifdef HasFFTW3Threads
+        if(!threads_initialized)
+        {
+            fftwInitThreads(Real());
+            threads_initialized = true;
+        }
+        fftwPlanWithThreads(threads, Real());
+#endif
+    }
+};
+
+    // Create a plan like fftwPlanCreate(), but reuse a cached plan when an
+    // equivalent one exists. A plan is equivalent when it has the same transform
+    // type, layout, in-place-ness, memory alignment, flags and thread count.
+    // 'owned' is set to false when the cache owns the returned plan.
+    // Release the plan with fftwPlanRelease(). Must be called under FFTWLock.
+template <class Real, class T1, class T2>
+typename FFTWReal2Complex<Real>::plan_type
+fftwPlanCreateCached(unsigned int N, int* shape,
+                     T1 * in,  int* instrides,  int instep,
+                     T2 * out, int* outstrides, int outstep,
+                     int sign, unsigned int planner_flags,
+                     int howmany, int indist, int outdist,
+                     bool & owned)
+{
+    typedef FFTWPlanCacheImpl<Real> Cache;
+    typedef typename Cache::PlanType PlanType;
+
+    Cache & cache = Cache::instance();
+    cache.prepareThreads();
+
+    if(!cache.enabled)
+    {
+        owned = true;
+        return fftwPlanCreate(N, shape, in, instrides, instep, out, outstrides, outstep,
+                              sign, planner_flags, howmany, indist, outdist);
+    }
+
+    typename Cache::Key key;
+    key.push_back(sizeof(T1) / sizeof(Real)); // 1: real, 2: complex
+    key.push_back(sizeof(T2) / sizeof(Real));
+    key.push_back(N);
+    key.push_back(sign);
+    key.push_back(planner_flags);
+    key.push_back(cache.threads);
+    key.push_back((void *)in == (void *)out);
+    key.push_back(fftwAlignmentOf(in));
+    key.push_back(fftwAlignmentOf(out));
+    key.push_back(howmany);
+    key.push_back(indist);
+    key.push_back(outdist);
+    key.push_back(instep);
+    key.push_back(outstep);
+    key.insert(key.end(), shape, shape + N);
+    key.insert(key.end(), instrides, instrides + N);
+    key.insert(key.end(), outstrides, outstrides + N);
+
+    owned = false;
+    PlanType plan = cache.acquire(key);
+    if(plan != 0)
+        return plan;
+
+    plan = fftwPlanCreate(N, shape, in, instrides, instep, out, outstrides, outstep,
+                          sign, planner_flags, howmany, indist, outdist);
+    if(plan != 0 && !cache.insert(key, plan))
+        owned = true;
+    return plan;
+}
+
+    // Give up a plan obtained from fftwPlanCreateCached(). Must be called under FFTWLock.
+template <class Real>
+inline void
+fftwPlanRelease(typename FFTWReal2Complex<Real>::plan_type plan, bool owned)
+{
+    if(owned)
+        fftwPlanDestroy(plan);
+    else
+        FFTWPlanCacheImpl<Real>::instance().release(plan);
+}
+
 template <int DUMMY>
 struct FFTWPaddingSize
 {
@@ -815,6 +1111,160 @@ fftwCorrespondingShapeC2R(TinyVector<T, N> shape, bool oddDimension0 = false)
     return shape;
 }
 
+/********************************************************/
+/*                                                      */
+/*                    FFTWPlanCache                     */
+/*                                                      */
+/********************************************************/
+
+/** \brief Process-wide control of FFTW planning.
+
+    Creating an FFTW plan is often much more expensive than executing it.
+    Therefore, \ref FFTWPlan (and all functions using it, such as
+    \ref fourierTransform() and \ref convolveFFT()) keeps the plans it creates
+    in a process-wide, thread-safe cache and reuses them for all later transforms
+    with the same type, shape, strides, in-place-ness, memory alignment,
+    planner flags and number of threads. Since FFTW maintains separate state
+    for each precision, there is one cache per <tt>Real</tt> type
+    (<tt>float</tt>, <tt>double</tt> or <tt>long double</tt>).
+
+    This class also provides access to FFTW's
+    <a href="http://www.fftw.org/doc/Wisdom.html">wisdom</a> (the knowledge gathered by
+    <tt>FFTW_MEASURE</tt> and <tt>FFTW_PATIENT</tt> planning), which can be saved to
+    a file and reloaded in the next run, and to FFTW's multi-threaded transforms.
+    The latter are only available when the application is compiled with
+    <tt>HasFFTW3Threads</tt> defined and linked against the <tt>fftw3_threads</tt>
+    (and/or <tt>fftw3f_threads</tt>) library. Otherwise, the thread count is
+    recorded, but transforms run single-threaded.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+
+    \code
+    FFTWPlanCache<double>::importWisdom("fftw.wisdom");
+    FFTWPlanCache<double>::setNumberOfThreads(4);
+
+    for(int k=0; k<iterations; ++k)
+    {
+        // only the first iteration creates new plans
+        convolveFFT(image[k], kernel, result[k]);
+    }
+
+    FFTWPlanCache<double>::exportWisdom("fftw.wisdom");
+    \endcode
+*/
+template <class Real = double>
+class FFTWPlanCache
+{
+    typedef detail::FFTWPlanCacheImpl<Real> Impl;
+
+  public:
+        /** \brief Switch plan caching on or off (default: on).
+
+            When caching is switched off, each \ref FFTWPlan creates and destroys
+            its own FFTW plan, as in previous versions of VIGRA.
+        */
+    static void enable(bool on = true)
+    {
+        detail::FFTWLock<> lock;
+        Impl::instance().enabled = on;
+    }
+
+        /** \brief Check if plan caching is switched on.
+        */
+    static bool isEnabled()
+    {
+        detail::FFTWLock<> lock;
+        return Impl::instance().enabled;
+    }
+
+        /** \brief Destroy all cached plans that are not in use.
+
+            Plans still used by \ref FFTWPlan objects are kept until these
+            objects are destroyed.
+        */
+    static void clear()
+    {
+        detail::FFTWLock<> lock;
+        Impl::instance().clear();
+    }
+
+        /** \brief Number of cached plans.
+        */
+    static std::size_t size()
+    {
+        detail::FFTWLock<> lock;
+        return Impl::instance().plans.size();
+    }
+
+        /** \brief Keep at most \a n plans in the cache (default: 64).
+
+            When a new plan is added to a full cache, the least recently used plan
+            that is not currently used by an \ref FFTWPlan object is destroyed. When
+            all cached plans are in use, the new plan is not cached. This bounds the
+            memory of long-running processes that transform arrays of many
+            different shapes or alignments. Reducing the capacity destroys unused
+            plans immediately, plans in use are destroyed as soon as they are released.
+            Passing <tt>0</tt> effectively switches caching off.
+        */
+    static void setCapacity(std::size_t n)
+    {
+        detail::FFTWLock<> lock;
+        Impl::instance().setCapacity(n);
+    }
+
+        /** \brief Maximum number of cached plans.
+        */
+    static std::size_t capacity()
+    {
+        detail::FFTWLock<> lock;
+        return Impl::instance().capacity;
+    }
+
+        /** \brief Use \a n threads in subsequently created plans (default: 1).
+
+            Existing plans are not affected. The thread count is part of the
+            cache key, i.e. plans for different thread counts coexist in the cache.
+        */
+    static void setNumberOfThreads(int n)
+    {
+        vigra_precondition(n > 0,
+            "FFTWPlanCache::setNumberOfThreads(): thread count must be positive.");
+        detail::FFTWLock<> lock;
+        Impl::instance().threads = n;
+    }
+
+        /** \brief Number of threads used in subsequently created plans.
+        */
+    static int numberOfThreads()
+    {
+        detail::FFTWLock<> lock;
+        return Impl::instance().threads;
+    }
+
+        /** \brief Add the wisdom stored in \a filename to FFTW's accumulated wisdom.
+
+            Returns <tt>false</tt> if the file could not be read.
+        */
+    static bool importWisdom(std::string const & filename)
+    {
+        detail::FFTWLock<> lock;
+        return detail::fftwImportWisdom(filename.c_str(), Real());
+    }
+
+        /** \brief Write FFTW's accumulated wisdom to \a filename.
+
+            Returns <tt>false</tt> if the file could not be written.
+        */
+    static bool exportWisdom(std::string const & filename)
+    {
+        detail::FFTWLock<> lock;
+        return detail::fftwExportWisdom(filename.c_str(), Real());
+    }
+};
+
 /********************************************************/
 /*                                                      */
 /*                       FFTWPlan                       */
@@ -832,6 +1282,9 @@ fftwCorrespondingShapeC2R(TinyVector<T, N> shape, bool oddDimension0 = false)
     about FFTW's planning process (by providing non-default planning flags) and/or want to re-use
     plans for several transformations.
 
+    Plans are looked up in (and added to) a process-wide cache, so that repeated
+    creation of equivalent plans is cheap, see \ref FFTWPlanCache.
+
     <b> Usage:</b>
 
     <b>\#include</b> \<vigra/multi_fft.hxx\><br>
@@ -858,6 +1311,7 @@ class FFTWPlan
     PlanType plan;
     Shape shape, instrides, outstrides;
     int sign;
+    bool owns_plan;
 
   public:
         /** \brief Create an empty plan.
@@ -865,7 +1319,8 @@ class FFTWPlan
             The plan can be initialized later by one of the init() functions.
         */
     FFTWPlan()
-    : plan(0)
+    : plan(0),
+      owns_plan(true)
     {}
 
         /** \brief Create a plan for a complex-to-complex transform.
@@ -880,7 +1335,8 @@ class FFTWPlan
     FFTWPlan(MultiArrayView<N, FFTWComplex<Real>, C1> in,
              MultiArrayView<N, FFTWComplex<Real>, C2> out,
              int SIGN, unsigned int planner_flags = FFTW_ESTIMATE)
-    : plan(0)
+    : plan(0),
+      owns_plan(true)
     {
         init(in, out, SIGN, planner_flags);
     }
@@ -900,7 +1356,8 @@ class FFTWPlan
     FFTWPlan(MultiArrayView<N, Real, C1> in,
              MultiArrayView<N, FFTWComplex<Real>, C2> out,
              unsigned int planner_flags = FFTW_ESTIMATE)
-    : plan(0)
+    : plan(0),
+      owns_plan(true)
     {
         init(in, out, planner_flags);
     }
@@ -920,7 +1377,8 @@ class FFTWPlan
     FFTWPlan(MultiArrayView<N, FFTWComplex<Real>, C1> in,
              MultiArrayView<N, Real, C2> out,
              unsigned int planner_flags = FFTW_ESTIMATE)
-    : plan(0)
+    : plan(0),
+      owns_plan(true)
     {
         init(in, out, planner_flags);
     }
@@ -929,7 +1387,8 @@ class FFTWPlan
         */
     FFTWPlan(FFTWPlan const & other)
     : plan(other.plan),
-      sign(other.sign)
+      sign(other.sign),
+      owns_plan(other.owns_plan)
     {
         FFTWPlan & o = const_cast<FFTWPlan &>(other);
         shape.swap(o.shape);
@@ -945,11 +1404,16 @@ class FFTWPlan
         if(this != &other)
         {
             FFTWPlan & o = const_cast<FFTWPlan &>(other);
+            {
+                detail::FFTWLock<> lock;
+                detail::fftwPlanRelease<Real>(plan, owns_plan);
+            }
             plan = o.plan;
             shape.swap(o.shape);
             instrides.swap(o.instrides);
             outstrides.swap(o.outstrides);
             sign = o.sign;
+            owns_plan = o.owns_plan;
             o.plan = 0; // act like std::auto_ptr
         }
         return *this;
@@ -960,7 +1424,7 @@ class FFTWPlan
     ~FFTWPlan()
     {
         detail::FFTWLock<> lock;
-        detail::fftwPlanDestroy(plan);
+        detail::fftwPlanRelease<Real>(plan, owns_plan);
     }
 
         /** \brief Init a complex-to-complex transform.
@@ -1114,12 +1578,14 @@ FFTWPlan<N, Real>::initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flag
 
     {
         detail::FFTWLock<> lock;
-        PlanType newPlan = detail::fftwPlanCreate(N, newShape.begin(),
+        bool owned = true;
+        PlanType newPlan = detail::fftwPlanCreateCached<Real>(N, newShape.begin(),
                                       ins.data(), itotal.begin(), ins.stride(N-1),
                                       outs.data(), ototal.begin(), outs.stride(N-1),
-                                      SIGN, planner_flags);
-        detail::fftwPlanDestroy(plan);
+                                      SIGN, planner_flags, 1, 0, 0, owned);
+        detail::fftwPlanRelease<Real>(plan, owns_plan);
         plan = newPlan;
+        owns_plan = owned;
     }
 
     shape.swap(newShape);
@@ -1152,6 +1618,81 @@ void FFTWPlan<N, Real>::executeImpl(MI ins, MO outs) const
         outs *= V(1.0) / Real(outs.size());
 }
 
+namespace detail {
+
+    // Execute the same transform on a stack of arrays in a single FFTW call.
+    // The transforms run along the first N dimensions, and dimension N
+    // enumerates the arrays. Strides must increase with the dimension index.
+template <unsigned int N, class Real>
+class FFTWBatchPlan
+{
+    typedef typename FFTWReal2Complex<Real>::plan_type PlanType;
+
+    PlanType plan;
+    bool owns_plan;
+    int sign;
+    MultiArrayIndex size;
+
+    FFTWBatchPlan(FFTWBatchPlan const &);
+    FFTWBatchPlan & operator=(FFTWBatchPlan const &);
+
+  public:
+    template <class T1, class C1, class T2, class C2>
+    FFTWBatchPlan(MultiArrayView<N+1, T1, C1> in, MultiArrayView<N+1, T2, C2> out,
+                  int SIGN, unsigned int planner_flags)
+    : plan(0),
+      owns_plan(true),
+      sign(SIGN)
+    {
+        vigra_precondition(in.shape(N) == out.shape(N),
+            "FFTWBatchPlan(): input and output must have the same number of arrays.");
+        for(unsigned int k=0; k<N; ++k)
+            vigra_precondition(in.stride(k) < in.stride(k+1) && out.stride(k) < out.stride(k+1),
+                "FFTWBatchPlan(): strides must increase with the dimension index.");
+
+        // FFTW expects the dimensions in descending stride order
+        ArrayVector<int> shape(N), itotal(N), ototal(N);
+        size = 1;
+        for(unsigned int j=0; j<N; ++j)
+        {
+            unsigned int k = N-1-j;
+            shape[j] = SIGN == FFTW_FORWARD
+                           ? in.shape(k)
+                           : out.shape(k);
+            itotal[j] = j == 0 ? in.shape(k)  : in.stride(k+1) / in.stride(k);
+            ototal[j] = j == 0 ? out.shape(k) : out.stride(k+1) / out.stride(k);
+            size *= shape[j];
+        }
+
+        detail::FFTWLock<> lock;
+        plan = fftwPlanCreateCached<Real>(N, shape.begin(),
+                                          in.data(), itotal.begin(), in.stride(0),
+                                          out.data(), ototal.begin(), out.stride(0),
+                                          SIGN, planner_flags,
+                                          in.shape(N), in.stride(N), out.stride(N),
+                                          owns_plan);
+    }
+
+    ~FFTWBatchPlan()
+    {
+        detail::FFTWLock<> lock;
+        fftwPlanRelease<Real>(plan, owns_plan);
+    }
+
+    template <class T1, class C1, class T2, class C2>
+    void execute(MultiArrayView<N+1, T1, C1> in, MultiArrayView<N+1, T2, C2> out) const
+    {
+        vigra_precondition(plan != 0, "FFTWBatchPlan::execute(): plan is NULL.");
+
+        fftwPlanExecute(plan, in.data(), out.data());
+
+        if(sign == FFTW_BACKWARD)
+            out *= T2(1.0) / Real(size);
+    }
+};
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*                  FFTWConvolvePlan                    */
@@ -1202,6 +1743,7 @@ class FFTWConvolvePlan
     RArray realArray, realKernel;
     CArray fourierArray, fourierKernel;
     bool useFourierKernel;
+    unsigned int plannerFlags;
 
   public:
 
@@ -1212,7 +1754,8 @@ class FFTWConvolvePlan
             The plan can be initialized later by one of the init() functions.
         */
     FFTWConvolvePlan()
-    : useFourierKernel(false)
+    : useFourierKernel(false),
+      plannerFlags(FFTW_ESTIMATE)
     {}
 
         /** \brief Create a plan to convolve a real array with a real kernel.
@@ -1423,6 +1966,7 @@ class FFTWConvolvePlan
         backward_plan = bplan;
         fourierArray.swap(newFourierArray);
         fourierKernel.swap(newFourierKernel);
+        plannerFlags = planner_flags;
     }
 
     void init(Shape inOut, Shape kernel,
@@ -1562,6 +2106,28 @@ class FFTWConvolvePlan
                     KernelIterator kernels, KernelIterator kernelsEnd,
                     OutIterator outs, VigraTrueType /* useFourierKernel*/);
 
+    typedef MultiArray<N+1, Complex, FFTWAllocator<Complex> > BatchCArray;
+    typedef MultiArrayView<N+1, Real, StridedArrayTag>        BatchRArray;
+
+    static typename MultiArrayShape<N+1>::type
+    batchShape(Shape const & shape, MultiArrayIndex count)
+    {
+        typename MultiArrayShape<N+1>::type res;
+        for(unsigned int k=0; k<N; ++k)
+            res[k] = shape[k];
+        res[N] = count;
+        return res;
+    }
+
+        // real view of a stack of Fourier arrays, with the same layout as 'realArray'
+    static BatchRArray
+    batchRealView(BatchCArray & fourier, Shape const & realShape)
+    {
+        typename MultiArrayShape<N+1>::type shape   = batchShape(realShape, fourier.shape(N)),
+                                            strides = 2*fourier.stride();
+        strides[0] = 1;
+        return BatchRArray(shape, strides, (Real*)fourier.data());
+    }
 };
 
 template <unsigned int N, class Real>
@@ -1589,6 +2155,7 @@ FFTWConvolvePlan<N, Real>::init(Shape in, Shape kernel,
     fourierArray.swap(newFourierArray);
     fourierKernel.swap(newFourierKernel);
     useFourierKernel = false;
+    plannerFlags = planner_flags;
 }
 
 template <unsigned int N, class Real>
@@ -1620,6 +2187,7 @@ FFTWConvolvePlan<N, Real>::initFourierKernel(Shape in, Shape kernel,
     fourierArray.swap(newFourierArray);
     fourierKernel.swap(newFourierKernel);
     useFourierKernel = true;
+    plannerFlags = planner_flags;
 }
 
 template <unsigned int N, class Real>
@@ -1651,6 +2219,7 @@ FFTWConvolvePlan<N, Real>::initComplex(Shape in, Shape kernel,
     backward_plan = bplan;
     fourierArray.swap(newFourierArray);
     fourierKernel.swap(newFourierKernel);
+    plannerFlags = planner_flags;
 }
 
 #ifndef DOXYGEN // doxygen documents these functions as free functions
@@ -1796,6 +2365,29 @@ FFTWConvolvePlan<N, Real>::executeManyImpl(MultiArrayView<N, Real, C1> in,
     detail::fftEmbedArray(in, realArray);
     forward_plan.execute(realArray, fourierArray);
 
+    MultiArrayIndex count = std::distance(kernels, kernelsEnd);
+    if(count > 1)
+    {
+        // transform all kernels and results with a single call each
+        BatchCArray fourierKernels(batchShape(fourierArray.shape(), count));
+        BatchRArray realKernels(batchRealView(fourierKernels, paddedShape));
+
+        detail::FFTWBatchPlan<N, Real> fplan(realKernels, fourierKernels, FFTW_FORWARD, plannerFlags),
+                                       bplan(fourierKernels, realKernels, FFTW_BACKWARD, plannerFlags);
+
+        for(MultiArrayIndex k=0; k<count; ++k, ++kernels)
+            detail::fftEmbedKernel(*kernels, realKernels.bindOuter(k));
+        fplan.execute(realKernels, fourierKernels);
+
+        for(MultiArrayIndex k=0; k<count; ++k)
+            fourierKernels.bindOuter(k) *= fourierArray;
+        bplan.execute(fourierKernels, realKernels);
+
+        for(MultiArrayIndex k=0; k<count; ++k, ++outs)
+            *outs = realKernels.bindOuter(k).subarray(left, right);
+        return;
+    }
+
     for(; kernels != kernelsEnd; ++kernels, ++outs)
     {
         detail::fftEmbedKernel(*kernels, realKernel);
@@ -1834,6 +2426,29 @@ FFTWConvolvePlan<N, Real>::executeManyImpl(MultiArrayView<N, Real, C1> in,
     detail::fftEmbedArray(in, realArray);
     forward_plan.execute(realArray, fourierArray);
 
+    MultiArrayIndex count = std::distance(kernels, kernelsEnd);
+    if(count > 1)
+    {
+        // compute all inverse transforms with a single call
+        BatchCArray fourierKernels(batchShape(complexShape, count));
+        BatchRArray realKernels(batchRealView(fourierKernels, paddedShape));
+
+        detail::FFTWBatchPlan<N, Real> bplan(fourierKernels, realKernels, FFTW_BACKWARD, plannerFlags);
+
+        for(MultiArrayIndex k=0; k<count; ++k, ++kernels)
+        {
+            MultiArrayView<N, Complex> fourierKernel = fourierKernels.bindOuter(k);
+            fourierKernel = *kernels;
+            moveDCToHalfspaceUpperLeft(fourierKernel);
+            fourierKernel *= fourierArray;
+        }
+        bplan.execute(fourierKernels, realKernels);
+
+        for(MultiArrayIndex k=0; k<count; ++k, ++outs)
+            *outs = realKernels.bindOuter(k).subarray(left, right);
+        return;
+    }
+
     for(; kernels != kernelsEnd; ++kernels, ++outs)
     {
         fourierKernel = *kernels;
@@ -2189,7 +2804,9 @@ fourierTransformInverse(MultiArrayView<N, FFTWComplex<Real>, C1> in,
     <DT><b>convolveFFTMany</b><DD> Like <tt>convolveFFT</tt>, but you may provide many kernels at once
                         (using an iterator pair specifying the kernel sequence).
                         This has the advantage that the forward transform of the input array needs
-                        to be executed only once.
+                        to be executed only once. Moreover, the transforms of all kernels and results
+                        are executed as a single batch by FFTW (this requires memory for all
+                        kernel spectra at once).
     <DT><b>convolveFFTComplex</b><DD> Convolve a complex-valued input array with a complex-valued kernel,
                         resulting in a complex-valued output array. An additional flag is used to
                         specify whether the kernel is defined in the spatial or frequency domain.
@@ -2197,6 +2814,10 @@ fourierTransformInverse(MultiArrayView<N, FFTWComplex<Real>, C1> in,
                         kernels at once (using an iterator pair specifying the kernel sequence).
                         This has the advantage that the forward transform of the input array needs
                         to be executed only once.
+    <DT><b>convolveFFTBlockwise</b><DD> Like <tt>convolveFFT</tt>, but the array is processed in
+                        parallel blocks of fixed size (overlap-save), so that memory consumption and
+                        transform size do not grow with the array. Accepts \ref ChunkedArray as well.
+                        Declared in \<vigra/multi_fft_blockwise.hxx\>.
     </DL>
 
     The output arrays must have the same shape as the input arrays. In the "Many" variants of the
@@ -0,0 +1,297 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2009-2010 by Ullrich Koethe                  */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_FFT_BLOCKWISE_HXX
+#define VIGRA_MULTI_FFT_BLOCKWISE_HXX
+
+#include "multi_fft.hxx"
+#include "threadpool.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "multi_array_chunked.hxx"
+
+namespace vigra {
+
+/** \addtogroup ConvolutionFilters
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                 convolveFFTBlockwise                 */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Reads the window [start, stop) of the input array.
+template <unsigned int N, class Real, class C>
+struct FFTWBlockwiseArrayReader
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayView<N, Real, C> in;
+
+    FFTWBlockwiseArrayReader(MultiArrayView<N, Real, C> const & a)
+    : in(a)
+    {}
+
+    MultiArrayView<N, Real, StridedArrayTag>
+    operator()(int, Shape const & start, Shape const & stop)
+    {
+        return in.subarray(start, stop);
+    }
+};
+
+    // Copies the window [start, stop) of a ChunkedArray into a per-thread buffer.
+template <unsigned int N, class Real>
+struct FFTWBlockwiseChunkedReader
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    ChunkedArray<N, Real> const & in;
+    ArrayVector<MultiArray<N, Real> > buffers;
+
+    FFTWBlockwiseChunkedReader(ChunkedArray<N, Real> const & a, Shape const & window, int threads)
+    : in(a),
+      buffers(threads, MultiArray<N, Real>(window))
+    {}
+
+    MultiArrayView<N, Real, StridedArrayTag>
+    operator()(int threadId, Shape const & start, Shape const &)
+    {
+        MultiArrayView<N, Real, StridedArrayTag> window(buffers[threadId]);
+        in.checkoutSubarray(start, window);
+        return window;
+    }
+};
+
+template <unsigned int N, class Real, class C>
+struct FFTWBlockwiseArrayWriter
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayView<N, Real, C> out;
+
+    FFTWBlockwiseArrayWriter(MultiArrayView<N, Real, C> const & a)
+    : out(a)
+    {}
+
+    void operator()(Shape const & start, Shape const & stop,
+                    MultiArrayView<N, Real, StridedArrayTag> const & block)
+    {
+        out.subarray(start, stop) = block;
+    }
+};
+
+template <unsigned int N, class Real>
+struct FFTWBlockwiseChunkedWriter
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    ChunkedArray<N, Real> & out;
+
+    FFTWBlockwiseChunkedWriter(ChunkedArray<N, Real> & a)
+    : out(a)
+    {}
+
+    void operator()(Shape const & start, Shape const &,
+                    MultiArrayView<N, Real, StridedArrayTag> const & block)
+    {
+        out.commitSubarray(start, block);
+    }
+};
+
+    // Overlap-save convolution: every block core is computed from a window that
+    // extends the core by the kernel support. Windows near the array border are
+    // shifted inwards (where reflective padding reproduces convolveFFT()), so that
+    // all windows have the same shape and share one pair of plans and the kernel
+    // spectrum. Each thread owns one Fourier buffer.
+template <unsigned int N, class Real, class C, class Reader, class Writer>
+void
+convolveFFTBlockwiseImpl(typename MultiArrayShape<N>::type const & shape,
+                         MultiArrayView<N, Real, C> kernel,
+                         Reader & reader, Writer & writer,
+                         typename MultiArrayShape<N>::type const & blockShape,
+                         BlockwiseOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef FFTWComplex<Real> Complex;
+    typedef MultiArray<N, Complex, FFTWAllocator<Complex> > CArray;
+    typedef MultiArrayView<N, Real, UnstridedArrayTag> RArray;
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+
+    Shape kernelShape = kernel.shape(),
+          after = div(kernelShape, MultiArrayIndex(2)),
+          before = kernelShape - Shape(1) - after,
+          window = min(blockShape + kernelShape - Shape(1), shape),
+          paddedShape = fftwBestPaddedShapeR2C(window + kernelShape - Shape(1)),
+          complexShape = fftwCorrespondingShapeR2C(paddedShape),
+          left = div(paddedShape - window, MultiArrayIndex(2));
+
+    int threads = options.getActualNumThreads();
+    CArray fourierKernel(complexShape);
+    ArrayVector<CArray> fourierArrays(threads, fourierKernel);
+
+    Shape realStrides = 2*fourierKernel.stride();
+    realStrides[0] = 1;
+
+    RArray realKernel(paddedShape, realStrides, (Real*)fourierKernel.data());
+    FFTWPlan<N, Real> forward_plan(realKernel, fourierKernel),
+                      backward_plan(fourierKernel, realKernel);
+
+    detail::fftEmbedKernel(kernel, realKernel);
+    forward_plan.execute(realKernel, fourierKernel);
+
+    const Blocking blocking(shape, blockShape);
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](const int threadId, const Block core)
+        {
+            Shape start = min(max(core.begin() - before, Shape()), shape - window),
+                  coreStart = left + core.begin() - start,
+                  coreStop  = left + core.end() - start;
+            CArray & fourierArray = fourierArrays[threadId];
+            RArray realArray(paddedShape, realStrides, (Real*)fourierArray.data());
+
+            detail::fftEmbedArray(reader(threadId, start, start + window), realArray);
+            forward_plan.execute(realArray, fourierArray);
+            fourierArray *= fourierKernel;
+            backward_plan.execute(fourierArray, realArray);
+
+            writer(core.begin(), core.end(), realArray.subarray(coreStart, coreStop));
+        },
+        blocking.numBlocks()
+    );
+}
+
+} // namespace detail
+
+/** \brief Convolve a large real-valued array blockwise by means of the Fourier transform.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class Real, class C1, class C2, class C3>
+        void
+        convolveFFTBlockwise(MultiArrayView<N, Real, C1> in,
+                             MultiArrayView<N, Real, C2> kernel,
+                             MultiArrayView<N, Real, C3> out,
+                             BlockwiseOptions const & options = BlockwiseOptions());
+
+        template <unsigned int N, class Real, class C>
+        void
+        convolveFFTBlockwise(ChunkedArray<N, Real> const & in,
+                             MultiArrayView<N, Real, C> kernel,
+                             ChunkedArray<N, Real> & out,
+                             BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    \ref convolveFFT() transforms the entire (padded) array at once, which becomes
+    slow and memory hungry for large arrays. This function uses the overlap-save
+    method instead: the array is split into blocks of
+    <tt>options.getBlockShape()</tt>, and each block is convolved in a window enlarged
+    by the kernel support. All windows have the same shape, so the FFTW plans and the
+    kernel spectrum are computed only once, and each thread reuses its own transform
+    buffer. Blocks are processed in parallel according to
+    <tt>options.numThreads()</tt>. The result equals that of \ref convolveFFT()
+    (with identical reflective border treatment) up to rounding errors.
+
+    Good block sizes are a few times the kernel size: the transform size is
+    <tt>blockShape + 2*(kernel.shape() - 1)</tt> (rounded up to an efficient FFT size).
+
+    If the arrays are \ref ChunkedArray "ChunkedArrays", blocks are aligned with
+    the destination's chunks, and only the windows of the blocks currently being
+    processed are held in memory.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_fft_blockwise.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> src(Shape3(2000, 2000, 200)), dest(src.shape());
+    MultiArray<3, float> kernel(Shape3(31, 31, 31));
+    ...
+    convolveFFTBlockwise(src, kernel, dest,
+                         BlockwiseOptions().blockShape(Shape3(128)).numThreads(8));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void convolveFFTBlockwise)
+
+template <unsigned int N, class Real, class C1, class C2, class C3>
+void
+convolveFFTBlockwise(MultiArrayView<N, Real, C1> in,
+                     MultiArrayView<N, Real, C2> kernel,
+                     MultiArrayView<N, Real, C3> out,
+                     BlockwiseOptions const & options = BlockwiseOptions())
+{
+    vigra_precondition(in.shape() == out.shape(),
+        "convolveFFTBlockwise(): input and output must have the same shape.");
+
+    detail::FFTWBlockwiseArrayReader<N, Real, C1> reader(in);
+    detail::FFTWBlockwiseArrayWriter<N, Real, C3> writer(out);
+    detail::convolveFFTBlockwiseImpl(in.shape(), kernel, reader, writer,
+                                     options.template getBlockShapeN<N>(), options);
+}
+
+template <unsigned int N, class Real, class C>
+void
+convolveFFTBlockwise(ChunkedArray<N, Real> const & in,
+                     MultiArrayView<N, Real, C> kernel,
+                     ChunkedArray<N, Real> & out,
+                     BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(in.shape() == out.shape(),
+        "convolveFFTBlockwise(): input and output must have the same shape.");
+
+    Shape blockShape = blockwise::chunkAlignedBlockShape(out, options),
+          window = min(blockShape + kernel.shape() - Shape(1), in.shape());
+
+    detail::FFTWBlockwiseChunkedReader<N, Real> reader(in, window, options.getActualNumThreads());
+    detail::FFTWBlockwiseChunkedWriter<N, Real> writer(out);
+    detail::convolveFFTBlockwiseImpl(in.shape(), kernel, reader, writer, blockShape, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_FFT_BLOCKWISE_HXX
@@ -0,0 +1,624 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_MULTI_FILTERBANK_HXX
+#define VIGRA_MULTI_FILTERBANK_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "multi_array.hxx"
+#include "multi_convolution.hxx"
+#include "multi_tensorutilities.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "multi_math.hxx"
+#include "scratch_arena.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+/** \addtogroup ParallelProcessing
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                      FilterBank                      */
+/*                                                      */
+/********************************************************/
+
+/** \brief Specification of a set of Gaussian filters to be computed by \ref filterBankMultiArray().
+
+    <b>\#include</b> \<vigra/multi_filterbank.hxx\><br/>
+    Namespace: vigra
+
+    A filter bank is a list of (feature, scale) pairs. Each feature contributes one
+    channel (scalar features) or <tt>N</tt> channels (eigenvalues of <tt>N</tt>-dimensional
+    tensors) to the result, in the order in which the features were added.
+
+    \code
+    FilterBank bank;
+    double scales[] = { 0.7, 1.0, 1.6, 3.5, 5.0 };
+    for(int k=0; k<5; ++k)
+        bank.add(FilterBank::GaussianSmoothing, scales[k])
+            .add(FilterBank::GaussianGradientMagnitude, scales[k])
+            .add(FilterBank::LaplacianOfGaussian, scales[k])
+            .add(FilterBank::HessianOfGaussianEigenvalues, scales[k])
+            .add(FilterBank::StructureTensorEigenvalues, scales[k]);
+    \endcode
+*/
+class FilterBank
+{
+  public:
+        /** Features that can be computed by a filter bank.
+        */
+    enum Feature
+    {
+        GaussianSmoothing,              ///< \ref gaussianSmoothMultiArray(), 1 channel
+        GaussianGradientMagnitude,      ///< \ref gaussianGradientMagnitude(), 1 channel
+        LaplacianOfGaussian,            ///< \ref laplacianOfGaussianMultiArray(), 1 channel
+        HessianOfGaussianEigenvalues,   ///< eigenvalues of \ref hessianOfGaussianMultiArray(), N channels
+        StructureTensorEigenvalues      ///< eigenvalues of \ref structureTensorMultiArray(), N channels
+    };
+
+    struct Filter
+    {
+        Feature feature;
+        double scale, outerScale;
+    };
+
+    FilterBank()
+    : min_increment_(1.0)
+    {}
+
+        /** Add a feature at the given scale. The outer scale of the structure
+            tensor is set to <tt>scale / 2</tt>.
+        */
+    FilterBank & add(Feature feature, double scale)
+    {
+        return add(feature, scale, 0.5*scale);
+    }
+
+        /** Add a feature at the given scale. The outer scale is only used
+            by <tt>StructureTensorEigenvalues</tt>, where <tt>scale</tt> is
+            the inner scale.
+        */
+    FilterBank & add(Feature feature, double scale, double outerScale)
+    {
+        vigra_precondition(scale > 0.0,
+            "FilterBank::add(): scale must be positive.");
+        vigra_precondition(feature != StructureTensorEigenvalues || outerScale > 0.0,
+            "FilterBank::add(): outer scale must be positive.");
+        Filter filter = { feature, scale,
+                          feature == StructureTensorEigenvalues ? outerScale : 0.0 };
+        filters_.push_back(filter);
+        return *this;
+    }
+
+        /** Minimal scale increment when a scale is computed from a smaller one.
+
+            The filter bank smoothes the data successively, i.e. scale
+            <tt>s</tt> is obtained from the result at the largest scale <tt>t</tt>
+            with <tt>sqrt(s*s - t*t) >= increment</tt> by convolution with
+            a Gaussian of standard deviation <tt>sqrt(s*s - t*t)</tt> (or from
+            the original data if there is no such <tt>t</tt>). Smaller increments save
+            more computations, but sampled Gaussians at small scales are poor
+            approximations of the continuous ones, so that the results deviate more
+            from those of the individual filters. <tt>increment = 0</tt> results
+            in a pure cascade.
+
+            Default: 1.0
+        */
+    FilterBank & minimumIncrement(double increment)
+    {
+        vigra_precondition(increment >= 0.0,
+            "FilterBank::minimumIncrement(): increment must not be negative.");
+        min_increment_ = increment;
+        return *this;
+    }
+
+    double getMinimumIncrement() const
+    {
+        return min_increment_;
+    }
+
+        /** Number of features in the bank.
+        */
+    unsigned int size() const
+    {
+        return filters_.size();
+    }
+
+    Filter const & operator[](unsigned int k) const
+    {
+        return filters_[k];
+    }
+
+        /** Number of result channels of a feature for <tt>ndim</tt>-dimensional data.
+        */
+    static unsigned int channelCount(Feature feature, unsigned int ndim)
+    {
+        return (feature == HessianOfGaussianEigenvalues || feature == StructureTensorEigenvalues)
+                   ? ndim
+                   : 1;
+    }
+
+        /** Total number of result channels for <tt>ndim</tt>-dimensional data.
+        */
+    unsigned int channelCount(unsigned int ndim) const
+    {
+        return channelOffset(size(), ndim);
+    }
+
+        /** Index of the first result channel of feature <tt>k</tt> for
+            <tt>ndim</tt>-dimensional data.
+        */
+    unsigned int channelOffset(unsigned int k, unsigned int ndim) const
+    {
+        unsigned int res = 0;
+        for(unsigned int i=0; i<k; ++i)
+            res += channelCount(filters_[i].feature, ndim);
+        return res;
+    }
+
+  private:
+    std::vector<Filter> filters_;
+    double min_increment_;
+};
+
+namespace detail {
+
+    // Execution plan of a filter bank: The distinct scales are processed in
+    // ascending order. Each scale ("level") is computed from an earlier level
+    // (or the raw data) by separable filters at the scale increment, and all
+    // derivatives needed at a level share the one-dimensional passes of
+    // their common prefix.
+template <unsigned int N, class KernelType>
+class FilterBankPlan
+{
+  public:
+    typedef typename MultiArrayShape<N>::type                       Shape;
+    typedef TinyVector<int, N>                                      Orders;
+    typedef MultiArray<N, KernelType, ScratchAllocator<KernelType> > Array;
+    typedef MultiArrayView<N, KernelType, StridedArrayTag>          View;
+    typedef VIGRA_SHARED_PTR<Array>                                 ArrayPointer;
+
+    struct Level
+    {
+        double scale;
+        int base;                       // level this one is computed from (-1: raw data)
+        bool isBase;                    // level is needed on the entire block
+        MultiArrayIndex radius;         // support of the smoothing cascade up to this level
+        MultiArrayIndex margin;         // required region around the block core
+        Kernel1D<KernelType> kernels[3];
+        std::vector<Orders> derivatives;
+        std::vector<unsigned int> filters;
+    };
+
+    FilterBankPlan(FilterBank const & bank)
+    : bank_(bank)
+    , border_(0)
+    {
+        std::vector<double> scales;
+        for(unsigned int k=0; k<bank.size(); ++k)
+            scales.push_back(bank[k].scale);
+        std::sort(scales.begin(), scales.end());
+        scales.erase(std::unique(scales.begin(), scales.end()), scales.end());
+
+        levels_.resize(scales.size());
+        double minIncrement2 = sq(bank.getMinimumIncrement());
+        for(unsigned int l=0; l<levels_.size(); ++l)
+        {
+            Level & level = levels_[l];
+            level.scale = scales[l];
+            level.base = -1;
+            level.isBase = false;
+            level.margin = 0;
+            for(int b=(int)l-1; b>=0; --b)
+            {
+                if(sq(scales[l]) - sq(scales[b]) >= minIncrement2)
+                {
+                    level.base = b;
+                    levels_[b].isBase = true;
+                    break;
+                }
+            }
+            double baseScale = level.base < 0 ? 0.0 : scales[level.base],
+                   increment = std::sqrt(sq(level.scale) - sq(baseScale));
+            level.kernels[0].initGaussian(increment);
+            level.kernels[1].initGaussianDerivative(increment, 1);
+            level.kernels[2].initGaussianDerivative(increment, 2);
+            level.radius = level.kernels[0].right() +
+                           (level.base < 0 ? 0 : levels_[level.base].radius);
+        }
+
+        for(unsigned int k=0; k<bank.size(); ++k)
+        {
+            unsigned int l = std::lower_bound(scales.begin(), scales.end(), bank[k].scale) - scales.begin();
+            Level & level = levels_[l];
+            level.filters.push_back(k);
+            switch(bank[k].feature)
+            {
+              case FilterBank::GaussianSmoothing:
+                addDerivative(level, Orders(0));
+                break;
+              case FilterBank::StructureTensorEigenvalues:
+              {
+                Kernel1D<KernelType> outer;
+                outer.initGaussian(bank[k].outerScale);
+                level.margin = std::max<MultiArrayIndex>(level.margin, outer.right());
+              }
+              // fall through
+              case FilterBank::GaussianGradientMagnitude:
+                for(unsigned int i=0; i<N; ++i)
+                    addDerivative(level, unitOrders(i));
+                break;
+              case FilterBank::LaplacianOfGaussian:
+                for(unsigned int i=0; i<N; ++i)
+                    addDerivative(level, unitOrders(i, i));
+                break;
+              case FilterBank::HessianOfGaussianEigenvalues:
+                for(unsigned int i=0; i<N; ++i)
+                    for(unsigned int j=i; j<N; ++j)
+                        addDerivative(level, unitOrders(i, j));
+                break;
+            }
+        }
+
+        for(unsigned int l=0; l<levels_.size(); ++l)
+        {
+            Level const & level = levels_[l];
+            MultiArrayIndex radius = 0;
+            for(unsigned int k=0; k<level.derivatives.size(); ++k)
+                radius = std::max<MultiArrayIndex>(radius, level.kernels[max(level.derivatives[k])].right());
+            if(level.isBase)
+                radius = std::max<MultiArrayIndex>(radius, level.kernels[0].right());
+            radius += level.margin + (level.base < 0 ? 0 : levels_[level.base].radius);
+            border_ = std::max(border_, radius);
+        }
+    }
+
+        // required border around each block
+    Shape border() const
+    {
+        return Shape(border_);
+    }
+
+        // compute all features for the core of a block
+    template <class T1, class S1, class T2, class S2>
+    void exec(MultiArrayView<N, T1, S1> const & block,
+              Shape const & coreBegin, Shape const & coreEnd,
+              MultiArrayView<N+1, T2, S2> dest) const
+    {
+        Shape shape = block.shape();
+        Array raw(block);
+        std::vector<ArrayPointer> levelArrays(levels_.size());
+
+        for(unsigned int l=0; l<levels_.size(); ++l)
+        {
+            Level const & level = levels_[l];
+            View base = level.base < 0
+                            ? View(raw)
+                            : View(*levelArrays[level.base]);
+            Shape regionBegin = max(coreBegin - Shape(level.margin), Shape(0)),
+                  regionEnd   = min(coreEnd + Shape(level.margin), shape);
+
+            std::vector<ArrayPointer> storage;
+            std::vector<View> derivatives(level.derivatives.size());
+            std::vector<unsigned int> todo;
+            if(level.isBase)
+            {
+                levelArrays[l] = ArrayPointer(new Array(shape));
+                separableConvolveMultiArray(base, *levelArrays[l], level.kernels[0]);
+            }
+            for(unsigned int k=0; k<level.derivatives.size(); ++k)
+            {
+                if(level.isBase && level.derivatives[k] == Orders(0))
+                {
+                    derivatives[k] = levelArrays[l]->subarray(regionBegin, regionEnd);
+                }
+                else
+                {
+                    storage.push_back(ArrayPointer(new Array(regionEnd - regionBegin)));
+                    derivatives[k] = *storage.back();
+                    todo.push_back(k);
+                }
+            }
+            if(todo.size() > 0)
+                derive(base, level, todo, 0, regionBegin, regionEnd, derivatives);
+
+            for(unsigned int k=0; k<level.filters.size(); ++k)
+                computeFeature(level, level.filters[k], derivatives,
+                               coreBegin - regionBegin, coreEnd - regionBegin, dest);
+        }
+    }
+
+  private:
+    static void addDerivative(Level & level, Orders const & orders)
+    {
+        std::vector<Orders> & d = level.derivatives;
+        if(std::find(d.begin(), d.end(), orders) == d.end())
+            d.push_back(orders);
+    }
+
+        // first derivative along dimension i
+    static Orders unitOrders(unsigned int i)
+    {
+        Orders res(0);
+        ++res[i];
+        return res;
+    }
+
+        // second derivative along dimensions i and j
+    static Orders unitOrders(unsigned int i, unsigned int j)
+    {
+        Orders res(0);
+        ++res[i];
+        ++res[j];
+        return res;
+    }
+
+    int findDerivative(Level const & level, Orders const & orders) const
+    {
+        return std::find(level.derivatives.begin(), level.derivatives.end(), orders) -
+               level.derivatives.begin();
+    }
+
+        // Apply the one-dimensional passes along dimension 'dim' and beyond.
+        // 'src' covers the region in the dimensions before 'dim' and the entire
+        // block in the other dimensions.
+    void derive(View const & src, Level const & level,
+                std::vector<unsigned int> const & which, unsigned int dim,
+                Shape const & regionBegin, Shape const & regionEnd,
+                std::vector<View> & results) const
+    {
+        Shape start, stop(src.shape());
+        start[dim] = regionBegin[dim];
+        stop[dim]  = regionEnd[dim];
+
+        for(int order=0; order<3; ++order)
+        {
+            std::vector<unsigned int> group;
+            for(unsigned int k=0; k<which.size(); ++k)
+                if(level.derivatives[which[k]][dim] == order)
+                    group.push_back(which[k]);
+            if(group.size() == 0)
+                continue;
+
+            if(dim == N-1)
+            {
+                convolveMultiArrayOneDimension(src, results[group[0]], dim,
+                                               level.kernels[order], start, stop);
+            }
+            else
+            {
+                Array tmp(stop - start);
+                convolveMultiArrayOneDimension(src, tmp, dim, level.kernels[order], start, stop);
+                derive(tmp, level, group, dim+1, regionBegin, regionEnd, results);
+            }
+        }
+    }
+
+    template <class T2, class S2>
+    void computeFeature(Level const & level, unsigned int k,
+                        std::vector<View> const & derivatives,
+                        Shape const & coreBegin, Shape const & coreEnd,
+                        MultiArrayView<N+1, T2, S2> dest) const
+    {
+        using namespace multi_math;
+        typedef TinyVector<KernelType, int(N*(N+1)/2)> TensorType;
+        typedef TinyVector<KernelType, int(N)>         EigenvalueType;
+
+        unsigned int channel = bank_.channelOffset(k, N);
+        Shape coreShape = coreEnd - coreBegin;
+
+        switch(bank_[k].feature)
+        {
+          case FilterBank::GaussianSmoothing:
+          {
+            dest.bindOuter(channel) =
+                derivatives[findDerivative(level, Orders(0))].subarray(coreBegin, coreEnd);
+            break;
+          }
+          case FilterBank::GaussianGradientMagnitude:
+          {
+            Array res(coreShape);
+            for(unsigned int i=0; i<N; ++i)
+                res += sq(derivatives[findDerivative(level, unitOrders(i))].subarray(coreBegin, coreEnd));
+            dest.bindOuter(channel) = sqrt(res);
+            break;
+          }
+          case FilterBank::LaplacianOfGaussian:
+          {
+            Array res(coreShape);
+            for(unsigned int i=0; i<N; ++i)
+                res += derivatives[findDerivative(level, unitOrders(i, i))].subarray(coreBegin, coreEnd);
+            dest.bindOuter(channel) = res;
+            break;
+          }
+          case FilterBank::HessianOfGaussianEigenvalues:
+          {
+            MultiArray<N, TensorType, ScratchAllocator<TensorType> > hessian(coreShape);
+            for(unsigned int b=0, i=0; i<N; ++i)
+                for(unsigned int j=i; j<N; ++j, ++b)
+                    hessian.bindElementChannel(b) =
+                        derivatives[findDerivative(level, unitOrders(i, j))].subarray(coreBegin, coreEnd);
+            MultiArray<N, EigenvalueType, ScratchAllocator<EigenvalueType> > eigenvalues(coreShape);
+            tensorEigenvaluesMultiArray(hessian, eigenvalues);
+            for(unsigned int i=0; i<N; ++i)
+                dest.bindOuter(channel+i) = eigenvalues.bindElementChannel(i);
+            break;
+          }
+          case FilterBank::StructureTensorEigenvalues:
+          {
+            Shape regionShape = derivatives[0].shape();
+            MultiArray<N, TensorType, ScratchAllocator<TensorType> > tensor(regionShape);
+            for(unsigned int b=0, i=0; i<N; ++i)
+                for(unsigned int j=i; j<N; ++j, ++b)
+                    tensor.bindElementChannel(b) = derivatives[findDerivative(level, unitOrders(i))] *
+                                                   derivatives[findDerivative(level, unitOrders(j))];
+            MultiArray<N, TensorType, ScratchAllocator<TensorType> > smoothed(coreShape);
+            gaussianSmoothMultiArray(tensor, smoothed,
+                ConvolutionOptions<N>().stdDev(bank_[k].outerScale).subarray(coreBegin, coreEnd));
+            MultiArray<N, EigenvalueType, ScratchAllocator<EigenvalueType> > eigenvalues(coreShape);
+            tensorEigenvaluesMultiArray(smoothed, eigenvalues);
+            for(unsigned int i=0; i<N; ++i)
+                dest.bindOuter(channel+i) = eigenvalues.bindElementChannel(i);
+            break;
+          }
+        }
+    }
+
+    FilterBank const & bank_;
+    std::vector<Level> levels_;
+    MultiArrayIndex border_;
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                 filterBankMultiArray                 */
+/*                                                      */
+/********************************************************/
+
+/** \brief Compute a set of Gaussian features in a single blockwise, parallel pass.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2>
+        void
+        filterBankMultiArray(MultiArrayView<N, T1, S1> const & source,
+                             MultiArrayView<N+1, T2, S2> dest,
+                             FilterBank const & bank,
+                             BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    The features specified by the \ref vigra::FilterBank are written into the channels
+    (last dimension) of <tt>dest</tt>, which must have <tt>bank.channelCount(N)</tt> channels.
+    The channels of eigenvalue features are in descending order of the eigenvalues.
+
+    Compared to calling the individual filter functions, the filter bank saves
+    most of the work: each scale is computed from a smaller scale by convolution with the scale
+    increment (see \ref vigra::FilterBank::minimumIncrement()), all derivatives at a given scale
+    share their one-dimensional filter passes as far as possible, and the data are
+    traversed only once. The array is processed in parallel in blocks, whose shape and
+    the number of threads are controlled by the \ref vigra::BlockwiseOptions. Because the
+    scales are computed successively, the results differ slightly from those of the
+    individual filters (by a small fraction of the feature magnitudes), and the
+    blocks need a larger border.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_filterbank.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, UInt8> volume(Shape3(200, 200, 100));
+    ...
+    FilterBank bank;
+    bank.add(FilterBank::GaussianSmoothing, 1.0)
+        .add(FilterBank::HessianOfGaussianEigenvalues, 1.0)
+        .add(FilterBank::GaussianSmoothing, 3.5)
+        .add(FilterBank::StructureTensorEigenvalues, 3.5);
+
+    MultiArray<4, float> features(Shape4(200, 200, 100, bank.channelCount(3)));
+    filterBankMultiArray(volume, features, bank, BlockwiseOptions().blockShape(64));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void filterBankMultiArray)
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+void
+filterBankMultiArray(MultiArrayView<N, T1, S1> const & source,
+                     MultiArrayView<N+1, T2, S2> dest,
+                     FilterBank const & bank,
+                     BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef typename NumericTraits<T2>::RealPromote KernelType;
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Shape Shape;
+    typedef typename Blocking::BlockWithBorder BlockWithBorder;
+    typedef typename MultiArrayShape<N+1>::type DestShape;
+
+    for(unsigned int k=0; k<N; ++k)
+        vigra_precondition(source.shape(k) == dest.shape(k),
+            "filterBankMultiArray(): shape mismatch between source and destination.");
+    vigra_precondition(dest.shape(N) == (MultiArrayIndex)bank.channelCount(N),
+        "filterBankMultiArray(): destination must have bank.channelCount(N) channels.");
+    if(bank.size() == 0)
+        return;
+
+    detail::FilterBankPlan<N, KernelType> plan(bank);
+    const Blocking blocking(source.shape(), options.template getBlockShapeN<N>());
+    const Shape border = plan.border();
+    VIGRA_SHARED_PTR<ScratchArenaPool> arenas = blockwise::scratchArenas(options);
+
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockWithBorderBegin(border), blocking.blockWithBorderEnd(border),
+        [&](const int threadId, const BlockWithBorder bwb)
+        {
+            ScratchArena & arena = (*arenas)[threadId];
+            {
+                ScratchArena::Scope scope(arena);
+                DestShape destBegin, destEnd;
+                for(unsigned int k=0; k<N; ++k)
+                {
+                    destBegin[k] = bwb.core().begin()[k];
+                    destEnd[k] = bwb.core().end()[k];
+                }
+                destEnd[N] = dest.shape(N);
+                plan.exec(source.subarray(bwb.border().begin(), bwb.border().end()),
+                          bwb.localCore().begin(), bwb.localCore().end(),
+                          dest.subarray(destBegin, destEnd));
+            }
+            arena.reset();
+        },
+        blocking.numBlocks()
+    );
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_FILTERBANK_HXX
@@ -2707,6 +2707,25 @@ public:
         return &neighborExists_;
     }
 
+        /** \brief Memory offsets of the neighbors of an interior node.
+
+            Returns the distances (in elements) between an interior node (i.e. a node not
+            at the border, see \ref gridGraphScan()) and its neighbors in an array with
+            the given \a strides. The order is the same as in <tt>OutArcIt</tt>, or in
+            <tt>OutBackArcIt</tt> when \a backEdgesOnly is <tt>true</tt>. The
+            corresponding neighbor indices are given by
+            <tt>(*neighborIndexArray(backEdgesOnly))[0]</tt>.
+        */
+    ArrayVector<MultiArrayIndex>
+    interiorNeighborOffsets(shape_type const & strides, bool backEdgesOnly = false) const
+    {
+        ArrayVector<MultiArrayIndex> const & indices = (*neighborIndexArray(backEdgesOnly))[0];
+        ArrayVector<MultiArrayIndex> res(indices.size());
+        for(unsigned int k=0; k<indices.size(); ++k)
+            res[k] = dot(neighborOffsets_[indices[k]], strides);
+        return res;
+    }
+
   protected:
     NeighborOffsetArray neighborOffsets_;
     NeighborExistsArray neighborExists_;
@@ -2727,6 +2746,73 @@ isInside(GridGraph<N, DirectedTag> const & g,
     return allLess(v, g.shape()) && allGreaterEqual(v, typename MultiArrayShape<N>::type());
 }
 
+/** \brief Visit all nodes of a GridGraph in scan order, separating interior and border nodes.
+
+    A node is in the interior when none of its coordinates is at the first or last
+    position of the respective axis, i.e. when all its neighbors exist. For interior
+    nodes, the neighbor offsets are the same everywhere, so algorithms can precompute
+    a memory offset table (see \ref GridGraph::interiorNeighborOffsets()) and run a
+    tight loop over raw pointers, without the border classification of the generic
+    neighbor iterators. Only the thin border shell needs the generic code path.
+
+    The function calls <tt>interior(start, length)</tt> for each maximal run of interior
+    nodes along dimension 0, where <tt>start</tt> is the first node of the run, and
+    <tt>border(node)</tt> for each border node. Runs and border nodes are visited in
+    scan order, so that algorithms relying on the scan order (e.g. union-find labeling
+    with <tt>OutBackArcIt</tt>) produce identical results.
+
+    <b>\#include</b> \<vigra/multi_gridgraph.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class DirectedTag, class InteriorFunctor, class BorderFunctor>
+void
+gridGraphScan(GridGraph<N, DirectedTag> const & g,
+              InteriorFunctor && interior, BorderFunctor && border)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    Shape const & shape = g.shape();
+    if(prod(shape) == 0)
+        return;
+
+    MultiArrayIndex width = shape[0];
+    Shape node;
+    while(true)
+    {
+        bool interiorLine = width > 2;
+        for(unsigned int k=1; k<N && interiorLine; ++k)
+            if(node[k] == 0 || node[k] == shape[k]-1)
+                interiorLine = false;
+
+        if(interiorLine)
+        {
+            node[0] = 0;
+            border(node);
+            node[0] = 1;
+            interior(node, width-2);
+            node[0] = width-1;
+            border(node);
+        }
+        else
+        {
+            for(node[0]=0; node[0]<width; ++node[0])
+                border(node);
+        }
+        node[0] = 0;
+
+        // go to the next line
+        unsigned int k = 1;
+        for(; k<N; ++k)
+        {
+            if(++node[k] < shape[k])
+                break;
+            node[k] = 0;
+        }
+        if(k == N)
+            break;
+    }
+}
+
 //@}
 
 #ifdef WITH_BOOST_GRAPH
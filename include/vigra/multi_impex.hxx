@@ -50,6 +50,7 @@
 #include "multi_array.hxx"
 #include "multi_pointoperators.hxx"
 #include "sifImport.hxx"
+#include "threadpool.hxx"
 
 #ifdef _MSC_VER
 # include <direct.h>
@@ -225,9 +226,24 @@ class VolumeImportInfo
     template <class T, class Stride>
     void importImpl(MultiArrayView <3, T, Stride> &volume) const;
 
+    template <class T, class Stride>
+    void importImpl(MultiArrayView <3, T, Stride> &volume,
+                    ParallelOptions const & options) const;
+
+    template <class T>
+    void importImpl(ChunkedArray<3, T> & volume,
+                    ParallelOptions const & options) const;
+
   protected:
     void getVolumeInfoFromFirstSlice(const std::string &filename);
 
+        // read slice 'z' of a STACK or MULTIPAGE volume
+    template <class T, class Stride>
+    void importSlice(MultiArrayIndex z, MultiArrayView <2, T, Stride> slice) const;
+
+        // open the raw data file of a RAW volume
+    void openRawFile(std::ifstream & s) const;
+
     size_type shape_;
     Resolution resolution_;
     //PixelType pixelType_;
@@ -487,86 +503,95 @@ readVolumeImpl(DestIterator d, Shape const & shape, std::ifstream & s, ArrayVect
 } // namespace detail
 
 template <class T, class Stride>
-void VolumeImportInfo::importImpl(MultiArrayView <3, T, Stride> &volume) const
+void VolumeImportInfo::importSlice(MultiArrayIndex z, MultiArrayView <2, T, Stride> slice) const
 {
-    vigra_precondition(this->shape() == volume.shape(), "importVolume(): Output array must be shaped according to VolumeImportInfo.");
+    // each call uses its own decoder, so that slices can be read concurrently.
+    // The decoder is created directly rather than via ImageImportInfo, which would
+    // count all pages of a multi-page file and open the file a second time.
+    VIGRA_UNIQUE_PTR<Decoder> decoder;
+    if(fileType_ == "STACK")
+        decoder = getDecoder(baseName_ + numbers_[z] + extension_);
+    else
+        decoder = getDecoder(baseName_, "undefined", (unsigned int)z);
+    vigra_precondition(slice.shape() == Shape2(decoder->getWidth(), decoder->getHeight()),
+        "importVolume(): the images have inconsistent sizes.");
+    detail::readImage(decoder.get(), slice);
+    decoder->close();
+}
 
-    if(fileType_ == "RAW")
-    {
-        std::string dirName, baseName;
-        char oldCWD[2048];
+inline void VolumeImportInfo::openRawFile(std::ifstream & s) const
+{
+    // the raw file name is relative to the directory of the .info file
+    char oldCWD[2048];
 
 #ifdef _MSC_VER
-        if(_getcwd(oldCWD, 2048) == 0)
-        {
-            perror("getcwd");
-            vigra_fail("VolumeImportInfo: Unable to query current directory (getcwd).");
-        }
-        if(_chdir(path_.c_str()))
-        {
-            perror("chdir");
-            vigra_fail("VolumeImportInfo: Unable to change to new directory (chdir).");
-        }
+    if(_getcwd(oldCWD, 2048) == 0)
+    {
+        perror("getcwd");
+        vigra_fail("VolumeImportInfo: Unable to query current directory (getcwd).");
+    }
+    if(_chdir(path_.c_str()))
+    {
+        perror("chdir");
+        vigra_fail("VolumeImportInfo: Unable to change to new directory (chdir).");
+    }
 #else
-        if(getcwd(oldCWD, 2048) == 0)
-        {
-            perror("getcwd");
-            vigra_fail("VolumeImportInfo: Unable to query current directory (getcwd).");
-        }
-        if(chdir(path_.c_str()))
-        {
-            perror("chdir");
-            vigra_fail("VolumeImportInfo: Unable to change to new directory (chdir).");
-        }
+    if(getcwd(oldCWD, 2048) == 0)
+    {
+        perror("getcwd");
+        vigra_fail("VolumeImportInfo: Unable to query current directory (getcwd).");
+    }
+    if(chdir(path_.c_str()))
+    {
+        perror("chdir");
+        vigra_fail("VolumeImportInfo: Unable to change to new directory (chdir).");
+    }
 #endif
 
-        std::ifstream s(rawFilename_.c_str(), std::ios::binary);
-        vigra_precondition(s.good(), "RAW file could not be opened");
-
-        ArrayVector<T> buffer(shape_[0]);
-        detail::readVolumeImpl(volume.traverser_begin(), shape_, s, buffer, vigra::MetaInt<2>());
-
-        //vigra_precondition(s.good(), "RAW file could not be opened");
-        //s.read((char*)volume.data(), shape_[0]*shape_[1]*shape_[2]*sizeof(T));
+    s.open(rawFilename_.c_str(), std::ios::binary);
 
 #ifdef _MSC_VER
-        if(_chdir(oldCWD))
-            perror("chdir");
+    if(_chdir(oldCWD))
+        perror("chdir");
 #else
-        if(chdir(oldCWD))
-            perror("chdir");
+    if(chdir(oldCWD))
+        perror("chdir");
 #endif
 
-        vigra_postcondition(
-            volume.shape() == shape(), "imported volume has wrong size");
-    }
-    else if(fileType_ == "STACK")
-    {
-        for (unsigned int i = 0; i < numbers_.size(); ++i)
-        {
-            // build the filename
-            std::string filename = baseName_ + numbers_[i] + extension_;
+    vigra_precondition(s.good(), "RAW file could not be opened");
+}
 
-            // import the image
-            ImageImportInfo info (filename.c_str ());
+template <class T, class Stride>
+void VolumeImportInfo::importImpl(MultiArrayView <3, T, Stride> &volume) const
+{
+    importImpl(volume, ParallelOptions().numThreads(ParallelOptions::NoThreads));
+}
 
-            // generate a basic image view to the current layer
-            MultiArrayView <2, T, Stride> view (volume.bindOuter (i));
-            vigra_precondition(view.shape() == info.shape(),
-                "importVolume(): the images have inconsistent sizes.");
+template <class T, class Stride>
+void VolumeImportInfo::importImpl(MultiArrayView <3, T, Stride> &volume,
+                                  ParallelOptions const & options) const
+{
+    vigra_precondition(this->shape() == volume.shape(), "importVolume(): Output array must be shaped according to VolumeImportInfo.");
 
-            importImage (info, destImage(view));
-        }
-    }
-    else if(fileType_ == "MULTIPAGE")
+    if(fileType_ == "RAW")
     {
-        ImageImportInfo info(baseName_.c_str());
+        std::ifstream s;
+        openRawFile(s);
 
-        for(int k=0; k<info.numImages(); ++k)
-        {
-            info.setImageIndex(k);
-            importImage(info, volume.bindOuter(k));
-        }
+        ArrayVector<T> buffer(shape_[0]);
+        detail::readVolumeImpl(volume.traverser_begin(), shape_, s, buffer, vigra::MetaInt<2>());
+
+        vigra_postcondition(
+            volume.shape() == shape(), "imported volume has wrong size");
+    }
+    else if(fileType_ == "STACK" || fileType_ == "MULTIPAGE")
+    {
+        // decode the slices concurrently, directly into the target slices
+        parallel_foreach(options.getNumThreads(), shape_[2],
+            [&](size_t /* thread_id */, MultiArrayIndex z)
+            {
+                importSlice(z, volume.bindOuter(z));
+            });
     }
     // else if(fileType_ == "HDF5")
     // {
@@ -581,6 +606,56 @@ void VolumeImportInfo::importImpl(MultiArrayView <3, T, Stride> &volume) const
 }
 
 
+template <class T>
+void VolumeImportInfo::importImpl(ChunkedArray<3, T> & volume,
+                                  ParallelOptions const & options) const
+{
+    vigra_precondition(this->shape() == volume.shape(), "importVolume(): Output array must be shaped according to VolumeImportInfo.");
+
+    if(fileType_ == "STACK" || fileType_ == "MULTIPAGE")
+    {
+        // stream slice by slice, so that only one slice per thread
+        // must be held in memory
+        parallel_foreach(options.getNumThreads(), shape_[2],
+            [&](size_t /* thread_id */, MultiArrayIndex z)
+            {
+                MultiArray<2, T> slice(Shape2(shape_[0], shape_[1]));
+                importSlice(z, slice);
+                volume.commitSubarray(Shape3(0, 0, z), slice.insertSingletonDimension(2));
+            });
+    }
+    else if(fileType_ == "RAW")
+    {
+        // the file is read sequentially, one slice at a time
+        std::ifstream s;
+        openRawFile(s);
+
+        ArrayVector<T> buffer(shape_[0]);
+        MultiArray<3, T> slice(Shape3(shape_[0], shape_[1], 1));
+        for(MultiArrayIndex z=0; z<shape_[2]; ++z)
+        {
+            detail::readVolumeImpl(slice.traverser_begin(), slice.shape(), s, buffer, vigra::MetaInt<2>());
+            volume.commitSubarray(Shape3(0, 0, z), slice);
+        }
+    }
+    else if(fileType_ == "SIF")
+    {
+        SIFImportInfo infoSIF(baseName_.c_str());
+        parallel_foreach(options.getNumThreads(), shape_[2],
+            [&](size_t /* thread_id */, MultiArrayIndex z)
+            {
+                MultiArray<3, T> frame(Shape3(shape_[0], shape_[1], 1));
+                readSIFBlock(infoSIF, Shape3(0, 0, z), frame.shape(), frame);
+                volume.commitSubarray(Shape3(0, 0, z), frame);
+            });
+    }
+    else
+    {
+        vigra_precondition(false,
+            "importVolume(): file type '" + fileType_ + "' cannot be imported into a ChunkedArray.");
+    }
+}
+
 VIGRA_EXPORT void findImageSequence(const std::string &name_base,
                        const std::string &name_ext,
                        std::vector<std::string> & numbers);
@@ -615,6 +690,21 @@ VIGRA_EXPORT void findImageSequence(const std::string &name_base,
         importVolume(MultiArray <3, T, Allocator> & volume,
                      const std::string &name_base,
                      const std::string &name_ext);
+
+        // variant 4: like variant 1, but decode the slices in parallel
+        template <class T, class Stride>
+        void
+        importVolume(VolumeImportInfo const & info,
+                     MultiArrayView <3, T, Stride> volume,
+                     ParallelOptions const & options);
+
+        // variant 5: stream the slices in parallel into a chunked array
+        // (requires \<vigra/multi_array_chunked.hxx\>)
+        template <class T>
+        void
+        importVolume(VolumeImportInfo const & info,
+                     ChunkedArray<3, T> & volume,
+                     ParallelOptions const & options = ParallelOptions());
     }
     \endcode
 
@@ -661,6 +751,20 @@ VIGRA_EXPORT void findImageSequence(const std::string &name_base,
     will be interpreted according to their numerical order (i.e. "009", "010", "011"
     are read in the same order as "9", "10", "11"). The number of images
     found determines the depth of the volume.
+
+    Variants 4 and 5 decode the slices of image stacks and multi-page TIFF files concurrently
+    on <tt>options.getNumThreads()</tt> threads. Each slice is decoded directly into its
+    target slice of the destination (variant 4), or into a per-thread slice buffer that is
+    immediately committed to the chunked array (variant 5), so that volumes larger than RAM
+    can be loaded into a \ref vigra::ChunkedArrayCompressed or \ref vigra::ChunkedArrayHDF5.
+    Andor SIF files are streamed frame by frame in the same way. Raw volumes described
+    by a ".info" file are read sequentially, but are also streamed into chunked arrays
+    one slice at a time. Variant 4 reads SIF and raw volumes sequentially.
+    \code
+    VolumeImportInfo info("my_data", ".tif");
+    ChunkedArrayLazy<3, UInt16> volume(info.shape());
+    importVolume(info, volume, ParallelOptions().numThreads(16));
+    \endcode
 */
 doxygen_overloaded_function(template <...> void importVolume)
 
@@ -694,6 +798,24 @@ void importVolume (MultiArray <3, T, Allocator> & volume,
     info.importImpl(volume);
 }
 
+template <class T, class Stride>
+void
+importVolume(VolumeImportInfo const & info,
+             MultiArrayView <3, T, Stride> volume,
+             ParallelOptions const & options)
+{
+    info.importImpl(volume, options);
+}
+
+template <class T>
+void
+importVolume(VolumeImportInfo const & info,
+             ChunkedArray<3, T> & volume,
+             ParallelOptions const & options = ParallelOptions())
+{
+    info.importImpl(volume, options);
+}
+
 namespace detail {
 
 template <class T>
@@ -40,6 +40,7 @@
 #include "multi_shape.hxx"
 #include "multi_handle.hxx"
 #include "metaprogramming.hxx"
+#include <algorithm>
 
 namespace vigra {
 
@@ -710,6 +711,63 @@ get(CoupledScanOrderIterator<N, HANDLES, DIM> const & i)
     return vigra::get<TARGET_INDEX>(*i);
 }
 
+/** \brief Call a kernel for each run of a scan-order range along the innermost dimension.
+
+    The range <tt>[start, end)</tt> is split into strips, i.e. maximal runs of consecutive
+    elements along dimension 0. For each strip, the kernel is called as
+    <tt>f(handles, length)</tt>, where <tt>handles</tt> is a copy of the iterator's
+    \ref vigra::CoupledHandle at the first element of the strip, and <tt>length</tt>
+    is the number of elements in the strip. The kernel may modify its copy of the handles.
+    The pointer and stride of the K-th coupled array are available as
+    <tt>cast<K>(handles).ptr()</tt> and <tt>cast<K>(handles).strides()[0]</tt>, so that
+    the inner loop can run on raw pointers without the coordinate carry logic of
+    <tt>CoupledScanOrderIterator::operator++()</tt>. Alternatively,
+    <tt>handles.template increment<0>()</tt> advances all coupled arrays and the coordinate
+    to the next element of the strip.
+
+    <b>Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_iterator_coupled.hxx\> <br/>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> a(Shape3(100, 200, 50)), b(a.shape());
+    ...
+    typedef CoupledIteratorType<3, float, float>::type Iterator;
+    Iterator start = createCoupledIterator(a, b),
+             end   = start.getEndIterator();
+
+    // b = 2*a
+    stripForeach(start, end,
+        [](Iterator::value_type & h, MultiArrayIndex length)
+        {
+            float const * src = cast<1>(h).ptr();
+            float * dest      = cast<2>(h).ptr();
+            MultiArrayIndex ss = cast<1>(h).strides()[0],
+                            ds = cast<2>(h).strides()[0];
+            for(MultiArrayIndex k=0; k<length; ++k)
+                dest[k*ds] = 2.0f*src[k*ss];
+        });
+    \endcode
+*/
+template <unsigned int N, class HANDLES, int DIM, class FUNCTOR>
+void
+stripForeach(CoupledScanOrderIterator<N, HANDLES, DIM> start,
+             CoupledScanOrderIterator<N, HANDLES, DIM> const & end,
+             FUNCTOR && f)
+{
+    while(start < end)
+    {
+        MultiArrayIndex length = std::min<MultiArrayIndex>(start.shape(0) - start.point(0),
+                                                           end - start);
+        HANDLES handles(*start);
+        f(handles, length);
+        // the last step carries the coordinate to the next strip
+        start.addDim(0, length-1);
+        ++start;
+    }
+}
+
 /** Helper class to easliy get the type of a CoupledScanOrderIterator (and corresponding CoupledHandle) for up to five arrays of dimension N with element types T1,...,T5.
  */
 template <unsigned int N, class T1=void, class T2=void, class T3=void, class T4=void, class T5=void>
@@ -301,6 +301,122 @@ labelGraphWithBackground(GridGraph<N, DirectedTag> const & g,
     return count;
 }
 
+namespace graph_detail {
+
+    // Union-find labeling of a GridGraph whose maps are MultiArrayViews. Interior
+    // nodes are processed by a raw-pointer loop over precomputed neighbor offsets,
+    // border nodes by the generic neighbor iterator. 'isBackground' returns true
+    // for nodes that get label zero.
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2,
+          class Equal, class IsBackground>
+T2
+labelGridGraph(GridGraph<N, DirectedTag> const & g,
+               MultiArrayView<N, T1, S1> const & data,
+               MultiArrayView<N, T2, S2> labels,
+               Equal const & equal,
+               IsBackground const & isBackground)
+{
+    typedef GridGraph<N, DirectedTag>     Graph;
+    typedef typename Graph::OutBackArcIt  neighbor_iterator;
+    typedef typename Graph::shape_type    Shape;
+
+    vigra::UnionFindArray<T2>  regions;
+
+    ArrayVector<MultiArrayIndex> const & backIndices = (*g.neighborIndexArray(true))[0];
+    ArrayVector<MultiArrayIndex> dataOffsets  = g.interiorNeighborOffsets(data.stride(), true),
+                                 labelOffsets = g.interiorNeighborOffsets(labels.stride(), true);
+    ArrayVector<Shape> diffs;
+    for(unsigned int k=0; k<backIndices.size(); ++k)
+        diffs.push_back(g.neighborOffset(backIndices[k]));
+    int degree = (int)backIndices.size();
+    MultiArrayIndex dataStride = data.stride(0),
+                    labelStride = labels.stride(0);
+
+    // pass 1: find connected components
+    gridGraphScan(g,
+        [&](Shape const & start, MultiArrayIndex length)
+        {
+            T1 const * d = &data[start];
+            T2 * l = &labels[start];
+            for(MultiArrayIndex i=0; i<length; ++i, d += dataStride, l += labelStride)
+            {
+                T1 center = *d;
+
+                if(isBackground(center))
+                {
+                    *l = 0;
+                    continue;
+                }
+
+                T2 currentIndex = regions.nextFreeIndex();
+                for(int k=0; k<degree; ++k)
+                {
+                    if(labeling_equality::callEqual(equal, center, d[dataOffsets[k]], diffs[k]))
+                        currentIndex = regions.makeUnion(l[labelOffsets[k]], currentIndex);
+                }
+                *l = regions.finalizeIndex(currentIndex);
+            }
+        },
+        [&](Shape const & node)
+        {
+            T1 center = data[node];
+
+            if(isBackground(center))
+            {
+                labels[node] = 0;
+                return;
+            }
+
+            T2 currentIndex = regions.nextFreeIndex();
+            for (neighbor_iterator arc(g, node); arc != INVALID; ++arc)
+            {
+                Shape diff = g.neighborOffset(arc.neighborIndex());
+                if(labeling_equality::callEqual(equal, center, data[g.target(*arc)], diff))
+                    currentIndex = regions.makeUnion(labels[g.target(*arc)], currentIndex);
+            }
+            labels[node] = regions.finalizeIndex(currentIndex);
+        });
+
+    T2 count = regions.makeContiguous();
+
+    // pass 2: make component labels contiguous
+    typename MultiArrayView<N, T2, S2>::iterator i = labels.begin(), end = labels.end();
+    for(; i != end; ++i)
+        *i = regions.findLabel(*i);
+    return count;
+}
+
+} // namespace graph_detail
+
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2, class Equal>
+inline T2
+labelGraph(GridGraph<N, DirectedTag> const & g,
+           MultiArrayView<N, T1, S1> const & data,
+           MultiArrayView<N, T2, S2> & labels,
+           Equal const & equal)
+{
+    return graph_detail::labelGridGraph(g, data, labels, equal,
+                                        [](T1 const &) { return false; });
+}
+
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2, class Equal>
+inline T2
+labelGraphWithBackground(GridGraph<N, DirectedTag> const & g,
+                         MultiArrayView<N, T1, S1> const & data,
+                         MultiArrayView<N, T2, S2> & labels,
+                         typename MultiArrayView<N, T1, S1>::value_type backgroundValue,
+                         Equal const & equal)
+{
+    typedef typename GridGraph<N, DirectedTag>::shape_type Shape;
+    return graph_detail::labelGridGraph(g, data, labels, equal,
+        [&](T1 const & v)
+        {
+            return labeling_equality::callEqual(equal, v, backgroundValue, Shape());
+        });
+}
 
 } // namespace lemon_graph
 
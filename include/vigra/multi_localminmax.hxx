@@ -159,6 +159,76 @@ localMinMaxGraph(Graph const &g,
 }
 
 
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2, class Compare>
+unsigned int
+localMinMaxGraph(GridGraph<N, DirectedTag> const &g,
+                 MultiArrayView<N, T1, S1> const &src,
+                 MultiArrayView<N, T2, S2> &dest,
+                 typename MultiArrayView<N, T2, S2>::value_type marker,
+                 typename MultiArrayView<N, T1, S1>::value_type threshold,
+                 Compare const &compare,
+                 bool allowAtBorder = true)
+{
+    typedef GridGraph<N, DirectedTag>   Graph;
+    typedef typename Graph::OutArcIt    neighbor_iterator;
+    typedef typename Graph::shape_type  Shape;
+
+    ArrayVector<MultiArrayIndex> offsets = g.interiorNeighborOffsets(src.stride());
+    int degree = (int)offsets.size();
+    MultiArrayIndex srcStride = src.stride(0),
+                    destStride = dest.stride(0);
+
+    unsigned int count = 0;
+    gridGraphScan(g,
+        [&](Shape const & start, MultiArrayIndex length)
+        {
+            T1 const * s = &src[start];
+            T2 * d = &dest[start];
+            for(MultiArrayIndex i=0; i<length; ++i, s += srcStride, d += destStride)
+            {
+                T1 current = *s;
+
+                if (!compare(current, threshold))
+                    continue;
+
+                int k = 0;
+                for (; k<degree; ++k)
+                    if (!compare(current, s[offsets[k]]))
+                        break;
+
+                if (k == degree)
+                {
+                    *d = marker;
+                    ++count;
+                }
+            }
+        },
+        [&](Shape const & node)
+        {
+            if(!allowAtBorder)
+                return;
+
+            T1 current = src[node];
+
+            if (!compare(current, threshold))
+                return;
+
+            neighbor_iterator arc(g, node);
+            for (; arc != INVALID; ++arc)
+                if (!compare(current, src[g.target(*arc)]))
+                    break;
+
+            if (arc == INVALID)
+            {
+                dest[node] = marker;
+                ++count;
+            }
+        });
+    return count;
+}
+
+
 template <class Graph, class T1Map, class T2Map, class Compare, class Equal>
 unsigned int
 extendedLocalMinMaxGraph(Graph const &g,
@@ -40,6 +40,7 @@
 #include "tinyvector.hxx"
 #include "rgbvalue.hxx"
 #include "mathutil.hxx"
+#include "threadpool.hxx"
 #include <complex>
 
 namespace vigra {
@@ -81,12 +82,41 @@ struct MultiMathOperand
         arg_.reset(axis);
     }
 
+    // move the pointer of all RHS arrays by 'k' steps along the given 'axis'
+    void move(unsigned int axis, MultiArrayIndex k) const
+    {
+        arg_.move(axis, k);
+    }
+
+    // Check if all RHS arrays have unit stride along the given 'axis',
+    // so that flat() can be used to iterate along this axis.
+    bool unitStride(unsigned int axis) const
+    {
+        return arg_.unitStride(axis);
+    }
+
+    // Check if all RHS arrays have the given strides along all non-singleton
+    // axes of 'shape', i.e. if they can be traversed in a single flat loop
+    // together with a LHS array of this shape and these strides.
+    template <class SHAPE>
+    bool sameStrides(SHAPE const & shape, SHAPE const & strides) const
+    {
+        return arg_.sameStrides(shape, strides);
+    }
+
     // get the value of the expression at the current pointer location
     result_type operator*() const
     {
         return *arg_;
     }
 
+    // get the value of the expression at the flat offset 'k' of the current
+    // pointer location (only valid when unitStride() or sameStrides() hold)
+    result_type flat(MultiArrayIndex k) const
+    {
+        return arg_.flat(k);
+    }
+
     // get the value of the expression at an offset of the current pointer location
     template <class SHAPE>
     result_type operator[](SHAPE const & s) const
@@ -156,11 +186,34 @@ struct MultiMathOperand<MultiArrayView<N, T, C> >
         p_ -= shape_[axis]*strides_[axis];
     }
 
+    void move(unsigned int axis, MultiArrayIndex k) const
+    {
+        p_ += k*strides_[axis];
+    }
+
+    bool unitStride(unsigned int axis) const
+    {
+        return strides_[axis] == 1;
+    }
+
+    bool sameStrides(Shape const & shape, Shape const & strides) const
+    {
+        for(unsigned int k=0; k<N; ++k)
+            if(shape[k] > 1 && strides_[k] != strides[k])
+                return false;
+        return true;
+    }
+
     result_type operator*() const
     {
         return *p_;
     }
 
+    T const & flat(MultiArrayIndex k) const
+    {
+        return p_[k];
+    }
+
     mutable T const * p_;
     Shape shape_, strides_;
 };
@@ -206,11 +259,30 @@ struct MultiMathScalarOperand
     void reset(unsigned int /* axis */) const
     {}
 
+    void move(unsigned int /* axis */, MultiArrayIndex /* k */) const
+    {}
+
+    bool unitStride(unsigned int /* axis */) const
+    {
+        return true;
+    }
+
+    template <class SHAPE>
+    bool sameStrides(SHAPE const &, SHAPE const &) const
+    {
+        return true;
+    }
+
     T const & operator*() const
     {
         return v_;
     }
 
+    T const & flat(MultiArrayIndex /* k */) const
+    {
+        return v_;
+    }
+
     T v_;
 };
 
@@ -281,6 +353,22 @@ struct MultiMathUnaryOperator
         o_.reset(axis);
     }
 
+    void move(unsigned int axis, MultiArrayIndex k) const
+    {
+        o_.move(axis, k);
+    }
+
+    bool unitStride(unsigned int axis) const
+    {
+        return o_.unitStride(axis);
+    }
+
+    template <class SHAPE>
+    bool sameStrides(SHAPE const & shape, SHAPE const & strides) const
+    {
+        return o_.sameStrides(shape, strides);
+    }
+
     template <class POINT>
     result_type operator[](POINT const & p) const
     {
@@ -292,6 +380,11 @@ struct MultiMathUnaryOperator
         return f_(*o_);
     }
 
+    result_type flat(MultiArrayIndex k) const
+    {
+        return f_(o_.flat(k));
+    }
+
     O o_;
     F f_;
 };
@@ -442,11 +535,33 @@ struct MultiMathBinaryOperator
         o2_.reset(axis);
     }
 
+    void move(unsigned int axis, MultiArrayIndex k) const
+    {
+        o1_.move(axis, k);
+        o2_.move(axis, k);
+    }
+
+    bool unitStride(unsigned int axis) const
+    {
+        return o1_.unitStride(axis) && o2_.unitStride(axis);
+    }
+
+    template <class SHAPE>
+    bool sameStrides(SHAPE const & shape, SHAPE const & strides) const
+    {
+        return o1_.sameStrides(shape, strides) && o2_.sameStrides(shape, strides);
+    }
+
     result_type operator*() const
     {
         return f_(*o1_, *o2_);
     }
 
+    result_type flat(MultiArrayIndex k) const
+    {
+        return f_(o1_.flat(k), o2_.flat(k));
+    }
+
     O1 o1_;
     O2 o2_;
     F f_;
@@ -662,6 +777,13 @@ struct MultiMathExec<1, Assign>
                      Shape const & strideOrder, Expression const & e)
     {
         MultiArrayIndex axis = strideOrder[LEVEL];
+        if(strides[axis] == 1 && e.unitStride(axis))
+        {
+            // all arrays are unstrided along the inner axis:
+            // use a flat loop the compiler can vectorize
+            Assign::assignFlat(data, 0, shape[axis], e);
+            return;
+        }
         for(MultiArrayIndex k=0; k<shape[axis]; ++k, data += strides[axis], e.inc(axis))
         {
             Assign::assign(data, e);
@@ -671,6 +793,83 @@ struct MultiMathExec<1, Assign>
     }
 };
 
+    // If the LHS is contiguous and all RHS arrays have the same memory layout,
+    // the entire expression is evaluated in a single flat loop.
+template <unsigned int N, class T, class C, class Expression>
+inline bool
+multiMathIsCollapsible(MultiArrayView<N, T, C> const & a, Expression const & e)
+{
+    return a.isUnstrided() && e.sameStrides(a.shape(), a.stride());
+}
+
+template <class Assign, unsigned int N, class T, class C, class Expression>
+void
+multiMathExec(MultiArrayView<N, T, C> a, Expression const & e)
+{
+    if(multiMathIsCollapsible(a, e))
+        Assign::assignFlat(a.data(), 0, a.size(), e);
+    else
+        MultiMathExec<N, Assign>::exec(a.data(), a.shape(), a.stride(),
+                                       a.strideOrdering(), e);
+}
+
+    // Evaluate the expression with several threads. Collapsible expressions
+    // are split into contiguous ranges of the flat loop, all others are
+    // split along the outermost axis of the LHS. Each task works on its own
+    // copy of the expression, so that the RHS pointers don't interfere.
+    // Small arrays are evaluated serially.
+template <class Assign, unsigned int N, class T, class C, class Expression>
+void
+multiMathExecParallel(MultiArrayView<N, T, C> a, Expression const & e,
+                      ParallelOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    static const MultiArrayIndex minimumTaskSize = 1 << 15;
+
+    int threads = options.getActualNumThreads();
+    if(threads <= 1 || a.size() < 2*minimumTaskSize)
+    {
+        multiMathExec<Assign>(a, e);
+        return;
+    }
+
+    if(multiMathIsCollapsible(a, e))
+    {
+        MultiArrayIndex taskSize = std::max(minimumTaskSize, a.size() / (4*threads)),
+                        tasks    = (a.size() + taskSize - 1) / taskSize;
+        T * data = a.data();
+        parallel_foreach(options.getNumThreads(), tasks,
+            [&](int /* threadId */, MultiArrayIndex task)
+            {
+                MultiArrayIndex begin = task*taskSize,
+                                end   = std::min(begin + taskSize, a.size());
+                Assign::assignFlat(data, begin, end, e);
+            });
+        return;
+    }
+
+    Shape strideOrder = a.strideOrdering();
+    unsigned int axis = (unsigned int)strideOrder[N-1];
+    MultiArrayIndex outer = a.shape(axis),
+                    inner = a.size() / outer,
+                    taskSize = std::max<MultiArrayIndex>(
+                                  std::max<MultiArrayIndex>(1, minimumTaskSize / inner),
+                                  outer / (4*threads)),
+                    tasks    = (outer + taskSize - 1) / taskSize;
+    parallel_foreach(options.getNumThreads(), tasks,
+        [&](int /* threadId */, MultiArrayIndex task)
+        {
+            MultiArrayIndex begin = task*taskSize,
+                            end   = std::min(begin + taskSize, outer);
+            Shape shape(a.shape());
+            shape[axis] = end - begin;
+            Expression local(e);
+            local.move(axis, begin);
+            MultiMathExec<N, Assign>::exec(a.data() + begin*a.stride(axis), shape,
+                                           a.stride(), strideOrder, local);
+        });
+}
+
 #define VIGRA_MULTIMATH_ASSIGN(NAME, OP) \
 struct MultiMath##NAME \
 { \
@@ -679,6 +878,14 @@ struct MultiMath##NAME \
     { \
         *data OP vigra::detail::RequiresExplicitCast<T>::cast(*e); \
     } \
+     \
+    template <class T, class Expression> \
+    static void assignFlat(T * data, MultiArrayIndex begin, MultiArrayIndex end, \
+                           Expression const & e) \
+    { \
+        for(MultiArrayIndex k=begin; k<end; ++k) \
+            data[k] OP vigra::detail::RequiresExplicitCast<T>::cast(e.flat(k)); \
+    } \
 }; \
  \
 template <unsigned int N, class T, class C, class Expression> \
@@ -689,8 +896,19 @@ void NAME(MultiArrayView<N, T, C> a, MultiMathOperand<Expression> const & e) \
     vigra_precondition(e.checkShape(shape), \
        "multi_math: shape mismatch in expression."); \
         \
-    MultiMathExec<N, MultiMath##NAME>::exec(a.data(), a.shape(), a.stride(), \
-                                            a.strideOrdering(), e); \
+    multiMathExec<MultiMath##NAME>(a, e); \
+} \
+ \
+template <unsigned int N, class T, class C, class Expression> \
+void NAME(MultiArrayView<N, T, C> a, MultiMathOperand<Expression> const & e, \
+          ParallelOptions const & options) \
+{ \
+    typename MultiArrayShape<N>::type shape(a.shape()); \
+     \
+    vigra_precondition(e.checkShape(shape), \
+       "multi_math: shape mismatch in expression."); \
+        \
+    multiMathExecParallel<MultiMath##NAME>(a, e, options); \
 } \
  \
 template <unsigned int N, class T, class A, class Expression> \
@@ -704,8 +922,7 @@ void NAME##OrResize(MultiArray<N, T, A> & a, MultiMathOperand<Expression> const
     if(a.size() == 0) \
         a.reshape(shape); \
          \
-    MultiMathExec<N, MultiMath##NAME>::exec(a.data(), a.shape(), a.stride(), \
-                                            a.strideOrdering(), e); \
+    multiMathExec<MultiMath##NAME>(a, e); \
 }
 
 VIGRA_MULTIMATH_ASSIGN(assign, =)
@@ -769,6 +986,23 @@ struct MultiMathReduceAny
 
 } // namespace math_detail
 
+#define VIGRA_MULTIMATH_PARALLEL_ASSIGN(NAME) \
+template <unsigned int N, class T, class C, class Expression> \
+inline void \
+parallel_##NAME(MultiArrayView<N, T, C> a, MultiMathOperand<Expression> const & e, \
+                ParallelOptions const & options = ParallelOptions()) \
+{ \
+    math_detail::NAME(a, e, options); \
+}
+
+VIGRA_MULTIMATH_PARALLEL_ASSIGN(assign)
+VIGRA_MULTIMATH_PARALLEL_ASSIGN(plusAssign)
+VIGRA_MULTIMATH_PARALLEL_ASSIGN(minusAssign)
+VIGRA_MULTIMATH_PARALLEL_ASSIGN(multiplyAssign)
+VIGRA_MULTIMATH_PARALLEL_ASSIGN(divideAssign)
+
+#undef VIGRA_MULTIMATH_PARALLEL_ASSIGN
+
 template <class U, class T>
 U
 sum(MultiMathOperand<T> const & v, U res = NumericTraits<U>::zero())
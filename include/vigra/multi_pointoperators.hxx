@@ -58,6 +58,16 @@ namespace vigra
     specified by a pair: an iterator referring to the first point of the array
     and a shape object specifying the size of the (rectangular) ROI.
 
+    The functions <tt>initMultiArray()</tt>, <tt>copyMultiArray()</tt>, <tt>transformMultiArray()</tt>,
+    <tt>combineTwoMultiArrays()</tt>, <tt>combineThreeMultiArrays()</tt>, and <tt>inspectMultiArray()</tt>
+    have overloads with an additional \ref vigra::ParallelOptions argument. They split the
+    destination (or, for <tt>inspectMultiArray()</tt>, the source) along its outermost non-singleton
+    dimension and process the parts with several threads. Functors are shared between the threads
+    and must therefore be stateless, i.e. calling them must not modify shared data. Reductions
+    along the split dimension (reduce mode with a singleton destination dimension) cannot be split
+    and are executed serially, as are small arrays. These overloads are provided by
+    <tt>\#include</tt> \<vigra/multi_pointoperators_parallel.hxx\>.
+
     <b>\#include</b> \<vigra/multi_pointoperators.hxx\><br/>
     Namespace: vigra
 */
@@ -110,6 +120,17 @@ initMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,
         template <unsigned int N, class T, class S, class FUNCTOR>
         void
         initMultiArray(MultiArrayView<N, T, S> s, FUNCTOR const & f);
+
+        // parallel versions, see <vigra/multi_pointoperators_parallel.hxx>
+        template <unsigned int N, class T, class S, class VALUETYPE>
+        void
+        initMultiArray(MultiArrayView<N, T, S> s, VALUETYPE const & v,
+                       ParallelOptions const & options);
+
+        template <unsigned int N, class T, class S, class FUNCTOR>
+        void
+        initMultiArray(MultiArrayView<N, T, S> s, FUNCTOR const & f,
+                       ParallelOptions const & options);
     }
     \endcode
 
@@ -460,6 +481,14 @@ copyMultiArrayImpl(SrcIterator s, SrcShape const & sshape, SrcAccessor src,
         void
         copyMultiArray(MultiArrayView<N, T1, S1> const & source,
                        MultiArrayView<N, T2, S2> dest);
+
+        // parallel version, see <vigra/multi_pointoperators_parallel.hxx>
+        template <unsigned int N, class T1, class S1,
+                  class T2, class S2>
+        void
+        copyMultiArray(MultiArrayView<N, T1, S1> const & source,
+                       MultiArrayView<N, T2, S2> dest,
+                       ParallelOptions const & options);
     }
     \endcode
 
@@ -806,6 +835,15 @@ transformMultiArrayImpl(SrcIterator s, SrcShape const & sshape, SrcAccessor src,
         void
         transformMultiArray(MultiArrayView<N, T1, S1> const & source,
                             MultiArrayView<N, T2, S2> dest, Functor const & f);
+
+        // parallel version, see <vigra/multi_pointoperators_parallel.hxx>
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2,
+                  class Functor>
+        void
+        transformMultiArray(MultiArrayView<N, T1, S1> const & source,
+                            MultiArrayView<N, T2, S2> dest, Functor const & f,
+                            ParallelOptions const & options);
     }
     \endcode
 
@@ -1259,6 +1297,17 @@ combineTwoMultiArraysImpl(
                               MultiArrayView<N, T12, S12> const & source2,
                               MultiArrayView<N, T2, S2> dest,
                               Functor const & f);
+
+        // parallel version, see <vigra/multi_pointoperators_parallel.hxx>
+        template <unsigned int N, class T11, class S11,
+                                  class T12, class S12,
+                                  class T2, class S2,
+                  class Functor>
+        void
+        combineTwoMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                              MultiArrayView<N, T12, S12> const & source2,
+                              MultiArrayView<N, T2, S2> dest,
+                              Functor const & f, ParallelOptions const & options);
     }
     \endcode
 
@@ -1605,6 +1654,19 @@ combineThreeMultiArraysImpl(SrcIterator1 s1, SrcShape const & shape, SrcAccessor
                                 MultiArrayView<N, T13, S13> const & source3,
                                 MultiArrayView<N, T2, S2> dest,
                                 Functor const & f);
+
+        // parallel version, see <vigra/multi_pointoperators_parallel.hxx>
+        template <unsigned int N, class T11, class S11,
+                                  class T12, class S12,
+                                  class T13, class S13,
+                                  class T2, class S2,
+                  class Functor>
+        void
+        combineThreeMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                                MultiArrayView<N, T12, S12> const & source2,
+                                MultiArrayView<N, T13, S13> const & source3,
+                                MultiArrayView<N, T2, S2> dest,
+                                Functor const & f, ParallelOptions const & options);
     }
     \endcode
 
@@ -1780,6 +1842,14 @@ inspectMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,  Functor & f,
         void
         inspectMultiArray(MultiArrayView<N, T, S> const & s,
                           Functor & f);
+
+        // parallel version, see <vigra/multi_pointoperators_parallel.hxx>;
+        // the functor must support reset() and merging
+        template <unsigned int N, class T, class S,
+                  class Functor>
+        void
+        inspectMultiArray(MultiArrayView<N, T, S> const & s,
+                          Functor & f, ParallelOptions const & options);
     }
     \endcode
 
@@ -1820,6 +1890,16 @@ inspectMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,  Functor & f,
     \endcode
     The functor must support function call with one argument.
 
+    The parallel version inspects parts of the array with separate copies of the functor
+    and merges these copies into \a f at the end. The functor must therefore also provide
+    <tt>reset()</tt> and a merge operator <tt>f(Functor const &)</tt>, as do \ref vigra::FindMinMax,
+    \ref vigra::FindSum, \ref vigra::FindAverage, \ref vigra::FindAverageAndVariance, and
+    \ref vigra::FindROISize. Functors requiring multiple passes are applied serially.
+    \code
+    FindAverage<int> average;
+    inspectMultiArray(array, average, ParallelOptions().numThreads(4));
+    \endcode
+
     \deprecatedUsage{inspectMultiArray}
     \code
     typedef vigra::MultiArray<3, int> Array;
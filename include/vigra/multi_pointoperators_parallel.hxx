@@ -0,0 +1,291 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_MULTI_POINTOPERATORS_PARALLEL_HXX
+#define VIGRA_MULTI_POINTOPERATORS_PARALLEL_HXX
+
+#include <algorithm>
+#include <vector>
+#include "multi_array.hxx"
+#include "multi_pointoperators.hxx"
+#include "threadpool.hxx"
+
+namespace vigra
+{
+
+namespace detail {
+
+    // Arrays smaller than twice this number of elements are processed serially.
+enum { PointoperatorMinimumTaskSize = 1 << 15 };
+
+    // Find the outermost non-singleton axis of 'shape', along which the
+    // point operators split their work. Returns -1 when the work should
+    // not be split (too small array or serial execution requested).
+template <class Shape>
+int
+pointoperatorSplitAxis(Shape const & shape, ParallelOptions const & options)
+{
+    if(options.getActualNumThreads() <= 1 ||
+       prod(shape) < 2*(MultiArrayIndex)PointoperatorMinimumTaskSize)
+        return -1;
+    for(int k=(int)shape.size()-1; k>=0; --k)
+        if(shape[k] > 1)
+            return k;
+    return -1;
+}
+
+    // Number of slices per task when 'shape' is split along 'axis'.
+template <class Shape>
+MultiArrayIndex
+pointoperatorTaskSize(Shape const & shape, int axis, ParallelOptions const & options)
+{
+    MultiArrayIndex inner = prod(shape) / shape[axis];
+    return std::max<MultiArrayIndex>(
+               std::max<MultiArrayIndex>(1, PointoperatorMinimumTaskSize / inner),
+               shape[axis] / (4*options.getActualNumThreads()));
+}
+
+    // Call f(task, begin, end) in parallel for consecutive ranges
+    // [begin, end) of 'size' slices.
+template <class Function>
+void
+pointoperatorParallelSplit(MultiArrayIndex size, MultiArrayIndex taskSize,
+                           ParallelOptions const & options, Function f)
+{
+    MultiArrayIndex tasks = (size + taskSize - 1) / taskSize;
+    parallel_foreach(options.getNumThreads(), tasks,
+        [&](int /* threadId */, MultiArrayIndex task)
+        {
+            f(task, task*taskSize, std::min(size, (task+1)*taskSize));
+        });
+}
+
+    // The part [begin, end) of 'a' along 'axis', or the entire array
+    // when 'a' is a singleton along 'axis' (expand mode).
+template <unsigned int N, class T, class S>
+MultiArrayView<N, T, S>
+pointoperatorSlab(MultiArrayView<N, T, S> const & a, int axis,
+                  MultiArrayIndex begin, MultiArrayIndex end)
+{
+    if(a.shape(axis) == 1)
+        return a;
+    typename MultiArrayShape<N>::type start, stop(a.shape());
+    start[axis] = begin;
+    stop[axis] = end;
+    return a.subarray(start, stop);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T, class S, class VALUETYPE>
+void
+initMultiArray(MultiArrayView<N, T, S> s, VALUETYPE const & v,
+               ParallelOptions const & options)
+{
+    int axis = detail::pointoperatorSplitAxis(s.shape(), options);
+    if(axis < 0)
+    {
+        initMultiArray(s, v);
+        return;
+    }
+    detail::pointoperatorParallelSplit(s.shape(axis),
+        detail::pointoperatorTaskSize(s.shape(), axis, options), options,
+        [&](MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            initMultiArray(detail::pointoperatorSlab(s, axis, begin, end), v);
+        });
+}
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+void
+copyMultiArray(MultiArrayView<N, T1, S1> const & source,
+               MultiArrayView<N, T2, S2> dest,
+               ParallelOptions const & options)
+{
+    for(unsigned k=0; k<N; ++k)
+        vigra_precondition(source.shape(k) == dest.shape(k) || source.shape(k) == 1 || 1 == dest.shape(k),
+            "copyMultiArray(): shape mismatch between input and output.");
+    int axis = detail::pointoperatorSplitAxis(dest.shape(), options);
+    if(axis < 0)
+    {
+        copyMultiArray(source, dest);
+        return;
+    }
+    detail::pointoperatorParallelSplit(dest.shape(axis),
+        detail::pointoperatorTaskSize(dest.shape(), axis, options), options,
+        [&](MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            copyMultiArray(detail::pointoperatorSlab(source, axis, begin, end),
+                           detail::pointoperatorSlab(dest, axis, begin, end));
+        });
+}
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2,
+          class Functor>
+void
+transformMultiArray(MultiArrayView<N, T1, S1> const & source,
+                    MultiArrayView<N, T2, S2> dest, Functor const & f,
+                    ParallelOptions const & options)
+{
+    for(unsigned int k=0; k<N; ++k)
+        vigra_precondition(source.shape(k) == dest.shape(k) || source.shape(k) == 1 || 1 == dest.shape(k),
+            "transformMultiArray(): shape mismatch between input and output.");
+    int axis = detail::pointoperatorSplitAxis(dest.shape(), options);
+    if(axis < 0)
+    {
+        transformMultiArray(source, dest, f);
+        return;
+    }
+    detail::pointoperatorParallelSplit(dest.shape(axis),
+        detail::pointoperatorTaskSize(source.shape(), axis, options), options,
+        [&](MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            transformMultiArray(detail::pointoperatorSlab(source, axis, begin, end),
+                                detail::pointoperatorSlab(dest, axis, begin, end), f);
+        });
+}
+
+template <unsigned int N, class T11, class S11,
+                          class T12, class S12,
+                          class T2, class S2,
+          class Functor>
+void
+combineTwoMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                      MultiArrayView<N, T12, S12> const & source2,
+                      MultiArrayView<N, T2, S2> dest,
+                      Functor const & f, ParallelOptions const & options)
+{
+    for(unsigned int k=0; k<N; ++k)
+        vigra_precondition((source1.shape(k) == source2.shape(k) || source1.shape(k) == 1 || 1 == source2.shape(k)) &&
+                           (source1.shape(k) == dest.shape(k) || source1.shape(k) == 1 || 1 == dest.shape(k)),
+            "combineTwoMultiArrays(): shape mismatch between inputs and/or output.");
+    int axis = detail::pointoperatorSplitAxis(dest.shape(), options);
+    if(axis < 0)
+    {
+        combineTwoMultiArrays(source1, source2, dest, f);
+        return;
+    }
+    typename MultiArrayShape<N>::type shape(max(source1.shape(), source2.shape()));
+    detail::pointoperatorParallelSplit(dest.shape(axis),
+        detail::pointoperatorTaskSize(shape, axis, options), options,
+        [&](MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            combineTwoMultiArrays(detail::pointoperatorSlab(source1, axis, begin, end),
+                                  detail::pointoperatorSlab(source2, axis, begin, end),
+                                  detail::pointoperatorSlab(dest, axis, begin, end), f);
+        });
+}
+
+template <unsigned int N, class T11, class S11,
+                          class T12, class S12,
+                          class T13, class S13,
+                          class T2, class S2,
+          class Functor>
+void
+combineThreeMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                        MultiArrayView<N, T12, S12> const & source2,
+                        MultiArrayView<N, T13, S13> const & source3,
+                        MultiArrayView<N, T2, S2> dest,
+                        Functor const & f, ParallelOptions const & options)
+{
+    vigra_precondition(source1.shape() == source2.shape() && source1.shape() == source3.shape() && source1.shape() == dest.shape(),
+        "combineThreeMultiArrays(): shape mismatch between inputs and/or output.");
+    int axis = detail::pointoperatorSplitAxis(dest.shape(), options);
+    if(axis < 0)
+    {
+        combineThreeMultiArrays(source1, source2, source3, dest, f);
+        return;
+    }
+    detail::pointoperatorParallelSplit(dest.shape(axis),
+        detail::pointoperatorTaskSize(dest.shape(), axis, options), options,
+        [&](MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            combineThreeMultiArrays(detail::pointoperatorSlab(source1, axis, begin, end),
+                                    detail::pointoperatorSlab(source2, axis, begin, end),
+                                    detail::pointoperatorSlab(source3, axis, begin, end),
+                                    detail::pointoperatorSlab(dest, axis, begin, end), f);
+        });
+}
+
+template <unsigned int N, class T, class S, class Functor>
+inline void
+inspectMultiArrayParallelImpl(MultiArrayView<N, T, S> const & s, Functor & f,
+                              ParallelOptions const &, VigraTrueType)
+{
+    // functors with extra passes are applied serially
+    inspectMultiArray(s, f);
+}
+
+template <unsigned int N, class T, class S, class Functor>
+void
+inspectMultiArrayParallelImpl(MultiArrayView<N, T, S> const & s, Functor & f,
+                              ParallelOptions const & options, VigraFalseType)
+{
+    int axis = detail::pointoperatorSplitAxis(s.shape(), options);
+    if(axis < 0)
+    {
+        inspectMultiArray(s, f);
+        return;
+    }
+    MultiArrayIndex taskSize = detail::pointoperatorTaskSize(s.shape(), axis, options);
+    Functor empty(f);
+    empty.reset();
+    // one functor per task, so that the merged result doesn't depend on the scheduling
+    std::vector<Functor> partial((s.shape(axis) + taskSize - 1) / taskSize, empty);
+    detail::pointoperatorParallelSplit(s.shape(axis), taskSize, options,
+        [&](MultiArrayIndex task, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            inspectMultiArray(detail::pointoperatorSlab(s, axis, begin, end), partial[task]);
+        });
+    for(unsigned int k=0; k<partial.size(); ++k)
+        f(partial[k]);
+}
+
+template <unsigned int N, class T, class S, class Functor>
+inline void
+inspectMultiArray(MultiArrayView<N, T, S> const & s, Functor & f,
+                  ParallelOptions const & options)
+{
+    typedef typename IfBool<detail::get_extra_passes<Functor>::value,
+                            VigraTrueType, VigraFalseType>::type hasExtraPasses;
+    inspectMultiArrayParallelImpl(s, f, options, hasExtraPasses());
+}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_POINTOPERATORS_PARALLEL_HXX
@@ -0,0 +1,382 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+
+#ifndef VIGRA_MULTI_PYRAMID_HXX
+#define VIGRA_MULTI_PYRAMID_HXX
+
+#include <algorithm>
+#include <vector>
+#include "multi_array.hxx"
+#include "multi_array_chunked.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "scratch_arena.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+/** \addtogroup ParallelProcessing
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                  pyramidLevelShape                   */
+/*                                                      */
+/********************************************************/
+
+/** \brief Shape of a level of a Gaussian pyramid.
+
+    <b>\#include</b> \<vigra/multi_pyramid.hxx\><br/>
+    Namespace: vigra
+
+    Returns the shape of pyramid level <tt>level</tt> when level 0 has shape
+    <tt>shape</tt>, i.e. each level has shape <tt>ceil(previous_shape / 2)</tt>
+    as required by \ref pyramidReduceBurtFilter() and \ref gaussianPyramidMultiArray().
+*/
+template <int N>
+TinyVector<MultiArrayIndex, N>
+pyramidLevelShape(TinyVector<MultiArrayIndex, N> shape, int level)
+{
+    for(int k=0; k<level; ++k)
+        for(int d=0; d<N; ++d)
+            shape[d] = (shape[d] + 1) / 2;
+    return shape;
+}
+
+namespace detail {
+
+    // mirror index m into [0, size) (periodically, so that tiny levels work as well)
+inline MultiArrayIndex
+burtReflect(MultiArrayIndex m, MultiArrayIndex size)
+{
+    if(size == 1)
+        return 0;
+    MultiArrayIndex period = 2*size - 2;
+    m = std::abs(m) % period;
+    return m < size
+               ? m
+               : period - m;
+}
+
+    // Two-fold reduction with the 5-tap Burt kernel along dimension d.
+    // 'src' holds the coordinates [srcBegin, srcBegin + src.shape(d)) of a level
+    // with length 'srcSize' along d, 'dest' receives the coordinates
+    // [destBegin, destBegin + dest.shape(d)) of the next level.
+template <unsigned int N, class T>
+void
+burtReduceDimension(MultiArrayView<N, T> const & src, MultiArrayView<N, T> dest,
+                    unsigned int d, MultiArrayIndex srcBegin, MultiArrayIndex destBegin,
+                    MultiArrayIndex srcSize, double const * kernel)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayIndex dsize = dest.shape(d),
+                    sstride = src.stride(d),
+                    dstride = dest.stride(d);
+    ArrayVector<MultiArrayIndex> index(5*dsize);
+    for(MultiArrayIndex j=0; j<dsize; ++j)
+    {
+        for(int t=0; t<5; ++t)
+        {
+            MultiArrayIndex m = burtReflect(2*(j + destBegin) + t - 2, srcSize) - srcBegin;
+            vigra_invariant(m >= 0 && m < src.shape(d),
+                "gaussianPyramidMultiArray(): internal error: block border too small.");
+            index[5*j+t] = m*sstride;
+        }
+    }
+
+    Shape lineShape(dest.shape());
+    lineShape[d] = 1;
+    MultiCoordinateIterator<N> i(lineShape), end = i.getEndIterator();
+    for(; i != end; ++i)
+    {
+        T const * s = &src[*i];
+        T * t = &dest[*i];
+        MultiArrayIndex const * m = index.begin();
+        for(MultiArrayIndex j=0; j<dsize; ++j, t += dstride, m += 5)
+            *t = T(kernel[0]*s[m[0]] + kernel[1]*s[m[1]] + kernel[2]*s[m[2]] +
+                   kernel[3]*s[m[3]] + kernel[4]*s[m[4]]);
+    }
+}
+
+template <unsigned int N, class T1, class S1>
+struct PyramidArrayReader
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayView<N, T1, S1> in;
+
+    PyramidArrayReader(MultiArrayView<N, T1, S1> const & a)
+    : in(a)
+    {}
+
+    Shape const & shape() const
+    {
+        return in.shape();
+    }
+
+    template <class U>
+    void operator()(Shape const & start, MultiArrayView<N, U> & block) const
+    {
+        block = in.subarray(start, start + block.shape());
+    }
+};
+
+template <unsigned int N, class T1>
+struct PyramidChunkedReader
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    ChunkedArray<N, T1> const & in;
+
+    PyramidChunkedReader(ChunkedArray<N, T1> const & a)
+    : in(a)
+    {}
+
+    Shape const & shape() const
+    {
+        return in.shape();
+    }
+
+    template <class U>
+    void operator()(Shape const & start, MultiArrayView<N, U> & block) const
+    {
+        MultiArray<N, T1, ScratchAllocator<T1> > tmp(block.shape());
+        in.checkoutSubarray(start, tmp);
+        block = tmp;
+    }
+};
+
+    // Computes one level from the previous one: the destination level is divided
+    // into blocks, and for each block the region of the previous level that influences
+    // it (i.e. the block plus a border of two pixels) is read, reduced along
+    // one dimension after the other, and committed to the destination.
+template <unsigned int N, class Reader, class T2>
+void
+gaussianPyramidReduceLevel(Reader const & reader,
+                           ChunkedArray<N, T2> & dest,
+                           double const * kernel,
+                           BlockwiseOptions const & options,
+                           VIGRA_SHARED_PTR<ScratchArenaPool> arenas)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename NumericTraits<T2>::RealPromote TmpType;
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+
+    const Shape srcShape = reader.shape(),
+                destShape = dest.shape();
+    Blocking blocking(destShape, blockwise::chunkAlignedBlockShape(dest, options));
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](int threadId, Block const & block)
+        {
+            ScratchArena & arena = (*arenas)[threadId];
+            {
+                ScratchArena::Scope scope(arena);
+
+                const Shape regionBegin = max(block.begin()*2 - Shape(2), Shape(0)),
+                            regionEnd   = min(block.end()*2 + Shape(1), srcShape);
+                MultiArray<N, TmpType, ScratchAllocator<TmpType> > current(regionEnd - regionBegin);
+                reader(regionBegin, current);
+
+                // reduce one dimension after the other
+                Shape shape(current.shape());
+                for(unsigned int d=0; d<N; ++d)
+                {
+                    shape[d] = block.size()[d];
+                    MultiArray<N, TmpType, ScratchAllocator<TmpType> > next(shape);
+                    burtReduceDimension(current, next, d, regionBegin[d], block.begin()[d],
+                                        srcShape[d], kernel);
+                    current.swap(next);
+                }
+
+                MultiArray<N, T2, ScratchAllocator<T2> > result(current.shape());
+                typename MultiArrayView<N, T2>::iterator r = result.begin();
+                for(typename MultiArrayView<N, TmpType>::iterator c = current.begin(); c != current.end(); ++c, ++r)
+                    *r = detail::RequiresExplicitCast<T2>::cast(*c);
+                dest.commitSubarray(block.begin(), result);
+            }
+            arena.reset();
+        },
+        blocking.numBlocks()
+    );
+}
+
+    // Level k+1 is computed from level k, which is read back from its
+    // destination array, so that the border per block remains constant.
+template <unsigned int N, class Reader, class T2>
+void
+gaussianPyramidImpl(Reader const & reader,
+                    std::vector<ChunkedArray<N, T2> *> const & levels,
+                    double centerValue,
+                    BlockwiseOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(0.25 <= centerValue && centerValue <= 0.5,
+        "gaussianPyramidMultiArray(): centerValue must be between 0.25 and 0.5.");
+
+    int top = (int)levels.size();
+    if(top == 0)
+        return;
+
+    Shape shape = reader.shape();
+    for(int k=0; k<top; ++k)
+    {
+        shape = pyramidLevelShape(shape, 1);
+        vigra_precondition(levels[k] != 0 && levels[k]->shape() == shape,
+            "gaussianPyramidMultiArray(): level shapes must be ceil(previous_shape / 2).");
+        vigra_precondition(!levels[k]->isReadOnly(),
+            "gaussianPyramidMultiArray(): destination level is read-only.");
+    }
+
+    double kernel[5] = { 0.25 - centerValue / 2.0, 0.25, centerValue,
+                         0.25, 0.25 - centerValue / 2.0 };
+
+    VIGRA_SHARED_PTR<ScratchArenaPool> arenas = blockwise::scratchArenas(options);
+    gaussianPyramidReduceLevel(reader, *levels[0], kernel, options, arenas);
+    for(int k=1; k<top; ++k)
+        gaussianPyramidReduceLevel(PyramidChunkedReader<N, T2>(*levels[k-1]), *levels[k],
+                                   kernel, options, arenas);
+}
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*               gaussianPyramidMultiArray              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Compute the levels of an N-dimensional Gaussian pyramid blockwise and in parallel.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2>
+        void
+        gaussianPyramidMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                  std::vector<ChunkedArray<N, T2> *> const & levels,
+                                  double centerValue = 0.4,
+                                  BlockwiseOptions const & options = BlockwiseOptions());
+
+        template <unsigned int N, class T1, class T2>
+        void
+        gaussianPyramidMultiArray(ChunkedArray<N, T1> const & source,
+                                  std::vector<ChunkedArray<N, T2> *> const & levels,
+                                  double centerValue = 0.4,
+                                  BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    This is the N-dimensional counterpart of repeated calls to
+    \ref pyramidReduceBurtFilter(): <tt>levels[k]</tt> receives pyramid level
+    <tt>k+1</tt> (the source itself is level 0), computed by smoothing the previous
+    level with the separable Burt filter
+    \code
+    [0.25 - centerValue / 2.0, 0.25, centerValue, 0.25, 0.25 - centerValue / 2.0]
+    \endcode
+    and taking every second sample, with reflective border treatment.
+    Every level must have shape <tt>ceil(previous_shape / 2)</tt>, see
+    \ref pyramidLevelShape().
+
+    The levels are computed one after the other: each level is divided into
+    blocks, and for each block the corresponding region of the previous level (plus a
+    border of two pixels required by the filter) is read, reduced, and committed to the
+    destination level. Level <tt>k+1</tt> is read back from <tt>levels[k]</tt>, so that
+    neither the source nor any level has to be held in memory completely, and each level
+    can be stored in its own \ref ChunkedArray, e.g. a \ref ChunkedArrayHDF5 dataset.
+    Blocks are processed in parallel according to <tt>options.numThreads()</tt>.
+    <tt>options.blockShape()</tt> refers to the destination levels and is rounded up to
+    multiples of each level's chunk shape.
+
+    Since every level is computed from the stored previous level, the results agree
+    with repeated calls of \ref pyramidReduceBurtFilter() up to rounding errors.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_pyramid.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    HDF5File file("pyramid.h5", HDF5File::Open);
+    ChunkedArrayHDF5<3, float> source(file, "level0");
+
+    std::vector<ChunkedArrayHDF5<3, float> *> datasets;
+    std::vector<ChunkedArray<3, float> *> levels;
+    for(int k=1; k<=5; ++k)
+    {
+        datasets.push_back(new ChunkedArrayHDF5<3, float>(file, "level" + asString(k), HDF5File::New,
+                                                          pyramidLevelShape(source.shape(), k)));
+        levels.push_back(datasets.back());
+    }
+
+    gaussianPyramidMultiArray(source, levels, 0.4, BlockwiseOptions().numThreads(8));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void gaussianPyramidMultiArray)
+
+template <unsigned int N, class T1, class S1, class T2>
+void
+gaussianPyramidMultiArray(MultiArrayView<N, T1, S1> const & source,
+                          std::vector<ChunkedArray<N, T2> *> const & levels,
+                          double centerValue = 0.4,
+                          BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::gaussianPyramidImpl(detail::PyramidArrayReader<N, T1, S1>(source),
+                                levels, centerValue, options);
+}
+
+template <unsigned int N, class T1, class T2>
+void
+gaussianPyramidMultiArray(ChunkedArray<N, T1> const & source,
+                          std::vector<ChunkedArray<N, T2> *> const & levels,
+                          double centerValue = 0.4,
+                          BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::gaussianPyramidImpl(detail::PyramidChunkedReader<N, T1>(source),
+                                levels, centerValue, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_PYRAMID_HXX
@@ -0,0 +1,410 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+
+#ifndef VIGRA_MULTI_SPLINEVIEW_HXX
+#define VIGRA_MULTI_SPLINEVIEW_HXX
+
+#include <algorithm>
+#include "multi_array.hxx"
+#include "multi_resize.hxx"
+#include "splines.hxx"
+#include "splineimageview.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // Contraction of the spline coefficients with the separable weights of one point,
+    // starting with the outermost dimension D. offsets[d*KSIZE + k] are the memory
+    // offsets of tap k in dimension d, w[d][k*stride] the corresponding weights.
+template <int D, int KSIZE>
+struct SplineMultiArrayContraction
+{
+    template <class V, class T>
+    static V exec(T const * data, MultiArrayIndex const * offsets,
+                  double const * const * w, int stride)
+    {
+        V sum = V(w[D][0]*SplineMultiArrayContraction<D-1, KSIZE>::template exec<V>(data + offsets[D*KSIZE], offsets, w, stride));
+        for(int k=1; k<KSIZE; ++k)
+            sum += V(w[D][k*stride]*SplineMultiArrayContraction<D-1, KSIZE>::template exec<V>(data + offsets[D*KSIZE+k], offsets, w, stride));
+        return sum;
+    }
+};
+
+template <int KSIZE>
+struct SplineMultiArrayContraction<0, KSIZE>
+{
+    template <class V, class T>
+    static V exec(T const * data, MultiArrayIndex const * offsets,
+                  double const * const * w, int stride)
+    {
+        V sum = V(w[0][0]*data[offsets[0]]);
+        for(int k=1; k<KSIZE; ++k)
+            sum += V(w[0][k*stride]*data[offsets[k]]);
+        return sum;
+    }
+};
+
+} // namespace detail
+
+/** \addtogroup GeometricTransformations
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                  SplineMultiArrayView                */
+/*                                                      */
+/********************************************************/
+
+/** \brief Create a continuous view onto an N-dimensional array using splines.
+
+    <b>\#include</b> \<vigra/multi_splineview.hxx\><br>
+    Namespace: vigra
+
+    This is the N-dimensional counterpart of \ref SplineImageView: the constructor
+    computes the coefficients of a B-spline of order <tt>ORDER</tt> that interpolates
+    the given array (using reflective boundary conditions), and the spline and its
+    partial derivatives can then be evaluated at arbitrary real-valued coordinates
+    within the first reflection of the array. For <tt>N = 2</tt>, the results agree
+    with \ref SplineImageView up to rounding errors.
+
+    The view doesn't use an internal cache, so that the same view can be evaluated
+    by several threads concurrently. For good performance, use the batched
+    <tt>evaluate()</tt> functions to compute many points at once.
+
+    <b> Usage:</b>
+
+    \code
+    MultiArray<3, float> volume(Shape3(200, 200, 100));
+    ...
+    SplineMultiArrayView<3, 3, float> spline(volume);
+
+    // value and gradient at a single point
+    float v = spline(TinyVector<double, 3>(10.3, 20.8, 5.5));
+    float dz = spline(TinyVector<double, 3>(10.3, 20.8, 5.5), TinyVector<unsigned int, 3>(0, 0, 1));
+
+    // batched evaluation at many points
+    MultiArray<1, TinyVector<double, 3> > points(Shape1(10000));
+    MultiArray<1, float> values(points.shape());
+    MultiArray<1, TinyVector<float, 3> > gradients(points.shape());
+    ...
+    spline.evaluate(points, values, gradients);
+    \endcode
+*/
+template <unsigned int N, int ORDER, class VALUETYPE>
+class SplineMultiArrayView
+{
+    typedef typename NumericTraits<VALUETYPE>::RealPromote InternalValue;
+
+  public:
+
+        /** The view's value type (return type of access and derivative functions).
+        */
+    typedef VALUETYPE value_type;
+
+        /** The type of real-valued coordinates.
+        */
+    typedef TinyVector<double, N> difference_type;
+
+        /** The type of the array shape.
+        */
+    typedef typename MultiArrayShape<N>::type shape_type;
+
+        /** The type specifying the order of the partial derivatives.
+        */
+    typedef TinyVector<unsigned int, N> derivative_type;
+
+        /** The order of the spline used.
+        */
+    enum StaticOrder { order = ORDER };
+
+        /** The type of the internal array holding the spline coefficients.
+        */
+    typedef MultiArray<N, InternalValue> InternalArray;
+
+        /** Construct SplineMultiArrayView for an N-dimensional array.
+
+            If <tt>skipPrefiltering = true</tt> (default: <tt>false</tt>), the recursive
+            prefilter of the cardinal spline function is not applied, resulting
+            in an approximating (smoothing) rather than interpolating spline.
+        */
+    template <class U, class S>
+    explicit SplineMultiArrayView(MultiArrayView<N, U, S> const & s, bool skipPrefiltering = false)
+    : coefficients_(s)
+    {
+        if(!skipPrefiltering)
+            init();
+    }
+
+        /** Access interpolated function at real-valued coordinate <tt>p</tt>.
+            An exception is thrown if the coordinate is outside the first reflection.
+        */
+    value_type operator()(difference_type const & p) const
+    {
+        return operator()(p, derivative_type());
+    }
+
+        /** Access partial derivative of order <tt>d</tt> at real-valued coordinate <tt>p</tt>.
+            An exception is thrown if the coordinate is outside the first reflection.
+        */
+    value_type operator()(difference_type const & p, derivative_type const & d) const
+    {
+        difference_type point(p);
+        value_type res;
+        evaluate(MultiArrayView<1, difference_type>(Shape1(1), &point),
+                 MultiArrayView<1, value_type>(Shape1(1), &res), d);
+        return res;
+    }
+
+        /** Evaluate the partial derivative of order <tt>d</tt> (default: the function
+            value) at many points at once: <tt>values(i)</tt> receives the result for
+            <tt>points(i)</tt>. The weights are computed for blocks of points in loops
+            that the compiler can vectorize. Points should preferably be ordered by
+            location for good cache locality.
+        */
+    template <class S1, class T2, class S2>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  derivative_type const & d = derivative_type()) const;
+
+        /** Evaluate the function and its gradient at many points at once.
+        */
+    template <class S1, class T2, class S2, class T3, class S3>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  MultiArrayView<1, TinyVector<T3, N>, S3> gradients) const;
+
+        /** The shape of the underlying array.
+        */
+    shape_type const & shape() const
+    {
+        return coefficients_.shape();
+    }
+
+        /** The length of the underlying array along dimension <tt>d</tt>.
+        */
+    MultiArrayIndex shape(int d) const
+    {
+        return coefficients_.shape(d);
+    }
+
+        /** The internal array holding the spline coefficients.
+        */
+    InternalArray const & coefficients() const
+    {
+        return coefficients_;
+    }
+
+        /** Check if <tt>p</tt> is in the original array range, i.e.
+            <tt>0 <= p[d] <= shape(d)-1</tt> for all <tt>d</tt>.
+        */
+    bool isInside(difference_type const & p) const
+    {
+        for(unsigned int d=0; d<N; ++d)
+            if(p[d] < 0.0 || p[d] > shape(d) - 1.0)
+                return false;
+        return true;
+    }
+
+        /** Check if <tt>p</tt> is in the valid range. Points outside the original
+            array range are computed by reflective boundary conditions, but only within
+            the first reflection (cf. \ref SplineImageView::isValid()).
+        */
+    bool isValid(difference_type const & p) const
+    {
+        for(unsigned int d=0; d<N; ++d)
+        {
+            double w1 = shape(d) - 1.0,
+                   x1 = shape(d) - kcenter_ - 2.0;
+            if(!(p[d] < w1 + x1 && p[d] > -x1))
+                return false;
+        }
+        return true;
+    }
+
+  protected:
+
+    enum { ksize_ = ORDER + 1, kcenter_ = ORDER / 2, batchSize_ = 64 };
+
+    void init();
+
+    template <class S>
+    void batchIndices(MultiArrayView<1, difference_type, S> const & points,
+                      MultiArrayIndex start, int n,
+                      MultiArrayIndex * offsets, double * u) const;
+
+    InternalArray coefficients_;
+};
+
+template <unsigned int N, int ORDER, class VALUETYPE>
+void
+SplineMultiArrayView<N, ORDER, VALUETYPE>::init()
+{
+    ArrayVector<double> const & b = BSpline<ORDER, double>().prefilterCoefficients();
+    if(b.size() == 0)
+        return;
+
+    for(unsigned int d=0; d<N; ++d)
+    {
+        int size = (int)shape(d);
+        if(size < 2)
+            continue;
+
+        shape_type lineShape(shape());
+        lineShape[d] = 1;
+        MultiArrayIndex stride = coefficients_.stride(d);
+        ArrayVector<InternalValue> line(size), causal(size);
+        MultiCoordinateIterator<N> i(lineShape), end = i.getEndIterator();
+        for(; i != end; ++i)
+        {
+            InternalValue * p = &coefficients_[*i];
+            for(int k=0; k<size; ++k)
+                line[k] = p[k*stride];
+            for(unsigned int j=0; j<b.size(); ++j)
+                detail::splinePrefilterLine(line.begin(), causal.begin(), size, b[j]);
+            for(int k=0; k<size; ++k)
+                p[k*stride] = line[k];
+        }
+    }
+}
+
+template <unsigned int N, int ORDER, class VALUETYPE>
+template <class S>
+void
+SplineMultiArrayView<N, ORDER, VALUETYPE>::batchIndices(MultiArrayView<1, difference_type, S> const & points,
+                                                        MultiArrayIndex start, int n,
+                                                        MultiArrayIndex * offsets, double * u) const
+{
+    int index[ksize_];
+    for(int p=0; p<n; ++p)
+    {
+        difference_type const & point = points(start+p);
+        vigra_precondition(isValid(point),
+            "SplineMultiArrayView::evaluate(): coordinates out of range.");
+        for(unsigned int d=0; d<N; ++d)
+        {
+            int center = detail::splineFacetCenter<ORDER>(point[d]);
+            u[d*batchSize_ + p] = point[d] - center;
+            detail::splineTapIndices<ORDER>(center, (int)shape(d) - 1, index);
+            for(int k=0; k<ksize_; ++k)
+                offsets[(p*N + d)*ksize_ + k] = index[k]*coefficients_.stride(d);
+        }
+    }
+}
+
+template <unsigned int N, int ORDER, class VALUETYPE>
+template <class S1, class T2, class S2>
+void
+SplineMultiArrayView<N, ORDER, VALUETYPE>::evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                                                    MultiArrayView<1, T2, S2> values,
+                                                    derivative_type const & d) const
+{
+    vigra_precondition(points.shape(0) == values.shape(0),
+        "SplineMultiArrayView::evaluate(): shape mismatch between points and values.");
+
+    MultiArrayIndex offsets[batchSize_*N*ksize_];
+    double u[N*batchSize_], w[N*ksize_*batchSize_];
+    double const * wp[N];
+
+    for(MultiArrayIndex start = 0; start < points.shape(0); start += batchSize_)
+    {
+        int n = (int)std::min<MultiArrayIndex>(batchSize_, points.shape(0) - start);
+        batchIndices(points, start, n, offsets, u);
+        for(unsigned int k=0; k<N; ++k)
+            detail::splineFacetWeights<ORDER>(u + k*batchSize_, n, d[k], w + k*ksize_*batchSize_, batchSize_);
+
+        for(int p=0; p<n; ++p)
+        {
+            for(unsigned int k=0; k<N; ++k)
+                wp[k] = w + k*ksize_*batchSize_ + p;
+            values(start+p) = detail::RequiresExplicitCast<VALUETYPE>::cast(
+                detail::SplineMultiArrayContraction<N-1, ksize_>::template exec<InternalValue>(
+                                         coefficients_.data(), offsets + p*N*ksize_, wp, batchSize_));
+        }
+    }
+}
+
+template <unsigned int N, int ORDER, class VALUETYPE>
+template <class S1, class T2, class S2, class T3, class S3>
+void
+SplineMultiArrayView<N, ORDER, VALUETYPE>::evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                                                    MultiArrayView<1, T2, S2> values,
+                                                    MultiArrayView<1, TinyVector<T3, N>, S3> gradients) const
+{
+    vigra_precondition(points.shape(0) == values.shape(0) && points.shape(0) == gradients.shape(0),
+        "SplineMultiArrayView::evaluate(): shape mismatch between points and values.");
+
+    MultiArrayIndex offsets[batchSize_*N*ksize_];
+    double u[N*batchSize_], w[N*ksize_*batchSize_], wd[N*ksize_*batchSize_];
+    double const * wp[N];
+
+    for(MultiArrayIndex start = 0; start < points.shape(0); start += batchSize_)
+    {
+        int n = (int)std::min<MultiArrayIndex>(batchSize_, points.shape(0) - start);
+        batchIndices(points, start, n, offsets, u);
+        for(unsigned int k=0; k<N; ++k)
+        {
+            detail::splineFacetWeights<ORDER>(u + k*batchSize_, n, 0, w + k*ksize_*batchSize_, batchSize_);
+            detail::splineFacetWeights<ORDER>(u + k*batchSize_, n, 1, wd + k*ksize_*batchSize_, batchSize_);
+        }
+
+        for(int p=0; p<n; ++p)
+        {
+            MultiArrayIndex const * o = offsets + p*N*ksize_;
+            for(unsigned int k=0; k<N; ++k)
+                wp[k] = w + k*ksize_*batchSize_ + p;
+            values(start+p) = detail::RequiresExplicitCast<VALUETYPE>::cast(
+                detail::SplineMultiArrayContraction<N-1, ksize_>::template exec<InternalValue>(
+                                                              coefficients_.data(), o, wp, batchSize_));
+            for(unsigned int j=0; j<N; ++j)
+            {
+                wp[j] = wd + j*ksize_*batchSize_ + p;
+                gradients(start+p)[j] = detail::RequiresExplicitCast<T3>::cast(
+                    detail::SplineMultiArrayContraction<N-1, ksize_>::template exec<InternalValue>(
+                                                              coefficients_.data(), o, wp, batchSize_));
+                wp[j] = w + j*ksize_*batchSize_ + p;
+            }
+        }
+    }
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_SPLINEVIEW_HXX
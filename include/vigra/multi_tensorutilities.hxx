@@ -42,6 +42,7 @@
 #include "metaprogramming.hxx"
 #include "multi_shape.hxx"
 #include "multi_pointoperators.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
@@ -179,6 +180,241 @@ public:
     }
 };
 
+template <int N, class T>
+struct SymmetricEigenBatch
+{
+    static void values(std::ptrdiff_t, T const * const *, T * const *)
+    {
+        vigra_fail("tensorEigenvaluesMultiArray(): Sorry, can only handle dimensions up to 3.");
+    }
+
+    static void system(std::ptrdiff_t, T const * const *, T * const *, T * const *)
+    {
+        vigra_fail("tensorEigensystemMultiArray(): Sorry, can only handle dimensions up to 3.");
+    }
+};
+
+template <class T>
+struct SymmetricEigenBatch<1, T>
+{
+    static void values(std::ptrdiff_t n, T const * const * a, T * const * r)
+    {
+        for(std::ptrdiff_t i = 0; i < n; ++i)
+            r[0][i] = a[0][i];
+    }
+
+    static void system(std::ptrdiff_t n, T const * const * a, T * const * r, T * const * e)
+    {
+        values(n, a, r);
+        for(std::ptrdiff_t i = 0; i < n; ++i)
+            e[0][i] = T(1);
+    }
+};
+
+template <class T>
+struct SymmetricEigenBatch<2, T>
+{
+    static void values(std::ptrdiff_t n, T const * const * a, T * const * r)
+    {
+        symmetric2x2EigenvaluesBatch(n, a, r);
+    }
+
+    static void system(std::ptrdiff_t n, T const * const * a, T * const * r, T * const * e)
+    {
+        symmetric2x2EigensystemBatch(n, a, r, e);
+    }
+};
+
+template <class T>
+struct SymmetricEigenBatch<3, T>
+{
+    static void values(std::ptrdiff_t n, T const * const * a, T * const * r)
+    {
+        symmetric3x3EigenvaluesBatch(n, a, r);
+    }
+
+    static void system(std::ptrdiff_t n, T const * const * a, T * const * r, T * const * e)
+    {
+        symmetric3x3EigensystemBatch(n, a, r, e);
+    }
+};
+
+    // Eigenvalues (and eigenvectors, if 'vectors' is not zero) of the tensors
+    // along one array line. Each channel is addressed by a pointer and a common
+    // stride, so that interleaved (TinyVector) and planar (Multiband) layouts are
+    // handled alike. The channels are copied into small contiguous batches
+    // for the vectorized kernels.
+template <int N, class T1, class T2>
+void
+tensorEigenLine(MultiArrayIndex length,
+                T1 const * const * src, MultiArrayIndex srcStride,
+                T2 * const * values, MultiArrayIndex valueStride,
+                T2 * const * vectors, MultiArrayIndex vectorStride)
+{
+    enum { M = N*(N+1)/2, BatchSize = 64 };
+    typedef typename NumericTraits<T2>::RealPromote Real;
+
+    Real a[M][BatchSize], r[N][BatchSize], e[N*N][BatchSize];
+    Real const * pa[M];
+    Real * pr[N], * pe[N*N];
+    for(int c=0; c<M; ++c)
+        pa[c] = a[c];
+    for(int c=0; c<N; ++c)
+        pr[c] = r[c];
+    for(int c=0; c<N*N; ++c)
+        pe[c] = e[c];
+
+    for(MultiArrayIndex start = 0; start < length; start += BatchSize)
+    {
+        MultiArrayIndex n = std::min<MultiArrayIndex>(BatchSize, length - start);
+        for(int c=0; c<M; ++c)
+        {
+            T1 const * s = src[c] + start*srcStride;
+            for(MultiArrayIndex i=0; i<n; ++i)
+                a[c][i] = static_cast<Real>(s[i*srcStride]);
+        }
+        if(vectors)
+            SymmetricEigenBatch<N, Real>::system(n, pa, pr, pe);
+        else
+            SymmetricEigenBatch<N, Real>::values(n, pa, pr);
+        for(int c=0; c<N; ++c)
+        {
+            T2 * d = values[c] + start*valueStride;
+            for(MultiArrayIndex i=0; i<n; ++i)
+                d[i*valueStride] = detail::RequiresExplicitCast<T2>::cast(r[c][i]);
+        }
+        for(int c=0; vectors && c<N*N; ++c)
+        {
+            T2 * d = vectors[c] + start*vectorStride;
+            for(MultiArrayIndex i=0; i<n; ++i)
+                d[i*vectorStride] = detail::RequiresExplicitCast<T2>::cast(e[c][i]);
+        }
+    }
+}
+
+    // Calls f(p) for the start point p of every line along dimension 0,
+    // in parallel if requested.
+template <class Shape, class F>
+void
+tensorForEachLine(Shape const & shape, F f, ParallelOptions const & options)
+{
+    static const int N = Shape::static_size;
+
+    if(prod(shape) == 0)
+        return;
+    MultiArrayIndex lines = prod(shape) / shape[0];
+    auto line = [&](MultiArrayIndex l)
+    {
+        Shape p;
+        for(int k=1; k<N; ++k)
+        {
+            p[k] = l % shape[k];
+            l /= shape[k];
+        }
+        f(p);
+    };
+    if(options.getActualNumThreads() > 1 && lines > 1)
+        parallel_foreach(options.getNumThreads(), lines,
+                         [&](int, std::ptrdiff_t l) { line(l); });
+    else
+        for(MultiArrayIndex l=0; l<lines; ++l)
+            line(l);
+}
+
+    // Interleaved layout: channels are the elements of TinyVector-like value types.
+template <unsigned int N, class T1, class S1, class T2, class S2, class T3, class S3>
+void
+tensorEigenMultiArray(MultiArrayView<N, T1, S1> const & source,
+                      MultiArrayView<N, T2, S2> values,
+                      MultiArrayView<N, T3, S3> * vectors,
+                      ParallelOptions const & options)
+{
+    static const int M = N*(N+1)/2;
+    typedef typename T1::value_type SrcType;
+    typedef typename T2::value_type DestType;
+
+    vigra_precondition(source.shape() == values.shape(),
+        "tensorEigenvaluesMultiArray(): shape mismatch between input and output.");
+    vigra_precondition(M == (int)T1::static_size,
+        "tensorEigenvaluesMultiArray(): Wrong number of channels in input array.");
+    vigra_precondition(N == (int)T2::static_size,
+        "tensorEigenvaluesMultiArray(): Wrong number of channels in output array.");
+    vigra_precondition(!vectors || (vectors->shape() == source.shape() && N*N == (int)T3::static_size),
+        "tensorEigensystemMultiArray(): eigenvector array must have the input shape and N*N channels.");
+
+    tensorForEachLine(source.shape(),
+        [&](typename MultiArrayShape<N>::type const & p)
+        {
+            SrcType const * s[M];
+            DestType * d[N], * e[N*N];
+            for(int c=0; c<M; ++c)
+                s[c] = &source[p][c];
+            for(int c=0; c<(int)N; ++c)
+                d[c] = &values[p][c];
+            for(int c=0; vectors && c<(int)(N*N); ++c)
+                e[c] = &(*vectors)[p][c];
+            tensorEigenLine<N>(source.shape(0), s, M*source.stride(0),
+                               d, (MultiArrayIndex)N*values.stride(0),
+                               vectors ? e : (DestType **)0,
+                               vectors ? (MultiArrayIndex)(N*N)*vectors->stride(0) : 0);
+        },
+        options);
+}
+
+    // Planar layout: the last dimension enumerates the channels.
+template <unsigned int N, class T1, class S1, class T2, class S2, class S3>
+void
+tensorEigenMultiArray(MultiArrayView<N, Multiband<T1>, S1> const & source,
+                      MultiArrayView<N, Multiband<T2>, S2> values,
+                      MultiArrayView<N, Multiband<T2>, S3> * vectors,
+                      ParallelOptions const & options)
+{
+    static const int D = N-1, M = D*(D+1)/2;
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename MultiArrayShape<N-1>::type SpatialShape;
+
+    SpatialShape shape = source.shape().dropIndex(N-1);
+    vigra_precondition(shape == values.shape().dropIndex(N-1),
+        "tensorEigenvaluesMultiArray(): shape mismatch between input and output.");
+    vigra_precondition(M == source.shape(N-1),
+        "tensorEigenvaluesMultiArray(): Wrong number of channels in input array.");
+    vigra_precondition(D == values.shape(N-1),
+        "tensorEigenvaluesMultiArray(): Wrong number of channels in output array.");
+    vigra_precondition(!vectors || (shape == vectors->shape().dropIndex(N-1) &&
+                                    D*D == vectors->shape(N-1)),
+        "tensorEigensystemMultiArray(): eigenvector array must have the input shape and N*N channels.");
+
+    tensorForEachLine(shape,
+        [&](SpatialShape const & sp)
+        {
+            T1 const * s[M];
+            T2 * d[D], * e[D*D];
+            Shape p;
+            for(int k=0; k<D; ++k)
+                p[k] = sp[k];
+            for(int c=0; c<M; ++c)
+            {
+                p[N-1] = c;
+                s[c] = &source[p];
+            }
+            for(int c=0; c<D; ++c)
+            {
+                p[N-1] = c;
+                d[c] = &values[p];
+            }
+            for(int c=0; vectors && c<D*D; ++c)
+            {
+                p[N-1] = c;
+                e[c] = &(*vectors)[p];
+            }
+            tensorEigenLine<D>(shape[0], s, source.stride(0),
+                               d, values.stride(0),
+                               vectors ? e : (T2 **)0,
+                               vectors ? vectors->stride(0) : 0);
+        },
+        options);
+}
+
 } // namespace detail
 
 
@@ -418,9 +654,17 @@ tensorTraceMultiArray(MultiArrayView<N, T1, S1> const & source,
     see \ref vectorToTensorMultiArray()) representing the upper triangular part of a
     symmetric tensor into a vector-valued array holding the tensor eigenvalues (thus,
     the destination value_type must be vectors of length N).
+    The eigenvalues are sorted in descending order.
 
     Currently, <tt>N <= 3</tt> is required.
 
+    The array view versions process the tensors in batches using the vectorizable
+    kernels \ref symmetric2x2EigenvaluesBatch() and \ref symmetric3x3EigenvaluesBatch().
+    When <tt>ParallelOptions</tt> are passed, lines of the array are distributed
+    over the requested number of threads. The tensors may also be stored
+    in structure-of-arrays form as <tt>Multiband</tt> arrays, where the last
+    dimension enumerates the N*(N+1)/2 tensor components (or the N eigenvalues).
+
     <b> Declarations:</b>
 
     pass arbitrary-dimensional array views:
@@ -431,6 +675,22 @@ tensorTraceMultiArray(MultiArrayView<N, T1, S1> const & source,
         void
         tensorEigenvaluesMultiArray(MultiArrayView<N, T1, S1> const & source,
                                     MultiArrayView<N, T2, S2> dest);
+
+        // parallel version
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2>
+        void
+        tensorEigenvaluesMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                    MultiArrayView<N, T2, S2> dest,
+                                    ParallelOptions const & options);
+
+        // structure-of-arrays version, channels in the last dimension
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2>
+        void
+        tensorEigenvaluesMultiArray(MultiArrayView<N, Multiband<T1>, S1> const & source,
+                                    MultiArrayView<N, Multiband<T2>, S2> dest,
+                                    ParallelOptions const & options = ParallelOptions());
     }
     \endcode
 
@@ -469,6 +729,9 @@ tensorTraceMultiArray(MultiArrayView<N, T1, S1> const & source,
 
     hessianOfGaussianMultiArray(vol, hessian, 2.0);
     tensorEigenvaluesMultiArray(hessian, eigenvalues);
+
+    // the same using 4 threads
+    tensorEigenvaluesMultiArray(hessian, eigenvalues, ParallelOptions().numThreads(4));
     \endcode
 
     <b> Preconditions:</b>
@@ -511,15 +774,116 @@ tensorEigenvaluesMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> s,
     tensorEigenvaluesMultiArray(s.first, s.second, s.third, d.first, d.second);
 }
 
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+inline void
+tensorEigenvaluesMultiArray(MultiArrayView<N, T1, S1> const & source,
+                            MultiArrayView<N, T2, S2> dest,
+                            ParallelOptions const & options)
+{
+    // no eigenvectors requested: the null pointer's type has N*N channels,
+    // so that the unused eigenvector code is never instantiated on 'dest'
+    typedef MultiArrayView<N, TinyVector<typename T2::value_type, int(N*N)> > NoEigenvectors;
+    detail::tensorEigenMultiArray(source, dest, (NoEigenvectors *)0, options);
+}
+
 template <unsigned int N, class T1, class S1,
                           class T2, class S2>
 inline void
 tensorEigenvaluesMultiArray(MultiArrayView<N, T1, S1> const & source,
                             MultiArrayView<N, T2, S2> dest)
 {
-    vigra_precondition(source.shape() == dest.shape(),
-        "tensorEigenvaluesMultiArray(): shape mismatch between input and output.");
-    tensorEigenvaluesMultiArray(srcMultiArrayRange(source), destMultiArray(dest));
+    tensorEigenvaluesMultiArray(source, dest, ParallelOptions().numThreads(ParallelOptions::NoThreads));
+}
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+inline void
+tensorEigenvaluesMultiArray(MultiArrayView<N, Multiband<T1>, S1> const & source,
+                            MultiArrayView<N, Multiband<T2>, S2> dest,
+                            ParallelOptions const & options = ParallelOptions())
+{
+    detail::tensorEigenMultiArray(source, dest, (MultiArrayView<N, Multiband<T2>, S2> *)0, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*             tensorEigensystemMultiArray              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Calculate the tensor eigenvalues and eigenvectors for every element of a N-D tensor array.
+
+    Like \ref tensorEigenvaluesMultiArray(), but additionally writes the unit eigenvectors
+    to <tt>eigenvectors</tt>, whose value_type must be vectors of length N*N: the eigenvector
+    belonging to eigenvalue <tt>k</tt> occupies the elements <tt>k*N ... k*N+N-1</tt>
+    (in the <tt>Multiband</tt> version, the corresponding channels). For N = 3,
+    the eigenvectors form a right-handed basis.
+    See \ref symmetric2x2EigensystemBatch() and \ref symmetric3x3EigensystemBatch() for
+    the algorithm.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2, class T3, class S3>
+        void
+        tensorEigensystemMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                    MultiArrayView<N, T2, S2> eigenvalues,
+                                    MultiArrayView<N, T3, S3> eigenvectors,
+                                    ParallelOptions const & options = ParallelOptions());
+
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2, class S3>
+        void
+        tensorEigensystemMultiArray(MultiArrayView<N, Multiband<T1>, S1> const & source,
+                                    MultiArrayView<N, Multiband<T2>, S2> eigenvalues,
+                                    MultiArrayView<N, Multiband<T2>, S3> eigenvectors,
+                                    ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_tensorutilities.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, TinyVector<float, 6> >  tensor(shape);
+    MultiArray<3, TinyVector<float, 3> >  eigenvalues(shape);
+    MultiArray<3, TinyVector<float, 9> >  eigenvectors(shape);
+
+    structureTensorMultiArray(vol, tensor, 1.0, 2.0);
+    tensorEigensystemMultiArray(tensor, eigenvalues, eigenvectors);
+    \endcode
+
+    <b> Preconditions:</b>
+
+    <tt>N <= 3</tt>
+*/
+doxygen_overloaded_function(template <...> void tensorEigensystemMultiArray)
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2, class T3, class S3>
+inline void
+tensorEigensystemMultiArray(MultiArrayView<N, T1, S1> const & source,
+                            MultiArrayView<N, T2, S2> eigenvalues,
+                            MultiArrayView<N, T3, S3> eigenvectors,
+                            ParallelOptions const & options = ParallelOptions())
+{
+    detail::tensorEigenMultiArray(source, eigenvalues, &eigenvectors, options);
+}
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2, class S3>
+inline void
+tensorEigensystemMultiArray(MultiArrayView<N, Multiband<T1>, S1> const & source,
+                            MultiArrayView<N, Multiband<T2>, S2> eigenvalues,
+                            MultiArrayView<N, Multiband<T2>, S3> eigenvectors,
+                            ParallelOptions const & options = ParallelOptions())
+{
+    detail::tensorEigenMultiArray(source, eigenvalues, &eigenvectors, options);
 }
 
 /********************************************************/
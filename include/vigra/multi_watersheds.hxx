@@ -136,7 +136,7 @@ prepareWatersheds(Graph const & g,
 
 
 template <class Graph, class T1Map, class T2Map, class T3Map>
-typename T2Map::value_type
+typename T3Map::value_type
 unionFindWatersheds(Graph const & g,
                     T1Map const &,
                     T2Map const & lowestNeighborIndex,
@@ -181,6 +181,167 @@ unionFindWatersheds(Graph const & g,
     return count;
 }
 
+    // GridGraph optimization for arrays: interior nodes use a precomputed
+    // table of memory offsets instead of the generic neighbor iterator
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2>
+void
+prepareWatersheds(GridGraph<N, DirectedTag> const & g,
+                  MultiArrayView<N, T1, S1> const & data,
+                  MultiArrayView<N, T2, S2> & lowestNeighborIndex)
+{
+    typedef GridGraph<N, DirectedTag>     Graph;
+    typedef typename Graph::OutArcIt      neighbor_iterator;
+    typedef typename Graph::shape_type    Shape;
+    typedef NeighborIndexFunctor<Graph>   IndexFunctor;
+
+    ArrayVector<MultiArrayIndex> const & indices = (*g.neighborIndexArray(false))[0];
+    ArrayVector<MultiArrayIndex> offsets = g.interiorNeighborOffsets(data.stride(), false);
+    int degree = (int)indices.size();
+    MultiArrayIndex dataStride = data.stride(0),
+                    indexStride = lowestNeighborIndex.stride(0);
+
+    gridGraphScan(g,
+        [&](Shape const & start, MultiArrayIndex length)
+        {
+            T1 const * d = &data[start];
+            T2 * l = &lowestNeighborIndex[start];
+            for(MultiArrayIndex i=0; i<length; ++i, d += dataStride, l += indexStride)
+            {
+                T1 lowestValue = *d;
+                T2 lowestIndex = IndexFunctor::invalidIndex(g);
+                for(int k=0; k<degree; ++k)
+                {
+                    if(d[offsets[k]] < lowestValue)
+                    {
+                        lowestValue = d[offsets[k]];
+                        lowestIndex = (T2)indices[k];
+                    }
+                }
+                *l = lowestIndex;
+            }
+        },
+        [&](Shape const & node)
+        {
+            T1 lowestValue = data[node];
+            T2 lowestIndex = IndexFunctor::invalidIndex(g);
+            for(neighbor_iterator arc(g, node); arc != INVALID; ++arc)
+            {
+                if(data[g.target(*arc)] < lowestValue)
+                {
+                    lowestValue = data[g.target(*arc)];
+                    lowestIndex = IndexFunctor::get(g, node, arc);
+                }
+            }
+            lowestNeighborIndex[node] = lowestIndex;
+        });
+}
+
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2, class T3, class S3>
+T3
+unionFindWatersheds(GridGraph<N, DirectedTag> const & g,
+                    MultiArrayView<N, T1, S1> const &,
+                    MultiArrayView<N, T2, S2> const & lowestNeighborIndex,
+                    MultiArrayView<N, T3, S3> & labels)
+{
+    typedef GridGraph<N, DirectedTag>     Graph;
+    typedef typename Graph::OutBackArcIt  neighbor_iterator;
+    typedef typename Graph::shape_type    Shape;
+    typedef NeighborIndexFunctor<Graph>   IndexFunctor;
+
+    vigra::UnionFindArray<T3>  regions;
+
+    ArrayVector<MultiArrayIndex> const & backIndices = (*g.neighborIndexArray(true))[0];
+    ArrayVector<MultiArrayIndex> indexOffsets = g.interiorNeighborOffsets(lowestNeighborIndex.stride(), true),
+                                 labelOffsets = g.interiorNeighborOffsets(labels.stride(), true);
+    ArrayVector<T2> backIndex, oppositeIndex;
+    for(unsigned int k=0; k<backIndices.size(); ++k)
+    {
+        backIndex.push_back((T2)backIndices[k]);
+        oppositeIndex.push_back((T2)g.oppositeIndex(backIndices[k]));
+    }
+    int degree = (int)backIndices.size();
+    T2 const invalid = IndexFunctor::invalidIndex(g);
+    MultiArrayIndex indexStride = lowestNeighborIndex.stride(0),
+                    labelStride = labels.stride(0);
+
+    // pass 1: find connected components
+    gridGraphScan(g,
+        [&](Shape const & start, MultiArrayIndex length)
+        {
+            T2 const * n = &lowestNeighborIndex[start];
+            T3 * l = &labels[start];
+            for(MultiArrayIndex i=0; i<length; ++i, n += indexStride, l += labelStride)
+            {
+                T3 currentIndex = regions.nextFreeIndex();
+                for(int k=0; k<degree; ++k)
+                {
+                    T2 targetIndex = n[indexOffsets[k]];
+                    if((*n == invalid && targetIndex == invalid) ||
+                       *n == backIndex[k] || targetIndex == oppositeIndex[k])
+                    {
+                        currentIndex = regions.makeUnion(l[labelOffsets[k]], currentIndex);
+                    }
+                }
+                *l = regions.finalizeIndex(currentIndex);
+            }
+        },
+        [&](Shape const & node)
+        {
+            T3 currentIndex = regions.nextFreeIndex();
+            for (neighbor_iterator arc(g, node); arc != INVALID; ++arc)
+            {
+                if((lowestNeighborIndex[node] == invalid &&
+                    lowestNeighborIndex[g.target(*arc)] == invalid) ||
+                   (lowestNeighborIndex[node] == IndexFunctor::get(g, node, arc)) ||
+                   (lowestNeighborIndex[g.target(*arc)] == IndexFunctor::getOpposite(g, node, arc)))
+                {
+                    currentIndex = regions.makeUnion(labels[g.target(*arc)], currentIndex);
+                }
+            }
+            labels[node] = regions.finalizeIndex(currentIndex);
+        });
+
+    T3 count = regions.makeContiguous();
+
+    // pass 2: make component labels contiguous
+    typename MultiArrayView<N, T3, S3>::iterator i = labels.begin(), end = labels.end();
+    for(; i != end; ++i)
+        *i = regions.findLabel(*i);
+    return count;
+}
+
+template <class Graph, class T1Map, class T2Map>
+typename T2Map::value_type
+unionFindWatershedsGraph(Graph const & g,
+                         T1Map const & data,
+                         T2Map & labels)
+{
+    typedef typename NeighborIndexFunctor<Graph>::index_type index_type;
+
+    typename Graph::template NodeMap<index_type>  lowestNeighborIndex(g);
+
+    prepareWatersheds(g, data, lowestNeighborIndex);
+    return unionFindWatersheds(g, data, lowestNeighborIndex, labels);
+}
+
+template <unsigned int N, class DirectedTag,
+          class T1, class S1, class T2, class S2>
+T2
+unionFindWatershedsGraph(GridGraph<N, DirectedTag> const & g,
+                         MultiArrayView<N, T1, S1> const & data,
+                         MultiArrayView<N, T2, S2> & labels)
+{
+    typedef typename NeighborIndexFunctor<GridGraph<N, DirectedTag> >::index_type index_type;
+
+    MultiArray<N, index_type> lowestNeighborIndex(g.shape());
+    MultiArrayView<N, index_type> lowestNeighborIndexView(lowestNeighborIndex);
+
+    prepareWatersheds(g, data, lowestNeighborIndexView);
+    return unionFindWatersheds(g, data, lowestNeighborIndexView, labels);
+}
+
 template <class Graph, class T1Map, class T2Map>
 typename T2Map::value_type
 generateWatershedSeeds(Graph const & g,
@@ -347,10 +508,7 @@ watershedsGraph(Graph const & g,
         vigra_precondition((index_type)g.maxDegree() <= NumericTraits<index_type>::max(),
             "watershedsGraph(): cannot handle nodes with degree > 65535.");
 
-        typename Graph::template NodeMap<index_type>  lowestNeighborIndex(g);
-
-        graph_detail::prepareWatersheds(g, data, lowestNeighborIndex);
-        return graph_detail::unionFindWatersheds(g, data, lowestNeighborIndex, labels);
+        return graph_detail::unionFindWatershedsGraph(g, data, labels);
     }
     else if(options.method == WatershedOptions::RegionGrowing)
     {
@@ -0,0 +1,490 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_PROFILING_HXX
+#define VIGRA_PROFILING_HXX
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "config.hxx"
+#include "error.hxx"
+#include "sized_int.hxx"
+#include "threading.hxx"
+
+/** \page Profiling  Profiling and tracing of multi-threaded code
+
+<b>\#include</b> \<vigra/profiling.hxx\>
+
+The \ref TimingMacros measure the wall time of a single scope in a single thread.
+The profiling layer defined here records <i>named regions</i> in all threads
+of a program and exports them as a timeline, so that one can see where the
+time of a parallel computation goes -- into computation, into waiting for locks,
+or into chunk I/O.
+
+Instrumentation is opt-in: the macros below expand to nothing unless the
+preprocessor flag <tt>VIGRA_PROFILING</tt> is defined when compiling the
+instrumented code. In particular, their arguments are not evaluated, so that the
+instrumentation has no cost at all in regular builds.
+
+\code
+   #define VIGRA_PROFILING
+   #include <vigra/profiling.hxx>
+
+   void process(...)
+   {
+       VIGRA_PROFILE_SCOPE("myapp", "process");   // recorded until the end of the scope
+       ...
+       for(int k=0; k<n; ++k)
+       {
+           VIGRA_PROFILE_SCOPE_ID("myapp", "item", k);  // attach an integer ID to the event
+           ...
+       }
+   }
+
+   int main()
+   {
+       ...
+       using namespace vigra::profiling;
+       TraceRecorder::global().writeChromeTrace("trace.json");  // view in chrome://tracing or Perfetto
+       TraceRecorder::global().writeSummary(std::cout);         // statistics per region as JSON
+   }
+\endcode
+
+<ul>
+<li> <tt>VIGRA_PROFILE_SCOPE(category, name)</tt>: record the time from this statement
+     to the end of the enclosing scope. \a category and \a name must be string literals
+     (or other strings that live until the trace has been exported).
+<li> <tt>VIGRA_PROFILE_SCOPE_ID(category, name, id)</tt>: likewise, but attach
+     an integer \a id (e.g. a block or chunk index) to the event.
+<li> <tt>VIGRA_PROFILE_THREAD_NAME(name)</tt>: set the name of the current thread
+     in the exported trace (\a name is converted to <tt>std::string</tt>).
+</ul>
+
+Each thread appends its events to its own buffer, so that recording does not
+introduce additional lock contention between threads. Buffers of finished threads are
+kept until \ref vigra::profiling::TraceRecorder::clear() is called.
+
+The library itself is instrumented in the following places (the category is given
+in parentheses): task execution in \ref vigra::ThreadPool ("ThreadPool"),
+chunk loading, unloading and contended locks in \ref vigra::ChunkedArray ("ChunkedArray"),
+block processing of the blockwise algorithms ("blockwise"), and tree construction
+in the rf3 random forest ("rf3").
+*/
+
+namespace vigra {
+
+namespace profiling {
+
+/** \addtogroup Profiling
+*/
+//@{
+
+    /** \brief A single completed region, as recorded by \ref ScopedRegion.
+
+        Times are in nanoseconds since the creation of the \ref TraceRecorder.
+
+        <b>\#include</b> \<vigra/profiling.hxx\><br/>
+        Namespace: vigra::profiling
+    */
+struct TraceEvent
+{
+    const char * category;
+    const char * name;
+    Int64 start;
+    Int64 duration;
+    Int64 id;        ///< user-provided ID, or -1
+};
+
+    /** \brief The events recorded by a single thread.
+
+        <b>\#include</b> \<vigra/profiling.hxx\><br/>
+        Namespace: vigra::profiling
+    */
+class ThreadTrace
+{
+  public:
+    explicit ThreadTrace(int index)
+    : index_(index)
+    {}
+
+        /** Sequential number of the thread (in order of its first recorded event).
+        */
+    int index() const
+    {
+        return index_;
+    }
+
+    std::string name() const
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        return name_;
+    }
+
+    void setName(std::string const & name)
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        name_ = name;
+    }
+
+        /** Append an event. The lock is only contended while the trace is exported.
+        */
+    void add(TraceEvent const & event)
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        events_.push_back(event);
+    }
+
+        /** Return a copy of the events recorded so far.
+        */
+    std::vector<TraceEvent> events() const
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        return events_;
+    }
+
+    void clear()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        events_.clear();
+    }
+
+  private:
+    mutable threading::mutex lock_;
+    int index_;
+    std::string name_;
+    std::vector<TraceEvent> events_;
+};
+
+    /** \brief Program-wide collection of the per-thread event buffers.
+
+        There is a single instance, accessible via \ref global(). Recording
+        is active by default and can be paused by <tt>enable(false)</tt>.
+
+        <b>\#include</b> \<vigra/profiling.hxx\><br/>
+        Namespace: vigra::profiling
+    */
+class TraceRecorder
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+        /** Statistics of all events with the same category and name.
+            Times are in seconds.
+        */
+    struct RegionStatistics
+    {
+        std::string category, name;
+        std::size_t count;
+        double total_time, min_time, max_time;
+    };
+
+    static TraceRecorder & global()
+    {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    bool isEnabled() const
+    {
+        return enabled_.load(threading::memory_order_relaxed) != 0;
+    }
+
+    void enable(bool on = true)
+    {
+        enabled_.store(on ? 1 : 0);
+    }
+
+        /** Nanoseconds since the recorder was created.
+        */
+    Int64 now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch_).count();
+    }
+
+        /** The buffer of the calling thread (created on first use).
+        */
+    ThreadTrace & threadTrace()
+    {
+        static thread_local ThreadTrace * trace = 0;
+        if(trace == 0)
+        {
+            threading::lock_guard<threading::mutex> guard(lock_);
+            threads_.push_back(std::make_shared<ThreadTrace>((int)threads_.size()));
+            trace = threads_.back().get();
+        }
+        return *trace;
+    }
+
+    void setThreadName(std::string const & name)
+    {
+        threadTrace().setName(name);
+    }
+
+        /** Remove all recorded events. Thread buffers and names are kept.
+        */
+    void clear()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        for(std::size_t k=0; k<threads_.size(); ++k)
+            threads_[k]->clear();
+    }
+
+        /** Total number of recorded events.
+        */
+    std::size_t eventCount() const
+    {
+        std::size_t res = 0;
+        std::vector<std::shared_ptr<ThreadTrace> > threads = threadTraces();
+        for(std::size_t k=0; k<threads.size(); ++k)
+            res += threads[k]->events().size();
+        return res;
+    }
+
+        /** Aggregate the events per category and name, sorted by
+            decreasing total time.
+        */
+    std::vector<RegionStatistics> statistics() const
+    {
+        typedef std::map<std::pair<std::string, std::string>, RegionStatistics> Map;
+        Map regions;
+        std::vector<std::shared_ptr<ThreadTrace> > threads = threadTraces();
+        for(std::size_t k=0; k<threads.size(); ++k)
+        {
+            std::vector<TraceEvent> events = threads[k]->events();
+            for(std::size_t i=0; i<events.size(); ++i)
+            {
+                double t = events[i].duration * 1e-9;
+                std::pair<std::string, std::string> key(events[i].category, events[i].name);
+                Map::iterator r = regions.find(key);
+                if(r == regions.end())
+                {
+                    RegionStatistics s = { key.first, key.second, 1, t, t, t };
+                    regions.insert(std::make_pair(key, s));
+                }
+                else
+                {
+                    ++r->second.count;
+                    r->second.total_time += t;
+                    r->second.min_time = std::min(r->second.min_time, t);
+                    r->second.max_time = std::max(r->second.max_time, t);
+                }
+            }
+        }
+        std::vector<RegionStatistics> res;
+        for(Map::const_iterator r = regions.begin(); r != regions.end(); ++r)
+            res.push_back(r->second);
+        std::sort(res.begin(), res.end(),
+                  [](RegionStatistics const & a, RegionStatistics const & b)
+                  {
+                      return a.total_time > b.total_time;
+                  });
+        return res;
+    }
+
+        /** Write all events in the Chrome trace event format, which can be
+            displayed by <tt>chrome://tracing</tt> and Perfetto.
+        */
+    void writeChromeTrace(std::ostream & out) const
+    {
+        std::vector<std::shared_ptr<ThreadTrace> > threads = threadTraces();
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        const char * sep = "\n";
+        for(std::size_t k=0; k<threads.size(); ++k)
+        {
+            std::string name = threads[k]->name();
+            if(name.empty())
+                name = k == 0 ? "main" : "thread " + std::to_string(k);
+            out << sep << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": "
+                << threads[k]->index() << ", \"args\": {\"name\": " << quoted(name) << "}}";
+            sep = ",\n";
+
+            std::vector<TraceEvent> events = threads[k]->events();
+            for(std::size_t i=0; i<events.size(); ++i)
+            {
+                TraceEvent const & e = events[i];
+                // timestamps are in microseconds
+                out << sep << "{\"ph\": \"X\", \"cat\": " << quoted(e.category)
+                    << ", \"name\": " << quoted(e.name)
+                    << ", \"pid\": 1, \"tid\": " << threads[k]->index()
+                    << ", \"ts\": " << e.start / 1000 << "." << digits3(e.start % 1000)
+                    << ", \"dur\": " << e.duration / 1000 << "." << digits3(e.duration % 1000);
+                if(e.id >= 0)
+                    out << ", \"args\": {\"id\": " << e.id << "}";
+                out << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    void writeChromeTrace(std::string const & filename) const
+    {
+        std::ofstream out(filename.c_str());
+        vigra_precondition(out.good(),
+            "TraceRecorder::writeChromeTrace(): unable to open '" + filename + "'.");
+        writeChromeTrace(out);
+    }
+
+        /** Write the result of \ref statistics() as JSON. Times are in seconds.
+        */
+    void writeSummary(std::ostream & out) const
+    {
+        std::vector<RegionStatistics> regions = statistics();
+        out << "{\"regions\": [";
+        for(std::size_t k=0; k<regions.size(); ++k)
+        {
+            RegionStatistics const & r = regions[k];
+            out << (k == 0 ? "\n" : ",\n")
+                << "  {\"category\": " << quoted(r.category)
+                << ", \"name\": " << quoted(r.name)
+                << ", \"count\": " << r.count
+                << ", \"total_time\": " << r.total_time
+                << ", \"mean_time\": " << r.total_time / r.count
+                << ", \"min_time\": " << r.min_time
+                << ", \"max_time\": " << r.max_time << "}";
+        }
+        out << "\n]}\n";
+    }
+
+    void writeSummary(std::string const & filename) const
+    {
+        std::ofstream out(filename.c_str());
+        vigra_precondition(out.good(),
+            "TraceRecorder::writeSummary(): unable to open '" + filename + "'.");
+        writeSummary(out);
+    }
+
+  private:
+    TraceRecorder()
+    : epoch_(Clock::now())
+    {
+        enabled_.store(1);
+    }
+
+    TraceRecorder(TraceRecorder const &);
+    TraceRecorder & operator=(TraceRecorder const &);
+
+    std::vector<std::shared_ptr<ThreadTrace> > threadTraces() const
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        return threads_;
+    }
+
+    static std::string quoted(std::string const & s)
+    {
+        std::string res("\"");
+        for(std::size_t k=0; k<s.size(); ++k)
+        {
+            char c = s[k];
+            if(c == '"' || c == '\\')
+                res += '\\';
+            if((unsigned char)c < 0x20)
+                c = ' ';
+            res += c;
+        }
+        return res + "\"";
+    }
+
+    static std::string digits3(Int64 v)
+    {
+        std::string res = std::to_string(v);
+        return std::string(3 - res.size(), '0') + res;
+    }
+
+    Clock::time_point epoch_;
+    threading::atomic_long enabled_;
+    mutable threading::mutex lock_;
+    std::vector<std::shared_ptr<ThreadTrace> > threads_;
+};
+
+    /** \brief Record the lifetime of this object as an event of the current thread.
+
+        Usually created via the macros <tt>VIGRA_PROFILE_SCOPE</tt> and
+        <tt>VIGRA_PROFILE_SCOPE_ID</tt>, see \ref Profiling.
+
+        <b>\#include</b> \<vigra/profiling.hxx\><br/>
+        Namespace: vigra::profiling
+    */
+class ScopedRegion
+{
+  public:
+    ScopedRegion(const char * category, const char * name, Int64 id = -1)
+    : trace_(0)
+    {
+        TraceRecorder & recorder = TraceRecorder::global();
+        if(recorder.isEnabled())
+        {
+            trace_ = &recorder.threadTrace();
+            event_.category = category;
+            event_.name = name;
+            event_.id = id;
+            event_.start = recorder.now();
+        }
+    }
+
+    ~ScopedRegion()
+    {
+        if(trace_)
+        {
+            event_.duration = TraceRecorder::global().now() - event_.start;
+            trace_->add(event_);
+        }
+    }
+
+  private:
+    ScopedRegion(ScopedRegion const &);
+    ScopedRegion & operator=(ScopedRegion const &);
+
+    ThreadTrace * trace_;
+    TraceEvent event_;
+};
+
+//@}
+
+} // namespace profiling
+
+} // namespace vigra
+
+#include "profiling_macros.hxx"
+
+#endif // VIGRA_PROFILING_HXX
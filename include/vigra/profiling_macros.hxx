@@ -0,0 +1,67 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+
+#ifndef VIGRA_PROFILING_MACROS_HXX
+#define VIGRA_PROFILING_MACROS_HXX
+
+// Only the instrumentation macros, see \ref Profiling. Library headers include
+// this file, so that the trace recorder is only compiled into translation units
+// that define VIGRA_PROFILING.
+
+#ifdef VIGRA_PROFILING
+
+#include "profiling.hxx"
+
+#define VIGRA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VIGRA_PROFILE_CONCAT(a, b) VIGRA_PROFILE_CONCAT_IMPL(a, b)
+
+#define VIGRA_PROFILE_SCOPE(category, name) \
+    ::vigra::profiling::ScopedRegion VIGRA_PROFILE_CONCAT(vigra_profile_region_, __LINE__)(category, name)
+#define VIGRA_PROFILE_SCOPE_ID(category, name, id) \
+    ::vigra::profiling::ScopedRegion VIGRA_PROFILE_CONCAT(vigra_profile_region_, __LINE__)(category, name, (::vigra::Int64)(id))
+#define VIGRA_PROFILE_THREAD_NAME(name) \
+    ::vigra::profiling::TraceRecorder::global().setThreadName(name)
+
+#else
+
+#define VIGRA_PROFILE_SCOPE(category, name)
+#define VIGRA_PROFILE_SCOPE_ID(category, name, id)
+#define VIGRA_PROFILE_THREAD_NAME(name)
+
+#endif // VIGRA_PROFILING
+
+#endif // VIGRA_PROFILING_MACROS_HXX
@@ -45,6 +45,7 @@
 #include "sampling.hxx"
 #include "threading.hxx"
 #include "threadpool.hxx"
+#include "profiling_macros.hxx"
 #include "random_forest_3/random_forest.hxx"
 #include "random_forest_3/random_forest_common.hxx"
 #include "random_forest_3/random_forest_visitors.hxx"
@@ -456,20 +457,27 @@ random_forest_impl(
         futures.emplace_back(
             pool.enqueue([&features, &transformed_labels, &options, &tree_visitors, &stop, &trees, i, &rand_engines](size_t thread_id)
                 {
+                    VIGRA_PROFILE_SCOPE_ID("rf3", "train tree", i);
                     random_forest_single_tree<RF, SCORER, VisitorCopyType, STOP>(features, transformed_labels, options, tree_visitors[i], stop, trees[i], rand_engines[thread_id]);
                 }
             )
         );
     }
-    for (auto & fut : futures)
-        fut.get();
+    {
+        VIGRA_PROFILE_SCOPE("rf3", "wait for trees");
+        for (auto & fut : futures)
+            fut.get();
+    }
 
     // Merge the trees together.
     RF rf(trees[0]);
     rf.options_ = options;
-    for (size_t i = 1; i < trees.size(); ++i)
     {
-        rf.merge(trees[i]);
+        VIGRA_PROFILE_SCOPE("rf3", "merge trees");
+        for (size_t i = 1; i < trees.size(); ++i)
+        {
+            rf.merge(trees[i]);
+        }
     }
 
     // Call the visitor.
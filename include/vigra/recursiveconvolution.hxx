@@ -45,6 +45,7 @@
 #include "bordertreatment.hxx"
 #include "array_vector.hxx"
 #include "multi_shape.hxx"
+#include "multi_array.hxx"
 
 namespace vigra {
 
@@ -57,7 +58,8 @@ namespace vigra {
 /** \addtogroup RecursiveConvolution Recursive convolution functions
 
     First order recursive filters and their specialization for
-    the exponential filter and its derivatives (1D and separable 2D).
+    the exponential filter and its derivatives (1D and separable 2D), and
+    the recursive Gaussian filter and its derivatives (1D and nD).
     These filters are very fast, and the speed does not depend on the
     filter size.
 */
@@ -2222,6 +2224,265 @@ recursiveSecondDerivativeY(MultiArrayView<2, T1, S1> const & src,
                                destImage(dest), scale);
 }
 
+/********************************************************/
+/*                                                      */
+/*         recursiveGaussianFilterMultiArray            */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Young/van Vliet recursive Gaussian (see recursiveGaussianFilterLine())
+    // applied to 'count' interleaved lines of length 'w' at once: element 'x' of
+    // line 'i' is located at data[i + count*x]. The loops over the lines are
+    // innermost, so that they can be vectorized by the compiler. 'scratch' must
+    // provide space for 3*count elements.
+template <class T>
+void
+recursiveGaussianFilterLines(T * data, MultiArrayIndex count, MultiArrayIndex w, double sigma,
+                             T * scratch)
+{
+    vigra_precondition(w >= 4,
+        "recursiveGaussianFilterMultiArray(): line must have at least length 4.");
+
+    double q = 1.31564 * (std::sqrt(1.0 + 0.490811 * sigma*sigma) - 1.0);
+    double qq = q*q;
+    double qqq = qq*q;
+    double b0 = 1.0/(1.57825 + 2.44413*q + 1.4281*qq + 0.422205*qqq);
+    double b1 = (2.44413*q + 2.85619*qq + 1.26661*qqq)*b0;
+    double b2 = (-1.4281*qq - 1.26661*qqq)*b0;
+    double b3 = 0.422205*qqq*b0;
+    double B = 1.0 - (b1 + b2 + b3);
+
+    MultiArrayIndex kernelw = std::min<MultiArrayIndex>(w-4, (MultiArrayIndex)(4.0*sigma));
+
+    // initialise the filter for reflective boundary conditions
+    std::fill(scratch, scratch + 3*count, T());
+    T * y1 = scratch, * y2 = y1 + count, * y3 = y2 + count;
+    for(MultiArrayIndex x=kernelw; x>0; --x)
+    {
+        T const * in = data + x*count;
+        for(MultiArrayIndex i=0; i<count; ++i)
+            y3[i] = detail::RequiresExplicitCast<T>::cast(B*in[i] + (b1*y1[i]+b2*y2[i]+b3*y3[i]));
+        std::swap(y2, y3);
+        std::swap(y1, y2);
+    }
+
+    // from left to right - causal - forward (in-place)
+    T * f0 = data, * f1 = data + count, * f2 = data + 2*count;
+    for(MultiArrayIndex i=0; i<count; ++i)
+    {
+        f0[i] = detail::RequiresExplicitCast<T>::cast(B*f0[i] + (b1*y1[i]+b2*y2[i]+b3*y3[i]));
+        f1[i] = detail::RequiresExplicitCast<T>::cast(B*f1[i] + (b1*f0[i]+b2*y1[i]+b3*y2[i]));
+        f2[i] = detail::RequiresExplicitCast<T>::cast(B*f2[i] + (b1*f1[i]+b2*f0[i]+b3*y1[i]));
+    }
+    for(MultiArrayIndex x=3; x<w; ++x)
+    {
+        T * f = data + x*count;
+        for(MultiArrayIndex i=0; i<count; ++i)
+            f[i] = detail::RequiresExplicitCast<T>::cast(B*f[i] + (b1*f[i-count]+b2*f[i-2*count]+b3*f[i-3*count]));
+    }
+
+    // from right to left - anticausal - backward (in-place)
+    T * l1 = data + (w-1)*count, * l2 = l1 - count, * l3 = l2 - count, * l4 = l3 - count;
+    for(MultiArrayIndex i=0; i<count; ++i)
+    {
+        T v1 = detail::RequiresExplicitCast<T>::cast(B*l1[i] + (b1*l2[i]+b2*l3[i]+b3*l4[i]));
+        T v2 = detail::RequiresExplicitCast<T>::cast(B*l2[i] + (b1*v1+b2*l2[i]+b3*l3[i]));
+        T v3 = detail::RequiresExplicitCast<T>::cast(B*l3[i] + (b1*v2+b2*v1+b3*l2[i]));
+        l1[i] = v1;
+        l2[i] = v2;
+        l3[i] = v3;
+    }
+    for(MultiArrayIndex x=w-4; x>=0; --x)
+    {
+        T * f = data + x*count;
+        for(MultiArrayIndex i=0; i<count; ++i)
+            f[i] = detail::RequiresExplicitCast<T>::cast(B*f[i]+(b1*f[i+count]+b2*f[i+2*count]+b3*f[i+3*count]));
+    }
+}
+
+    // central differences of order 1 or 2 along interleaved lines, multiplied
+    // by 'norm' (reflective boundary conditions). 'scratch' must provide space
+    // for 2*count elements.
+template <class T>
+void
+centralDifferenceLines(T * data, MultiArrayIndex count, MultiArrayIndex w,
+                       unsigned int order, double norm, T * scratch)
+{
+    if(order == 0)
+        return;
+    vigra_precondition(order <= 2 && w >= 2,
+        "recursiveGaussianFilterMultiArray(): derivative order must be <= 2 and line length >= 2.");
+
+    T * previous = scratch, * current = previous + count;
+    std::copy(data + count, data + 2*count, previous);
+    for(MultiArrayIndex x=0; x<w; ++x)
+    {
+        T * f = data + x*count;
+        T const * next = (x+1 < w) ? f + count : f - count;
+        std::copy(f, f + count, current);
+        if(order == 1)
+        {
+            for(MultiArrayIndex i=0; i<count; ++i)
+                f[i] = detail::RequiresExplicitCast<T>::cast(0.5*norm*(next[i] - previous[i]));
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<count; ++i)
+                f[i] = detail::RequiresExplicitCast<T>::cast(norm*(next[i] - 2.0*current[i] + previous[i]));
+        }
+        std::swap(previous, current);
+    }
+}
+
+    // filter an array with consecutive memory layout in-place along dimension 'dim'.
+    // Along dimension 0, the lines are consecutive in memory, so tiles of
+    // 'tileSize' lines are transposed into a buffer and filtered together.
+template <unsigned int N, class T, class Stride>
+void
+recursiveGaussianFilterInPlace(MultiArrayView<N, T, Stride> array, unsigned int dim,
+                               double sigma, unsigned int order, double norm = 1.0)
+{
+    vigra_precondition(array.isUnstrided(),
+        "recursiveGaussianFilterMultiArray(): internal error: array must be unstrided.");
+    static const MultiArrayIndex tileSize = 16;
+
+    MultiArrayIndex count = array.stride(dim),
+                    w = array.shape(dim),
+                    slices = array.size() / (count * w);
+    if(count == 1)
+    {
+        ArrayVector<T> buffer(tileSize*(w + 3));
+        T * tile = buffer.begin(), * scratch = tile + tileSize*w;
+        for(MultiArrayIndex k=0; k<slices; k+=tileSize)
+        {
+            MultiArrayIndex lines = std::min(tileSize, slices - k);
+            T * data = array.data() + k*w;
+            for(MultiArrayIndex i=0; i<lines; ++i)
+                for(MultiArrayIndex x=0; x<w; ++x)
+                    tile[i + lines*x] = data[i*w + x];
+            if(sigma > 0.0)
+                recursiveGaussianFilterLines(tile, lines, w, sigma, scratch);
+            centralDifferenceLines(tile, lines, w, order, norm, scratch);
+            for(MultiArrayIndex i=0; i<lines; ++i)
+                for(MultiArrayIndex x=0; x<w; ++x)
+                    data[i*w + x] = tile[i + lines*x];
+        }
+    }
+    else
+    {
+        ArrayVector<T> scratch(3*count);
+        for(MultiArrayIndex k=0; k<slices; ++k)
+        {
+            T * data = array.data() + k*count*w;
+            if(sigma > 0.0)
+                recursiveGaussianFilterLines(data, count, w, sigma, scratch.begin());
+            centralDifferenceLines(data, count, w, order, norm, scratch.begin());
+        }
+    }
+}
+
+} // namespace detail
+
+/** \brief Recursive approximation of Gaussian smoothing and its derivatives in arbitrary dimensions.
+
+    These functions apply the recursive Gaussian filter of Young and van Vliet
+    (see \ref recursiveGaussianFilterLine()) along one or all dimensions
+    of a \ref MultiArrayView. The computation time does not depend on the filter scale,
+    so that the recursive filter is much faster than convolution with a Gaussian kernel
+    (see \ref gaussianSmoothMultiArray()) when <tt>sigma</tt> is large. Derivatives
+    are computed by central differences of the smoothed data, i.e. with the kernels
+    <tt>[0.5, 0, -0.5]</tt> (first derivative) and <tt>[1, -2, 1]</tt> (second derivative).
+
+    All lines along the filtered dimension are processed together, such that
+    the innermost loops run over consecutive memory locations and can be vectorized
+    by the compiler. Along dimension 0, where each line is consecutive in memory,
+    tiles of 16 lines are transposed into a buffer for this purpose. The filters are also available through the options of the
+    Gaussian filter functions, see \ref vigra::ConvolutionOptions::filterMethod().
+
+    Border treatment approximates <tt>BORDER_TREATMENT_REFLECT</tt>. Source and destination
+    may be the same array. The lines along the filtered dimension(s) must have
+    at least length 4.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // smooth (or differentiate) along dimension 'dim'
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2>
+        void
+        recursiveGaussianFilterMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                          MultiArrayView<N, T2, S2> dest,
+                                          unsigned int dim, double sigma,
+                                          unsigned int derivativeOrder = 0);
+
+        // isotropic smoothing along all dimensions
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2>
+        void
+        recursiveGaussianFilterMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                          MultiArrayView<N, T2, S2> dest,
+                                          double sigma);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/recursiveconvolution.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(300, 300, 200)), smoothed(volume.shape()),
+                         dz(volume.shape());
+    ...
+    recursiveGaussianFilterMultiArray(volume, smoothed, 10.0);
+
+    // derivative along z at scale 10
+    recursiveGaussianFilterMultiArray(smoothed, dz, 2, 0.0, 1);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void recursiveGaussianFilterMultiArray)
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+void
+recursiveGaussianFilterMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                  MultiArrayView<N, T2, S2> dest,
+                                  unsigned int dim, double sigma,
+                                  unsigned int derivativeOrder = 0)
+{
+    typedef typename NumericTraits<T2>::RealPromote TmpType;
+
+    vigra_precondition(source.shape() == dest.shape(),
+        "recursiveGaussianFilterMultiArray(): shape mismatch between input and output.");
+    vigra_precondition(dim < N,
+        "recursiveGaussianFilterMultiArray(): dimension out of range.");
+
+    MultiArray<N, TmpType> tmp(source);
+    detail::recursiveGaussianFilterInPlace(tmp, dim, std::abs(sigma), derivativeOrder);
+    dest = tmp;
+}
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2>
+void
+recursiveGaussianFilterMultiArray(MultiArrayView<N, T1, S1> const & source,
+                                  MultiArrayView<N, T2, S2> dest,
+                                  double sigma)
+{
+    typedef typename NumericTraits<T2>::RealPromote TmpType;
+
+    vigra_precondition(source.shape() == dest.shape(),
+        "recursiveGaussianFilterMultiArray(): shape mismatch between input and output.");
+
+    MultiArray<N, TmpType> tmp(source);
+    for(unsigned int k=0; k<N; ++k)
+        detail::recursiveGaussianFilterInPlace(tmp, k, std::abs(sigma), 0);
+    dest = tmp;
+}
+
 //@}
 
 } // namespace vigra
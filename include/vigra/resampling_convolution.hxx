@@ -959,9 +959,6 @@ void pyramidReduceBurtFilter(SrcIterator sul, SrcIterator slr, SrcAccessor src,
     vigra_precondition(wnew == (wold + 1) / 2 && hnew == (hold + 1) / 2,
        "pyramidReduceBurtFilter(): destSize = ceil(srcSize / 2) required.");
 
-    Rational<int> samplingRatio(1,2), offset(0);
-    resampling_detail::MapTargetToSourceCoordinate mapCoordinate(samplingRatio, offset);
-
     ArrayVector<Kernel1D<double> > kernels(1);
     kernels[0].initExplicitly(-2, 2) = 0.25 - centerValue / 2.0, 0.25, centerValue, 0.25, 0.25 - centerValue / 2.0;
 
@@ -979,9 +976,7 @@ void pyramidReduceBurtFilter(SrcIterator sul, SrcIterator slr, SrcAccessor src,
     {
         typename SrcIterator::row_iterator sr = sul.rowIterator();
         typename TmpIterator::row_iterator tr = tul.rowIterator();
-        // FIXME: replace with reduceLineBurtFilter()
-        resamplingConvolveLine(sr, sr+wold, src, tr, tr+wnew, tmp.accessor(),
-                               kernels, mapCoordinate);
+        resamplingReduceLine2(sr, sr+wold, src, tr, tr+wnew, tmp.accessor(), kernels);
     }
 
     tul  = tmp.upperLeft();
@@ -990,8 +985,7 @@ void pyramidReduceBurtFilter(SrcIterator sul, SrcIterator slr, SrcAccessor src,
     {
         typename DestIterator::column_iterator dc = dul.columnIterator();
         typename TmpIterator::column_iterator tc = tul.columnIterator();
-        resamplingConvolveLine(tc, tc+hold, tmp.accessor(), dc, dc+hnew, dest,
-                               kernels, mapCoordinate);
+        resamplingReduceLine2(tc, tc+hold, tmp.accessor(), dc, dc+hnew, dest, kernels);
     }
 }
 
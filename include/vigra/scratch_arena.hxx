@@ -0,0 +1,353 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_SCRATCH_ARENA_HXX
+#define VIGRA_SCRATCH_ARENA_HXX
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "config.hxx"
+#include "memory.hxx"
+
+namespace vigra {
+
+/** \brief Reusable scratch memory for temporary arrays.
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br/>
+    Namespace: vigra
+
+    Algorithms that process many blocks (e.g. the blockwise filters in
+    \<vigra/multi_blockwise.hxx\>) allocate the same temporary arrays over and over again.
+    A ScratchArena hands out memory from a few large segments instead: allocations
+    simply advance a pointer, and deallocations in reverse order of allocation (the
+    usual pattern for scoped temporaries) give the memory back immediately. When the
+    arena is reset() after a block, the segments are merged into a single one, so that
+    after the first few blocks no more system allocations happen.
+
+    The arena is activated for the current thread by a ScratchArena::Scope object.
+    While a scope is active, \ref vigra::ScratchAllocator (used for the temporaries
+    in \<vigra/multi_convolution.hxx\> and \<vigra/multi_blockwise.hxx\>) takes its
+    memory from the arena, otherwise it allocates aligned memory from the system.
+    An arena must only be used by one thread at a time, and all memory obtained
+    from it must be released before reset() is called.
+*/
+class ScratchArena
+{
+    struct Segment
+    {
+        char * data;
+        std::size_t size, used;
+    };
+
+  public:
+        // segments are aligned to this size, and allocations are rounded to
+        // multiples of it, which keeps all allocations aligned for SIMD access
+    static const std::size_t alignment = 64;
+
+        /** Create an arena, optionally with an initial segment of \a bytes.
+        */
+    explicit ScratchArena(std::size_t bytes = 0)
+    : system_allocations_(0)
+    {
+        if(bytes > 0)
+            addSegment(bytes);
+    }
+
+    ~ScratchArena()
+    {
+        for(std::size_t k = 0; k < segments_.size(); ++k)
+            detail::alignedFree(segments_[k].data);
+    }
+
+        /** Get \a bytes of memory.
+        */
+    void * allocate(std::size_t bytes)
+    {
+        bytes = roundUp(bytes);
+        if(segments_.empty() || segments_.back().size - segments_.back().used < bytes)
+            addSegment(std::max(bytes, 2*capacity()));
+        Segment & s = segments_.back();
+        void * res = s.data + s.used;
+        s.used += bytes;
+        return res;
+    }
+
+        /** Release memory obtained by allocate(). It becomes immediately available
+            again when it was the most recent allocation, otherwise at the next reset().
+        */
+    void deallocate(void * p, std::size_t bytes)
+    {
+        if(segments_.empty())
+            return;
+        Segment & s = segments_.back();
+        bytes = roundUp(bytes);
+        if(static_cast<char *>(p) + bytes == s.data + s.used)
+            s.used -= bytes;
+    }
+
+        /** Release all memory handed out by the arena and merge the segments,
+            so that the next round of allocations is served by a single segment.
+        */
+    void reset()
+    {
+        if(segments_.size() > 1)
+        {
+            std::size_t bytes = capacity();
+            for(std::size_t k = 0; k < segments_.size(); ++k)
+                detail::alignedFree(segments_[k].data);
+            segments_.clear();
+            addSegment(bytes);
+        }
+        else if(segments_.size() == 1)
+        {
+            segments_[0].used = 0;
+        }
+    }
+
+        /** Total size of the arena's segments in bytes.
+        */
+    std::size_t capacity() const
+    {
+        std::size_t res = 0;
+        for(std::size_t k = 0; k < segments_.size(); ++k)
+            res += segments_[k].size;
+        return res;
+    }
+
+        /** Number of segments requested from the system so far.
+        */
+    std::size_t systemAllocations() const
+    {
+        return system_allocations_;
+    }
+
+        /** The arena that is active in the current thread (or 0).
+        */
+    static ScratchArena * current()
+    {
+        return currentRef();
+    }
+
+        /** Activate an arena for the current thread during the lifetime of this object.
+            Scopes may be nested.
+        */
+    class Scope
+    {
+      public:
+        explicit Scope(ScratchArena & arena)
+        : previous_(currentRef())
+        {
+            currentRef() = &arena;
+        }
+
+        ~Scope()
+        {
+            currentRef() = previous_;
+        }
+
+      private:
+        Scope(Scope const &);
+        Scope & operator=(Scope const &);
+
+        ScratchArena * previous_;
+    };
+
+  private:
+    ScratchArena(ScratchArena const &);
+    ScratchArena & operator=(ScratchArena const &);
+
+    static ScratchArena * & currentRef()
+    {
+        static thread_local ScratchArena * arena = 0;
+        return arena;
+    }
+
+    static std::size_t roundUp(std::size_t bytes)
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    void addSegment(std::size_t bytes)
+    {
+        Segment s = { static_cast<char *>(detail::alignedMalloc(bytes, alignment)), bytes, 0 };
+        segments_.push_back(s);
+        ++system_allocations_;
+    }
+
+    std::vector<Segment> segments_;
+    std::size_t system_allocations_;
+};
+
+/** \brief One \ref vigra::ScratchArena per thread of a parallel algorithm.
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br/>
+    Namespace: vigra
+
+    Threads are identified by the thread index passed to the functor
+    of \ref parallel_foreach().
+*/
+class ScratchArenaPool
+{
+  public:
+    explicit ScratchArenaPool(std::size_t n = 0)
+    {
+        resize(n);
+    }
+
+    ~ScratchArenaPool()
+    {
+        for(std::size_t k = 0; k < arenas_.size(); ++k)
+            delete arenas_[k];
+    }
+
+        /** Make sure that the pool contains at least \a n arenas. Not thread-safe.
+        */
+    void resize(std::size_t n)
+    {
+        while(arenas_.size() < n)
+            arenas_.push_back(new ScratchArena());
+    }
+
+    std::size_t size() const
+    {
+        return arenas_.size();
+    }
+
+    ScratchArena & operator[](std::size_t k)
+    {
+        return *arenas_[k];
+    }
+
+  private:
+    ScratchArenaPool(ScratchArenaPool const &);
+    ScratchArenaPool & operator=(ScratchArenaPool const &);
+
+    std::vector<ScratchArena *> arenas_;
+};
+
+/** \brief Allocator that takes its memory from the current thread's \ref vigra::ScratchArena.
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br/>
+    Namespace: vigra
+
+    The arena is determined when the allocator is constructed (i.e. usually when
+    the array using it is created). If no arena is active at this point, the allocator
+    gets its memory from the system. In both cases, the memory is aligned to
+    <tt>ScratchArena::alignment</tt> bytes. Use it for temporaries, e.g.
+    <tt>MultiArray<N, T, ScratchAllocator<T> ></tt>.
+*/
+template <class T>
+class ScratchAllocator
+{
+  public:
+    typedef T                 value_type;
+    typedef T *               pointer;
+    typedef T const *         const_pointer;
+    typedef T &               reference;
+    typedef T const &         const_reference;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef ScratchAllocator<U> other;
+    };
+
+    ScratchAllocator()
+    : arena_(ScratchArena::current())
+    {}
+
+    template <class U>
+    ScratchAllocator(ScratchAllocator<U> const & other)
+    : arena_(other.arena())
+    {}
+
+    pointer allocate(size_type n, void const * = 0)
+    {
+        return arena_
+                   ? static_cast<pointer>(arena_->allocate(n*sizeof(T)))
+                   : static_cast<pointer>(detail::alignedMalloc(n*sizeof(T), ScratchArena::alignment));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        if(arena_)
+            arena_->deallocate(p, n*sizeof(T));
+        else
+            detail::alignedFree(p);
+    }
+
+    void construct(pointer p, T const & value)
+    {
+        new(p) T(value);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    size_type max_size() const
+    {
+        return size_type(-1) / sizeof(T);
+    }
+
+    ScratchArena * arena() const
+    {
+        return arena_;
+    }
+
+    template <class U>
+    bool operator==(ScratchAllocator<U> const & other) const
+    {
+        return arena_ == other.arena();
+    }
+
+    template <class U>
+    bool operator!=(ScratchAllocator<U> const & other) const
+    {
+        return arena_ != other.arena();
+    }
+
+  private:
+    ScratchArena * arena_;
+};
+
+} // namespace vigra
+
+#endif // VIGRA_SCRATCH_ARENA_HXX
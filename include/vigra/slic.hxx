@@ -296,20 +296,40 @@ Slic<N, T, Label>::updateAssigments()
                             restrictToSubarray(startCoord, endCoord),
                  end = iter.getEndIterator();
 
+        typedef typename LookupTag<Mean, RegionFeatures>::value_type MeanType;
+        MeanType mean = get<Mean>(clusters_, c);
+
         // only pixels within the ROI can be assigned to a cluster
-        for(; iter != end; ++iter)
-        {
-            // compute distance between cluster center and pixel
-            DistanceType spatialDist   = squaredNorm(center-iter.point());
-            DistanceType colorDist     = squaredNorm(get<Mean>(clusters_, c)-iter.template get<1>());
-            DistanceType dist =  colorDist + normalization_*spatialDist;
-            // update label?
-            if(dist < iter.template get<3>())
+        stripForeach(iter, end,
+            [&](typename Iterator::value_type & h, MultiArrayIndex length)
             {
-                iter.template get<2>() = static_cast<Label>(c);
-                iter.template get<3>() = dist;
-            }
-        }
+                // along a strip, only the first coordinate of the pixel changes
+                CenterType diff = center - h.point();
+                DistanceType otherDist = 0;
+                for(unsigned int d=1; d<N; ++d)
+                    otherDist += sq(diff[d]);
+
+                auto data     = cast<1>(h).ptr();
+                auto label    = cast<2>(h).ptr();
+                auto distance = cast<3>(h).ptr();
+                MultiArrayIndex dataStride     = cast<1>(h).strides()[0],
+                                labelStride    = cast<2>(h).strides()[0],
+                                distanceStride = cast<3>(h).strides()[0];
+                for(MultiArrayIndex k=0; k<length; ++k,
+                    data += dataStride, label += labelStride, distance += distanceStride)
+                {
+                    // compute distance between cluster center and pixel
+                    DistanceType spatialDist = sq(diff[0] - k) + otherDist;
+                    DistanceType colorDist   = squaredNorm(mean - *data);
+                    DistanceType dist = colorDist + normalization_*spatialDist;
+                    // update label?
+                    if(dist < *distance)
+                    {
+                        *label    = static_cast<Label>(c);
+                        *distance = dist;
+                    }
+                }
+            });
     }
 }
 
@@ -465,6 +465,31 @@ class SplineImageView
     template <class Array>
     void coefficientArray(double x, double y, Array & res) const;
 
+        /** Evaluate the derivative of order <tt>(dx, dy)</tt> (default: the function
+            value) at many points at once: <tt>values(i)</tt> receives the result for
+            <tt>points(i)</tt>. The interpolation weights are computed for blocks of
+            points in loops that the compiler can vectorize, and the function
+            doesn't touch the view's internal cache, so that several threads can
+            evaluate the same view concurrently. Points should preferably be ordered
+            by location (e.g. scanline order of a small tile of the destination image)
+            for good cache locality. An exception is thrown if a point is outside the
+            first reflection (see \ref isValid()).
+        */
+    template <class S1, class T2, class S2>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  unsigned int dx = 0, unsigned int dy = 0) const;
+
+        /** Evaluate the function and its first derivatives at many points at once.
+            <tt>values(i)</tt>, <tt>dxValues(i)</tt> and <tt>dyValues(i)</tt> receive
+            the results for <tt>points(i)</tt>.
+        */
+    template <class S1, class T2, class S2, class T3, class S3, class T4, class S4>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  MultiArrayView<1, T3, S3> dxValues,
+                  MultiArrayView<1, T4, S4> dyValues) const;
+
         /** Check if x is in the original image range.
             Equivalent to <tt>0 <= x <= width()-1</tt>.
         */
@@ -517,12 +542,19 @@ class SplineImageView
 
   protected:
 
+    enum { batchSize_ = 64 };
+
     void init();
     void calculateIndices(double x, double y) const;
     void coefficients(double t, double * const & c) const;
     void derivCoefficients(double t, unsigned int d, double * const & c) const;
     value_type convolve() const;
 
+    template <class S>
+    void batchIndices(MultiArrayView<1, difference_type, S> const & points,
+                      MultiArrayIndex start, int n,
+                      int * ix, int * iy, double * u, double * v) const;
+
     unsigned int w_, h_;
     int w1_, h1_;
     double x0_, x1_, y0_, y1_;
@@ -590,6 +622,83 @@ struct SplineImageViewUnrollLoop2<0, ValueType>
     }
 };
 
+    // Evaluate the weights of the ORDER+1 taps (or their derivatives of order d) of a
+    // B-spline for n facet coordinates u[p] by means of the polynomial coefficients in
+    // BSpline::weights(). Weight k of point p is stored in w[k*stride + p], so that
+    // the innermost loops run over consecutive points and can be vectorized.
+template <int ORDER>
+void
+splineFacetWeights(double const * u, int n, unsigned int d, double * w, int stride)
+{
+    typename BSpline<ORDER, double>::WeightMatrix const & weights = BSpline<ORDER, double>::weights();
+
+    for(int k=0; k<=ORDER; ++k)
+    {
+        double * wk = w + k*stride;
+        if(d > (unsigned int)ORDER)
+        {
+            for(int p=0; p<n; ++p)
+                wk[p] = 0.0;
+            continue;
+        }
+        // coefficients of the d-th derivative of the polynomial of tap k
+        double c[ORDER+1];
+        int degree = ORDER - d;
+        for(int i=0; i<=degree; ++i)
+        {
+            double f = 1.0;
+            for(unsigned int j=0; j<d; ++j)
+                f *= i + d - j;
+            c[i] = f*weights[i+d][k];
+        }
+        // Horner's scheme
+        for(int p=0; p<n; ++p)
+            wk[p] = c[degree];
+        for(int i=degree-1; i>=0; --i)
+            for(int p=0; p<n; ++p)
+                wk[p] = wk[p]*u[p] + c[i];
+    }
+}
+
+    // Index of the central tap for coordinate x (truncation is much cheaper than
+    // floor() and suffices for the common case of non-negative coordinates).
+template <int ORDER>
+inline int
+splineFacetCenter(double x)
+{
+    if(ORDER % 2 == 0)
+        x += 0.5;
+    return x >= 0.0
+              ? (int)x
+              : (int)VIGRA_CSTD::floor(x);
+}
+
+    // Indices of the ORDER+1 taps around 'center' in an axis with maximum index w1,
+    // using reflective boundary conditions.
+template <int ORDER>
+inline void
+splineTapIndices(int center, int w1, int * index)
+{
+    int start = center - ORDER / 2;
+    if(start >= 0 && start + ORDER <= w1)
+    {
+        for(int k=0; k<=ORDER; ++k)
+            index[k] = start + k;
+    }
+    else
+    {
+        for(int k=0; k<=ORDER; ++k)
+        {
+            int m = start + k;
+            index[k] = (m < 0)
+                          ? -m
+                          : (m > w1)
+                              ? 2*w1 - m
+                              : m;
+        }
+    }
+}
+
 } // namespace detail
 
 template <int ORDER, class VALUETYPE>
@@ -734,6 +843,123 @@ VALUETYPE SplineImageView<ORDER, VALUETYPE>::operator()(double x, double y,
     return convolve();
 }
 
+template <int ORDER, class VALUETYPE>
+template <class S>
+void
+SplineImageView<ORDER, VALUETYPE>::batchIndices(MultiArrayView<1, difference_type, S> const & points,
+                                                MultiArrayIndex start, int n,
+                                                int * ix, int * iy, double * u, double * v) const
+{
+    for(int p=0; p<n; ++p)
+    {
+        double x = points(start+p)[0],
+               y = points(start+p)[1];
+        vigra_precondition(isValid(x, y),
+                    "SplineImageView::evaluate(): coordinates out of range.");
+        int xCenter = detail::splineFacetCenter<ORDER>(x),
+            yCenter = detail::splineFacetCenter<ORDER>(y);
+        u[p] = x - xCenter;
+        v[p] = y - yCenter;
+        detail::splineTapIndices<ORDER>(xCenter, w1_, ix + p*ksize_);
+        detail::splineTapIndices<ORDER>(yCenter, h1_, iy + p*ksize_);
+    }
+}
+
+template <int ORDER, class VALUETYPE>
+template <class S1, class T2, class S2>
+void
+SplineImageView<ORDER, VALUETYPE>::evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                                            MultiArrayView<1, T2, S2> values,
+                                            unsigned int dx, unsigned int dy) const
+{
+    typedef typename NumericTraits<VALUETYPE>::RealPromote RealPromote;
+
+    vigra_precondition(points.shape(0) == values.shape(0),
+        "SplineImageView::evaluate(): shape mismatch between points and values.");
+
+    int ix[batchSize_*ksize_], iy[batchSize_*ksize_];
+    double u[batchSize_], v[batchSize_], kx[ksize_*batchSize_], ky[ksize_*batchSize_];
+
+    for(MultiArrayIndex start = 0; start < points.shape(0); start += batchSize_)
+    {
+        int n = (int)std::min<MultiArrayIndex>(batchSize_, points.shape(0) - start);
+        batchIndices(points, start, n, ix, iy, u, v);
+        detail::splineFacetWeights<ORDER>(u, n, dx, kx, batchSize_);
+        detail::splineFacetWeights<ORDER>(v, n, dy, ky, batchSize_);
+
+        for(int p=0; p<n; ++p)
+        {
+            int const * px = ix + p*ksize_;
+            RealPromote sum = NumericTraits<RealPromote>::zero();
+            for(int j=0; j<ksize_; ++j)
+            {
+                InternalValue const * row = image_[iy[p*ksize_ + j]];
+                RealPromote rowSum = RealPromote(kx[p]*row[px[0]]);
+                for(int k=1; k<ksize_; ++k)
+                    rowSum += RealPromote(kx[k*batchSize_ + p]*row[px[k]]);
+                sum += RealPromote(ky[j*batchSize_ + p]*rowSum);
+            }
+            values(start+p) = detail::RequiresExplicitCast<VALUETYPE>::cast(sum);
+        }
+    }
+}
+
+template <int ORDER, class VALUETYPE>
+template <class S1, class T2, class S2, class T3, class S3, class T4, class S4>
+void
+SplineImageView<ORDER, VALUETYPE>::evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                                            MultiArrayView<1, T2, S2> values,
+                                            MultiArrayView<1, T3, S3> dxValues,
+                                            MultiArrayView<1, T4, S4> dyValues) const
+{
+    typedef typename NumericTraits<VALUETYPE>::RealPromote RealPromote;
+
+    vigra_precondition(points.shape(0) == values.shape(0) &&
+                       points.shape(0) == dxValues.shape(0) &&
+                       points.shape(0) == dyValues.shape(0),
+        "SplineImageView::evaluate(): shape mismatch between points and values.");
+
+    int ix[batchSize_*ksize_], iy[batchSize_*ksize_];
+    double u[batchSize_], v[batchSize_],
+           kx[ksize_*batchSize_], ky[ksize_*batchSize_],
+           kdx[ksize_*batchSize_], kdy[ksize_*batchSize_];
+
+    for(MultiArrayIndex start = 0; start < points.shape(0); start += batchSize_)
+    {
+        int n = (int)std::min<MultiArrayIndex>(batchSize_, points.shape(0) - start);
+        batchIndices(points, start, n, ix, iy, u, v);
+        detail::splineFacetWeights<ORDER>(u, n, 0, kx, batchSize_);
+        detail::splineFacetWeights<ORDER>(u, n, 1, kdx, batchSize_);
+        detail::splineFacetWeights<ORDER>(v, n, 0, ky, batchSize_);
+        detail::splineFacetWeights<ORDER>(v, n, 1, kdy, batchSize_);
+
+        for(int p=0; p<n; ++p)
+        {
+            int const * px = ix + p*ksize_;
+            RealPromote sum   = NumericTraits<RealPromote>::zero(),
+                        sumDx = NumericTraits<RealPromote>::zero(),
+                        sumDy = NumericTraits<RealPromote>::zero();
+            for(int j=0; j<ksize_; ++j)
+            {
+                InternalValue const * row = image_[iy[p*ksize_ + j]];
+                RealPromote rowSum   = NumericTraits<RealPromote>::zero(),
+                            rowSumDx = NumericTraits<RealPromote>::zero();
+                for(int k=0; k<ksize_; ++k)
+                {
+                    rowSum   += RealPromote(kx[k*batchSize_ + p]*row[px[k]]);
+                    rowSumDx += RealPromote(kdx[k*batchSize_ + p]*row[px[k]]);
+                }
+                sum   += RealPromote(ky[j*batchSize_ + p]*rowSum);
+                sumDx += RealPromote(ky[j*batchSize_ + p]*rowSumDx);
+                sumDy += RealPromote(kdy[j*batchSize_ + p]*rowSum);
+            }
+            values(start+p)   = detail::RequiresExplicitCast<VALUETYPE>::cast(sum);
+            dxValues(start+p) = detail::RequiresExplicitCast<VALUETYPE>::cast(sumDx);
+            dyValues(start+p) = detail::RequiresExplicitCast<VALUETYPE>::cast(sumDy);
+        }
+    }
+}
+
 template <int ORDER, class VALUETYPE>
 typename SplineImageView<ORDER, VALUETYPE>::SquaredNormType
 SplineImageView<ORDER, VALUETYPE>::g2(double x, double y) const
@@ -986,6 +1212,35 @@ class SplineImageView0Base
     size_type size() const
         { return size_type(w_, h_); }
 
+    template <class S1, class T2, class S2>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  unsigned int dx = 0, unsigned int dy = 0) const
+    {
+        vigra_precondition(points.shape(0) == values.shape(0),
+            "SplineImageView::evaluate(): shape mismatch between points and values.");
+        for(MultiArrayIndex i=0; i<points.shape(0); ++i)
+            values(i) = operator()(points(i)[0], points(i)[1], dx, dy);
+    }
+
+    template <class S1, class T2, class S2, class T3, class S3, class T4, class S4>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  MultiArrayView<1, T3, S3> dxValues,
+                  MultiArrayView<1, T4, S4> dyValues) const
+    {
+        vigra_precondition(points.shape(0) == values.shape(0) &&
+                           points.shape(0) == dxValues.shape(0) &&
+                           points.shape(0) == dyValues.shape(0),
+            "SplineImageView::evaluate(): shape mismatch between points and values.");
+        for(MultiArrayIndex i=0; i<points.shape(0); ++i)
+        {
+            values(i) = operator()(points(i)[0], points(i)[1]);
+            dxValues(i) = dx(points(i)[0], points(i)[1]);
+            dyValues(i) = dy(points(i)[0], points(i)[1]);
+        }
+    }
+
     TinyVector<unsigned int, 2> shape() const
         { return TinyVector<unsigned int, 2>(w_, h_); }
 
@@ -1558,6 +1813,35 @@ class SplineImageView1Base
     size_type size() const
         { return size_type(w_, h_); }
 
+    template <class S1, class T2, class S2>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  unsigned int dx = 0, unsigned int dy = 0) const
+    {
+        vigra_precondition(points.shape(0) == values.shape(0),
+            "SplineImageView::evaluate(): shape mismatch between points and values.");
+        for(MultiArrayIndex i=0; i<points.shape(0); ++i)
+            values(i) = operator()(points(i)[0], points(i)[1], dx, dy);
+    }
+
+    template <class S1, class T2, class S2, class T3, class S3, class T4, class S4>
+    void evaluate(MultiArrayView<1, difference_type, S1> const & points,
+                  MultiArrayView<1, T2, S2> values,
+                  MultiArrayView<1, T3, S3> dxValues,
+                  MultiArrayView<1, T4, S4> dyValues) const
+    {
+        vigra_precondition(points.shape(0) == values.shape(0) &&
+                           points.shape(0) == dxValues.shape(0) &&
+                           points.shape(0) == dyValues.shape(0),
+            "SplineImageView::evaluate(): shape mismatch between points and values.");
+        for(MultiArrayIndex i=0; i<points.shape(0); ++i)
+        {
+            values(i) = operator()(points(i)[0], points(i)[1]);
+            dxValues(i) = dx(points(i)[0], points(i)[1]);
+            dyValues(i) = dy(points(i)[0], points(i)[1]);
+        }
+    }
+
     TinyVector<unsigned int, 2> shape() const
         { return TinyVector<unsigned int, 2>(w_, h_); }
 
@@ -37,12 +37,16 @@
 #define VIGRA_THREADPOOL_HXX
 
 #include <vector>
+#include <deque>
 #include <queue>
+#include <exception>
+#include <functional>
 #include <stdexcept>
 #include <cmath>
 #include "mathutil.hxx"
 #include "counting_iterator.hxx"
 #include "threading.hxx"
+#include "profiling_macros.hxx"
 
 
 namespace vigra
@@ -243,6 +247,7 @@ inline void ThreadPool::init(const ParallelOptions & options)
         workers.emplace_back(
             [ti,this]
             {
+                VIGRA_PROFILE_THREAD_NAME("ThreadPool worker " + std::to_string(ti));
                 for(;;)
                 {
                     std::function<void(int)> task;
@@ -261,7 +266,10 @@ inline void ThreadPool::init(const ParallelOptions & options)
                             task = std::move(this->tasks.front());
                             this->tasks.pop();
                             lock.unlock();
-                            task(ti);
+                            {
+                                VIGRA_PROFILE_SCOPE("ThreadPool", "task");
+                                task(ti);
+                            }
                             ++processed;
                             --busy;
                             finish_condition.notify_one();
@@ -677,6 +685,245 @@ inline void parallel_foreach(
     parallel_foreach(threadpool, iter, iter.end(), f, nItems);
 }
 
+/********************************************************/
+/*                                                      */
+/*                      TaskGraph                       */
+/*                                                      */
+/********************************************************/
+
+    /**\brief Execute a set of tasks with dependencies on a \ref ThreadPool.
+
+        Each task is a functor callable with the thread index as its only argument
+        (like the tasks passed to <tt>ThreadPool::enqueue()</tt>). A task is started
+        as soon as all tasks it depends on have finished, so that independent chains of
+        work proceed concurrently, without a barrier between the stages of a pipeline.
+        Internally, each task holds a counter of unfinished dependencies, and the
+        thread that decrements a counter to zero enqueues the corresponding task.
+
+        <b>Usage:</b>
+
+        \code
+        TaskGraph graph;
+        std::vector<TaskGraph::TaskId> stage1, stage2;
+        for(int k=0; k<n; ++k)
+            stage1.push_back(graph.add([&, k](int) { computeStage1(k); }));
+        for(int k=0; k<n; ++k)
+        {
+            // block k of stage 2 needs blocks k-1, k, and k+1 of stage 1
+            std::vector<TaskGraph::TaskId> deps;
+            for(int j=std::max(k-1, 0); j<std::min(k+2, n); ++j)
+                deps.push_back(stage1[j]);
+            stage2.push_back(graph.add([&, k](int) { computeStage2(k); }, deps));
+        }
+        graph.run(ParallelOptions());  // returns when all tasks are finished
+        \endcode
+
+        If a task throws an exception, the tasks that have not yet started are skipped,
+        and <tt>run()</tt> rethrows the first exception after all running tasks finished.
+        A graph can be run repeatedly. See \ref vigra::blockwise::addBlockwiseTasks()
+        for a convenient way to set up per-block dependencies of blockwise algorithms.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+class TaskGraph
+{
+  public:
+    typedef std::size_t TaskId;
+
+    TaskGraph()
+    {}
+
+        /** Add a task without dependencies and return its ID.
+        */
+    template <class F>
+    TaskId add(F && f)
+    {
+        tasks_.push_back(Task(std::function<void(int)>(std::forward<F>(f))));
+        return tasks_.size() - 1;
+    }
+
+        /** Add a task that will be started when all tasks in
+            \a dependencies have finished, and return its ID.
+        */
+    template <class F>
+    TaskId add(F && f, std::vector<TaskId> const & dependencies)
+    {
+        TaskId id = add(std::forward<F>(f));
+        for(std::size_t k=0; k<dependencies.size(); ++k)
+            addDependency(dependencies[k], id);
+        return id;
+    }
+
+        /** Task \a after shall not start before task \a before has finished.
+        */
+    void addDependency(TaskId before, TaskId after)
+    {
+        vigra_precondition(before < tasks_.size() && after < tasks_.size() && before != after,
+            "TaskGraph::addDependency(): invalid task ID.");
+        tasks_[before].successors.push_back(after);
+        ++tasks_[after].dependencies;
+    }
+
+        /** Number of tasks in the graph.
+        */
+    std::size_t size() const
+    {
+        return tasks_.size();
+    }
+
+        /** Execute all tasks on the given pool and wait until they are finished.
+
+            If the pool has no worker threads, the tasks are executed
+            synchronously in the present thread.
+        */
+    void run(ThreadPool & pool)
+    {
+        checkAcyclic();
+        if(tasks_.size() == 0)
+            return;
+        if(pool.nThreads() == 0)
+        {
+            runSequential();
+            return;
+        }
+
+        RunState state(tasks_.size());
+        for(std::size_t k=0; k<tasks_.size(); ++k)
+            state.pending[k].store(tasks_[k].dependencies);
+        for(std::size_t k=0; k<tasks_.size(); ++k)
+            if(tasks_[k].dependencies == 0)
+                schedule(pool, state, k);
+
+        threading::unique_lock<threading::mutex> lock(state.mutex);
+        state.done.wait(lock, [&state]() { return state.finished == state.pending.size(); });
+        if(state.exception)
+            std::rethrow_exception(state.exception);
+    }
+
+        /** Execute all tasks on a temporary pool with the given number of threads.
+        */
+    void run(ParallelOptions const & options)
+    {
+        ThreadPool pool(options);
+        run(pool);
+    }
+
+  private:
+    struct Task
+    {
+        explicit Task(std::function<void(int)> const & f)
+        : function(f)
+        , dependencies(0)
+        {}
+
+        std::function<void(int)> function;
+        std::vector<TaskId> successors;
+        long dependencies;
+    };
+
+    struct RunState
+    {
+        explicit RunState(std::size_t n)
+        : pending(n)
+        , finished(0)
+        {
+            failed.store(0);
+        }
+
+        std::vector<threading::atomic_long> pending;
+        threading::atomic_long failed;
+        std::exception_ptr exception;
+        std::size_t finished;
+        threading::mutex mutex;
+        threading::condition_variable done;
+    };
+
+    // Without workers, ThreadPool::enqueue() runs a task immediately, so scheduling
+    // successors from within a task would recurse as deep as the longest chain.
+    // Keep the ready tasks in a work list instead.
+    void runSequential()
+    {
+        std::vector<long> pending(tasks_.size());
+        std::deque<TaskId> ready;
+        for(std::size_t k=0; k<tasks_.size(); ++k)
+        {
+            pending[k] = tasks_[k].dependencies;
+            if(pending[k] == 0)
+                ready.push_back(k);
+        }
+        while(!ready.empty())
+        {
+            TaskId id = ready.front();
+            ready.pop_front();
+            tasks_[id].function(0);
+            std::vector<TaskId> const & successors = tasks_[id].successors;
+            for(std::size_t k=0; k<successors.size(); ++k)
+                if(--pending[successors[k]] == 0)
+                    ready.push_back(successors[k]);
+        }
+    }
+
+    void schedule(ThreadPool & pool, RunState & state, TaskId id)
+    {
+        pool.enqueue(
+            [this, &pool, &state, id](int thread_id)
+            {
+                if(state.failed.load() == 0)
+                {
+                    try
+                    {
+                        tasks_[id].function(thread_id);
+                    }
+                    catch(...)
+                    {
+                        threading::lock_guard<threading::mutex> guard(state.mutex);
+                        if(!state.exception)
+                            state.exception = std::current_exception();
+                        state.failed.store(1);
+                    }
+                }
+                std::vector<TaskId> const & successors = tasks_[id].successors;
+                for(std::size_t k=0; k<successors.size(); ++k)
+                    if(--state.pending[successors[k]] == 0)
+                        schedule(pool, state, successors[k]);
+
+                // 'state' must not be accessed after the last task was counted
+                threading::lock_guard<threading::mutex> guard(state.mutex);
+                if(++state.finished == state.pending.size())
+                    state.done.notify_all();
+            });
+    }
+
+    // Kahn's algorithm: all tasks can be reached iff there are no cycles
+    void checkAcyclic() const
+    {
+        std::vector<long> pending(tasks_.size());
+        std::vector<TaskId> ready;
+        for(std::size_t k=0; k<tasks_.size(); ++k)
+        {
+            pending[k] = tasks_[k].dependencies;
+            if(pending[k] == 0)
+                ready.push_back(k);
+        }
+        std::size_t count = 0;
+        while(!ready.empty())
+        {
+            TaskId id = ready.back();
+            ready.pop_back();
+            ++count;
+            std::vector<TaskId> const & successors = tasks_[id].successors;
+            for(std::size_t k=0; k<successors.size(); ++k)
+                if(--pending[successors[k]] == 0)
+                    ready.push_back(successors[k]);
+        }
+        vigra_precondition(count == tasks_.size(),
+            "TaskGraph::run(): the dependencies contain a cycle.");
+    }
+
+    std::vector<Task> tasks_;
+};
+
 //@}
 
 } // namespace vigra
@@ -89,6 +89,10 @@ Alternatively, you can perform nested timing like so:
    }
 \endcode
 
+These macros measure a single scope in a single thread. To find out where
+the time of a multi-threaded computation is spent, use the \ref Profiling
+layer instead.
+
 */
 
 /** \file timing.hxx  Timing macros for runtime measurements
@@ -465,6 +465,17 @@ ImageExportInfo & ImageExportInfo::setCanvasSize(const Size2D & size)
     return *this;
 }
 
+ImageExportInfo & ImageExportInfo::setTileSize(const Size2D & size)
+{
+    m_tile_size = size;
+    return *this;
+}
+
+vigra::Size2D ImageExportInfo::getTileSize() const
+{
+    return m_tile_size;
+}
+
 vigra::Diff2D ImageExportInfo::getPosition() const
 {
     return m_pos;
@@ -546,6 +557,8 @@ VIGRA_UNIQUE_PTR<Encoder> encoder( const ImageExportInfo & info )
     enc->setYResolution(info.getYResolution());
     enc->setPosition(info.getPosition());
     enc->setCanvasSize(info.getCanvasSize());
+    if ( info.getTileSize().area() > 0 )
+        enc->setTileSize(info.getTileSize().width(), info.getTileSize().height());
 
     if ( info.getICCProfile().size() > 0 ) {
         enc->setICCProfile(info.getICCProfile());
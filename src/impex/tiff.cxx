@@ -59,11 +59,17 @@
 #endif
 
 #include "vigra/sized_int.hxx"
+#include "vigra/threadpool.hxx"
+#include "vigra/array_vector.hxx"
+#include "vigra/compression.hxx"
 #include "error.hxx"
 #include "tiff.hxx"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
 extern "C"
 {
@@ -166,7 +172,11 @@ namespace vigra {
     VIGRA_UNIQUE_PTR<Decoder> TIFFCodecFactory::getDecoder() const
     {
         // use 'NULL' to silence all warnings
-        TIFFSetWarningHandler((TIFFErrorHandler)&vigraWarningHandler);
+        // (the handler is process-global, so install it only once and in a thread-safe way,
+        //  decoders may be created concurrently when vigranumpy releases the GIL)
+        static const bool handlerInstalled =
+            (TIFFSetWarningHandler((TIFFErrorHandler)&vigraWarningHandler), true);
+        (void)handlerInstalled;
 
         return VIGRA_UNIQUE_PTR<Decoder>( new TIFFDecoder() );
     }
@@ -243,9 +253,22 @@ namespace vigra {
 
         unsigned int scanline;
 
+        // needed to open additional handles for parallel decoding
+        std::string filename;
+
+        // tiled files are decoded via readRegion(), one row of tiles at a time
+        bool tiled;
+        uint32_t blockwidth, blockheight;
+
         std::string get_pixeltype_by_sampleformat() const;
         std::string get_pixeltype_by_datatype() const;
 
+        void readBlock( TIFF * handle, tdata_t buffer,
+                        uint32_t bx, uint32_t by, uint16_t plane,
+                        unsigned int x0, unsigned int y0,
+                        unsigned int w, unsigned int h,
+                        UInt8 * dest ) const;
+
     public:
 
         TIFFDecoderImpl( const std::string & filename );
@@ -258,9 +281,17 @@ namespace vigra {
 
         const void * currentScanlineOfBand( unsigned int band ) const;
         void nextScanline();
+
+        void readRegion( unsigned int x0, unsigned int y0,
+                         unsigned int w, unsigned int h,
+                         void * dest, int numThreads );
     };
 
     TIFFDecoderImpl::TIFFDecoderImpl( const std::string & filename )
+    : filename(filename),
+      tiled(false),
+      blockwidth(0),
+      blockheight(0)
     {
         tiff = TIFFOpen( filename.c_str(), "r" );
 
@@ -360,16 +391,21 @@ namespace vigra {
         TIFFGetField( tiff, TIFFTAG_IMAGEWIDTH, &width );
         TIFFGetField( tiff, TIFFTAG_IMAGELENGTH, &height );
 
-        // check for tiled TIFFs
-        uint32_t tileWidth, tileHeight;
-        if( TIFFGetField( tiff, TIFFTAG_TILEWIDTH, &tileWidth ) &&
-            TIFFGetField( tiff, TIFFTAG_TILELENGTH, &tileHeight ) )
-            vigra_precondition( (tileWidth == width) && (tileHeight == height),
-                                "TIFFDecoder: "
-                                "Cannot read tiled TIFFs (not implemented)." );
+        // find out the size of the independently compressed blocks
+        tiled = TIFFIsTiled( tiff ) != 0;
+        if ( tiled ) {
+            TIFFGetField( tiff, TIFFTAG_TILEWIDTH, &blockwidth );
+            TIFFGetField( tiff, TIFFTAG_TILELENGTH, &blockheight );
+        } else {
+            uint32_t rowsperstrip;
+            TIFFGetFieldDefaulted( tiff, TIFFTAG_ROWSPERSTRIP, &rowsperstrip );
+            blockwidth = width;
+            blockheight = std::min( rowsperstrip, height );
+        }
 
         // find out strip heights
-        stripheight = 1; // now using scanline interface instead of strip interface
+        // (using scanline interface instead of strip interface, unless tiled)
+        stripheight = tiled ? blockheight : 1;
 
         // get samples_per_pixel
         samples_per_pixel = 0;
@@ -598,7 +634,22 @@ namespace vigra {
 
         // allocate data buffers
         const unsigned int stripsize = TIFFScanlineSize(tiff);
-        if ( planarconfig == PLANARCONFIG_SEPARATE ) {
+        if ( tiled ) {
+            // readRegion() always delivers interleaved pixels
+            vigra_precondition( bits_per_sample % 8 == 0,
+                                "TIFFDecoder: "
+                                "Cannot read tiled bilevel TIFFs (not implemented)." );
+            const unsigned int buffers =
+                planarconfig == PLANARCONFIG_SEPARATE ? samples_per_pixel : 1;
+            stripbuffer = new tdata_t[buffers];
+            for( unsigned int i = 0; i < buffers; ++i ) {
+                stripbuffer[i] = 0;
+            }
+            stripbuffer[0] = _TIFFmalloc( (tsize_t)width * blockheight *
+                                          samples_per_pixel * ( bits_per_sample / 8 ) );
+            if(stripbuffer[0] == 0)
+                throw std::bad_alloc();
+        } else if ( planarconfig == PLANARCONFIG_SEPARATE ) {
             stripbuffer = new tdata_t[samples_per_pixel];
             for( unsigned int i = 0; i < samples_per_pixel; ++i ) {
                 stripbuffer[i] = 0;
@@ -651,7 +702,7 @@ namespace vigra {
             // XXX probably right
             return startpointer + ( stripindex * width ) / 8;
         } else {
-            if ( planarconfig == PLANARCONFIG_SEPARATE ) {
+            if ( planarconfig == PLANARCONFIG_SEPARATE && !tiled ) {
                 UInt8 * const buf
                     = static_cast< UInt8 * >(stripbuffer[band]);
                 return buf + ( stripindex * width ) * ( bits_per_sample / 8 );
@@ -670,6 +721,14 @@ namespace vigra {
         if ( ++stripindex >= stripheight ) {
             stripindex = 0;
 
+            if ( tiled ) {
+                // readRegion() already inverts MINISWHITE images
+                const unsigned int rows = std::min( stripheight, height - scanline );
+                readRegion( 0, scanline, width, rows, stripbuffer[0], 1 );
+                scanline += rows;
+                return;
+            }
+
             if ( planarconfig == PLANARCONFIG_SEPARATE ) {
                 const tsize_t size = TIFFScanlineSize(tiff);
                 for( unsigned int i = 0; i < samples_per_pixel; ++i )
@@ -694,6 +753,148 @@ namespace vigra {
         }
     }
 
+    void TIFFDecoderImpl::readBlock( TIFF * handle, tdata_t buffer,
+                                     uint32_t bx, uint32_t by, uint16_t plane,
+                                     unsigned int x0, unsigned int y0,
+                                     unsigned int w, unsigned int h,
+                                     UInt8 * dest ) const
+    {
+        const unsigned int samplesize = bits_per_sample / 8;
+        const unsigned int pixelsize = samplesize * samples_per_pixel;
+        const bool separate = planarconfig == PLANARCONFIG_SEPARATE;
+        const bool invert = photometric == PHOTOMETRIC_MINISWHITE &&
+                            samples_per_pixel == 1 && pixeltype == "UINT8";
+
+        // an interleaved strip covering full rows of the region
+        // can be decoded directly into the destination
+        const unsigned int stripbegin = by * blockheight,
+                           stripend   = std::min( stripbegin + blockheight, height );
+        if ( !tiled && !separate && !invert && x0 == 0 && w == width &&
+             stripbegin >= y0 && stripend <= y0 + h )
+        {
+            const tsize_t size = (tsize_t)( stripend - stripbegin ) * width * pixelsize;
+            const tsize_t success =
+                TIFFReadEncodedStrip( handle, TIFFComputeStrip( handle, stripbegin, 0 ),
+                                      dest + (UIntBiggest)( stripbegin - y0 ) * width * pixelsize, size );
+            vigra_postcondition( success != -1,
+                                 "TIFFDecoder::readRegion(): Unable to read TIFF data." );
+            return;
+        }
+
+        // decode one tile or strip
+        tsize_t success;
+        if ( tiled )
+            success = TIFFReadEncodedTile( handle,
+                          TIFFComputeTile( handle, bx * blockwidth, by * blockheight, 0, plane ),
+                          buffer, (tsize_t)-1 );
+        else
+            success = TIFFReadEncodedStrip( handle,
+                          TIFFComputeStrip( handle, by * blockheight, plane ),
+                          buffer, (tsize_t)-1 );
+        vigra_postcondition( success != -1,
+                             "TIFFDecoder::readRegion(): Unable to read TIFF data." );
+
+        // copy the intersection of the block with the region of interest
+        const unsigned int blocksamplesize = separate ? samplesize : pixelsize;
+
+        const unsigned int xbegin = std::max( x0, bx * blockwidth ),
+                           xend   = std::min( x0 + w, std::min( (bx + 1) * blockwidth, width ) ),
+                           ybegin = std::max( y0, by * blockheight ),
+                           yend   = std::min( y0 + h, std::min( (by + 1) * blockheight, height ) );
+        const unsigned int n = xend - xbegin;
+
+        for ( unsigned int y = ybegin; y < yend; ++y ) {
+            const UInt8 * s = static_cast< const UInt8 * >(buffer) +
+                ( (UIntBiggest)( y - by * blockheight ) * blockwidth + xbegin - bx * blockwidth ) * blocksamplesize;
+            UInt8 * d = dest + ( (UIntBiggest)( y - y0 ) * w + xbegin - x0 ) * pixelsize;
+
+            if ( !separate ) {
+                std::memcpy( d, s, n * pixelsize );
+                if ( invert )
+                    for ( unsigned int x = 0; x < n; ++x )
+                        d[x] = 0xff - d[x];
+            } else {
+                d += plane * samplesize;
+                for ( unsigned int x = 0; x < n; ++x, s += samplesize, d += pixelsize )
+                    std::memcpy( d, s, samplesize );
+            }
+        }
+    }
+
+    void TIFFDecoderImpl::readRegion( unsigned int x0, unsigned int y0,
+                                      unsigned int w, unsigned int h,
+                                      void * dest, int numThreads )
+    {
+        vigra_precondition( x0 + w <= width && y0 + h <= height,
+                            "TIFFDecoder::readRegion(): region exceeds image bounds." );
+        vigra_precondition( bits_per_sample % 8 == 0,
+                            "TIFFDecoder::readRegion(): "
+                            "Cannot read regions of bilevel TIFFs (not implemented)." );
+        if ( w == 0 || h == 0 )
+            return;
+
+        // collect the tiles/strips intersecting the region
+        struct Block { uint32_t x, y; uint16_t plane; };
+        std::vector<Block> blocks;
+        const uint16_t planes = planarconfig == PLANARCONFIG_SEPARATE ? samples_per_pixel : 1;
+        for ( uint16_t plane = 0; plane < planes; ++plane )
+            for ( uint32_t by = y0 / blockheight; by <= (y0 + h - 1) / blockheight; ++by )
+                for ( uint32_t bx = x0 / blockwidth; bx <= (x0 + w - 1) / blockwidth; ++bx ) {
+                    Block b = { bx, by, plane };
+                    blocks.push_back( b );
+                }
+
+        const tsize_t buffersize = tiled ? TIFFTileSize( tiff ) : TIFFStripSize( tiff );
+        UInt8 * d = static_cast< UInt8 * >(dest);
+
+        // libtiff handles are not thread-safe, so every thread decodes
+        // its blocks through a handle of its own
+        const int threads = std::min<int>( ParallelOptions().numThreads( numThreads ).getActualNumThreads(),
+                                           (int)blocks.size() );
+        std::vector<TIFF *> handles( threads, (TIFF *)0 );
+        std::vector<tdata_t> buffers( threads, (tdata_t)0 );
+        handles[0] = tiff;
+
+        try {
+            parallel_foreach( threads > 1 ? threads : 0, blocks.size(),
+                [&]( size_t thread_id, size_t k )
+                {
+                    if ( handles[thread_id] == 0 ) {
+                        TIFF * handle = TIFFOpen( filename.c_str(), "r" );
+                        vigra_postcondition( handle != 0,
+                                             "TIFFDecoder::readRegion(): Unable to reopen file." );
+                        handles[thread_id] = handle;
+                        if ( !TIFFSetDirectory( handle, TIFFCurrentDirectory( tiff ) ) )
+                            vigra_fail( "TIFFDecoder::readRegion(): Invalid TIFF image index" );
+                    }
+                    if ( buffers[thread_id] == 0 ) {
+                        buffers[thread_id] = _TIFFmalloc( buffersize );
+                        if ( buffers[thread_id] == 0 )
+                            throw std::bad_alloc();
+                    }
+                    const Block & b = blocks[k];
+                    readBlock( handles[thread_id], buffers[thread_id],
+                               b.x, b.y, b.plane, x0, y0, w, h, d );
+                });
+        }
+        catch(...) {
+            for ( int i = 0; i < threads; ++i ) {
+                if ( i > 0 && handles[i] != 0 )
+                    TIFFClose( handles[i] );
+                if ( buffers[i] != 0 )
+                    _TIFFfree( buffers[i] );
+            }
+            throw;
+        }
+
+        for ( int i = 0; i < threads; ++i ) {
+            if ( i > 0 && handles[i] != 0 )
+                TIFFClose( handles[i] );
+            if ( buffers[i] != 0 )
+                _TIFFfree( buffers[i] );
+        }
+    }
+
     void TIFFDecoder::init( const std::string & filename, unsigned int imageIndex=0 )
     {
         pimpl = new TIFFDecoderImpl(filename);
@@ -773,7 +974,7 @@ namespace vigra {
 
     unsigned int TIFFDecoder::getOffset() const
     {
-        return pimpl->planarconfig == PLANARCONFIG_SEPARATE ?
+        return pimpl->planarconfig == PLANARCONFIG_SEPARATE && !pimpl->tiled ?
             1 : pimpl->samples_per_pixel;
     }
 
@@ -810,6 +1011,18 @@ namespace vigra {
         pimpl->nextScanline();
     }
 
+    bool TIFFDecoder::canReadRegion() const
+    {
+        return pimpl->bits_per_sample % 8 == 0;
+    }
+
+    void TIFFDecoder::readRegion( unsigned int x0, unsigned int y0,
+                                  unsigned int w, unsigned int h,
+                                  void * dest, int numThreads )
+    {
+        pimpl->readRegion( x0, y0, w, h, dest, numThreads );
+    }
+
     void TIFFDecoder::close() {}
     void TIFFDecoder::abort() {}
 
@@ -820,32 +1033,31 @@ namespace vigra {
 
         // attributes
 
+        std::string filename, mode;
         unsigned short tiffcomp;
-        bool finalized;
+        uint32_t tilewidth, tileheight;
+        bool tiled, finalized;
 
     public:
 
         // ctor, dtor
 
+        // the file is opened in finalizeSettings(), when we know
+        // whether the image requires the BigTIFF format
         TIFFEncoderImpl( const std::string & filename, const std::string & mode )
-            : tiffcomp(COMPRESSION_LZW), finalized(false)
+            : filename(filename), mode(mode), tiffcomp(COMPRESSION_LZW),
+              tilewidth(0), tileheight(0), tiled(false), finalized(false)
         {
-            tiff = TIFFOpen( filename.c_str(), mode.c_str() );
-            if (!tiff)
-            {
-                std::string msg("Unable to open file '");
-                msg += filename;
-                msg += "'.";
-                vigra_precondition( false, msg.c_str() );
-            }
-
             planarconfig = PLANARCONFIG_CONTIG;
         }
 
         // methods
 
         void setCompressionType( const std::string &, int );
+        void setTileSize( unsigned int, unsigned int );
         void finalizeSettings();
+        void writeRegion( unsigned int, unsigned int, unsigned int, unsigned int,
+                          const void *, int );
 
         void * currentScanlineOfBand( unsigned int band ) const
         {
@@ -863,9 +1075,15 @@ namespace vigra {
 
             if ( ++stripindex >= rows ) {
 
-                // write next strip
                 stripindex = 0;
 
+                if ( tiled ) {
+                    // the buffer holds one row of tiles
+                    writeRegion( 0, strip++ * stripheight, width, rows, stripbuffer[0], 1 );
+                    return;
+                }
+
+                // write next strip
                 int success = TIFFWriteEncodedStrip( tiff, strip++, stripbuffer[0],
                                        TIFFVStripSize( tiff, rows ) );
                 if(success == -1 && tiffcomp != COMPRESSION_NONE)
@@ -898,8 +1116,38 @@ namespace vigra {
             tiffcomp = COMPRESSION_DEFLATE;
     }
 
+    void TIFFEncoderImpl::setTileSize( unsigned int w, unsigned int h )
+    {
+        vigra_precondition( w % 16 == 0 && h % 16 == 0,
+                            "TIFFEncoder::setTileSize(): tile width and height "
+                            "must be multiples of 16." );
+        tilewidth = w;
+        tileheight = h;
+        tiled = w > 0 && h > 0;
+    }
+
     void TIFFEncoderImpl::finalizeSettings()
     {
+#if TIFFLIB_VERSION >= 20111221
+        // switch to BigTIFF when the uncompressed data approach the 4 GB limit
+        // of classic TIFF (compression may not help, e.g. for noisy data)
+        const UIntBiggest bytesPerSample = pixeltype == "DOUBLE" ? 8 :
+                 pixeltype == "INT32" || pixeltype == "UINT32" || pixeltype == "FLOAT" ? 4 :
+                 pixeltype == "INT16" || pixeltype == "UINT16" ? 2 : 1;
+        if ( mode == "w" &&
+             (UIntBiggest)width * height * samples_per_pixel * bytesPerSample >
+                 (static_cast<UIntBiggest>(0xF) << 28) )
+            mode = "w8";
+#endif
+        tiff = TIFFOpen( filename.c_str(), mode.c_str() );
+        if (!tiff)
+        {
+            std::string msg("Unable to open file '");
+            msg += filename;
+            msg += "'.";
+            vigra_precondition( false, msg.c_str() );
+        }
+
         // decide if we should write Grey, or RGB files
         // all additional channels are treated as extra samples
         if (samples_per_pixel < 3) {
@@ -912,14 +1160,21 @@ namespace vigra {
         TIFFSetField( tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG );
         TIFFSetField( tiff, TIFFTAG_IMAGEWIDTH, width );
         TIFFSetField( tiff, TIFFTAG_IMAGELENGTH, height );
-        // TIFFDefaultStripSize tries for 8kb strips! Laughable!
-        // This will do a 1MB strip for 8-bit images,
-        // 2MB strip for 16-bit, and so forth.
-        unsigned int estimate =
-            (unsigned int)std::max(static_cast<UIntBiggest>(1),
-                                  (static_cast<UIntBiggest>(1)<<20) / (width * samples_per_pixel));
-        TIFFSetField( tiff, TIFFTAG_ROWSPERSTRIP,
-                      stripheight = TIFFDefaultStripSize( tiff, estimate ) );
+        if ( tiled ) {
+            TIFFSetField( tiff, TIFFTAG_TILEWIDTH, tilewidth );
+            TIFFSetField( tiff, TIFFTAG_TILELENGTH, tileheight );
+            // the scanline interface collects one row of tiles
+            stripheight = tileheight;
+        } else {
+            // TIFFDefaultStripSize tries for 8kb strips! Laughable!
+            // This will do a 1MB strip for 8-bit images,
+            // 2MB strip for 16-bit, and so forth.
+            unsigned int estimate =
+                (unsigned int)std::max(static_cast<UIntBiggest>(1),
+                                      (static_cast<UIntBiggest>(1)<<20) / (width * samples_per_pixel));
+            TIFFSetField( tiff, TIFFTAG_ROWSPERSTRIP,
+                          stripheight = TIFFDefaultStripSize( tiff, estimate ) );
+        }
         TIFFSetField( tiff, TIFFTAG_SAMPLESPERPIXEL, samples_per_pixel );
         TIFFSetField( tiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT );
         TIFFSetField( tiff, TIFFTAG_COMPRESSION, tiffcomp );
@@ -954,6 +1209,9 @@ namespace vigra {
             bits_per_sample = 64;
         }
         TIFFSetField( tiff, TIFFTAG_BITSPERSAMPLE, bits_per_sample );
+        vigra_precondition( !tiled || bits_per_sample % 8 == 0,
+                            "TIFFEncoder::finalizeSettings(): "
+                            "Cannot write tiled bilevel TIFFs (not implemented)." );
 
        if (extra_samples_per_pixel > 0) {
               uint16_t * types = new  uint16_t[extra_samples_per_pixel];
@@ -1006,13 +1264,99 @@ namespace vigra {
         // alloc memory
         stripbuffer = new tdata_t[1];
         stripbuffer[0] = 0;
-        stripbuffer[0] = _TIFFmalloc( TIFFStripSize(tiff) );
+        stripbuffer[0] = _TIFFmalloc( tiled
+                                          ? (tsize_t)width * tileheight * samples_per_pixel * (bits_per_sample >> 3)
+                                          : TIFFStripSize(tiff) );
         if(stripbuffer[0] == 0)
             throw std::bad_alloc();
 
         finalized = true;
     }
 
+    void TIFFEncoderImpl::writeRegion( unsigned int x0, unsigned int y0,
+                                       unsigned int w, unsigned int h,
+                                       const void * src, int numThreads )
+    {
+        vigra_precondition( finalized && tiled,
+                            "TIFFEncoder::writeRegion(): tile size must be set before finalizeSettings()." );
+        vigra_precondition( x0 + w <= width && y0 + h <= height,
+                            "TIFFEncoder::writeRegion(): region exceeds image bounds." );
+        vigra_precondition( x0 % tilewidth == 0 && y0 % tileheight == 0 &&
+                            ( w % tilewidth == 0 || x0 + w == width ) &&
+                            ( h % tileheight == 0 || y0 + h == height ),
+                            "TIFFEncoder::writeRegion(): region must consist of complete tiles." );
+        if ( w == 0 || h == 0 )
+            return;
+
+        const std::size_t pixelbytes = samples_per_pixel * ( bits_per_sample >> 3 ),
+                          srcstride = w * pixelbytes,
+                          tilestride = tilewidth * pixelbytes,
+                          tilebytes = tilestride * tileheight;
+        const UInt8 * s = static_cast< const UInt8 * >(src);
+
+        std::vector< std::pair<uint32_t, uint32_t> > tiles;  // upper left corners
+        for ( uint32_t y = y0; y < y0 + h; y += tileheight )
+            for ( uint32_t x = x0; x < x0 + w; x += tilewidth )
+                tiles.push_back( std::make_pair( x, y ) );
+
+        // copy a tile into a buffer of full tile size, zero-padding at the image border
+        auto extractTile = [&]( std::size_t k, UInt8 * tile )
+        {
+            const uint32_t x = tiles[k].first, y = tiles[k].second,
+                           cols = std::min( tilewidth, x0 + w - x ),
+                           rows = std::min( tileheight, y0 + h - y );
+            if ( cols < tilewidth || rows < tileheight )
+                std::memset( tile, 0, tilebytes );
+            const UInt8 * line = s + ( y - y0 ) * srcstride + ( x - x0 ) * pixelbytes;
+            for ( uint32_t r = 0; r < rows; ++r, line += srcstride, tile += tilestride )
+                std::memcpy( tile, line, cols * pixelbytes );
+        };
+
+        const int threads = std::min<int>( ParallelOptions().numThreads( numThreads ).getActualNumThreads(),
+                                           (int)tiles.size() );
+#ifdef HasZLIB
+        const bool rawTiles = tiffcomp == COMPRESSION_NONE || tiffcomp == COMPRESSION_DEFLATE;
+#else
+        const bool rawTiles = tiffcomp == COMPRESSION_NONE;
+#endif
+
+        if ( threads > 1 && rawTiles ) {
+            // compress the tiles in parallel, but write them sequentially
+            // (libtiff handles are not thread-safe)
+            std::vector< ArrayVector<char> > encoded( tiles.size() );
+            parallel_foreach( threads, tiles.size(),
+                [&]( size_t, size_t k )
+                {
+                    ArrayVector<char> tile( tilebytes );
+                    extractTile( k, ( UInt8 * )tile.data() );
+                    if ( tiffcomp == COMPRESSION_NONE )
+                        encoded[k].swap( tile );
+                    else
+                        compress( tile.data(), tilebytes, encoded[k], ZLIB );
+                });
+            for ( std::size_t k = 0; k < tiles.size(); ++k ) {
+                const ttile_t index = TIFFComputeTile( tiff, tiles[k].first, tiles[k].second, 0, 0 );
+                vigra_postcondition( TIFFWriteRawTile( tiff, index, encoded[k].data(),
+                                                       (tsize_t)encoded[k].size() ) != -1,
+                                     "exportImage(): Unable to write TIFF data." );
+                ArrayVector<char>().swap( encoded[k] );
+            }
+        } else {
+            ArrayVector<UInt8> tile( tilebytes );
+            for ( std::size_t k = 0; k < tiles.size(); ++k ) {
+                extractTile( k, tile.data() );
+                const ttile_t index = TIFFComputeTile( tiff, tiles[k].first, tiles[k].second, 0, 0 );
+                int success = TIFFWriteEncodedTile( tiff, index, tile.data(), (tsize_t)tilebytes );
+                if(success == -1 && tiffcomp != COMPRESSION_NONE)
+                {
+                    throw Encoder::TIFFCompressionException(); // retry without compression
+                }
+                vigra_postcondition( success != -1,
+                                     "exportImage(): Unable to write TIFF data." );
+            }
+        }
+    }
+
     void TIFFEncoder::init( const std::string & filename, const std::string & mode )
     {
         pimpl = new TIFFEncoderImpl(filename, mode);
@@ -1104,6 +1448,24 @@ namespace vigra {
         pimpl->nextScanline();
     }
 
+    bool TIFFEncoder::canWriteRegion() const
+    {
+        return true;
+    }
+
+    void TIFFEncoder::setTileSize( unsigned int w, unsigned int h )
+    {
+        VIGRA_IMPEX_FINALIZED(pimpl->finalized);
+        pimpl->setTileSize( w, h );
+    }
+
+    void TIFFEncoder::writeRegion( unsigned int x0, unsigned int y0,
+                                   unsigned int w, unsigned int h,
+                                   const void * src, int numThreads )
+    {
+        pimpl->writeRegion( x0, y0, w, h, src, numThreads );
+    }
+
     void TIFFEncoder::setICCProfile(const ICCProfile & data)
     {
         pimpl->iccProfile = data;
@@ -92,6 +92,11 @@ namespace vigra {
         const void * currentScanlineOfBand( unsigned int ) const;
         void nextScanline();
 
+        bool canReadRegion() const;
+        void readRegion( unsigned int x0, unsigned int y0,
+                         unsigned int w, unsigned int h,
+                         void * dest, int numThreads = 1 );
+
         std::string getPixelType() const;
         unsigned int getOffset() const;
 
@@ -135,6 +140,11 @@ namespace vigra {
         void * currentScanlineOfBand( unsigned int );
         void nextScanline();
 
+        bool canWriteRegion() const;
+        void setTileSize( unsigned int, unsigned int );
+        void writeRegion( unsigned int, unsigned int, unsigned int, unsigned int,
+                          const void *, int = 1 );
+
         void setICCProfile(const ICCProfile & data);
 
         void init( const std::string &, const std::string & );
@@ -5,6 +5,9 @@
 #include <vigra/unittest.hxx>
 #include <vigra/multi_blocking.hxx>
 #include <vigra/multi_blockwise.hxx>
+#include <vigra/multi_filterbank.hxx>
+#include <vigra/multi_pyramid.hxx>
+#include <vigra/resampling_convolution.hxx>
 
 #include <iostream>
 #include "utils.hxx"
@@ -104,6 +107,322 @@ struct BlockwiseConvolutionTest
         );
 
     }
+
+    void testChunkedFilters()
+    {
+        typedef MultiArray<3, float> Array;
+        typedef Array::difference_type Shape;
+
+        Shape shape(50, 40, 30);
+        Array data(shape);
+        fillRandom(data.begin(), data.end(), 2000);
+
+        ChunkedArrayTmpFile<3, float> source(shape, Shape(16));
+        source.commitSubarray(Shape(0), data);
+
+        BlockwiseConvolutionOptions<3> opt;
+        opt.setStdDev(TinyVector<double, 3>(2.0));
+        opt.blockShape(Shape(16));
+        opt.numThreads(ParallelOptions::Nice);
+
+        {
+            // blocks coincide with the destination's chunks
+            Array res(shape), resC(shape);
+            gaussianSmoothMultiArray(data, res, opt);
+
+            ChunkedArrayLazy<3, float> dest(shape, Shape(16));
+            gaussianSmoothMultiArray(source, dest, opt);
+            dest.checkoutSubarray(Shape(0), resC);
+            shouldEqualSequence(res.begin(), res.end(), resC.begin());
+        }
+        {
+            // blocks span several chunks
+            typedef MultiArray<3, TinyVector<float, 3> > VectorArray;
+            VectorArray res(shape), resC(shape);
+            hessianOfGaussianEigenvaluesMultiArray(data, res, opt);
+
+            ChunkedArrayLazy<3, TinyVector<float, 3> > dest(shape, Shape(8));
+            opt.blockShape(Shape(12)); // rounded up to 16
+            hessianOfGaussianEigenvaluesMultiArray(source, dest, opt);
+            dest.checkoutSubarray(Shape(0), resC);
+            shouldEqualSequence(res.begin(), res.end(), resC.begin());
+        }
+    }
+
+    void testFilterBank()
+    {
+        typedef MultiArray<3, float> Array;
+        typedef Array::difference_type Shape;
+
+        Shape shape(40, 36, 30);
+        Array data(shape);
+        fillRandom(data.begin(), data.end(), 255);
+        gaussianSmoothMultiArray(data, data, 1.0);
+
+        FilterBank bank;
+        double scales[] = { 0.7, 1.0, 1.6, 3.5 };
+        for(int k=0; k<4; ++k)
+            bank.add(FilterBank::GaussianSmoothing, scales[k])
+                .add(FilterBank::GaussianGradientMagnitude, scales[k])
+                .add(FilterBank::LaplacianOfGaussian, scales[k])
+                .add(FilterBank::HessianOfGaussianEigenvalues, scales[k])
+                .add(FilterBank::StructureTensorEigenvalues, scales[k]);
+        shouldEqual(bank.channelCount(3), 4u*9u);
+        shouldEqual(bank.channelOffset(4, 3), 6u);
+
+        MultiArray<4, float> res(Shape4(40, 36, 30, bank.channelCount(3)));
+        filterBankMultiArray(data, res, bank, BlockwiseOptions().blockShape(16).numThreads(ParallelOptions::Nice));
+
+        MultiArray<4, float> res1(res.shape());
+        filterBankMultiArray(data, res1, bank, BlockwiseOptions().blockShape(shape));
+
+        // compare with the individual filters
+        for(unsigned int k=0; k<bank.size(); ++k)
+        {
+            double scale = bank[k].scale;
+            MultiArray<3, float> scalar(shape);
+            MultiArray<3, TinyVector<float, 6> > tensor(shape);
+            MultiArray<3, TinyVector<float, 3> > eigenvalues(shape);
+            MultiArray<4, float> expected(Shape4(40, 36, 30, FilterBank::channelCount(bank[k].feature, 3)));
+            switch(bank[k].feature)
+            {
+              case FilterBank::GaussianSmoothing:
+                gaussianSmoothMultiArray(data, expected.bindOuter(0), scale);
+                break;
+              case FilterBank::GaussianGradientMagnitude:
+                gaussianGradientMagnitude(data, expected.bindOuter(0), scale);
+                break;
+              case FilterBank::LaplacianOfGaussian:
+                laplacianOfGaussianMultiArray(data, expected.bindOuter(0), scale);
+                break;
+              case FilterBank::HessianOfGaussianEigenvalues:
+                hessianOfGaussianMultiArray(data, tensor, scale);
+                break;
+              case FilterBank::StructureTensorEigenvalues:
+                structureTensorMultiArray(data, tensor, scale, bank[k].outerScale);
+                break;
+            }
+            if(expected.shape(3) == 3)
+            {
+                tensorEigenvaluesMultiArray(tensor, eigenvalues);
+                for(int i=0; i<3; ++i)
+                    expected.bindOuter(i) = eigenvalues.bindElementChannel(i);
+            }
+
+            Shape4 channelBegin(0, 0, 0, bank.channelOffset(k, 3)),
+                   channelEnd(40, 36, 30, bank.channelOffset(k, 3) + expected.shape(3));
+            MultiArrayView<4, float> computed = res.subarray(channelBegin, channelEnd),
+                                     computed1 = res1.subarray(channelBegin, channelEnd);
+            float maxValue = 0.0f, maxError = 0.0f, maxBlockError = 0.0f;
+            for(int i=0; i<expected.size(); ++i)
+            {
+                maxValue = std::max(maxValue, std::abs(expected[i]));
+                maxError = std::max(maxError, std::abs(expected[i] - computed[i]));
+                maxBlockError = std::max(maxBlockError, std::abs(computed1[i] - computed[i]));
+            }
+            // the cascade of scales is a good approximation
+            should(maxError <= 0.01f*maxValue);
+            // the blocks don't influence the result (up to round-off)
+            should(maxBlockError <= 1e-4f*maxValue);
+        }
+    }
+
+    void testGaussianPyramid()
+    {
+        typedef MultiArray<2, double> Array2;
+        typedef Array2::difference_type Shape2;
+        typedef MultiArray<3, float> Array3;
+        typedef Array3::difference_type Shape3;
+
+        // compare with repeated 2D reductions
+        Array2 data2(Shape2(101, 77));
+        fillRandom(data2.begin(), data2.end(), 2000);
+
+        std::vector<VIGRA_UNIQUE_PTR<ChunkedArrayLazy<2, double> > > lazy2;
+        std::vector<ChunkedArray<2, double> *> levels2;
+        Array2 previous(data2);
+        for(int k=1; k<=5; ++k)
+        {
+            lazy2.emplace_back(new ChunkedArrayLazy<2, double>(pyramidLevelShape(data2.shape(), k), Shape2(8)));
+            levels2.push_back(lazy2.back().get());
+        }
+        gaussianPyramidMultiArray(data2, levels2, 0.4,
+                                  BlockwiseOptions().blockShape(Shape2(16)).numThreads(4));
+        for(int k=1; k<=5; ++k)
+        {
+            Array2 reference(pyramidLevelShape(data2.shape(), k)), result(reference.shape());
+            pyramidReduceBurtFilter(srcImageRange(previous), destImageRange(reference), 0.4);
+            levels2[k-1]->checkoutSubarray(Shape2(0), result);
+            shouldEqualSequenceTolerance(reference.begin(), reference.end(), result.begin(), 1e-12);
+            previous.swap(reference);
+        }
+
+        // blocking and chunked source don't influence the result
+        Array3 data3(Shape3(45, 38, 33));
+        fillRandom(data3.begin(), data3.end(), 2000);
+        ChunkedArrayLazy<3, float> source(data3.shape(), Shape3(16));
+        source.commitSubarray(Shape3(0), data3);
+
+        std::vector<VIGRA_UNIQUE_PTR<ChunkedArrayLazy<3, float> > > lazy3, lazy3B;
+        std::vector<ChunkedArray<3, float> *> levels3, levels3B;
+        for(int k=1; k<=3; ++k)
+        {
+            lazy3.emplace_back(new ChunkedArrayLazy<3, float>(pyramidLevelShape(data3.shape(), k), Shape3(4)));
+            levels3.push_back(lazy3.back().get());
+            lazy3B.emplace_back(new ChunkedArrayLazy<3, float>(pyramidLevelShape(data3.shape(), k), Shape3(32)));
+            levels3B.push_back(lazy3B.back().get());
+        }
+        gaussianPyramidMultiArray(data3, levels3B, 0.375,
+                                  BlockwiseOptions().blockShape(Shape3(64)).numThreads(ParallelOptions::NoThreads));
+        gaussianPyramidMultiArray(source, levels3, 0.375,
+                                  BlockwiseOptions().blockShape(Shape3(8)).numThreads(3));
+        for(int k=0; k<3; ++k)
+        {
+            Array3 result(levels3[k]->shape()), resultB(levels3[k]->shape());
+            levels3[k]->checkoutSubarray(Shape3(0), result);
+            levels3B[k]->checkoutSubarray(Shape3(0), resultB);
+            shouldEqualSequenceTolerance(resultB.begin(), resultB.end(), result.begin(), 1e-5);
+        }
+
+        // data that are constant along the last axis reduce like 2D images
+        Array2 slice(Shape2(45, 38)), reducedSlice(pyramidLevelShape(slice.shape(), 1));
+        fillRandom(slice.begin(), slice.end(), 2000);
+        for(int z=0; z<data3.shape(2); ++z)
+            data3.bindOuter(z) = slice;
+        pyramidReduceBurtFilter(srcImageRange(slice), destImageRange(reducedSlice), 0.4);
+
+        ChunkedArrayLazy<3, float> level1(pyramidLevelShape(data3.shape(), 1), Shape3(8));
+        std::vector<ChunkedArray<3, float> *> levels1(1, &level1);
+        gaussianPyramidMultiArray(data3, levels1, 0.4,
+                                  BlockwiseOptions().blockShape(Shape3(16)).numThreads(2));
+        Array3 result1(level1.shape());
+        level1.checkoutSubarray(Shape3(0), result1);
+        for(int z=0; z<result1.shape(2); ++z)
+        {
+            MultiArrayView<2, float> resultSlice(result1.bindOuter(z));
+            shouldEqualSequenceTolerance(reducedSlice.begin(), reducedSlice.end(), resultSlice.begin(), 1e-5);
+        }
+    }
+
+    void testScratchMemory()
+    {
+        typedef MultiArray<3, float> Array;
+        typedef Array::difference_type Shape;
+
+        Shape shape(40, 35, 30);
+        Array data(shape);
+        fillRandom(data.begin(), data.end(), 2000);
+
+        BlockwiseConvolutionOptions<3> opt;
+        opt.setStdDev(TinyVector<double, 3>(1.5));
+        opt.blockShape(Shape(16));
+        opt.numThreads(ParallelOptions::Nice);
+        opt.keepScratchMemory();
+        should(opt.getScratchArenas() != 0);
+
+        MultiArray<3, TinyVector<float, 6> > hessian(shape);
+        MultiArray<3, TinyVector<float, 3> > eigenvalues(shape);
+        hessianOfGaussianMultiArray(data, hessian, 1.5);
+        tensorEigenvaluesMultiArray(hessian, eigenvalues);
+        Array res(eigenvalues.bindElementChannel(0)), resB(shape);
+        hessianOfGaussianFirstEigenvalueMultiArray(data, resB, opt);
+        // blocks see a slightly truncated kernel support, hence the tolerance
+        shouldEqualSequenceTolerance(res.begin(), res.end(), resB.begin(), 1e-2);
+
+        // the scratch memory was allocated during the first call and is reused afterwards
+        ScratchArenaPool & arenas = *opt.getScratchArenas();
+        shouldEqual(arenas.size(), (std::size_t)opt.getActualNumThreads());
+        std::vector<std::size_t> allocations;
+        for(std::size_t k = 0; k < arenas.size(); ++k)
+        {
+            should(arenas[k].systemAllocations() <= 8);
+            allocations.push_back(arenas[k].systemAllocations());
+        }
+
+        Array resC(shape);
+        hessianOfGaussianFirstEigenvalueMultiArray(data, resC, opt);
+        shouldEqualSequence(resB.begin(), resB.end(), resC.begin());
+        for(std::size_t k = 0; k < arenas.size(); ++k)
+            shouldEqual(arenas[k].systemAllocations(), allocations[k]);
+        should(ScratchArena::current() == 0);
+
+        // allocations are aligned, with and without an active arena
+        ScratchArena arena(100);
+        {
+            ScratchArena::Scope scope(arena);
+            MultiArray<1, char, ScratchAllocator<char> > a(Shape1(3)), b(Shape1(1000));
+            shouldEqual((std::size_t)a.data() % ScratchArena::alignment, 0u);
+            shouldEqual((std::size_t)b.data() % ScratchArena::alignment, 0u);
+        }
+        MultiArray<1, char, ScratchAllocator<char> > c(Shape1(5));
+        shouldEqual((std::size_t)c.data() % ScratchArena::alignment, 0u);
+    }
+
+    void testPipelinedTasks()
+    {
+        typedef MultiArray<2, float> Array;
+        typedef MultiBlocking<2, MultiArrayIndex> Blocking;
+        typedef Blocking::Shape Shape;
+        typedef Blocking::BlockWithBorder BlockWithBorder;
+
+        Shape shape(123, 101);
+        Array data(shape);
+        fillRandom(data.begin(), data.end(), 2000);
+
+        BlockwiseConvolutionOptions<2> opt;
+        opt.setStdDev(TinyVector<double, 2>(1.5));
+        opt.blockShape(Shape(16, 12));
+        opt.numThreads(4);
+
+        // two separate blockwise passes
+        Array smoothed(shape), gradmag(shape);
+        gaussianSmoothMultiArray(data, smoothed, opt);
+        gaussianGradientMagnitudeMultiArray(smoothed, gradmag, opt);
+
+        // the same passes as one task graph, the second stage starts per block
+        // as soon as the first stage has finished the blocks covering its border
+        const Blocking blocking(shape, opt.getBlockShapeN<2>());
+        const Shape border1 = blockwise::getBorder(opt, 0, false);
+        const Shape border2 = blockwise::getBorder(opt, 1, false);
+        BlockwiseConvolutionOptions<2> subOpt(opt);
+        subOpt.subarray(Shape(0), Shape(0));
+        blockwise::GaussianSmoothFunctor<2> smooth(subOpt);
+        blockwise::GaussianGradientMagnitudeFunctor<2> gradient(subOpt);
+
+        Array smoothedT(shape), gradmagT(shape);
+        VIGRA_SHARED_PTR<ScratchArenaPool> arenas = blockwise::scratchArenas(opt);
+        TaskGraph graph;
+        std::vector<TaskGraph::TaskId> stage1 =
+            blockwise::addBlockwiseFilterTasks(graph, data, smoothedT, smooth, blocking, border1, arenas);
+        std::vector<TaskGraph::TaskId> stage2 =
+            blockwise::addBlockwiseFilterTasks(graph, smoothedT, gradmagT, gradient, blocking, border2, arenas, stage1);
+
+        // check that the input of every block of the third stage is complete when it starts
+        threading::atomic_long violations;
+        violations.store(0);
+        std::vector<TaskGraph::TaskId> stage3 =
+            blockwise::addBlockwiseTasks(graph, blocking, Shape(20),
+                [&](int, BlockWithBorder const & bwb)
+                {
+                    Blocking::BlockWithBorderIter b = blocking.blockWithBorderBegin(Shape(0)),
+                                                  bend = blocking.blockWithBorderEnd(Shape(0));
+                    for(int k=0; b != bend; ++b, ++k)
+                    {
+                        if((*b).core().intersects(bwb.border()) &&
+                            gradmagT.subarray((*b).core().begin(), (*b).core().end()) !=
+                                gradmag.subarray((*b).core().begin(), (*b).core().end()))
+                            ++violations;
+                    }
+                }, stage2);
+
+        shouldEqual(graph.size(), 3*blocking.numBlocks());
+        shouldEqual(stage3.size(), blocking.numBlocks());
+        graph.run(opt);
+
+        shouldEqual(violations.load(), 0);
+        shouldEqualSequence(smoothed.begin(), smoothed.end(), smoothedT.begin());
+        shouldEqualSequence(gradmag.begin(), gradmag.end(), gradmagT.begin());
+    }
 };
 
 struct BlockwiseConvolutionTestSuite
@@ -115,6 +434,11 @@ struct BlockwiseConvolutionTestSuite
         add(testCase(&BlockwiseConvolutionTest::simpleTest));
         add(testCase(&BlockwiseConvolutionTest::chunkedTest));
         add(testCase(&BlockwiseConvolutionTest::testParallel));
+        add(testCase(&BlockwiseConvolutionTest::testScratchMemory));
+        add(testCase(&BlockwiseConvolutionTest::testChunkedFilters));
+        add(testCase(&BlockwiseConvolutionTest::testFilterBank));
+        add(testCase(&BlockwiseConvolutionTest::testGaussianPyramid));
+        add(testCase(&BlockwiseConvolutionTest::testPipelinedTasks));
     }
 };
 
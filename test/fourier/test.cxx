@@ -45,6 +45,7 @@
 #include <vigra/inspectimage.hxx>
 #include <vigra/gaborfilter.hxx>
 #include <vigra/multi_fft.hxx>
+#include <vigra/multi_fft_blockwise.hxx>
 #include <vigra/multi_pointoperators.hxx>
 #include <vigra/convolution.hxx>
 #include "test.hxx"
@@ -691,6 +692,118 @@ struct MultiFFTTest
         shouldEqualSequenceTolerance(out2.data(), out2.data()+out2.size(),
                                      out4.data(), 1e-15);
     }
+
+    void testPlanCache()
+    {
+        typedef FFTWPlanCache<double> Cache;
+
+        DArray2 in(Shape2(30, 20)), out(in.shape()), ref(in.shape());
+        for(int k=0; k<in.size(); ++k)
+            in[k] = (k * 37) % 11;
+        DArray2 kernel(Shape2(5, 5), 1.0 / 25.0);
+
+        Cache::clear();
+        should(Cache::isEnabled());
+        convolveFFT(in, kernel, ref);
+        std::size_t plans = Cache::size();
+        should(plans > 0);
+
+        // equivalent plans are reused
+        convolveFFT(in, kernel, out);
+        shouldEqual(plans, Cache::size());
+        shouldEqualSequence(out.begin(), out.end(), ref.begin());
+
+        Cache::enable(false);
+        convolveFFT(in, kernel, out);
+        shouldEqual(plans, Cache::size());
+        shouldEqualSequenceTolerance(out.begin(), out.end(), ref.begin(), 1e-14);
+        Cache::enable(true);
+
+        Cache::setNumberOfThreads(2);
+        shouldEqual(2, Cache::numberOfThreads());
+        convolveFFT(in, kernel, out);
+        shouldEqualSequenceTolerance(out.begin(), out.end(), ref.begin(), 1e-14);
+        Cache::setNumberOfThreads(1);
+
+        should(Cache::exportWisdom("fftw.wisdom"));
+        should(Cache::importWisdom("fftw.wisdom"));
+        should(!Cache::importWisdom("no_such_file.wisdom"));
+
+        Cache::clear();
+        shouldEqual(0u, Cache::size());
+
+        // a full cache evicts the least recently used plan that is not in use
+        shouldEqual(64u, Cache::capacity());
+        Cache::setCapacity(2);
+        typedef MultiArray<2, FFTWComplex<double> > CArray2;
+        CArray2 c1(Shape2(8, 6)), c2(Shape2(10, 6)), c3(Shape2(12, 6)), cout(Shape2(12, 6));
+        c1 = FFTWComplex<double>(1.0);
+        {
+            FFTWPlan<2, double> inUse(c1, c1, FFTW_FORWARD);
+            FFTWPlan<2, double>(c2, c2, FFTW_FORWARD);
+            shouldEqual(2u, Cache::size());
+            FFTWPlan<2, double>(c3, c3, FFTW_FORWARD); // evicts the c2 plan
+            shouldEqual(2u, Cache::size());
+            FFTWPlan<2, double>(c2, c2, FFTW_FORWARD); // evicts the c3 plan
+            shouldEqual(2u, Cache::size());
+
+            // the plan in use survives eviction
+            Cache::clear();
+            shouldEqual(1u, Cache::size());
+            inUse.execute(c1, c1);
+            shouldEqualTolerance(c1(0,0).re(), 48.0, 1e-12);
+            shouldEqualTolerance(abs(c1(1,0)), 0.0, 1e-12);
+
+            // when all plans are in use, new plans are not cached
+            Cache::setCapacity(1);
+            FFTWPlan<2, double> uncached(c3, cout, FFTW_FORWARD);
+            shouldEqual(1u, Cache::size());
+            c3 = FFTWComplex<double>(1.0);
+            uncached.execute(c3, cout);
+            shouldEqualTolerance(cout(0,0).re(), 72.0, 1e-12);
+            shouldEqualTolerance(abs(cout(1,0)), 0.0, 1e-12);
+
+            // reducing the capacity releases plans in use when they are destroyed
+            Cache::setCapacity(0);
+            shouldEqual(1u, Cache::size());
+        }
+        shouldEqual(0u, Cache::size());
+
+        Cache::setCapacity(64);
+        convolveFFT(in, kernel, out);
+        shouldEqualSequence(out.begin(), out.end(), ref.begin());
+        should(Cache::size() > 0);
+        Cache::clear();
+    }
+
+    void testConvolveFFTBlockwise()
+    {
+        DArray2 in(Shape2(37, 29)), ref(in.shape()), out(in.shape());
+        for(int k=0; k<in.size(); ++k)
+            in[k] = (k * 7919) % 113 / 10.0;
+        DArray2 kernel(Shape2(5, 4));
+        for(int k=0; k<kernel.size(); ++k)
+            kernel[k] = (k * 31) % 7 / 5.0;
+
+        convolveFFT(in, kernel, ref);
+
+        convolveFFTBlockwise(in, kernel, out,
+                             BlockwiseOptions().blockShape(Shape2(8, 6)).numThreads(3));
+        shouldEqualSequenceTolerance(out.begin(), out.end(), ref.begin(), 1e-12);
+
+        // block larger than the array
+        out = 0.0;
+        convolveFFTBlockwise(in, kernel, out, BlockwiseOptions().blockShape(Shape2(64)));
+        shouldEqualSequenceTolerance(out.begin(), out.end(), ref.begin(), 1e-12);
+
+        ChunkedArrayLazy<2, double> cin(in.shape(), Shape2(8)), cout(in.shape(), Shape2(8));
+        cin.commitSubarray(Shape2(), in);
+        convolveFFTBlockwise(cin, kernel, cout,
+                             BlockwiseOptions().blockShape(Shape2(8)).numThreads(2));
+        out = 0.0;
+        cout.checkoutSubarray(Shape2(), out);
+        shouldEqualSequenceTolerance(out.begin(), out.end(), ref.begin(), 1e-12);
+    }
 };
 
 struct FFTWTestSuite
@@ -715,6 +828,8 @@ struct FFTWTestSuite
         add( testCase(&MultiFFTTest::testConvolveFFT));
         add( testCase(&MultiFFTTest::testConvolveFFTComplex));
         add( testCase(&MultiFFTTest::testConvolveFourierKernel));
+        add( testCase(&MultiFFTTest::testPlanCache));
+        add( testCase(&MultiFFTTest::testConvolveFFTBlockwise));
     }
 };
 
@@ -40,6 +40,8 @@
 #include <vigra/multi_array.hxx>
 #include <vigra/multi_gridgraph.hxx>
 #include <vigra/multi_localminmax.hxx>
+#include <vigra/multi_watersheds.hxx>
+#include <vigra/random.hxx>
 #include <vigra/algorithm.hxx>
 
 #ifdef WITH_BOOST_GRAPH
@@ -1215,6 +1217,99 @@ struct GridGraphAlgorithmTests
 
         shouldEqualSequence(src.begin(), src.end(), dest.begin());
     }
+
+    template <NeighborhoodType NType>
+    void testGridGraphScan()
+    {
+        typedef GridGraph<N, undirected_tag> Graph;
+
+        for(int size=1; size<6; ++size)
+        {
+            Shape shape(size);
+            shape[0] = size + 1;
+            Graph g(shape, NType);
+            MultiArray<N, int> visited(shape);
+            MultiArrayIndex next = 0;
+            bool scanOrder = true;
+
+            gridGraphScan(g,
+                [&](Shape const & start, MultiArrayIndex length)
+                {
+                    Shape p(start);
+                    for(MultiArrayIndex k=0; k<length; ++k, ++p[0])
+                    {
+                        scanOrder = scanOrder && (visited.scanOrderIndexToCoordinate(next++) == p);
+                        // interior nodes have all neighbors
+                        for(int j=0; j<g.maxDegree(); ++j)
+                            scanOrder = scanOrder && isInside(g, p + g.neighborOffset(j));
+                        visited[p] += 1;
+                    }
+                },
+                [&](Shape const & p)
+                {
+                    scanOrder = scanOrder && (visited.scanOrderIndexToCoordinate(next++) == p);
+                    scanOrder = scanOrder && (!allGreater(p, Shape()) || !allLess(p, shape - Shape(1)));
+                    visited[p] += 1;
+                });
+
+            should(scanOrder);
+            shouldEqual(next, visited.size());
+            int minVisits = 0, maxVisits = 0;
+            visited.minmax(&minVisits, &maxVisits);
+            shouldEqual(minVisits, 1);
+            shouldEqual(maxVisits, 1);
+        }
+    }
+
+    template <NeighborhoodType NType>
+    void testInteriorFastPaths()
+    {
+        typedef GridGraph<N, undirected_tag> Graph;
+
+        Shape shape(7);
+        shape[0] = 9;
+        Graph g(shape, NType);
+
+        // generic maps select the neighbor iterator code path,
+        // MultiArrayViews the interior/border split
+        typename Graph::template NodeMap<int> data(g), generic(g);
+        MultiArray<N, int> fast(shape);
+        MultiArrayView<N, int> dataView(data), fastView(fast);
+
+        RandomMT19937 random(42);
+        for(int k=0; k<data.size(); ++k)
+            data[k] = random.uniformInt(4);
+
+        lemon_graph::labelGraph(g, data, generic, std::equal_to<int>());
+        lemon_graph::labelGraph(g, dataView, fastView, std::equal_to<int>());
+        should(generic == fast);
+
+        generic.init(0);
+        fast.init(0);
+        lemon_graph::labelGraphWithBackground(g, data, generic, 0, std::equal_to<int>());
+        lemon_graph::labelGraphWithBackground(g, dataView, fastView, 0, std::equal_to<int>());
+        should(generic == fast);
+
+        for(int k=0; k<data.size(); ++k)
+            data[k] = random.uniformInt(1000);
+
+        for(int border=0; border<2; ++border)
+        {
+            generic.init(0);
+            fast.init(0);
+            shouldEqual(lemon_graph::localMinMaxGraph(g, data, generic, 1, 1000, std::less<int>(), border == 1),
+                        lemon_graph::localMinMaxGraph(g, dataView, fastView, 1, 1000, std::less<int>(), border == 1));
+            should(generic == fast);
+        }
+
+        generic.init(0);
+        fast.init(0);
+        WatershedOptions options;
+        options.unionFind();
+        shouldEqual(lemon_graph::watershedsGraph(g, data, generic, options),
+                    lemon_graph::watershedsGraph(g, dataView, fastView, options));
+        should(generic == fast);
+    }
 };
 
 template <unsigned int N>
@@ -1275,6 +1370,10 @@ struct GridgraphTestSuiteN
         add(testCase((&GridGraphTests<N>::template testArcIterator<undirected_tag, DirectNeighborhood>)));
 
         add(testCase((&GridGraphAlgorithmTests<N>::template testLocalMinMax<undirected_tag, DirectNeighborhood>)));
+        add(testCase((&GridGraphAlgorithmTests<N>::template testGridGraphScan<DirectNeighborhood>)));
+        add(testCase((&GridGraphAlgorithmTests<N>::template testGridGraphScan<IndirectNeighborhood>)));
+        add(testCase((&GridGraphAlgorithmTests<N>::template testInteriorFastPaths<DirectNeighborhood>)));
+        add(testCase((&GridGraphAlgorithmTests<N>::template testInteriorFastPaths<IndirectNeighborhood>)));
     }
 };
 
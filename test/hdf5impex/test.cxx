@@ -43,6 +43,8 @@
 #include "vigra/hdf5impex.hxx"
 #include "vigra/multi_array.hxx"
 #include "vigra/multi_impex.hxx"
+#include "vigra/multi_array_chunked_hdf5.hxx"
+#include "vigra/threadpool.hxx"
 
 using namespace vigra;
 
@@ -934,6 +936,147 @@ public:
 
 
 
+    void testHDF5FileChunkCache()
+    {
+        std::string file_name( "testfile_HDF5File_chunk_cache.hdf5");
+
+        MultiArray<3, float> out_data(Shape3(30, 20, 10));
+        linearSequence(out_data.begin(), out_data.end());
+
+        HDF5File file (file_name, HDF5File::New);
+        file.write("/compressed", out_data, Shape3(8, 8, 4), 5);
+
+        // default settings
+        should(!file.hasChunkCache("/compressed"));
+        shouldEqual(file.getChunkCacheSize("/compressed"), 0u);
+        size_t slots = 0, bytes = 0;
+        double w0 = 0.0;
+        {
+            HDF5HandleShared dataset = file.getDatasetHandleShared("/compressed");
+            HDF5Handle access(H5Dget_access_plist(dataset), &H5Pclose, "no access plist");
+            H5Pget_chunk_cache(access, &slots, &bytes, &w0);
+            should(bytes != 8u << 20);
+        }
+
+        file.setChunkCache("compressed", 8 << 20, 1009, 1.0);
+        shouldEqual(file.getChunkCacheSize("/compressed"), 8u << 20);
+        {
+            HDF5HandleShared dataset = file.getDatasetHandleShared("/compressed");
+            HDF5Handle access(H5Dget_access_plist(dataset), &H5Pclose, "no access plist");
+            H5Pget_chunk_cache(access, &slots, &bytes, &w0);
+            shouldEqual(slots, 1009u);
+            shouldEqual(bytes, 8u << 20);
+            shouldEqual(w0, 1.0);
+        }
+
+        // settings are inherited by copies
+        HDF5File copy(file);
+        shouldEqual(copy.getChunkCacheSize("/compressed"), 8u << 20);
+
+        // read several blocks through a single dataset handle
+        ArrayVector<Shape3> offsets;
+        ArrayVector<MultiArrayView<3, float> > blocks;
+        MultiArray<3, float> in_data(out_data.shape());
+        for(int z = 0; z < 10; z += 5)
+            for(int y = 0; y < 20; y += 7)
+                for(int x = 0; x < 30; x += 11)
+                {
+                    Shape3 start(x, y, z),
+                           stop(min(Shape3(x+11, y+7, z+5), out_data.shape()));
+                    offsets.push_back(start);
+                    blocks.push_back(in_data.subarray(start, stop));
+                }
+        file.readBlocks("/compressed", offsets, blocks);
+        should(in_data == out_data);
+
+        // strided targets
+        MultiArray<3, float> transposed(reverse(out_data.shape()));
+        offsets.clear();
+        blocks.clear();
+        offsets.push_back(Shape3(0, 0, 0));
+        blocks.push_back(transposed.transpose().subarray(Shape3(0), Shape3(30, 20, 5)));
+        offsets.push_back(Shape3(0, 0, 5));
+        blocks.push_back(transposed.transpose().subarray(Shape3(0, 0, 5), Shape3(30, 20, 10)));
+        file.readBlocks("/compressed", offsets, blocks);
+        should(transposed.transpose() == out_data);
+
+        // ChunkedArrayHDF5 configures the chunk cache when the file's
+        // chunks don't match the array's chunks
+        file.write("/misaligned", out_data, Shape3(10, 10, 5), 5);
+        {
+            ChunkedArrayHDF5<3, float> chunked(file, "/misaligned");
+            shouldEqual(chunked.chunkShape(), Shape3(16, 16, 8));
+            shouldEqualSequence(chunked.cbegin(), chunked.cend(), out_data.begin());
+            // an array chunk overlaps at most 3x2x2 file chunks of 2000 bytes,
+            // the cache has the minimal size and a prime number of slots >= 100*12
+            shouldEqual(chunked.file_.getChunkCacheSize("/misaligned"), 1u << 20);
+            shouldEqual(chunked.file_.getChunkCacheSlots("/misaligned"), 1201u);
+            HDF5HandleShared dataset = chunked.file_.getDatasetHandleShared("/misaligned");
+            HDF5Handle access(H5Dget_access_plist(dataset), &H5Pclose, "no access plist");
+            H5Pget_chunk_cache(access, &slots, &bytes, &w0);
+            shouldEqual(slots, 1201u);
+            shouldEqual(bytes, 1u << 20);
+        }
+        should(!file.hasChunkCache("/misaligned"));
+
+        // an explicitly disabled cache is respected
+        file.setChunkCache("/misaligned", 0);
+        should(file.hasChunkCache("/misaligned"));
+        {
+            ChunkedArrayHDF5<3, float> chunked(file, "/misaligned");
+            shouldEqual(chunked.file_.getChunkCacheSize("/misaligned"), 0u);
+            shouldEqual(chunked.file_.getChunkCacheSlots("/misaligned"), 10007u);
+            HDF5HandleShared dataset = chunked.file_.getDatasetHandleShared("/misaligned");
+            HDF5Handle access(H5Dget_access_plist(dataset), &H5Pclose, "no access plist");
+            H5Pget_chunk_cache(access, &slots, &bytes, &w0);
+            shouldEqual(bytes, 0u);
+            shouldEqualSequence(chunked.cbegin(), chunked.cend(), out_data.begin());
+        }
+
+        try
+        {
+            offsets.pop_back();
+            file.readBlocks("/compressed", offsets, blocks);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation & e)
+        {
+            std::string expected("\nPrecondition violation!\nHDF5File::readBlocks(): need as many block offsets as blocks.");
+            shouldEqual(std::string(e.what()).substr(0, expected.size()), expected);
+        }
+    }
+
+    void testChunkedArrayHDF5Threads()
+    {
+        // several arrays in the same file are used concurrently, and their
+        // small caches force chunks to be written back and read again
+        std::string file_name( "testfile_ChunkedArrayHDF5_threads.hdf5");
+        HDF5File file (file_name, HDF5File::New);
+
+        int const n = 8;
+        MultiArray<3, float> data(Shape3(40, 30, 20));
+        linearSequence(data.begin(), data.end());
+
+        parallel_foreach(4, n,
+            [&](size_t /*thread_id*/, int k)
+            {
+                std::string name = "/array" + asString(k);
+                MultiArray<3, float> expected(data), result(data.shape());
+                expected += (float)k;
+                {
+                    ChunkedArrayHDF5<3, float> array(file, name, HDF5File::New, data.shape(), Shape3(8),
+                                                     ChunkedArrayOptions().cacheMax(2));
+                    array.commitSubarray(Shape3(0), expected);
+                    array.checkoutSubarray(Shape3(0), result);
+                    should(result == expected);
+                }
+                ChunkedArrayHDF5<3, float> array(file, name, HDF5File::ReadOnly);
+                result = 0.0f;
+                array.checkoutSubarray(Shape3(0), result);
+                should(result == expected);
+            });
+    }
+
     void testHDF5FileChunks()
     {
         //write some data and read it again. Only spot test general functionality.
@@ -1405,6 +1548,8 @@ struct HDF5ImportExportTestSuite : public vigra::test_suite
         add(testCase(&HDF5ExportImportTest::testHDF5FileDataAccess));
         add(testCase(&HDF5ExportImportTest::testHDF5FileBlockAccess));
         add(testCase(&HDF5ExportImportTest::testHDF5FileChunks));
+        add(testCase(&HDF5ExportImportTest::testHDF5FileChunkCache));
+        add(testCase(&HDF5ExportImportTest::testChunkedArrayHDF5Threads));
         add(testCase(&HDF5ExportImportTest::testHDF5FileCompression));
         add(testCase(&HDF5ExportImportTest::testHDF5FileBrowsing));
         add(testCase(&HDF5ExportImportTest::testHDF5FileAttributes));
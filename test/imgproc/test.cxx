@@ -44,6 +44,8 @@
 #include "vigra/splineimageview.hxx"
 #include "vigra/basicgeometry.hxx"
 #include "vigra/affinegeometry.hxx"
+#include "vigra/multi_splineview.hxx"
+#include "vigra/random.hxx"
 #include "vigra/impex.hxx"
 #include "vigra/meshgrid.hxx"
 #include "vigra/multi_array.hxx"
@@ -1581,6 +1583,68 @@ struct SplineImageViewTest
         (void)view(4.5, 1.3);
     }
 
+    void testBatchEvaluation()
+    {
+        typedef TinyVector<double, 2> Point;
+
+        SplineImageView<N, double> view(srcImageRange(img));
+        int w = view.width(), h = view.height();
+
+        // points inside, near the border, and in the first reflection
+        MultiArray<1, Point> points(Shape1(300));
+        RandomMT19937 random;
+        for(int k=0; k<points.size(); ++k)
+            points(k) = Point(1.5*w*random.uniform() - 0.25*w, 1.5*h*random.uniform() - 0.25*h);
+        points(0) = Point(0.0, 0.0);
+        points(1) = Point(w - 1.0, h - 1.0);
+        points(2) = Point(10.0, 20.5);
+
+        MultiArray<1, double> values(points.shape()), dx(points.shape()), dy(points.shape()),
+                              dxy(points.shape());
+        view.evaluate(points, values);
+        view.evaluate(points, dxy, 1, 1);
+        // (derivatives are computed in a different way, hence the absolute tolerance)
+        for(int k=0; k<points.size(); ++k)
+        {
+            shouldEqualTolerance(values(k), view(points(k)[0], points(k)[1]), 1e-12);
+            shouldEqualTolerance(dxy(k) - view(points(k)[0], points(k)[1], 1, 1), 0.0, 1e-8);
+        }
+
+        view.evaluate(points, values, dx, dy);
+        for(int k=0; k<points.size(); ++k)
+        {
+            shouldEqualTolerance(values(k), view(points(k)[0], points(k)[1]), 1e-12);
+            shouldEqualTolerance(dx(k) - view.dx(points(k)[0], points(k)[1]), 0.0, 1e-8);
+            shouldEqualTolerance(dy(k) - view.dy(points(k)[0], points(k)[1]), 0.0, 1e-8);
+        }
+
+        // the N-dimensional view agrees with SplineImageView
+        MultiArrayView<2, double> data(Shape2(w, h), &img(0,0));
+        SplineMultiArrayView<2, N, double> view2(data);
+        MultiArray<1, TinyVector<double, 2> > gradients(points.shape());
+        view2.evaluate(points, dxy);
+        view2.evaluate(points, dx, gradients);
+        for(int k=0; k<points.size(); ++k)
+        {
+            shouldEqualTolerance(dxy(k), values(k), 1e-10);
+            shouldEqualTolerance(dx(k), values(k), 1e-10);
+            // the derivatives of linear splines are discontinuous at the last pixel
+            if(N > 1 || k != 1)
+            {
+                shouldEqualTolerance(gradients(k)[0] - view.dx(points(k)[0], points(k)[1]), 0.0, 1e-8);
+                shouldEqualTolerance(gradients(k)[1] - view.dy(points(k)[0], points(k)[1]), 0.0, 1e-8);
+            }
+        }
+
+        try
+        {
+            points(3) = Point(2.0*w, 0.0);
+            view.evaluate(points, values);
+            failTest("Out-of-range coordinate failed to throw exception");
+        }
+        catch(vigra::PreconditionViolation) {}
+    }
+
 };
 
 struct GeometricTransformsTest
@@ -1737,6 +1801,97 @@ struct GeometricTransformsTest
         shouldEqualSequenceTolerance(res1.begin(), res1.end(), ref.begin(), 1e-12);
     }
 
+    void testParallelWarp()
+    {
+        Image ref(img.size());
+        importImage(vigra::ImageImportInfo("lenna_rotate.xv"), destImage(ref));
+        MultiArrayView<2, double> refView(Shape2(w, h), &ref(0,0));
+
+        SplineImageView<3, double> sp(srcImageRange(img));
+        TinyVector<double, 2> center((w-1.0)/2.0, (h-1.0)/2.0);
+
+        MultiArray<2, double> res(Shape2(w, h));
+        rotateImage(sp, res, 45.0, ParallelOptions().numThreads(4));
+        shouldEqualSequenceTolerance(res.begin(), res.end(), refView.begin(), 1e-10);
+
+        res.init(0.0);
+        affineWarpImage(sp, res, rotationMatrix2DDegrees(45.0, center), ParallelOptions().numThreads(3));
+        shouldEqualSequenceTolerance(res.begin(), res.end(), refView.begin(), 1e-10);
+
+        // a general coordinate map
+        Matrix<double> rotation = rotationMatrix2DDegrees(45.0, center);
+        MultiArray<2, TinyVector<double, 2> > coordinates(Shape2(w, h));
+        for(int y=0; y<h; ++y)
+            for(int x=0; x<w; ++x)
+                coordinates(x, y) = TinyVector<double, 2>(x*rotation(0,0) + y*rotation(0,1) + rotation(0,2),
+                                                          x*rotation(1,0) + y*rotation(1,1) + rotation(1,2));
+        res.init(0.0);
+        coordinateWarpImage(sp, coordinates, res, ParallelOptions().numThreads(2));
+        shouldEqualSequenceTolerance(res.begin(), res.end(), refView.begin(), 1e-10);
+
+        // the N-dimensional warps agree for 2D
+        SplineMultiArrayView<2, 3, double> sp2(MultiArrayView<2, double>(Shape2(w, h), &img(0,0)));
+        res.init(0.0);
+        affineWarpMultiArray(sp2, res, rotation, ParallelOptions().numThreads(2));
+        shouldEqualSequenceTolerance(res.begin(), res.end(), refView.begin(), 1e-10);
+        res.init(0.0);
+        coordinateWarpMultiArray(sp2, coordinates, res);
+        shouldEqualSequenceTolerance(res.begin(), res.end(), refView.begin(), 1e-10);
+    }
+
+    void testWarp3D()
+    {
+        typedef TinyVector<double, 3> Point;
+
+        // cubic splines reproduce linear functions away from the border
+        MultiArray<3, double> volume(Shape3(30, 28, 26));
+        for(auto i = volume.begin(); i != volume.end(); ++i)
+        {
+            Shape3 p = i.point();
+            *i = 2.0*p[0] + 3.0*p[1] - p[2];
+        }
+        SplineMultiArrayView<3, 3, double> spline(volume);
+        shouldEqualTolerance(spline(Point(4.0, 5.0, 6.0)), volume(4, 5, 6), 1e-12);
+        shouldEqualTolerance(spline(Point(14.3, 13.6, 12.2)), 2.0*14.3 + 3.0*13.6 - 12.2, 1e-4);
+        shouldEqualTolerance(spline(Point(14.3, 13.6, 12.2), TinyVector<unsigned int, 3>(0, 1, 0)), 3.0, 1e-4);
+
+        MultiArray<1, Point> points(Shape1(2));
+        points(0) = Point(14.3, 13.6, 12.2);
+        points(1) = Point(15.8, 12.1, 13.5);
+        MultiArray<1, double> values(points.shape());
+        MultiArray<1, TinyVector<double, 3> > gradients(points.shape());
+        spline.evaluate(points, values, gradients);
+        for(int k=0; k<2; ++k)
+        {
+            shouldEqualTolerance(values(k), spline(points(k)), 1e-12);
+            shouldEqualTolerance(gradients(k)[0], 2.0, 1e-4);
+            shouldEqualTolerance(gradients(k)[1], 3.0, 1e-4);
+            shouldEqualTolerance(gradients(k)[2], -1.0, 1e-4);
+        }
+
+        // translation
+        Matrix<double> shift(identityMatrix<double>(4));
+        shift(0, 3) = 2.0;
+        shift(2, 3) = -1.0;
+        MultiArray<3, double> warped(volume.shape()), mapped(volume.shape());
+        affineWarpMultiArray(spline, warped, shift, ParallelOptions().numThreads(4));
+        MultiArray<3, Point> coordinates(volume.shape());
+        for(auto i = coordinates.begin(); i != coordinates.end(); ++i)
+            *i = Point(i.point()) + Point(2.0, 0.0, -1.0);
+        coordinateWarpMultiArray(spline, coordinates, mapped, ParallelOptions().numThreads(2));
+
+        for(int z=1; z<26; ++z)
+            for(int y=0; y<28; ++y)
+                for(int x=0; x<28; ++x)
+                {
+                    shouldEqualTolerance(warped(x, y, z), spline(Point(x+2.0, y, z-1.0)), 1e-12);
+                    shouldEqual(mapped(x, y, z), warped(x, y, z));
+                }
+        // points outside the source are not written
+        shouldEqual(warped(29, 0, 5), 0.0);
+        shouldEqual(warped(0, 0, 0), 0.0);
+    }
+
     void testScaling()
     {
         Image res(2*w-1, 2*h-1), ref(2*w-1, 2*h-1);
@@ -1803,28 +1958,35 @@ struct ImageFunctionsTestSuite
         add( testCase( &SplineImageViewTest<0>::testCoefficientArray));
         add( testCase( &SplineImageViewTest<0>::testImageResize0));
         add( testCase( &SplineImageViewTest<0>::testOutside));
+        add( testCase( &SplineImageViewTest<0>::testBatchEvaluation));
         add( testCase( &SplineImageViewTest<1>::testPSF));
         add( testCase( &SplineImageViewTest<1>::testCoefficientArray));
         add( testCase( &SplineImageViewTest<1>::testImageResize1));
         add( testCase( &SplineImageViewTest<1>::testOutside));
+        add( testCase( &SplineImageViewTest<1>::testBatchEvaluation));
         add( testCase( &SplineImageViewTest<2>::testPSF));
         add( testCase( &SplineImageViewTest<2>::testCoefficientArray));
         add( testCase( &SplineImageViewTest<2>::testImageResize));
         add( testCase( &SplineImageViewTest<2>::testOutside));
+        add( testCase( &SplineImageViewTest<2>::testBatchEvaluation));
         add( testCase( &SplineImageViewTest<3>::testPSF));
         add( testCase( &SplineImageViewTest<3>::testCoefficientArray));
         add( testCase( &SplineImageViewTest<3>::testImageResize));
         add( testCase( &SplineImageViewTest<3>::testOutside));
+        add( testCase( &SplineImageViewTest<3>::testBatchEvaluation));
         add( testCase( &SplineImageViewTest<5>::testPSF));
         add( testCase( &SplineImageViewTest<5>::testCoefficientArray));
         add( testCase( &SplineImageViewTest<5>::testImageResize));
         add( testCase( &SplineImageViewTest<5>::testOutside));
+        add( testCase( &SplineImageViewTest<5>::testBatchEvaluation));
         add( testCase( &SplineImageViewTest<5>::testVectorSIV));
 
         add( testCase( &GeometricTransformsTest::testSimpleGeometry));
         add( testCase( &GeometricTransformsTest::testAffineMatrix));
         add( testCase( &GeometricTransformsTest::testRotation));
         add( testCase( &GeometricTransformsTest::testScaling));
+        add( testCase( &GeometricTransformsTest::testParallelWarp));
+        add( testCase( &GeometricTransformsTest::testWarp3D));
     }
 };
 
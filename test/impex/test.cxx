@@ -41,6 +41,7 @@
 #include "vigra/impexalpha.hxx"
 #include "vigra/unittest.hxx"
 #include "vigra/multi_array.hxx"
+#include "vigra/multi_array_chunked.hxx"
 
 #if HasTIFF
 # include "vigra/tiff.hxx"
@@ -133,6 +134,30 @@ public:
         should(!isImage("filename-does-not-exist.gif"));
     }
 
+    void testReadRegion()
+    {
+        View ref(img);
+        MultiArray<2, unsigned char> roi(Shape2(40, 30));
+
+        // default implementation via the scanline interface
+        VIGRA_UNIQUE_PTR<Decoder> dec = getDecoder("lenna.xv");
+        should(!dec->canReadRegion());
+        dec->readRegion(20, 10, 40, 30, roi.data());
+        shouldEqualSequence(roi.begin(), roi.end(),
+                            ref.subarray(Shape2(20, 10), Shape2(60, 40)).begin());
+
+#if defined(HasTIFF)
+        // native strip access, decoded in parallel
+        exportImage(ref, ImageExportInfo("res_roi.tif").setCompression("LZW"));
+        dec = getDecoder("res_roi.tif");
+        should(dec->canReadRegion());
+        roi.init(0);
+        dec->readRegion(20, 10, 40, 30, roi.data(), 4);
+        shouldEqualSequence(roi.begin(), roi.end(),
+                            ref.subarray(Shape2(20, 10), Shape2(60, 40)).begin());
+#endif
+    }
+
     void testFile (const char *filename);
 
     void testGIF ()
@@ -429,6 +454,99 @@ public:
         importImage (info, destImage (img));
     }
 
+    void testReadRegion ()
+    {
+        typedef MultiArrayView<2, RGBValue<UInt8> > View;
+
+        // planar files go through the default implementation
+        exportImage (srcImageRange (img), vigra::ImageExportInfo ("resroi.xv"));
+
+        View ref(img);
+        MultiArray<2, RGBValue<UInt8> > roi(Shape2(17, 23));
+        VIGRA_UNIQUE_PTR<Decoder> dec = getDecoder ("resroi.xv");
+        dec->readRegion (5, 7, 17, 23, roi.data ());
+        shouldEqualSequence (roi.begin (), roi.end (),
+                             ref.subarray (Shape2(5, 7), Shape2(22, 30)).begin ());
+    }
+
+    void testDirectImport ()
+    {
+        typedef MultiArrayView<2, RGBValue<UInt8> > View;
+        View ref(img);
+
+        // matching pixel type and contiguous memory => direct path
+        MultiArray<2, RGBValue<UInt8> > direct;
+        importImage ("lennargb.xv", direct);
+        shouldEqualSequence (direct.begin (), direct.end (), ref.begin ());
+
+        MultiArray<2, TinyVector<UInt8, 3> > vec(ref.shape ());
+        importImage (vigra::ImageImportInfo ("lennargb.xv"), vec);
+        for (int k = 0; k < 3; ++k)
+            shouldEqualSequence (vec.bindElementChannel (k).begin (), vec.bindElementChannel (k).end (),
+                                 ref.bindElementChannel (k).begin ());
+
+        // strided destination and converted pixel type => accessor path
+        MultiArray<2, RGBValue<UInt8> > transposed(reverse (ref.shape ()));
+        importImage (vigra::ImageImportInfo ("lennargb.xv"), transposed.transpose ());
+        shouldEqualSequence (transposed.transpose ().begin (), transposed.transpose ().end (), ref.begin ());
+
+        MultiArray<2, RGBValue<float> > converted;
+        importImage ("lennargb.xv", converted);
+        shouldEqual (converted (10, 20), RGBValue<float>(ref (10, 20)));
+    }
+
+    void testChunkedExport ()
+    {
+        typedef MultiArrayView<2, RGBValue<UInt8> > View;
+        View ref(img);
+
+        // chunk shape 32x32 => tiles of 32x32, image size is not a multiple thereof
+        ChunkedArrayLazy<2, RGBValue<UInt8> > chunked(ref.shape (), Shape2(32));
+        chunked.commitSubarray (Shape2(0), ref);
+
+#if defined(HasTIFF)
+        exportImage (chunked, vigra::ImageExportInfo ("reschunked.tif").setCompression ("DEFLATE"),
+                     ParallelOptions ().numThreads (4));
+
+        MultiArray<2, RGBValue<UInt8> > res;
+        importImage ("reschunked.tif", res);
+        shouldEqual (res.shape (), ref.shape ());
+        shouldEqualSequence (res.begin (), res.end (), ref.begin ());
+
+        MultiArray<2, RGBValue<UInt8> > roi(Shape2(40, 20));
+        VIGRA_UNIQUE_PTR<Decoder> dec = getDecoder ("reschunked.tif");
+        dec->readRegion (30, 50, 40, 20, roi.data ());
+        shouldEqualSequence (roi.begin (), roi.end (),
+                             ref.subarray (Shape2(30, 50), Shape2(70, 70)).begin ());
+
+        // the default compression (LZW) is encoded sequentially
+        exportImage (chunked, vigra::ImageExportInfo ("reschunked.tif"));
+        importImage ("reschunked.tif", res);
+        shouldEqualSequence (res.begin (), res.end (), ref.begin ());
+
+        // libtiff cannot encode old-style JPEG, so this falls back to no compression
+        exportImage (chunked, vigra::ImageExportInfo ("reschunked.tif").setCompression ("JPEG QUALITY=80"));
+        importImage ("reschunked.tif", res);
+        shouldEqualSequence (res.begin (), res.end (), ref.begin ());
+
+        // the scanline interface writes tiled files as well
+        exportImage (ref, vigra::ImageExportInfo ("restiled.tif").setTileSize (Size2D(48, 16)));
+        importImage ("restiled.tif", res);
+        shouldEqualSequence (res.begin (), res.end (), ref.begin ());
+#else
+        try
+        {
+            exportImage (chunked, vigra::ImageExportInfo ("reschunked.xv"));
+            failTest ("Failed to throw exception.");
+        }
+        catch (vigra::PreconditionViolation & e)
+        {
+            std::string expected = "\nPrecondition violation!\nexportImage(ChunkedArray): file type does not support tiled output.";
+            shouldEqual (std::string (e.what ()).substr (0, expected.size ()), expected);
+        }
+#endif
+    }
+
     void testFile (const char *fileName);
 
     void testGIF ()
@@ -1818,6 +1936,7 @@ struct ImageImportExportTestSuite : public vigra::test_suite
         // general tests
         add(testCase(&ByteImageExportImportTest::testListFormatsExtensions));
         add(testCase(&ByteImageExportImportTest::testIsImage));
+        add(testCase(&ByteImageExportImportTest::testReadRegion));
 
         // grayscale byte images
         add(testCase(&ByteImageExportImportTest::testGIF));
@@ -1846,6 +1965,9 @@ struct ImageImportExportTestSuite : public vigra::test_suite
         add(testCase(&ByteRGBImageExportImportTest::testSUN));
         add(testCase(&ByteRGBImageExportImportTest::testVIFF1));
         add(testCase(&ByteRGBImageExportImportTest::testVIFF2));
+        add(testCase(&ByteRGBImageExportImportTest::testReadRegion));
+        add(testCase(&ByteRGBImageExportImportTest::testDirectImport));
+        add(testCase(&ByteRGBImageExportImportTest::testChunkedExport));
 
 #if defined(HasPNG)
         // 16-bit PNG
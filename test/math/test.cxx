@@ -2644,6 +2644,76 @@ struct LinalgTest
         }
     }
 
+    void testSymmetricEigensystemBatch()
+    {
+        double epsilon = 1e-8;
+        const int n = 20;
+
+        for(int size = 2; size <= 3; ++size)
+        {
+            const int M = size*(size+1)/2;
+            vigra::ArrayVector<double> data(M*n), values(size*n), vectors(size*size*n);
+            vigra::ArrayVector<Matrix> matrices;
+            double const * a[6];
+            double * r[3], * e[9];
+            for(int c=0; c<M; ++c)
+                a[c] = &data[c*n];
+            for(int c=0; c<size; ++c)
+                r[c] = &values[c*n];
+            for(int c=0; c<size*size; ++c)
+                e[c] = &vectors[c*n];
+
+            for(int i=0; i<n; ++i)
+            {
+                Matrix m = random_symmetric_matrix(size);
+                if(i == 0)
+                    m = vigra::identityMatrix<double>(size);
+                if(i == 1)
+                    m(0,0) = 2.0*m(1,1);
+                matrices.push_back(m);
+                for(int k=0, c=0; k<size; ++k)
+                    for(int l=k; l<size; ++l, ++c)
+                        data[c*n+i] = m(k, l);
+            }
+
+            if(size == 2)
+                vigra::symmetric2x2EigensystemBatch(n, a, r, e);
+            else
+                vigra::symmetric3x3EigensystemBatch(n, a, r, e);
+
+            for(int i=0; i<n; ++i)
+            {
+                Matrix ewref(size, 1), evref(size, size), ew(size, 1), ev(size, size);
+                symmetricEigensystem(matrices[i], ewref, evref);
+                for(int k=0; k<size; ++k)
+                {
+                    ew(k, 0) = r[k][i];
+                    for(int l=0; l<size; ++l)
+                        ev(l, k) = e[k*size+l][i];
+                }
+                shouldEqualSequenceTolerance(ew.data(), ew.data()+size, ewref.data(), epsilon);
+                Matrix id = transpose(ev) * ev;
+                Matrix idref = vigra::identityMatrix<double>(size);
+                shouldEqualSequenceTolerance(id.data(), id.data()+size*size, idref.data(), epsilon);
+                Matrix ae = ev * diagonalMatrix(ew) * transpose(ev);
+                shouldEqualSequenceTolerance(ae.data(), ae.data()+size*size, matrices[i].data(), epsilon);
+            }
+
+            values.init(0.0);
+            if(size == 2)
+                vigra::symmetric2x2EigenvaluesBatch(n, a, r);
+            else
+                vigra::symmetric3x3EigenvaluesBatch(n, a, r);
+            for(int i=0; i<n; ++i)
+            {
+                Matrix ewref(size, 1), evref(size, size);
+                symmetricEigensystem(matrices[i], ewref, evref);
+                for(int k=0; k<size; ++k)
+                    shouldEqualTolerance(r[k][i], ewref(k, 0), epsilon);
+            }
+        }
+    }
+
     void testNonsymmetricEigensystem()
     {
         double epsilon = 1e-8;
@@ -3021,6 +3091,7 @@ struct MathTestSuite
         add( testCase(&LinalgTest::testSymmetricEigensystem));
         add( testCase(&LinalgTest::testNonsymmetricEigensystem));
         add( testCase(&LinalgTest::testSymmetricEigensystemAnalytic));
+        add( testCase(&LinalgTest::testSymmetricEigensystemBatch));
         add( testCase(&LinalgTest::testDeterminant));
         add( testCase(&LinalgTest::testSVD));
 
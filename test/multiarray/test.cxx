@@ -38,9 +38,12 @@
 #include "vigra/multi_iterator_coupled.hxx"
 #include "vigra/multi_hierarchical_iterator.hxx"
 #include "vigra/multi_impex.hxx"
+#include "vigra/multi_array_chunked.hxx"
+#include "vigra/aligned_allocator.hxx"
 #include "vigra/basicimageview.hxx"
 #include "vigra/navigator.hxx"
 #include "vigra/multi_pointoperators.hxx"
+#include "vigra/multi_pointoperators_parallel.hxx"
 #include "vigra/tensorutilities.hxx"
 #include "vigra/multi_tensorutilities.hxx"
 #include "vigra/functorexpression.hxx"
@@ -961,6 +964,57 @@ public:
         shouldEqual(&*i2, &a3(1,2,4));
     }
 
+    void test_strip_foreach ()
+    {
+        typedef MultiArray<3, int> Array;
+        Array a(Shape3(7, 5, 4)), b(a.shape()), t(Shape3(4, 5, 7));
+        for(int k=0; k<a.size(); ++k)
+            a[k] = k;
+        MultiArrayView<3, int, StridedArrayTag> bt = t.transpose();
+
+        // coupled arrays with different strides
+        typedef CoupledIteratorType<3, int, int>::type Iterator;
+        Iterator start = createCoupledIterator(a, bt),
+                 end   = start.getEndIterator();
+        int strips = 0;
+        stripForeach(start, end,
+            [&strips](Iterator::value_type & h, MultiArrayIndex length)
+            {
+                shouldEqual(h.point()[0], 0);
+                shouldEqual(length, 7);
+                shouldEqual(cast<1>(h).strides()[0], 1);
+                shouldEqual(cast<2>(h).strides()[0], 20);
+                int const * src = cast<1>(h).ptr();
+                int * dest = cast<2>(h).ptr();
+                for(MultiArrayIndex k=0; k<length; ++k)
+                    dest[k*20] = 2*src[k];
+                ++strips;
+            });
+        shouldEqual(strips, 20);
+        for(int z=0; z<4; ++z)
+            for(int y=0; y<5; ++y)
+                for(int x=0; x<7; ++x)
+                    shouldEqual(t(z,y,x), 2*a(x,y,z));
+
+        // a partial range starts and ends in the middle of a strip
+        b = 0;
+        Iterator i = createCoupledIterator(a, b);
+        std::vector<MultiArrayIndex> lengths;
+        stripForeach(i+3, i+33,
+            [&lengths](Iterator::value_type & h, MultiArrayIndex length)
+            {
+                lengths.push_back(length);
+                for(MultiArrayIndex k=0; k<length; ++k, h.increment<0>())
+                    get<2>(h) = get<1>(h) + 1;
+            });
+        shouldEqual(lengths.size(), 5u);
+        shouldEqual(lengths[0], 4);
+        shouldEqual(lengths[1], 7);
+        shouldEqual(lengths[4], 5);
+        for(int k=0; k<a.size(); ++k)
+            shouldEqual(b[k], (k >= 3 && k < 33) ? k+1 : 0);
+    }
+
     void test_coupled_iterator ()
     {
         // test scan-order navigation
@@ -1159,6 +1213,98 @@ public:
         shouldEqual(count, 15);
     }
 
+    void test_aligned_allocator ()
+    {
+        typedef AlignedAllocator<float> Alloc;
+        typedef MultiArray<3, float, Alloc> Array;
+        float lo = 0.0f, hi = 0.0f;
+
+        Array a(Shape3(5, 6, 7), 3.0f);
+        shouldEqual((std::size_t)a.data() % 64, 0u);
+        should(a.allocator().options().getInitialization() == AllocationOptions::SerialInitialization);
+        a.minmax(&lo, &hi);
+        shouldEqual(lo, 3.0f);
+        shouldEqual(hi, 3.0f);
+
+        Array p(Shape3(5, 6, 7), Alloc(AllocationOptions().pageAlignment()));
+        shouldEqual((std::size_t)p.data() % detail::systemPageSize(), 0u);
+
+        // large enough for huge pages and parallel initialization
+        Shape3 large(128, 128, 64);
+        Array h(large, 2.0f, Alloc(AllocationOptions().hugePages().parallelInitialization(ParallelOptions().numThreads(4))));
+        shouldEqual((std::size_t)h.data() % AllocationOptions::HugePageSize, 0u);
+        h.minmax(&lo, &hi);
+        shouldEqual(lo, 2.0f);
+        shouldEqual(hi, 2.0f);
+
+        // reshape and copy keep the allocator
+        h.reshape(Shape3(64, 64, 64), 1.0f);
+        h.minmax(&lo, &hi);
+        shouldEqual(lo, 1.0f);
+        shouldEqual(hi, 1.0f);
+        Array c(h);
+        should(c == h);
+        should(c.allocator().options().getInitialization() == AllocationOptions::ParallelInitialization);
+
+        // uninitialized storage can be written normally
+        Array u(Shape3(4, 4, 4), Alloc(AllocationOptions().skipInitialization()));
+        u = 5.0f;
+        u.minmax(&lo, &hi);
+        shouldEqual(lo, 5.0f);
+        shouldEqual(hi, 5.0f);
+
+        // explicit initial values are always written
+        Alloc skip(AllocationOptions().skipInitialization());
+        Array v(Shape3(64, 64, 64), 3.0f, skip);
+        v.minmax(&lo, &hi);
+        shouldEqual(lo, 3.0f);
+        shouldEqual(hi, 3.0f);
+        v.reshape(Shape3(32, 64, 64), 1.0f);
+        v.minmax(&lo, &hi);
+        shouldEqual(lo, 1.0f);
+        shouldEqual(hi, 1.0f);
+
+        // non-POD elements are always constructed
+        MultiArray<1, std::string, AlignedAllocator<std::string> >
+            s(Shape1(10), std::string("abc"),
+              AlignedAllocator<std::string>(AllocationOptions().skipInitialization()));
+        shouldEqual(s[9], "abc");
+
+        // chunk storage
+        ChunkedArrayLazy<3, float, Alloc> lazy(large, Shape3(32), ChunkedArrayOptions(), Alloc(AllocationOptions().alignment(128)));
+        ChunkedArrayFull<3, float, Alloc> full(large, ChunkedArrayOptions().fillValue(4.0f), Alloc());
+        MultiArray<3, float> data(large);
+        for(int k=0; k<data.size(); ++k)
+            data[k] = (float)k;
+        lazy.commitSubarray(Shape3(), data);
+        full.commitSubarray(Shape3(), data);
+        MultiArray<3, float> lazyResult(large), fullResult(large);
+        lazy.checkoutSubarray(Shape3(), lazyResult);
+        full.checkoutSubarray(Shape3(), fullResult);
+        should(lazyResult == data);
+        should(fullResult == data);
+        shouldEqual((std::size_t)full.data() % 64, 0u);
+
+        // fill values survive skipInitialization(), also in partially written chunks
+        ChunkedArrayLazy<3, float, Alloc> lazySkip(large, Shape3(32), ChunkedArrayOptions(), skip);
+        ChunkedArrayFull<3, float, Alloc> fullSkip(large, ChunkedArrayOptions().fillValue(4.0f), skip);
+        MultiArray<3, float> part(Shape3(10, 20, 30), 7.0f);
+        lazySkip.commitSubarray(Shape3(5), part);
+        fullSkip.commitSubarray(Shape3(5), part);
+        lazySkip.checkoutSubarray(Shape3(), lazyResult);
+        fullSkip.checkoutSubarray(Shape3(), fullResult);
+        shouldEqual(lazyResult.subarray(Shape3(5), Shape3(15, 25, 35)).sum<double>(), 7.0*part.size());
+        shouldEqual(fullResult.subarray(Shape3(5), Shape3(15, 25, 35)).sum<double>(), 7.0*part.size());
+        lazyResult.subarray(Shape3(5), Shape3(15, 25, 35)) = 0.0f;
+        fullResult.subarray(Shape3(5), Shape3(15, 25, 35)) = 4.0f;
+        lazyResult.minmax(&lo, &hi);
+        shouldEqual(lo, 0.0f);
+        shouldEqual(hi, 0.0f);
+        fullResult.minmax(&lo, &hi);
+        shouldEqual(lo, 4.0f);
+        shouldEqual(hi, 4.0f);
+    }
+
     void test_traverser ()
     {
         // test hierarchical navigation and
@@ -1708,6 +1854,56 @@ struct MultiImpexTest
 #endif // _MSC_VER
     }
 
+    void testParallelImpex()
+    {
+#if defined(HasPNG)
+        const char * ext = ".png";
+#else
+        const char * ext = ".pnm";
+#endif
+        exportVolume(array, VolumeExportInfo("impex/ptest", ext));
+        VolumeImportInfo info("impex/ptest", ext);
+        shouldEqual(info.shape(), array.shape());
+
+        Array result(info.shape());
+        importVolume(info, result, ParallelOptions().numThreads(4));
+        shouldEqualSequence(result.begin(), result.end(), array.begin());
+
+        // slices are decoded into strided views as well
+        MultiArray<3, unsigned char> transposed(reverse(array.shape()));
+        importVolume(info, transposed.transpose(), ParallelOptions().numThreads(2));
+        shouldEqualSequence(transposed.transpose().begin(), transposed.transpose().end(), array.begin());
+
+        ChunkedArrayLazy<3, unsigned char> chunked(info.shape(), Shape(2, 2, 2));
+        importVolume(info, chunked, ParallelOptions().numThreads(4));
+        MultiArray<3, unsigned char> checkout(info.shape());
+        chunked.checkoutSubarray(Shape(), checkout);
+        shouldEqualSequence(checkout.begin(), checkout.end(), array.begin());
+    }
+
+    void testRawImpex()
+    {
+        {
+            std::ofstream raw("impex/raw.dat", std::ios::binary);
+            raw.write((char const *)array.data(), array.size());
+            std::ofstream info("impex/raw.info");
+            info << "width = 2\nheight = 3\ndepth = 4\ndatatype = UINT8\nfilename = raw.dat\n";
+        }
+        VolumeImportInfo info("impex/raw.info");
+        shouldEqual(info.shape(), array.shape());
+
+        Array result(info.shape());
+        importVolume(info, result);
+        shouldEqualSequence(result.begin(), result.end(), array.begin());
+
+        // raw volumes are streamed into chunked arrays slice by slice
+        ChunkedArrayLazy<3, unsigned char> chunked(info.shape(), Shape(2, 2, 2));
+        importVolume(info, chunked);
+        MultiArray<3, unsigned char> checkout(info.shape());
+        chunked.checkoutSubarray(Shape(), checkout);
+        shouldEqualSequence(checkout.begin(), checkout.end(), array.begin());
+    }
+
 #if defined(HasTIFF)
     void testMultipageTIFF()
     {
@@ -2405,6 +2601,84 @@ struct MultiArrayPointoperatorsTest
         shouldEqual(stats[1].max, 58.1f);
     }
 
+    void testParallel()
+    {
+        using namespace vigra::functor;
+
+        // large enough to be split into several tasks
+        Shape3 s(60, 50, 40);
+        MultiArray<3, int> a(s), b(s), c(s), res(s), ref(s);
+        for(int k=0; k<a.size(); ++k)
+        {
+            a[k] = k;
+            b[k] = k % 17;
+            c[k] = k % 5 + 1;
+        }
+        ParallelOptions options = ParallelOptions().numThreads(4);
+
+        initMultiArray(res, 3, options);
+        ref = 3;
+        should(res == ref);
+
+        copyMultiArray(a, res, options);
+        should(res == a);
+
+        // expand mode
+        MultiArray<3, int> line(Shape3(1, 50, 1));
+        for(int y=0; y<s[1]; ++y)
+            line(0,y,0) = y;
+        copyMultiArray(line, res, options);
+        for(int z=0; z<s[2]; ++z)
+            for(int y=0; y<s[1]; ++y)
+                for(int x=0; x<s[0]; ++x)
+                    shouldEqual(res(x,y,z), y);
+
+        transformMultiArray(a, res, Arg1()*Param(2), options);
+        transformMultiArray(a, ref, Arg1()*Param(2));
+        should(res == ref);
+
+        // reduce mode: the destination is split along the z-axis
+        MultiArray<3, int> sums(Shape3(1, 1, 40)), refSums(Shape3(1, 1, 40));
+        transformMultiArray(b, sums, reduceFunctor(Arg1() + Arg2(), 0), options);
+        transformMultiArray(b, refSums, reduceFunctor(Arg1() + Arg2(), 0));
+        should(sums == refSums);
+
+        combineTwoMultiArrays(a, b, res, Arg1() - Arg2(), options);
+        combineTwoMultiArrays(a, b, ref, Arg1() - Arg2());
+        should(res == ref);
+
+        combineTwoMultiArrays(line, b, res, Arg1() + Arg2(), options);
+        combineTwoMultiArrays(line, b, ref, Arg1() + Arg2());
+        should(res == ref);
+
+        combineThreeMultiArrays(a, b, c, res, Arg1() * Arg2() / Arg3(), options);
+        combineThreeMultiArrays(a, b, c, ref, Arg1() * Arg2() / Arg3());
+        should(res == ref);
+
+        FindMinMax<int> minmax;
+        inspectMultiArray(a, minmax, options);
+        shouldEqual(minmax.count, (unsigned int)a.size());
+        shouldEqual(minmax.min, 0);
+        shouldEqual(minmax.max, (int)a.size()-1);
+
+        // functors are merged into the given functor
+        FindAverage<int> average, refAverage;
+        inspectMultiArray(b, average, options);
+        inspectMultiArray(b, refAverage);
+        shouldEqual(average.count(), refAverage.count());
+        shouldEqualTolerance(average(), refAverage(), 1e-12);
+        inspectMultiArray(c, average, options);
+        inspectMultiArray(c, refAverage);
+        shouldEqual(average.count(), refAverage.count());
+        shouldEqualTolerance(average(), refAverage(), 1e-12);
+
+        FindAverageAndVariance<int> variance, refVariance;
+        inspectMultiArray(b, variance, options);
+        inspectMultiArray(b, refVariance);
+        shouldEqualTolerance(variance.average(), refVariance.average(), 1e-12);
+        shouldEqualTolerance(variance.variance(), refVariance.variance(), 1e-10);
+    }
+
     void testTensorUtilities()
     {
         MultiArrayShape<2>::type shape(3,4);
@@ -2455,6 +2729,40 @@ struct MultiArrayPointoperatorsTest
         vector = TinyVector<double, 2>();
         tensorEigenvaluesMultiArray(tensor1, vector);
         shouldEqualSequenceTolerance(vector.begin(), vector.end(), rtensor.begin(), (TinyVector<double, 2>(1e-14)));
+
+        vector = TinyVector<double, 2>();
+        tensorEigenvaluesMultiArray(tensor1, vector, ParallelOptions().numThreads(2));
+        shouldEqualSequenceTolerance(vector.begin(), vector.end(), rtensor.begin(), (TinyVector<double, 2>(1e-14)));
+
+        MultiArray<2, TinyVector<double, 4> > eigenvectors(shape);
+        vector = TinyVector<double, 2>();
+        tensorEigensystemMultiArray(tensor1, vector, eigenvectors);
+        shouldEqualSequenceTolerance(vector.begin(), vector.end(), rtensor.begin(), (TinyVector<double, 2>(1e-14)));
+        for(int k=0; k<size; ++k)
+        {
+            for(int l=0; l<2; ++l)
+            {
+                double x = eigenvectors[k][2*l], y = eigenvectors[k][2*l+1];
+                shouldEqualTolerance(x*x + y*y, 1.0, 1e-14);
+                // the residual is only small relative to the largest eigenvalue
+                shouldEqualTolerance(tensor1[k][0]*x + tensor1[k][1]*y - vector[k][l]*x, 0.0, 1e-13);
+                shouldEqualTolerance(tensor1[k][1]*x + tensor1[k][2]*y - vector[k][l]*y, 0.0, 1e-13);
+            }
+        }
+
+        // structure-of-arrays layout
+        MultiArray<3, Multiband<double> > planarTensor(Shape3(3, 4, 3)),
+                                          planarValues(Shape3(3, 4, 2));
+        for(int c=0; c<3; ++c)
+            planarTensor.bindOuter(c) = tensor1.bindElementChannel(c);
+        tensorEigenvaluesMultiArray(MultiArrayView<3, Multiband<double> >(planarTensor),
+                                    MultiArrayView<3, Multiband<double> >(planarValues));
+        for(int c=0; c<2; ++c)
+        {
+            MultiArrayView<2, double, StridedArrayTag> channel = vector.bindElementChannel(c);
+            shouldEqualSequence(planarValues.bindOuter(c).begin(), planarValues.bindOuter(c).end(),
+                                channel.begin());
+        }
     }
 };
 
@@ -2976,6 +3284,86 @@ public:
                     shouldEqual(d(x,y,z)+ss(y), r1(x,y,z));
     }
 
+    void testParallelAssign()
+    {
+        using namespace vigra::multi_math;
+
+        // large enough to be split into several tasks
+        Shape3 s(70, 60, 50);
+        array3_type u(s), v(s), w(s), ref(s);
+        for(int k=0; k<u.size(); ++k)
+        {
+            u[k] = k % 97 - 40.0;
+            v[k] = 1.0 + k % 13;
+        }
+        ParallelOptions options = ParallelOptions().numThreads(4);
+
+        // collapsible: flat loop
+        for(int k=0; k<u.size(); ++k)
+            ref[k] = (u[k] - 2.0) / v[k];
+        parallel_assign(w, (u - 2.0) / v, options);
+        shouldEqualSequence(w.begin(), w.end(), ref.begin());
+        w = 0.0;
+        w = (u - 2.0) / v;
+        shouldEqualSequence(w.begin(), w.end(), ref.begin());
+
+        // computed assignment
+        for(int k=0; k<u.size(); ++k)
+            ref[k] += u[k]*u[k];
+        parallel_plusAssign(w, sq(u), options);
+        shouldEqualSequence(w.begin(), w.end(), ref.begin());
+
+        // transposed RHS: split along the outer axis, strided inner loop
+        MultiArray<3, double> t(Shape3(50, 60, 70));
+        for(int k=0; k<t.size(); ++k)
+            t[k] = k % 31;
+        parallel_assign(w, max(t.transpose(), u), options);
+        for(int z=0; z<s[2]; ++z)
+            for(int y=0; y<s[1]; ++y)
+                for(int x=0; x<s[0]; ++x)
+                    shouldEqual(w(x,y,z), std::max(t(z,y,x), u(x,y,z)));
+
+        // transposed LHS: flat inner loops along the LHS's major axis
+        parallel_assign(t.transpose(), u * 2.0, options);
+        for(int z=0; z<s[2]; ++z)
+            for(int y=0; y<s[1]; ++y)
+                for(int x=0; x<s[0]; ++x)
+                    shouldEqual(t(z,y,x), 2.0*u(x,y,z));
+
+        // strided views and singleton expansion
+        MultiArray<3, double> big(Shape3(140, 60, 50));
+        MultiArrayView<3, double, StridedArrayTag> sub(s, Shape3(2, 140, 140*60), big.data());
+        MultiArray<3, double> line(Shape3(70, 1, 1));
+        for(int x=0; x<s[0]; ++x)
+            line(x,0,0) = x;
+        parallel_assign(sub, u + line, options);
+        for(int z=0; z<s[2]; ++z)
+            for(int y=0; y<s[1]; ++y)
+                for(int x=0; x<s[0]; ++x)
+                {
+                    shouldEqual(big(2*x,y,z), u(x,y,z) + x);
+                    shouldEqual(big(2*x+1,y,z), 0.0);
+                }
+
+        // serial evaluation via ParallelOptions
+        ref = 0.0;
+        ref = u * v;
+        parallel_assign(w, u * v, ParallelOptions().numThreads(ParallelOptions::NoThreads));
+        shouldEqualSequence(w.begin(), w.end(), ref.begin());
+
+        try
+        {
+            parallel_assign(w, t + u, options);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation & e)
+        {
+            std::string expected("\nPrecondition violation!\nmulti_math: shape mismatch in expression."),
+                        actual(e.what());
+            shouldEqual(actual.substr(0, expected.size()), expected);
+        }
+    }
+
     void testComplex()
     {
         using namespace vigra::multi_math;
@@ -3062,6 +3450,8 @@ struct MultiArrayTestSuite
         add( testCase( &MultiArrayTest::test_iterator ) );
         add( testCase( &MultiArrayTest::test_const_iterator ) );
         add( testCase( &MultiArrayTest::test_coupled_iterator ) );
+        add( testCase( &MultiArrayTest::test_strip_foreach ) );
+        add( testCase( &MultiArrayTest::test_aligned_allocator ) );
         add( testCase( &MultiArrayTest::test_traverser ) );
         add( testCase( &MultiArrayTest::test_const_traverser ) );
         add( testCase( &MultiArrayTest::test_hierarchical ) );
@@ -3077,6 +3467,8 @@ struct MultiArrayTestSuite
         add( testCase( &MultiArrayTest::test_expandElements ) );
 
         add( testCase( &MultiImpexTest::testImpex ) );
+        add( testCase( &MultiImpexTest::testParallelImpex ) );
+        add( testCase( &MultiImpexTest::testRawImpex ) );
 #if defined(HasTIFF)
         add( testCase( &MultiImpexTest::testMultipageTIFF ) );
 #endif
@@ -3153,11 +3545,13 @@ struct MultiArrayPointOperatorsTestSuite
         add( testCase( &MultiArrayPointoperatorsTest::testCombine3 ) );
         add( testCase( &MultiArrayPointoperatorsTest::testInitMultiArrayBorder ) );
         add( testCase( &MultiArrayPointoperatorsTest::testInspect ) );
+        add( testCase( &MultiArrayPointoperatorsTest::testParallel ) );
         add( testCase( &MultiArrayPointoperatorsTest::testTensorUtilities ) );
 
         add( testCase( &MultiMathTest::testSpeed ) );
         add( testCase( &MultiMathTest::testBasicArithmetic ) );
         add( testCase( &MultiMathTest::testExpandMode ) );
+        add( testCase( &MultiMathTest::testParallelAssign ) );
         add( testCase( &MultiMathTest::testAllFunctions ) );
         add( testCase( &MultiMathTest::testComputedAssignment ) );
         add( testCase( &MultiMathTest::testNonscalarValues ) );
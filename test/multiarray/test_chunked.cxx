@@ -739,6 +739,78 @@ public:
         shouldEqualSequence(array->cbegin(), array->cend(), ref.begin());
     }
 
+    void testPinnedChunk()
+    {
+        bool isFullArray = IsSameType<Array, ChunkedArrayFull<3, T> >::value;
+        Shape3 index = isFullArray
+                           ? Shape3()
+                           : Shape3(1, 2, 0);
+
+        {
+            // unused chunks are not allocated by read-only pins
+            BaseArray const & empty = *empty_array;
+            std::size_t bytes = empty.dataBytes();
+            PinnedChunk<3, T const> c = empty.pinChunk(index);
+            should(c.isValid());
+            shouldEqual(c.chunkIndex(), index);
+            shouldEqual(c.view().shape(), empty.chunkShape(index));
+            shouldEqual(empty.dataBytes(), bytes);
+            PlainArray filled(c.view().shape(), T(fill_value));
+            should(c.view() == filled);
+        }
+
+        PinnedChunk<3, T> c = array->pinChunk(index);
+        shouldEqual(c.chunkStart(), index*array->chunkShape());
+        shouldEqual(c.chunkStop(), c.chunkStart() + array->chunkShape(index));
+        should(c.view() == ref.subarray(c.chunkStart(), c.chunkStop()));
+
+        // copies share the pin, writes go directly to the chunk
+        PinnedChunk<3, T> c2(c);
+        c.release();
+        should(!c.isValid());
+        should(c2.isValid());
+        c2.view().init(T(3));
+        ref.subarray(c2.chunkStart(), c2.chunkStop()) = T(3);
+        c2.release();
+        shouldEqualSequence(array->cbegin(), array->cend(), ref.begin());
+
+        try
+        {
+            array->pinChunk(array->chunkArrayShape());
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation & e)
+        {
+            std::string expected("\nPrecondition violation!\nChunkedArray::pinChunk(): chunk index out of bounds.");
+            std::string message(e.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testParallelSubarray()
+    {
+        Shape3 start(5,0,3), stop(shape[0], shape[1], shape[2]-3);
+
+        PlainArray c(stop-start);
+        array->checkoutSubarray(start, c, ParallelOptions().numThreads(4));
+        should(c == ref.subarray(start, stop));
+
+        // ROI that does not touch the first chunk
+        Shape3 start2(9,10,17), stop2(18,21,22);
+        PlainArray c2(stop2-start2);
+        array->checkoutSubarray(start2, c2, ParallelOptions().numThreads(4));
+        should(c2 == ref.subarray(start2, stop2));
+
+        PlainArray d(stop-start, T(7));
+        array->commitSubarray(start, d, ParallelOptions().numThreads(4));
+        ref.subarray(start, stop) = T(7);
+        shouldEqualSequence(array->cbegin(), array->cend(), ref.begin());
+
+        PlainArray e(shape);
+        empty_array->checkoutSubarray(Shape3(), e, ParallelOptions().numThreads(4));
+        should(e == PlainArray(shape, T(fill_value)));
+    }
+
     static void testMultiThreadedRun(BaseArray * v, int startIndex, int d,
                                      threading::atomic_long * go)
     {
@@ -1526,6 +1598,8 @@ struct ChunkedMultiArrayTestSuite
         add( testCase( &ChunkedMultiArrayTest<Array>::test_subarray ) );
         add( testCase( &ChunkedMultiArrayTest<Array>::test_iterator ) );
         add( testCase( &ChunkedMultiArrayTest<Array>::testChunkIterator ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testPinnedChunk ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testParallelSubarray ) );
         add( testCase( &ChunkedMultiArrayTest<Array>::testMultiThreaded ) );
     }
 
@@ -530,6 +530,97 @@ struct MultiArraySeparableConvolutionTest
         shouldEqualSequenceTolerance(st1.data(), st1.data()+size, rst.data(), epsilon);
     }
 
+    void test_recursive()
+    {
+        using namespace multi_math;
+
+        {
+            MultiArray<3, double> src(Shape3(20, 25, 30)), dest(src.shape()), ref(src.shape());
+            makeRandom(src);
+
+            // the batched filter must reproduce the 1D filter along every axis
+            for(unsigned int dim=0; dim<3; ++dim)
+            {
+                recursiveGaussianFilterMultiArray(src, dest, dim, 2.0);
+
+                // move 'dim' to the last position
+                Shape3 permutation;
+                for(unsigned int k=0, l=0; k<3; ++k)
+                    if(k != dim)
+                        permutation[l++] = k;
+                permutation[2] = dim;
+                MultiArrayView<3, double, StridedArrayTag> s = src.transpose(permutation),
+                                                           r = ref.transpose(permutation);
+                for(MultiArrayIndex j=0; j<s.shape(1); ++j)
+                    for(MultiArrayIndex i=0; i<s.shape(0); ++i)
+                    {
+                        MultiArrayView<1, double, StridedArrayTag> sl = s.bindInner(Shape2(i, j)),
+                                                                   rl = r.bindInner(Shape2(i, j));
+                        recursiveGaussianFilterLine(sl.begin(), sl.end(), StandardConstValueAccessor<double>(),
+                                                    rl.begin(), StandardValueAccessor<double>(), 2.0);
+                    }
+                shouldEqualSequenceTolerance(dest.begin(), dest.end(), ref.begin(), 1e-12);
+            }
+
+            // derivatives are central differences of the smoothed data, also along
+            // dimension 0, where lines are filtered in tiles (including a partial one)
+            MultiArray<3, double> d1(src.shape()), d2(src.shape());
+            recursiveGaussianFilterMultiArray(src, dest, 0, 2.0);
+            recursiveGaussianFilterMultiArray(src, d1, 0, 2.0, 1);
+            recursiveGaussianFilterMultiArray(src, d2, 0, 2.0, 2);
+            for(MultiArrayIndex z=0; z<src.shape(2); ++z)
+                for(MultiArrayIndex y=0; y<src.shape(1); ++y)
+                    for(MultiArrayIndex x=1; x<src.shape(0)-1; ++x)
+                    {
+                        shouldEqualTolerance(d1(x,y,z), 0.5*(dest(x+1,y,z) - dest(x-1,y,z)), 1e-12);
+                        shouldEqualTolerance(d2(x,y,z), dest(x+1,y,z) - 2.0*dest(x,y,z) + dest(x-1,y,z), 1e-12);
+                    }
+        }
+
+        {
+            // the recursive filter approximates the FIR filters (see ConvolutionOptions::filterMethod())
+            typedef MultiArray<2, double>                 Array;
+            typedef MultiArray<2, TinyVector<double, 2> > VectorArray;
+
+            Array src(Shape2(160, 140)), fir(src.shape()), rec(src.shape());
+            src.subarray(Shape2(50, 60), Shape2(100, 90)) = 1.0;
+            ConvolutionOptions<2> firOpt, recOpt;
+            firOpt.filterMethod(GaussianFilterFIR);
+            recOpt.filterMethod(GaussianFilterRecursive);
+
+            gaussianSmoothMultiArray(src, fir, 10.0, firOpt);
+            gaussianSmoothMultiArray(src, rec, 10.0, recOpt);
+            should(Array(fir - rec).norm(0) <= 0.05 * fir.norm(0));
+
+            // 'Auto' switches to the recursive filter for large scales only
+            Array res(src.shape());
+            ConvolutionOptions<2> autoOpt;
+            autoOpt.filterMethod(GaussianFilterAuto);
+            gaussianSmoothMultiArray(src, res, 10.0, autoOpt);
+            shouldEqualSequence(res.begin(), res.end(), rec.begin());
+            gaussianSmoothMultiArray(src, res, 2.0, autoOpt);
+            gaussianSmoothMultiArray(src, fir, 2.0);
+            shouldEqualSequence(res.begin(), res.end(), fir.begin());
+
+            VectorArray firGrad(src.shape()), recGrad(src.shape());
+            gaussianGradientMultiArray(src, firGrad, 8.0, firOpt);
+            gaussianGradientMultiArray(src, recGrad, 8.0, recOpt);
+            should(VectorArray(firGrad - recGrad).norm(0) <= 0.15 * firGrad.norm(0));
+
+            Array firLap(src.shape()), recLap(src.shape());
+            laplacianOfGaussianMultiArray(src, firLap, 8.0, firOpt);
+            laplacianOfGaussianMultiArray(src, recLap, 8.0, recOpt);
+            should(Array(firLap - recLap).norm(0) <= 0.3 * firLap.norm(0));
+
+            // subarray support
+            Shape2 start(20, 10), stop(140, 100);
+            MultiArray<2, TinyVector<double, 3> > hessian(src.shape()), subHessian(stop - start);
+            hessianOfGaussianMultiArray(src, hessian, 8.0, recOpt);
+            hessianOfGaussianMultiArray(src, subHessian, 8.0, ConvolutionOptions<2>(recOpt).subarray(start, stop));
+            shouldEqualSequence(subHessian.begin(), subHessian.end(), hessian.subarray(start, stop).begin());
+        }
+    }
+
     //--------------------------------------------
 
     const Size3 shape;
@@ -576,6 +667,44 @@ struct MultiArraySeparableConvolutionTest
         test_gradient1( srcImage, false );
         test_gradient1( srcImage, true );
     }
+
+    void test_resizeParallel()
+    {
+        MultiArray<3, double> src(Shape3(23, 17, 11));
+        MersenneTwister random;
+        for(auto & v : src)
+            v = random.uniform();
+
+        Shape3 dshapes[] = { Shape3(45, 33, 21),    // upsampling by 2
+                             Shape3(12, 9, 6),      // downsampling by 2
+                             Shape3(30, 8, 16),     // mixed, odd ratios
+                             Shape3(23, 17, 11) };  // identity
+        for(int k=0; k<4; ++k)
+        {
+            MultiArray<3, double> ref(dshapes[k]), res(dshapes[k]), serial(dshapes[k]);
+            resizeMultiArraySplineInterpolation(src, ref);
+            resizeMultiArraySplineInterpolation(src, res, ParallelOptions().numThreads(4));
+            resizeMultiArraySplineInterpolation(src, serial, BSpline<3, double>(),
+                                                ParallelOptions().numThreads(ParallelOptions::NoThreads));
+            shouldEqualSequenceTolerance(ref.begin(), ref.end(), res.begin(), 1e-10);
+            shouldEqualSequenceTolerance(ref.begin(), ref.end(), serial.begin(), 1e-10);
+
+            MultiArray<3, double> ref5(dshapes[k]), res5(dshapes[k]);
+            resizeMultiArraySplineInterpolation(src, ref5, BSpline<5, double>());
+            resizeMultiArraySplineInterpolation(src, res5, BSpline<5, double>(), ParallelOptions().numThreads(3));
+            shouldEqualSequenceTolerance(ref5.begin(), ref5.end(), res5.begin(), 1e-10);
+        }
+
+        // 2D, linear interpolation, integer result on a strided view
+        MultiArray<2, float> src2(Shape2(31, 20));
+        for(auto & v : src2)
+            v = 255.0f*random.uniform();
+        MultiArray<2, UInt8> ref2(Shape2(20, 61)), res2(Shape2(61, 20));
+        resizeMultiArraySplineInterpolation(src2, ref2, BSpline<1, double>());
+        resizeMultiArraySplineInterpolation(src2, res2.transpose(), BSpline<1, double>(),
+                                            ParallelOptions().numThreads(2));
+        shouldEqualSequence(ref2.begin(), ref2.end(), res2.transpose().begin());
+    }
 };                //-- struct MultiArraySeparableConvolutionTest
 
 //--------------------------------------------------------
@@ -598,6 +727,8 @@ struct MultiArraySeparableConvolutionTestSuite
                 add( testCase( &MultiArraySeparableConvolutionTest::test_hessian ) );
                 add( testCase( &MultiArraySeparableConvolutionTest::test_structureTensor ) );
                 add( testCase( &MultiArraySeparableConvolutionTest::test_gradient_magnitude ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_recursive ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_resizeParallel ) );
     }
 }; // struct MultiArraySeparableConvolutionTestSuite
 
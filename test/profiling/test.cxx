@@ -0,0 +1,232 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2016 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#define VIGRA_PROFILING
+
+#include <vigra/unittest.hxx>
+#include <vigra/profiling.hxx>
+#include <vigra/threadpool.hxx>
+#include <vigra/multi_array_chunked.hxx>
+#include <sstream>
+
+using namespace vigra;
+using namespace vigra::profiling;
+
+struct ProfilingTests
+{
+    typedef TraceRecorder::RegionStatistics RegionStatistics;
+
+    ProfilingTests()
+    {
+        TraceRecorder::global().enable();
+        TraceRecorder::global().clear();
+    }
+
+    static RegionStatistics region(std::string const & category, std::string const & name)
+    {
+        std::vector<RegionStatistics> s = TraceRecorder::global().statistics();
+        for(std::size_t k=0; k<s.size(); ++k)
+            if(s[k].category == category && s[k].name == name)
+                return s[k];
+        RegionStatistics none = { category, name, 0, 0.0, 0.0, 0.0 };
+        return none;
+    }
+
+    void testScopedRegion()
+    {
+        {
+            VIGRA_PROFILE_SCOPE("test", "outer");
+            {
+                VIGRA_PROFILE_SCOPE_ID("test", "inner", 7);
+                threading::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+        shouldEqual(TraceRecorder::global().eventCount(), 2u);
+
+        std::vector<TraceEvent> events = TraceRecorder::global().threadTrace().events();
+        shouldEqual(events.size(), 2u);
+        // events are recorded when the region ends, so the inner one comes first
+        shouldEqual(std::string(events[0].name), "inner");
+        shouldEqual(events[0].id, 7);
+        shouldEqual(std::string(events[1].name), "outer");
+        shouldEqual(events[1].id, -1);
+        should(events[0].duration >= 2000000);
+        should(events[1].start <= events[0].start);
+        should(events[1].start + events[1].duration >= events[0].start + events[0].duration);
+
+        RegionStatistics inner = region("test", "inner");
+        shouldEqual(inner.count, 1u);
+        should(inner.total_time >= 0.002);
+        should(region("test", "outer").total_time >= inner.total_time);
+    }
+
+    void testDisabled()
+    {
+        TraceRecorder::global().enable(false);
+        {
+            VIGRA_PROFILE_SCOPE("test", "ignored");
+        }
+        TraceRecorder::global().enable(true);
+        shouldEqual(TraceRecorder::global().eventCount(), 0u);
+    }
+
+    void testThreadPool()
+    {
+        int n = 20;
+        {
+            ThreadPool pool(3);
+            for(int k=0; k<n; ++k)
+            {
+                pool.enqueue(
+                    [k](int /* thread_id */)
+                    {
+                        VIGRA_PROFILE_SCOPE_ID("test", "work", k);
+                    });
+            }
+            pool.waitFinished();
+        }
+        shouldEqual(region("ThreadPool", "task").count, (std::size_t)n);
+        shouldEqual(region("test", "work").count, (std::size_t)n);
+
+        std::ostringstream trace;
+        TraceRecorder::global().writeChromeTrace(trace);
+        should(trace.str().find("\"name\": \"ThreadPool worker 0\"") != std::string::npos);
+    }
+
+    void testChunkedArray()
+    {
+        Shape3 shape(64), chunk_shape(16);
+        ChunkedArrayTmpFile<3, int> array(shape, chunk_shape, ChunkedArrayOptions().cacheMax(17), "");
+
+        int count = 0;
+        for(ChunkedArrayTmpFile<3, int>::iterator i = array.begin(); i != array.end(); ++i)
+            *i = count++;
+
+        // every chunk was loaded, and every loaded chunk is either
+        // still in the cache or was unloaded
+        std::size_t loads   = region("ChunkedArray", "chunk load").count,
+                    unloads = region("ChunkedArray", "chunk unload").count;
+        should(loads >= (std::size_t)prod(array.chunkArrayShape()));
+        should(unloads > 0);
+        shouldEqual(unloads + array.cacheSize(), loads);
+        shouldEqual(region("ChunkedArray", "lock wait").count, 0u);
+    }
+
+    // a chunked array whose chunks take a while to load
+    struct SlowChunkedArray
+    : public ChunkedArrayLazy<3, int>
+    {
+        SlowChunkedArray(Shape3 const & shape, Shape3 const & chunk_shape)
+        : ChunkedArrayLazy<3, int>(shape, chunk_shape)
+        , loading(false)
+        {}
+
+        virtual pointer loadChunk(ChunkBase<3, int> ** p, shape_type const & index)
+        {
+            loading = true;
+            threading::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return ChunkedArrayLazy<3, int>::loadChunk(p, index);
+        }
+
+        threading::atomic<bool> loading;
+    };
+
+    void testChunkWait()
+    {
+        SlowChunkedArray array(Shape3(16), Shape3(16));
+
+        // const access doesn't load uninitialized chunks, so the first access must write
+        threading::thread t([&array]()
+            {
+                array.setItem(Shape3(1), 1);
+            });
+        while(!array.loading)
+            threading::this_thread::yield();
+        shouldEqual(array.getItem(Shape3(2)), 0);
+        t.join();
+
+        // the whole wait for the chunk is a single region
+        RegionStatistics wait = region("ChunkedArray", "chunk wait");
+        shouldEqual(wait.count, 1u);
+        should(wait.total_time >= 0.02);
+    }
+
+    void testExport()
+    {
+        threading::thread t([]()
+            {
+                VIGRA_PROFILE_THREAD_NAME("worker \"a\"");
+                VIGRA_PROFILE_SCOPE_ID("test", "exported", 42);
+            });
+        t.join();
+
+        std::ostringstream trace;
+        TraceRecorder::global().writeChromeTrace(trace);
+        std::string s = trace.str();
+        shouldEqual(s.substr(0, 17), "{\"displayTimeUnit");
+        should(s.find("\"name\": \"worker \\\"a\\\"\"") != std::string::npos);
+        should(s.find("\"ph\": \"X\", \"cat\": \"test\", \"name\": \"exported\"") != std::string::npos);
+        should(s.find("\"args\": {\"id\": 42}") != std::string::npos);
+        shouldEqual(s.substr(s.size() - 4), "\n]}\n");
+
+        std::ostringstream summary;
+        TraceRecorder::global().writeSummary(summary);
+        should(summary.str().find("{\"category\": \"test\", \"name\": \"exported\", \"count\": 1,") != std::string::npos);
+    }
+};
+
+struct ProfilingTestSuite : public test_suite
+{
+    ProfilingTestSuite()
+        :
+        test_suite("Profiling test")
+    {
+        add(testCase(&ProfilingTests::testScopedRegion));
+        add(testCase(&ProfilingTests::testDisabled));
+        add(testCase(&ProfilingTests::testThreadPool));
+        add(testCase(&ProfilingTests::testChunkedArray));
+        add(testCase(&ProfilingTests::testChunkWait));
+        add(testCase(&ProfilingTests::testExport));
+    }
+};
+
+int main(int argc, char** argv)
+{
+    ProfilingTestSuite profiling_test;
+    int failed = profiling_test.run(testsToBeExecuted(argc, argv));
+    std::cout << profiling_test.report() << std::endl;
+    return (failed != 0);
+}
@@ -37,6 +37,7 @@
 #include "vigra/sifImport.hxx"
 #include "vigra/multi_array.hxx"
 #include "vigra/multi_impex.hxx"
+#include "vigra/multi_array_chunked.hxx"
 
 #ifdef HasHDF5
 # include "vigra/hdf5impex.hxx"
@@ -177,6 +178,14 @@ public:
                 }
             }
         }
+
+        // importVolume() streams the frames into a chunked array
+        VolumeImportInfo info(sifFile);
+        ChunkedArrayLazy<3, float> chunked(info.shape(), Shape3(2, 2, 2));
+        importVolume(info, chunked, ParallelOptions().numThreads(2));
+        MultiArray<3, float> checkout(info.shape());
+        chunked.checkoutSubarray(Shape3(), checkout);
+        should (checkout == in_data_volume);
     }
 
 };
@@ -231,6 +231,139 @@ struct ThreadPoolTests
         size_t const sum = std::accumulate(results.begin(), results.end(), 0);
         shouldEqual(sum, n);
     }
+
+    void run_task_graph(int n_threads)
+    {
+        // three stages of n tasks, task k of a stage needs tasks k-1, k, k+1 of the previous one
+        int const n = 100;
+        TaskGraph graph;
+        std::vector<threading::atomic_long> stamp(3*n);
+        threading::atomic_long clock;
+        clock.store(0);
+        std::vector<std::vector<TaskGraph::TaskId> > stages(3);
+        for (int s = 0; s < 3; ++s)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                std::vector<TaskGraph::TaskId> deps;
+                if (s > 0)
+                    for (int j = std::max(k-1, 0); j < std::min(k+2, n); ++j)
+                        deps.push_back(stages[s-1][j]);
+                stages[s].push_back(graph.add(
+                    [&stamp, &clock, s, k, n](int /*thread_id*/)
+                    {
+                        stamp[s*n+k].store(++clock);
+                    }, deps));
+            }
+        }
+        shouldEqual(graph.size(), (std::size_t)(3*n));
+
+        for (int iteration = 0; iteration < 2; ++iteration)
+        {
+            clock.store(0);
+            graph.run(ParallelOptions().numThreads(n_threads));
+            shouldEqual(clock.load(), 3*n);
+            for (int s = 1; s < 3; ++s)
+                for (int k = 0; k < n; ++k)
+                    for (int j = std::max(k-1, 0); j < std::min(k+2, n); ++j)
+                        should(stamp[(s-1)*n+j].load() < stamp[s*n+k].load());
+        }
+    }
+
+    void test_task_graph()
+    {
+        run_task_graph(4);
+        run_task_graph(ParallelOptions::NoThreads);
+
+        // a long chain must not exhaust the stack when there are no workers
+        int const n = 1000000;
+        TaskGraph chain;
+        long count = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            TaskGraph::TaskId id = chain.add([&count, k](int /*thread_id*/)
+                                             {
+                                                 if (count == k)
+                                                     ++count;
+                                             });
+            if (k > 0)
+                chain.addDependency(id-1, id);
+        }
+        chain.run(ParallelOptions().numThreads(ParallelOptions::NoThreads));
+        shouldEqual(count, (long)n);
+    }
+
+    void test_task_graph_exception()
+    {
+        std::string exception_string = "the test exception";
+        threading::atomic_long count;
+        count.store(0);
+
+        TaskGraph graph;
+        TaskGraph::TaskId first = graph.add(
+            [&exception_string](int /*thread_id*/)
+            {
+                throw std::runtime_error(exception_string);
+            });
+        TaskGraph::TaskId second = graph.add(
+            [&count](int /*thread_id*/)
+            {
+                ++count;
+            }, std::vector<TaskGraph::TaskId>(1, first));
+        graph.add(
+            [&count](int /*thread_id*/)
+            {
+                ++count;
+            }, std::vector<TaskGraph::TaskId>(1, second));
+
+        int threads[] = { 4, ParallelOptions::NoThreads };
+        for (int k = 0; k < 2; ++k)
+        {
+            bool caught = false;
+            try
+            {
+                graph.run(ParallelOptions().numThreads(threads[k]));
+            }
+            catch (std::runtime_error & ex)
+            {
+                if (ex.what() == exception_string)
+                    caught = true;
+            }
+            should(caught);
+            // the dependent tasks are skipped
+            shouldEqual(count.load(), 0);
+        }
+    }
+
+    void test_task_graph_cycle()
+    {
+        TaskGraph graph;
+        TaskGraph::TaskId a = graph.add([](int) {});
+        TaskGraph::TaskId b = graph.add([](int) {}, std::vector<TaskGraph::TaskId>(1, a));
+        graph.addDependency(b, a);
+
+        bool caught = false;
+        try
+        {
+            graph.run(ParallelOptions().numThreads(2));
+        }
+        catch (ContractViolation &)
+        {
+            caught = true;
+        }
+        should(caught);
+
+        caught = false;
+        try
+        {
+            graph.addDependency(a, a);
+        }
+        catch (ContractViolation &)
+        {
+            caught = true;
+        }
+        should(caught);
+    }
 };
 
 struct ThreadPoolTestSuite : public test_suite
@@ -244,6 +377,9 @@ struct ThreadPoolTestSuite : public test_suite
         add(testCase(&ThreadPoolTests::test_parallel_foreach));
         add(testCase(&ThreadPoolTests::test_parallel_foreach_exception));
         add(testCase(&ThreadPoolTests::test_parallel_foreach_sum_serial));
+        add(testCase(&ThreadPoolTests::test_task_graph));
+        add(testCase(&ThreadPoolTests::test_task_graph_exception));
+        add(testCase(&ThreadPoolTests::test_task_graph_cycle));
 #if !defined(USE_BOOST_THREAD) || \
     defined(BOOST_THREAD_PROVIDES_VARIADIC_THREAD)
         add(testCase(&ThreadPoolTests::test_parallel_foreach_sum));
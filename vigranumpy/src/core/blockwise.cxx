@@ -56,7 +56,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        gaussianSmoothMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            gaussianSmoothMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -67,7 +70,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        gaussianGradientMagnitudeMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            gaussianGradientMagnitudeMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -78,7 +84,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        gaussianGradientMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            gaussianGradientMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -89,7 +98,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        hessianOfGaussianEigenvaluesMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            hessianOfGaussianEigenvaluesMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -100,7 +112,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        hessianOfGaussianFirstEigenvalueMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            hessianOfGaussianFirstEigenvalueMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -111,7 +126,10 @@ namespace vigra{
         NumpyArray<DIM, T_OUT>  dest
     ){
         dest.reshapeIfEmpty(source.taggedShape());
-        hessianOfGaussianLastEigenvalueMultiArray(source, dest, opt);
+        {
+            PyAllowThreads _pythread;
+            hessianOfGaussianLastEigenvalueMultiArray(source, dest, opt);
+        }
         return dest;
     }
 
@@ -511,11 +511,14 @@ public:
         FloatNodeArrayMap  nodeFeatureArrayMap(g,nodeFeaturesArray);
         FloatEdgeArrayMap  edgeWeightsArrayMap(g,edgeWeightsArray);
 
-        for(EdgeIt e(g);e!=lemon::INVALID;++e){
-            const Edge edge(*e);
-            const Node u=g.u(edge);
-            const Node v=g.v(edge);
-            edgeWeightsArrayMap[edge]=nodeFeatureArrayMap[u]+nodeFeatureArrayMap[v];
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt e(g);e!=lemon::INVALID;++e){
+                const Edge edge(*e);
+                const Node u=g.u(edge);
+                const Node v=g.v(edge);
+                edgeWeightsArrayMap[edge]=nodeFeatureArrayMap[u]+nodeFeatureArrayMap[v];
+            }
         }
         return edgeWeightsArray;
     }
@@ -534,11 +537,14 @@ public:
         MultiFloatNodeArrayMap nodeFeatureArrayMap(g,nodeFeaturesArray);
         FloatEdgeArrayMap      edgeWeightsArrayMap(g,edgeWeightsArray);
 
-        for(EdgeIt e(g);e!=lemon::INVALID;++e){
-            const Edge edge(*e);
-            const Node u=g.u(edge);
-            const Node v=g.v(edge);
-            edgeWeightsArrayMap[edge]=functor(nodeFeatureArrayMap[u],nodeFeatureArrayMap[v]);
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt e(g);e!=lemon::INVALID;++e){
+                const Edge edge(*e);
+                const Node u=g.u(edge);
+                const Node v=g.v(edge);
+                edgeWeightsArrayMap[edge]=functor(nodeFeatureArrayMap[u],nodeFeatureArrayMap[v]);
+            }
         }
         return edgeWeightsArray;
     }
@@ -558,7 +564,10 @@ public:
         UInt32NodeArrayMap labelsArrayMap(g,labelsArray);
 
         // call algorithm itself
-        edgeWeightedWatershedsSegmentation(g,edgeWeightsArrayMap,seedsArrayMap,labelsArrayMap);
+        {
+            PyAllowThreads _pythread;
+            edgeWeightedWatershedsSegmentation(g,edgeWeightsArrayMap,seedsArrayMap,labelsArrayMap);
+        }
 
         // retun labels
         return labelsArray;
@@ -586,11 +595,14 @@ public:
         FloatNodeArrayMap  nodeWeightsArrayMap(g,nodeWeightsArray);
         UInt32NodeArrayMap labelsArrayMap(g,labelsArray);
 
-        std::copy(seedsArray.begin(),seedsArray.end(),labelsArray.begin());
+        {
+            PyAllowThreads _pythread;
+            std::copy(seedsArray.begin(),seedsArray.end(),labelsArray.begin());
 
-        //lemon_graph::graph_detail::generateWatershedSeeds(g, nodeWeightsArrayMap, labelsArrayMap, watershedsOption.seed_options);
-        lemon_graph::watershedsGraph(g, nodeWeightsArrayMap, labelsArrayMap, watershedsOption);
-        //lemon_graph::graph_detail::seededWatersheds(g, nodeWeightsArrayMap, seedsArrayMap, watershedsOption);
+            //lemon_graph::graph_detail::generateWatershedSeeds(g, nodeWeightsArrayMap, labelsArrayMap, watershedsOption.seed_options);
+            lemon_graph::watershedsGraph(g, nodeWeightsArrayMap, labelsArrayMap, watershedsOption);
+            //lemon_graph::graph_detail::seededWatersheds(g, nodeWeightsArrayMap, seedsArrayMap, watershedsOption);
+        }
 
         return labelsArray;
     }
@@ -616,7 +628,10 @@ public:
         FloatNodeArrayMap  nodeWeightsArrayMap(g,nodeWeightsArray);
         UInt32NodeArrayMap seedsArrayMap(g,seedsArray);
 
-        lemon_graph::graph_detail::generateWatershedSeeds(g, nodeWeightsArrayMap, seedsArrayMap, watershedsOption.seed_options);
+        {
+            PyAllowThreads _pythread;
+            lemon_graph::graph_detail::generateWatershedSeeds(g, nodeWeightsArrayMap, seedsArrayMap, watershedsOption.seed_options);
+        }
 
         return seedsArray;
     }
@@ -639,7 +654,10 @@ public:
         UInt32NodeArrayMap labelsArrayMap(g,labelsArray);
 
         // call algorithm itself
-        carvingSegmentation(g,edgeWeightsArrayMap,seedsArrayMap,backgroundLabel,backgroundBias,noBiasBelow,labelsArrayMap);
+        {
+            PyAllowThreads _pythread;
+            carvingSegmentation(g,edgeWeightsArrayMap,seedsArrayMap,backgroundLabel,backgroundBias,noBiasBelow,labelsArrayMap);
+        }
 
         // retun labels
         return labelsArray;
@@ -663,11 +681,14 @@ public:
 
 
 
-        std::copy(seedsArray.begin(),seedsArray.end(),labelsArray.begin());
+        {
+            PyAllowThreads _pythread;
+            std::copy(seedsArray.begin(),seedsArray.end(),labelsArray.begin());
 
-        shortestPathSegmentation<
-            Graph,FloatEdgeArrayMap, FloatNodeArrayMap, UInt32NodeArrayMap, float
-        >(g, edgeWeightsArrayMap, nodeWeightsArrayMap, labelsArrayMap);
+            shortestPathSegmentation<
+                Graph,FloatEdgeArrayMap, FloatNodeArrayMap, UInt32NodeArrayMap, float
+            >(g, edgeWeightsArrayMap, nodeWeightsArrayMap, labelsArrayMap);
+        }
 
 
         return labelsArray;
@@ -691,7 +712,10 @@ public:
         UInt32NodeArrayMap labelsArrayMap(g,labelsArray);
 
         // call algorithm itself
-        felzenszwalbSegmentation(g,edgeWeightsArrayMap,nodeSizesArrayMap,k,labelsArrayMap,nodeNumStop);
+        {
+            PyAllowThreads _pythread;
+            felzenszwalbSegmentation(g,edgeWeightsArrayMap,nodeSizesArrayMap,k,labelsArrayMap,nodeNumStop);
+        }
 
         // retun labels
         return labelsArray;
@@ -723,7 +747,10 @@ public:
         MultiFloatNodeArrayMap nodeFeaturesOutArrayMap(g,nodeFeaturesOutArray);
 
         // call algorithm itself
-        recursiveGraphSmoothing(g,nodeFeaturesArrayMap,edgeIndicatorArrayMap,lambda,edgeThreshold,scale,iterations,nodeFeaturesBufferArrayMap,nodeFeaturesOutArrayMap);
+        {
+            PyAllowThreads _pythread;
+            recursiveGraphSmoothing(g,nodeFeaturesArrayMap,edgeIndicatorArrayMap,lambda,edgeThreshold,scale,iterations,nodeFeaturesBufferArrayMap,nodeFeaturesOutArrayMap);
+        }
 
         // retun smoothed features
         return nodeFeaturesOutArray;
@@ -940,13 +967,16 @@ public:
         // numpy arrays => lemon maps
         FloatEdgeArrayMap edgeWeightsArrayMap(g,edgeWeightsArray);
         typedef typename FloatNodeArray::difference_type CoordType;
-        for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
-
-            const Edge edge(*iter);
-            const CoordType uCoord(g.u(edge));
-            const CoordType vCoord(g.v(edge));
-            const CoordType tCoord = uCoord+vCoord;
-            edgeWeightsArrayMap[edge]=interpolatedImage[tCoord];
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
+
+                const Edge edge(*iter);
+                const CoordType uCoord(g.u(edge));
+                const CoordType vCoord(g.v(edge));
+                const CoordType tCoord = uCoord+vCoord;
+                edgeWeightsArrayMap[edge]=interpolatedImage[tCoord];
+            }
         }
         return edgeWeightsArray;
     }
@@ -966,12 +996,15 @@ public:
         // numpy arrays => lemon maps
         FloatEdgeArrayMap edgeWeightsArrayMap(g,edgeWeightsArray);
         typedef typename FloatNodeArray::difference_type CoordType;
-        for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
-
-            const Edge edge(*iter);
-            const CoordType uCoord(g.u(edge));
-            const CoordType vCoord(g.v(edge));
-            edgeWeightsArrayMap[edge]=(image[uCoord]+image[vCoord])/2.0;
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
+
+                const Edge edge(*iter);
+                const CoordType uCoord(g.u(edge));
+                const CoordType vCoord(g.v(edge));
+                edgeWeightsArrayMap[edge]=(image[uCoord]+image[vCoord])/2.0;
+            }
         }
         return edgeWeightsArray;
     }
@@ -1002,13 +1035,16 @@ public:
         // numpy arrays => lemon maps
         MultiFloatEdgeArrayMap edgeWeightsArrayMap(g,edgeWeightsArray);
         typedef typename FloatNodeArray::difference_type CoordType;
-        for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
-
-            const Edge edge(*iter);
-            const CoordType uCoord(g.u(edge));
-            const CoordType vCoord(g.v(edge));
-            const CoordType tCoord = uCoord+vCoord;
-            edgeWeightsArrayMap[edge]=interpolatedImage[tCoord];
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
+
+                const Edge edge(*iter);
+                const CoordType uCoord(g.u(edge));
+                const CoordType vCoord(g.v(edge));
+                const CoordType tCoord = uCoord+vCoord;
+                edgeWeightsArrayMap[edge]=interpolatedImage[tCoord];
+            }
         }
         return edgeWeightsArray;
     }
@@ -1042,15 +1078,18 @@ public:
         // numpy arrays => lemon maps
         MultiFloatEdgeArrayMap edgeWeightsArrayMap(g,edgeWeightsArray);
         typedef typename FloatNodeArray::difference_type CoordType;
-        for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
-
-            const Edge edge(*iter);
-            const CoordType uCoord(g.u(edge));
-            const CoordType vCoord(g.v(edge));
-            MultiArray<1, float>  val = image[uCoord];
-            val+=image[vCoord];
-            val/=2.0;
-            edgeWeightsArrayMap[edge]=val;
+        {
+            PyAllowThreads _pythread;
+            for(EdgeIt iter(g); iter!=lemon::INVALID; ++ iter){
+
+                const Edge edge(*iter);
+                const CoordType uCoord(g.u(edge));
+                const CoordType vCoord(g.v(edge));
+                MultiArray<1, float>  val = image[uCoord];
+                val+=image[vCoord];
+                val/=2.0;
+                edgeWeightsArrayMap[edge]=val;
+            }
         }
         return edgeWeightsArray;
     }
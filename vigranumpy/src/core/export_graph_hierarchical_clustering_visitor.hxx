@@ -8,6 +8,7 @@
 /*std*/
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 /*vigra*/
 #include <vigra/numpy_array.hxx>
@@ -199,7 +200,7 @@ public:
         python::class_<HCluster,boost::noncopyable>(
             clsName.c_str(),python::init<ClusterOperator &>()[python::with_custodian_and_ward<1 /*custodian == self*/, 2 /*ward == const InputLabelingView & */>()]
         )
-        .def("cluster",&HCluster::cluster)
+        .def("cluster",&pyCluster<HCluster>)
         .def("reprNodeIds",registerConverters(&pyReprNodeIds<HCluster>))
         .def("ucmTransform",registerConverters(&pyUcmTransform<HCluster>))
         .def("resultLabels",registerConverters(&pyResultLabels<HCluster>),
@@ -216,6 +217,18 @@ public:
         );
     }
 
+    template<class HCLUSTER>
+    static void pyCluster(HCLUSTER & hcluster){
+        // the python operator calls back into python and must keep the GIL
+        if(std::is_same<typename HCLUSTER::ClusterOperator, PythonClusterOperator>::value){
+            hcluster.cluster();
+        }
+        else{
+            PyAllowThreads _pythread;
+            hcluster.cluster();
+        }
+    }
+
     static const Graph & pyMergeGraphsGraph(const MergeGraph & mg){
         return mg.graph();
     }
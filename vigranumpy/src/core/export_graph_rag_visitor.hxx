@@ -331,18 +331,21 @@ public:
         ragSeedsArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedNodeMapShape(rag));
         std::fill(ragSeedsArray.begin(),ragSeedsArray.end(),0);
 
-        UInt32NodeArrayMap labelsArrayMap(graph,labelsArray);
-        UInt32NodeArrayMap seedsArrayMap(graph,seedsArray);
+        {
+            PyAllowThreads _pythread;
+            UInt32NodeArrayMap labelsArrayMap(graph,labelsArray);
+            UInt32NodeArrayMap seedsArrayMap(graph,seedsArray);
 
-        typename PyNodeMapTraits<RagGraph, UInt32>::Map ragSeedsArrayMap(rag, ragSeedsArray);
+            typename PyNodeMapTraits<RagGraph, UInt32>::Map ragSeedsArrayMap(rag, ragSeedsArray);
 
 
-        for(NodeIt iter(graph); iter!=lemon::INVALID; ++iter){
-            const UInt32 label = labelsArrayMap[*iter];
-            const UInt32 seed  = seedsArrayMap[*iter];
-            if(seed!=0){
-                RagNode node = rag.nodeFromId(label);
-                ragSeedsArrayMap[node] = seed;
+            for(NodeIt iter(graph); iter!=lemon::INVALID; ++iter){
+                const UInt32 label = labelsArrayMap[*iter];
+                const UInt32 seed  = seedsArrayMap[*iter];
+                if(seed!=0){
+                    RagNode node = rag.nodeFromId(label);
+                    ragSeedsArrayMap[node] = seed;
+                }
             }
         }
 
@@ -366,15 +369,18 @@ public:
         ragGt.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedNodeMapShape(rag));
         ragGtQt.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedNodeMapShape(rag));
 
-        // make lemon maps
-        UInt32NodeArrayMap baseGraphRagLabelsMap(baseGraph, baseGraphRagLabels);
-        UInt32NodeArrayMap baseGraphGtMap(baseGraph, baseGraphGt);
-        RagUInt32NodeArrayMap ragGtMap(rag, ragGt);
-        RagFloatNodeArrayMap ragGtQtMap(rag, ragGtQt);
-
-        // call algorithm
-        projectGroundTruth(rag, baseGraph, baseGraphRagLabelsMap,
-                           baseGraphGtMap, ragGtMap, ragGtQtMap);
+        {
+            PyAllowThreads _pythread;
+            // make lemon maps
+            UInt32NodeArrayMap baseGraphRagLabelsMap(baseGraph, baseGraphRagLabels);
+            UInt32NodeArrayMap baseGraphGtMap(baseGraph, baseGraphGt);
+            RagUInt32NodeArrayMap ragGtMap(rag, ragGt);
+            RagFloatNodeArrayMap ragGtQtMap(rag, ragGtQt);
+
+            // call algorithm
+            projectGroundTruth(rag, baseGraph, baseGraphRagLabelsMap,
+                               baseGraphGtMap, ragGtMap, ragGtQtMap);
+        }
 
 
         return python::make_tuple(ragGt, ragGtQt);
@@ -394,7 +400,10 @@ public:
         RagAffiliatedEdges * affiliatedEdges = new RagAffiliatedEdges(rag);
 
         // call algorithm itself
-        makeRegionAdjacencyGraph(graph,labelsArrayMap,rag,*affiliatedEdges,ignoreLabel);
+        {
+            PyAllowThreads _pythread;
+            makeRegionAdjacencyGraph(graph,labelsArrayMap,rag,*affiliatedEdges,ignoreLabel);
+        }
 
         return affiliatedEdges;
     }
@@ -414,7 +423,10 @@ public:
         RagAffiliatedEdges * affiliatedEdges = new RagAffiliatedEdges(rag);
 
         // call algorithm itself
-        makeRegionAdjacencyGraphFast(graph,labelsArrayMap,rag,*affiliatedEdges,maxLabel,reserveEdges);
+        {
+            PyAllowThreads _pythread;
+            makeRegionAdjacencyGraphFast(graph,labelsArrayMap,rag,*affiliatedEdges,maxLabel,reserveEdges);
+        }
 
         return affiliatedEdges;
     }
@@ -441,59 +453,62 @@ public:
         // resize out
         ragEdgeFeaturesArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedEdgeMapShape(rag));
         std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),0.0f);
-        // numpy arrays => lemon maps
-        typename PyEdgeMapTraits<Graph   ,T >::Map edgeFeaturesArrayMap(graph,edgeFeaturesArray);
-        typename PyEdgeMapTraits<Graph   ,T >::Map edgeSizesArrayMap(graph,edgeSizesArray);
-        typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
-
-
-        if(accumulator == std::string("mean") ){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                float weightSum=0.0;
-                for(size_t i=0;i<affEdges.size();++i){
-                    const float weight = edgeSizesArrayMap[affEdges[i]];
-                    ragEdgeFeaturesArrayMap[ragEdge]+=weight*edgeFeaturesArrayMap[affEdges[i]];
-                    weightSum+=weight;
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            typename PyEdgeMapTraits<Graph   ,T >::Map edgeFeaturesArrayMap(graph,edgeFeaturesArray);
+            typename PyEdgeMapTraits<Graph   ,T >::Map edgeSizesArrayMap(graph,edgeSizesArray);
+            typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
+
+
+            if(accumulator == std::string("mean") ){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    float weightSum=0.0;
+                    for(size_t i=0;i<affEdges.size();++i){
+                        const float weight = edgeSizesArrayMap[affEdges[i]];
+                        ragEdgeFeaturesArrayMap[ragEdge]+=weight*edgeFeaturesArrayMap[affEdges[i]];
+                        weightSum+=weight;
+                    }
+
+                    ragEdgeFeaturesArrayMap[ragEdge]/=weightSum;
                 }
-
-                ragEdgeFeaturesArrayMap[ragEdge]/=weightSum;
             }
-        }
-        else if( accumulator == std::string("sum")){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                for(size_t i=0;i<affEdges.size();++i){
-                    ragEdgeFeaturesArrayMap[ragEdge]+=edgeFeaturesArrayMap[affEdges[i]];
+            else if( accumulator == std::string("sum")){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    for(size_t i=0;i<affEdges.size();++i){
+                        ragEdgeFeaturesArrayMap[ragEdge]+=edgeFeaturesArrayMap[affEdges[i]];
+                    }
                 }
             }
-        }
-        else if(accumulator == std::string("min")){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                float minVal=std::numeric_limits<float>::infinity();
-                for(size_t i=0;i<affEdges.size();++i){
-                    minVal  = std::min(minVal,edgeFeaturesArrayMap[affEdges[i]]);
+            else if(accumulator == std::string("min")){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    float minVal=std::numeric_limits<float>::infinity();
+                    for(size_t i=0;i<affEdges.size();++i){
+                        minVal  = std::min(minVal,edgeFeaturesArrayMap[affEdges[i]]);
+                    }
+                    ragEdgeFeaturesArrayMap[ragEdge]=minVal;
                 }
-                ragEdgeFeaturesArrayMap[ragEdge]=minVal;
             }
-        }
-        else if(accumulator == std::string("max")){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                float maxVal=-1.0*std::numeric_limits<float>::infinity();
-                for(size_t i=0;i<affEdges.size();++i){
-                    maxVal  = std::max(maxVal,edgeFeaturesArrayMap[affEdges[i]]);
+            else if(accumulator == std::string("max")){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    float maxVal=-1.0*std::numeric_limits<float>::infinity();
+                    for(size_t i=0;i<affEdges.size();++i){
+                        maxVal  = std::max(maxVal,edgeFeaturesArrayMap[affEdges[i]]);
+                    }
+                    ragEdgeFeaturesArrayMap[ragEdge]=maxVal;
                 }
-                ragEdgeFeaturesArrayMap[ragEdge]=maxVal;
             }
-        }
-        else{
-            throw std::runtime_error("not supported accumulator");
+            else{
+                throw std::runtime_error("not supported accumulator");
+            }
         }
 
         return ragEdgeFeaturesArray;
@@ -539,39 +554,42 @@ public:
         // resize out
         //ragEdgeFeaturesArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedEdgeMapShape(rag));
         std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),0.0f);
-        // numpy arrays => lemon maps
-        typename PyEdgeMapTraits<Graph   ,T >::Map edgeFeaturesArrayMap(graph,edgeFeaturesArray);
-        typename PyEdgeMapTraits<Graph   ,float >::Map edgeSizesArrayMap(graph,edgeSizesArray);
-        typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
-
-        //typedef typename PyEdgeMapTraits<Graph,float >::Array::value_type ValType;
-
-        if(accumulator == std::string("mean") ){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                float weightSum=0.0;
-                for(size_t i=0;i<affEdges.size();++i){
-                    const float weight = edgeSizesArrayMap[affEdges[i]];
-                    vigra::MultiArray<1,float> val = edgeFeaturesArrayMap[affEdges[i]];
-                    val*=weight;
-                    ragEdgeFeaturesArrayMap[ragEdge]+=val;
-                    weightSum+=weight;
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            typename PyEdgeMapTraits<Graph   ,T >::Map edgeFeaturesArrayMap(graph,edgeFeaturesArray);
+            typename PyEdgeMapTraits<Graph   ,float >::Map edgeSizesArrayMap(graph,edgeSizesArray);
+            typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
+
+            //typedef typename PyEdgeMapTraits<Graph,float >::Array::value_type ValType;
+
+            if(accumulator == std::string("mean") ){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    float weightSum=0.0;
+                    for(size_t i=0;i<affEdges.size();++i){
+                        const float weight = edgeSizesArrayMap[affEdges[i]];
+                        vigra::MultiArray<1,float> val = edgeFeaturesArrayMap[affEdges[i]];
+                        val*=weight;
+                        ragEdgeFeaturesArrayMap[ragEdge]+=val;
+                        weightSum+=weight;
+                    }
+                    ragEdgeFeaturesArrayMap[ragEdge]/=weightSum;
                 }
-                ragEdgeFeaturesArrayMap[ragEdge]/=weightSum;
             }
-        }
-        else if( accumulator == std::string("sum")){
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                for(size_t i=0;i<affEdges.size();++i){
-                    ragEdgeFeaturesArrayMap[ragEdge]+=edgeFeaturesArrayMap[affEdges[i]];
+            else if( accumulator == std::string("sum")){
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    for(size_t i=0;i<affEdges.size();++i){
+                        ragEdgeFeaturesArrayMap[ragEdge]+=edgeFeaturesArrayMap[affEdges[i]];
+                    }
                 }
             }
-        }
-        else{
-            throw std::runtime_error("not supported accumulator");
+            else{
+                throw std::runtime_error("not supported accumulator");
+            }
         }
 
         return ragEdgeFeaturesArray;
@@ -596,40 +614,43 @@ public:
 
 
 
-        // numpy arrays => lemon maps
-        typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
-
-
-        if(accumulator == std::string("mean") || accumulator == std::string("sum") ){
-            std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),0.0f);
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                for(size_t i=0;i<affEdges.size();++i){
-                    ragEdgeFeaturesArrayMap[ragEdge]+=otfEdgeMap[affEdges[i]];
-                }
-                if(accumulator == std::string("mean")){
-                    ragEdgeFeaturesArrayMap[ragEdge]/=affEdges.size();
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            typename PyEdgeMapTraits<RagGraph,T >::Map ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
+
+
+            if(accumulator == std::string("mean") || accumulator == std::string("sum") ){
+                std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),0.0f);
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    for(size_t i=0;i<affEdges.size();++i){
+                        ragEdgeFeaturesArrayMap[ragEdge]+=otfEdgeMap[affEdges[i]];
+                    }
+                    if(accumulator == std::string("mean")){
+                        ragEdgeFeaturesArrayMap[ragEdge]/=affEdges.size();
+                    }
                 }
             }
-        }
-        if(accumulator == std::string("min") ){
-            std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),std::numeric_limits<float>::infinity());
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                for(size_t i=0;i<affEdges.size();++i){
-                    ragEdgeFeaturesArrayMap[ragEdge] = std::min(otfEdgeMap[affEdges[i]], ragEdgeFeaturesArrayMap[ragEdge]);
+            if(accumulator == std::string("min") ){
+                std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),std::numeric_limits<float>::infinity());
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    for(size_t i=0;i<affEdges.size();++i){
+                        ragEdgeFeaturesArrayMap[ragEdge] = std::min(otfEdgeMap[affEdges[i]], ragEdgeFeaturesArrayMap[ragEdge]);
+                    }
                 }
             }
-        }
-        if(accumulator == std::string("max") ){
-            std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),-1.0f*std::numeric_limits<float>::infinity());
-            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagEdge ragEdge = *iter;
-                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-                for(size_t i=0;i<affEdges.size();++i){
-                    ragEdgeFeaturesArrayMap[ragEdge] = std::max(otfEdgeMap[affEdges[i]], ragEdgeFeaturesArrayMap[ragEdge]);
+            if(accumulator == std::string("max") ){
+                std::fill(ragEdgeFeaturesArray.begin(),ragEdgeFeaturesArray.end(),-1.0f*std::numeric_limits<float>::infinity());
+                for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagEdge ragEdge = *iter;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                    for(size_t i=0;i<affEdges.size();++i){
+                        ragEdgeFeaturesArrayMap[ragEdge] = std::max(otfEdgeMap[affEdges[i]], ragEdgeFeaturesArrayMap[ragEdge]);
+                    }
                 }
             }
         }
@@ -666,51 +687,54 @@ public:
 
         ragEdgeFeaturesArray.reshapeIfEmpty(outShape);
 
-        // define histogram for quantiles
-        typedef StandardQuantiles<AutoRangeHistogram<0> > Quantiles;
-        size_t n_bins_min = 2;
-        size_t n_bins_max = 64;
-
-        //in parallel with threadpool
-        // -1 = use all cores
-        parallel_foreach( -1, rag.edgeNum(),
-            [&](size_t /*thread_id*/, int id)
-            {
-                auto feat = ragEdgeFeaturesArray.bindInner(id);
-                // init the accumulator chain with the appropriate statistics
-                AccumulatorChain<double,
-                    Select<Mean, Sum, Minimum, Maximum, Variance, Skewness, Kurtosis, Quantiles> > a;
-                const std::vector<Edge> & affEdges = affiliatedEdges[id];
-
-                // set n_bins = ceil( n_values**1./2.5 ) , clipped to [2,64]
-                // turned out to be suitable empirically
-                // see https://github.com/consti123/quantile_tests
-                size_t n_bins = std::pow( affiliatedEdges.size(), 1. / 2.5);
-                n_bins = std::max( n_bins_min, std::min(n_bins, n_bins_max) );
-                a.setHistogramOptions(HistogramOptions().setBinCount(n_bins));
-
-                // accumulate the values of this edge
-                for(unsigned int k=1; k <= a.passesRequired(); ++k)
-                    for(size_t i=0;i<affEdges.size();++i)
-                        a.updatePassN( otfEdgeMap[affEdges[i]], k );
-
-                feat[0] = get<Mean>(a);
-                feat[1] = get<Sum>(a);
-                feat[2] = get<Minimum>(a);
-                feat[3] = get<Maximum>(a);
-                feat[4] = get<Variance>(a);
-                feat[5] = get<Skewness>(a);
-                feat[6] = get<Kurtosis>(a);
-                // get quantiles, keep only the ones we care for
-                TinyVector<double, 7> quant = get<Quantiles>(a);
-                // we keep: 0.1, 0.25, 05 (median), 0.75 and 0.9 quantile
-                feat[7] = quant[1];
-                feat[8] = quant[2];
-                feat[9] = quant[3];
-                feat[10] = quant[4];
-                feat[11] = quant[5];
-            }
-        );
+        {
+            PyAllowThreads _pythread;
+            // define histogram for quantiles
+            typedef StandardQuantiles<AutoRangeHistogram<0> > Quantiles;
+            size_t n_bins_min = 2;
+            size_t n_bins_max = 64;
+
+            //in parallel with threadpool
+            // -1 = use all cores
+            parallel_foreach( -1, rag.edgeNum(),
+                [&](size_t /*thread_id*/, int id)
+                {
+                    auto feat = ragEdgeFeaturesArray.bindInner(id);
+                    // init the accumulator chain with the appropriate statistics
+                    AccumulatorChain<double,
+                        Select<Mean, Sum, Minimum, Maximum, Variance, Skewness, Kurtosis, Quantiles> > a;
+                    const std::vector<Edge> & affEdges = affiliatedEdges[id];
+
+                    // set n_bins = ceil( n_values**1./2.5 ) , clipped to [2,64]
+                    // turned out to be suitable empirically
+                    // see https://github.com/consti123/quantile_tests
+                    size_t n_bins = std::pow( affiliatedEdges.size(), 1. / 2.5);
+                    n_bins = std::max( n_bins_min, std::min(n_bins, n_bins_max) );
+                    a.setHistogramOptions(HistogramOptions().setBinCount(n_bins));
+
+                    // accumulate the values of this edge
+                    for(unsigned int k=1; k <= a.passesRequired(); ++k)
+                        for(size_t i=0;i<affEdges.size();++i)
+                            a.updatePassN( otfEdgeMap[affEdges[i]], k );
+
+                    feat[0] = get<Mean>(a);
+                    feat[1] = get<Sum>(a);
+                    feat[2] = get<Minimum>(a);
+                    feat[3] = get<Maximum>(a);
+                    feat[4] = get<Variance>(a);
+                    feat[5] = get<Skewness>(a);
+                    feat[6] = get<Kurtosis>(a);
+                    // get quantiles, keep only the ones we care for
+                    TinyVector<double, 7> quant = get<Quantiles>(a);
+                    // we keep: 0.1, 0.25, 05 (median), 0.75 and 0.9 quantile
+                    feat[7] = quant[1];
+                    feat[8] = quant[2];
+                    feat[9] = quant[3];
+                    feat[10] = quant[4];
+                    feat[11] = quant[5];
+                }
+            );
+        }
 
         return ragEdgeFeaturesArray;
 
@@ -738,29 +762,32 @@ public:
         }
         NumpyArray<2, UInt32> edgePoints(NumpyArray<2, UInt32>::difference_type(nPoints, NodeMapDim));
 
-        // Find edges
-        size_t nNext = 0;
-        for(RagOutArcIt iter(rag, node); iter != lemon::INVALID; ++iter) {
-            const RagEdge ragEdge(*iter);
-            const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-            for (size_t i=0; i<affEdges.size(); ++i) {
-                Node u = graph.u(affEdges[i]);
-                Node v = graph.v(affEdges[i]);
-                UInt32 uLabel = labelsArrayMap[u];
-                UInt32 vLabel = labelsArrayMap[v];
-
-                NodeCoordinate coords;
-                if (uLabel == nodeLabel) {
-                    coords = GraphDescriptorToMultiArrayIndex<Graph>::intrinsicNodeCoordinate(graph, u);
-                } else if (vLabel == nodeLabel) {
-                    coords = GraphDescriptorToMultiArrayIndex<Graph>::intrinsicNodeCoordinate(graph, v);
-                } else {
-                    // If you get here, then there's an error. Maybe print a message?
-                }
-                for(size_t k=0; k<coords.size(); ++k) {
-                    edgePoints(nNext, k) = coords[k];
+        {
+            PyAllowThreads _pythread;
+            // Find edges
+            size_t nNext = 0;
+            for(RagOutArcIt iter(rag, node); iter != lemon::INVALID; ++iter) {
+                const RagEdge ragEdge(*iter);
+                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                for (size_t i=0; i<affEdges.size(); ++i) {
+                    Node u = graph.u(affEdges[i]);
+                    Node v = graph.v(affEdges[i]);
+                    UInt32 uLabel = labelsArrayMap[u];
+                    UInt32 vLabel = labelsArrayMap[v];
+
+                    NodeCoordinate coords;
+                    if (uLabel == nodeLabel) {
+                        coords = GraphDescriptorToMultiArrayIndex<Graph>::intrinsicNodeCoordinate(graph, u);
+                    } else if (vLabel == nodeLabel) {
+                        coords = GraphDescriptorToMultiArrayIndex<Graph>::intrinsicNodeCoordinate(graph, v);
+                    } else {
+                        // If you get here, then there's an error. Maybe print a message?
+                    }
+                    for(size_t k=0; k<coords.size(); ++k) {
+                        edgePoints(nNext, k) = coords[k];
+                    }
+                    nNext++;
                 }
-                nNext++;
             }
         }
         return edgePoints;
@@ -789,71 +816,74 @@ public:
         ragNodeFeaturesArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedNodeMapShape(rag));
         std::fill(ragNodeFeaturesArray.begin(),ragNodeFeaturesArray.end(),0.0f);
 
-        // numpy arrays => lemon maps
-        UInt32NodeArrayMap   labelsArrayMap(graph,labelsArray);
-        FloatNodeArrayMap    nodeFeaturesArrayMap(graph,nodeFeaturesArray);
-        FloatNodeArrayMap    nodeSizesArrayMap(graph,nodeSizesArray);
-        RagFloatNodeArrayMap ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
-
-        if(accumulator == std::string("mean")){
-            typename RagGraph:: template NodeMap<float> counting(rag,0.0f);
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const float  weight = nodeSizesArrayMap[*iter];
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]+= weight*nodeFeaturesArrayMap[*iter];
-                    counting[ragNode]+=weight;
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            UInt32NodeArrayMap   labelsArrayMap(graph,labelsArray);
+            FloatNodeArrayMap    nodeFeaturesArrayMap(graph,nodeFeaturesArray);
+            FloatNodeArrayMap    nodeSizesArrayMap(graph,nodeSizesArray);
+            RagFloatNodeArrayMap ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
+
+            if(accumulator == std::string("mean")){
+                typename RagGraph:: template NodeMap<float> counting(rag,0.0f);
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const float  weight = nodeSizesArrayMap[*iter];
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]+= weight*nodeFeaturesArrayMap[*iter];
+                        counting[ragNode]+=weight;
+                    }
                 }
-            }
-            for(RagNodeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagNode ragNode   = *iter;
-                ragNodeFeaturesArrayMap[ragNode]/=counting[ragNode];
-            }
-        }
-        else if(accumulator == std::string("sum")){
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]+=nodeFeaturesArrayMap[*iter];
+                for(RagNodeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagNode ragNode   = *iter;
+                    ragNodeFeaturesArrayMap[ragNode]/=counting[ragNode];
                 }
             }
-        }
-        else if(accumulator == std::string("min")){
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]=std::numeric_limits<float>::infinity();
+            else if(accumulator == std::string("sum")){
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]+=nodeFeaturesArrayMap[*iter];
+                    }
                 }
             }
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]=std::min(nodeFeaturesArrayMap[*iter],ragNodeFeaturesArrayMap[ragNode]);
+            else if(accumulator == std::string("min")){
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]=std::numeric_limits<float>::infinity();
+                    }
                 }
-            }
-        }
-        else if(accumulator == std::string("max")){
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]= -1.0*std::numeric_limits<float>::infinity();
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]=std::min(nodeFeaturesArrayMap[*iter],ragNodeFeaturesArrayMap[ragNode]);
+                    }
                 }
             }
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]=std::max(nodeFeaturesArrayMap[*iter],ragNodeFeaturesArrayMap[ragNode]);
+            else if(accumulator == std::string("max")){
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]= -1.0*std::numeric_limits<float>::infinity();
+                    }
+                }
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]=std::max(nodeFeaturesArrayMap[*iter],ragNodeFeaturesArrayMap[ragNode]);
+                    }
                 }
             }
-        }
-        else{
+            else{
 
+            }
         }
         return ragNodeFeaturesArray;
     }
@@ -883,41 +913,44 @@ public:
         ragNodeFeaturesArray.reshapeIfEmpty(   RagMultiFloatNodeArray::ArrayTraits::taggedShape(outShape,"nc") );
         std::fill(ragNodeFeaturesArray.begin(),ragNodeFeaturesArray.end(),0.0f);
 
-        // numpy arrays => lemon maps
-        UInt32NodeArrayMap        labelsArrayMap(graph,labelsArray);
-        MultiFloatNodeArrayMap    nodeFeaturesArrayMap(graph,nodeFeaturesArray);
-        FloatNodeArrayMap         nodeSizesArrayMap(graph,nodeSizesArray);
-        RagMultiFloatNodeArrayMap ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
-
-        if(accumulator == std::string("mean")){
-            typename RagGraph:: template NodeMap<float> counting(rag,0.0f);
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const float weight = nodeSizesArrayMap[*iter];
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    typename MultiFloatNodeArrayMap::Value feat = nodeFeaturesArrayMap[*iter];
-                    feat*=weight;
-                    ragNodeFeaturesArrayMap[ragNode]+=feat;
-                    counting[ragNode]+=weight;
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            UInt32NodeArrayMap        labelsArrayMap(graph,labelsArray);
+            MultiFloatNodeArrayMap    nodeFeaturesArrayMap(graph,nodeFeaturesArray);
+            FloatNodeArrayMap         nodeSizesArrayMap(graph,nodeSizesArray);
+            RagMultiFloatNodeArrayMap ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
+
+            if(accumulator == std::string("mean")){
+                typename RagGraph:: template NodeMap<float> counting(rag,0.0f);
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const float weight = nodeSizesArrayMap[*iter];
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        typename MultiFloatNodeArrayMap::Value feat = nodeFeaturesArrayMap[*iter];
+                        feat*=weight;
+                        ragNodeFeaturesArrayMap[ragNode]+=feat;
+                        counting[ragNode]+=weight;
+                    }
+                }
+                for(RagNodeIt iter(rag);iter!=lemon::INVALID;++iter){
+                    const RagNode ragNode   = *iter;
+                    ragNodeFeaturesArrayMap[ragNode]/=counting[ragNode];
                 }
             }
-            for(RagNodeIt iter(rag);iter!=lemon::INVALID;++iter){
-                const RagNode ragNode   = *iter;
-                ragNodeFeaturesArrayMap[ragNode]/=counting[ragNode];
-            }
-        }
-        else if(accumulator == std::string("sum")){
-            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-                UInt32 l = labelsArrayMap[*iter];
-                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                    const RagNode ragNode   = rag.nodeFromId(l);
-                    ragNodeFeaturesArrayMap[ragNode]+=nodeFeaturesArrayMap[*iter];
+            else if(accumulator == std::string("sum")){
+                for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                    UInt32 l = labelsArrayMap[*iter];
+                    if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                        const RagNode ragNode   = rag.nodeFromId(l);
+                        ragNodeFeaturesArrayMap[ragNode]+=nodeFeaturesArrayMap[*iter];
+                    }
                 }
             }
-        }
-        else{
-            throw std::runtime_error("for multiband only mean and sum is implemented");
+            else{
+                throw std::runtime_error("for multiband only mean and sum is implemented");
+            }
         }
         return ragNodeFeaturesArray;
     }
@@ -933,14 +966,17 @@ public:
         ragNodeSizeArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedNodeMapShape(rag));
         std::fill(ragNodeSizeArray.begin(),ragNodeSizeArray.end(),0.0f);
 
-        // numpy arrays => lemon maps
-        UInt32NodeArrayMap labelsArrayMap(graph,labelsArray);
-        RagFloatNodeArrayMap ragNodeSizeArrayMap(rag,ragNodeSizeArray);
-        for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
-            UInt32 l = labelsArrayMap[*iter];
-            if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
-                const RagNode ragNode   = rag.nodeFromId(l);
-                ragNodeSizeArrayMap[ragNode]+=1.0f;
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            UInt32NodeArrayMap labelsArrayMap(graph,labelsArray);
+            RagFloatNodeArrayMap ragNodeSizeArrayMap(rag,ragNodeSizeArray);
+            for(NodeIt iter(graph);iter!=lemon::INVALID;++iter){
+                UInt32 l = labelsArrayMap[*iter];
+                if(ignoreLabel==-1 || static_cast<Int32>(l)!=ignoreLabel){
+                    const RagNode ragNode   = rag.nodeFromId(l);
+                    ragNodeSizeArrayMap[ragNode]+=1.0f;
+                }
             }
         }
 
@@ -954,13 +990,16 @@ public:
     ){
         // reshape out
         ragEdgeFeaturesArray.reshapeIfEmpty(TaggedGraphShape<RagGraph>::taggedEdgeMapShape(rag));
-        // numpy arrays => lemon maps
-        RagFloatEdgeArrayMap ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            RagFloatEdgeArrayMap ragEdgeFeaturesArrayMap(rag,ragEdgeFeaturesArray);
 
-        for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
-            const RagEdge ragEdge = *iter;
-            const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
-            ragEdgeFeaturesArrayMap[ragEdge]=static_cast<float>(affEdges.size());
+            for(RagEdgeIt iter(rag);iter!=lemon::INVALID;++iter){
+                const RagEdge ragEdge = *iter;
+                const std::vector<Edge> & affEdges = affiliatedEdges[ragEdge];
+                ragEdgeFeaturesArrayMap[ragEdge]=static_cast<float>(affEdges.size());
+            }
         }
         return ragEdgeFeaturesArray;
     }
@@ -1002,14 +1041,17 @@ public:
 
         // reshape out  ( last argument (out) will be reshaped if empty, and #channels is taken from second argument)
         //reshapeNodeMapIfEmpty(graph,ragNodeFeaturesArray,graphNodeFeaturesArray);
-        // numpy arrays => lemon maps
-        typename PyNodeMapTraits<Graph,   UInt32>::Map labelsWhichGeneratedRagArrayMap(graph, labelsWhichGeneratedRagArray);
-        typename PyNodeMapTraits<RagGraph,T     >::Map ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
-        typename PyNodeMapTraits<Graph,   T     >::Map graphNodeFeaturesArrayMap(graph,graphNodeFeaturesArray);
+        {
+            PyAllowThreads _pythread;
+            // numpy arrays => lemon maps
+            typename PyNodeMapTraits<Graph,   UInt32>::Map labelsWhichGeneratedRagArrayMap(graph, labelsWhichGeneratedRagArray);
+            typename PyNodeMapTraits<RagGraph,T     >::Map ragNodeFeaturesArrayMap(rag,ragNodeFeaturesArray);
+            typename PyNodeMapTraits<Graph,   T     >::Map graphNodeFeaturesArrayMap(graph,graphNodeFeaturesArray);
 
 
-        projectBack(rag, graph, ignoreLabel, labelsWhichGeneratedRagArrayMap,
-                    ragNodeFeaturesArrayMap, graphNodeFeaturesArrayMap);
+            projectBack(rag, graph, ignoreLabel, labelsWhichGeneratedRagArrayMap,
+                        ragNodeFeaturesArrayMap, graphNodeFeaturesArrayMap);
+        }
 
 
         /*
@@ -65,31 +65,46 @@ NumpyAnyArray readImageImpl(ImageImportInfo const & info, std::string order = ""
       case 1:
       {
         NumpyArray<2, Singleband<T>, Stride> res(MultiArrayShape<2>::type(info.width(), info.height()), order);
-        importImage(info, destImage(res));
+        {
+            PyAllowThreads _pythread;
+            importImage(info, destImage(res));
+        }
         return res;
       }
       case 2:
       {
         NumpyArray<2, TinyVector<T, 2>, Stride> res(MultiArrayShape<2>::type(info.width(), info.height()), order);
-        importImage(info, destImage(res));
+        {
+            PyAllowThreads _pythread;
+            importImage(info, destImage(res));
+        }
         return res;
       }
       case 3:
       {
         NumpyArray<2, RGBValue<T>, Stride> res(MultiArrayShape<2>::type(info.width(), info.height()), order);
-        importImage(info, destImage(res));
+        {
+            PyAllowThreads _pythread;
+            importImage(info, destImage(res));
+        }
         return res;
       }
       case 4:
       {
         NumpyArray<2, TinyVector<T, 4>, Stride> res(MultiArrayShape<2>::type(info.width(), info.height()), order);
-        importImage(info, destImage(res));
+        {
+            PyAllowThreads _pythread;
+            importImage(info, destImage(res));
+        }
         return res;
       }
       default:
       {
         NumpyArray<3, Multiband<T> > res(MultiArrayShape<3>::type(info.width(), info.height(), info.numBands()), order);
-        importImage(info, destImage(res));
+        {
+            PyAllowThreads _pythread;
+            importImage(info, destImage(res));
+        }
         return res;
       }
     }
@@ -190,6 +205,7 @@ void writeImage(NumpyArray<3, Multiband<T> > const & image,
         info.setCompression("RLE");
     else if(std::string(compression) != "")
         info.setCompression(compression);
+    PyAllowThreads _pythread;
     exportImage(srcImageRange(image), info);
 }
 
@@ -215,25 +231,37 @@ readVolumeImpl(VolumeImportInfo const & info, std::string order = "")
       case 1:
       {
         NumpyArray<3, Singleband<T> > volume(info.shape(), order);
-        importVolume(info, volume);
+        {
+            PyAllowThreads _pythread;
+            importVolume(info, volume);
+        }
         return volume;
       }
       case 2:
       {
         NumpyArray<3, TinyVector<T, 2> > volume(info.shape(), order);
-        importVolume(info, volume);
+        {
+            PyAllowThreads _pythread;
+            importVolume(info, volume);
+        }
         return volume;
       }
       case 3:
       {
         NumpyArray<3, RGBValue<T> > volume(info.shape(), order);
-        importVolume(info, volume);
+        {
+            PyAllowThreads _pythread;
+            importVolume(info, volume);
+        }
         return volume;
       }
       case 4:
       {
         NumpyArray<3, TinyVector<T, 4> > volume(info.shape(), order);
-        importVolume(info, volume);
+        {
+            PyAllowThreads _pythread;
+            importVolume(info, volume);
+        }
         return volume;
       }
       //FIXME not yet supported
@@ -246,7 +274,10 @@ readVolumeImpl(VolumeImportInfo const & info, std::string order = "")
       default:
       {
         NumpyArray<3, RGBValue<T> > volume(info.shape(), order);
-        importVolume(info, volume);
+        {
+            PyAllowThreads _pythread;
+            importVolume(info, volume);
+        }
         return volume;
       }
     }
@@ -324,6 +355,7 @@ void writeVolume(NumpyArray<3, T > const & volume,
         info.setCompression("RLE");
     else if(std::string(compression) != "")
         info.setCompression(compression);
+    PyAllowThreads _pythread;
     exportVolume(volume, info);
 }
 
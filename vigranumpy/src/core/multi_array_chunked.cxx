@@ -199,7 +199,8 @@ NumpyAnyArray
 ChunkedArray_checkoutSubarray(python::object array,
                               TinyVector<MultiArrayIndex, N> const & start,
                               TinyVector<MultiArrayIndex, N> const & stop,
-                              NumpyArray<N, T> res = NumpyArray<N, T>())
+                              NumpyArray<N, T> res = NumpyArray<N, T>(),
+                              int n_threads = 1)
 {
     ChunkedArray<N, T> const & self = python::extract<ChunkedArray<N, T> const &>(array)();
 
@@ -215,7 +216,10 @@ ChunkedArray_checkoutSubarray(python::object array,
 
     {
         PyAllowThreads _pythread;
-        self.checkoutSubarray(start, res);
+        if(n_threads == 1)
+            self.checkoutSubarray(start, res);
+        else
+            self.checkoutSubarray(start, res, ParallelOptions().numThreads(n_threads));
     }
     return res;
 }
@@ -224,10 +228,161 @@ template <unsigned int N, class T>
 void
 ChunkedArray_commitSubarray(ChunkedArray<N, T> & self,
                             TinyVector<MultiArrayIndex, N> const & start,
-                            NumpyArray<N, T> array)
+                            NumpyArray<N, T> array,
+                            int n_threads = 1)
 {
     PyAllowThreads _pythread;
-    self.commitSubarray(start, array);
+    if(n_threads == 1)
+        self.commitSubarray(start, array);
+    else
+        self.commitSubarray(start, array, ParallelOptions().numThreads(n_threads));
+}
+
+// Python-side handle of a pinned chunk. It also holds a reference to
+// the Python ChunkedArray object, so that the array outlives its pins.
+template <unsigned int N, class U>
+struct PythonPinnedChunk
+{
+    typedef typename UnqualifiedType<U>::type T;
+
+    PythonPinnedChunk(python::object array, PinnedChunk<N, U> const & chunk)
+    : array_(array)
+    , chunk_(chunk)
+    {}
+
+    python::object array_;
+    PinnedChunk<N, U> chunk_;
+};
+
+template <unsigned int N, class U>
+void
+PythonPinnedChunk_deleteCapsule(PyObject * capsule)
+{
+    delete static_cast<PythonPinnedChunk<N, U> *>(PyCapsule_GetPointer(capsule, 0));
+}
+
+template <unsigned int N, class U>
+TinyVector<MultiArrayIndex, N>
+PythonPinnedChunk_index(PythonPinnedChunk<N, U> const & self)
+{
+    return self.chunk_.chunkIndex();
+}
+
+template <unsigned int N, class U>
+TinyVector<MultiArrayIndex, N>
+PythonPinnedChunk_start(PythonPinnedChunk<N, U> const & self)
+{
+    return self.chunk_.chunkStart();
+}
+
+template <unsigned int N, class U>
+TinyVector<MultiArrayIndex, N>
+PythonPinnedChunk_stop(PythonPinnedChunk<N, U> const & self)
+{
+    return self.chunk_.chunkStop();
+}
+
+template <unsigned int N, class U>
+bool
+PythonPinnedChunk_isValid(PythonPinnedChunk<N, U> const & self)
+{
+    return self.chunk_.isValid();
+}
+
+template <unsigned int N, class U>
+bool
+PythonPinnedChunk_writable(PythonPinnedChunk<N, U> const &)
+{
+    return !IsSameType<U, typename PythonPinnedChunk<N, U>::T const>::value;
+}
+
+template <unsigned int N, class U>
+void
+PythonPinnedChunk_release(PythonPinnedChunk<N, U> & self)
+{
+    self.chunk_.release();
+}
+
+template <unsigned int N, class U>
+python::object
+PythonPinnedChunk_view(PythonPinnedChunk<N, U> const & self)
+{
+    typedef typename PythonPinnedChunk<N, U>::T T;
+
+    vigra_precondition(self.chunk_.isValid(),
+        "ChunkHandle.view(): chunk has already been released.");
+
+    MultiArrayView<N, U> view = self.chunk_.view();
+    TinyVector<npy_intp, N> strides;
+    for(unsigned int k=0; k<N; ++k)
+        strides[k] = view.stride(k)*sizeof(T);
+    python_ptr array = constructNumpyArrayFromData(view.shape(), strides.begin(),
+                           NumpyArrayValuetypeTraits<T>::typeCode,
+                           const_cast<T *>(view.data()));
+    if(!PythonPinnedChunk_writable(self))
+        PyArray_CLEARFLAGS((PyArrayObject *)array.get(), NPY_ARRAY_WRITEABLE);
+
+    // the ndarray's base object owns another copy of the pin
+    PythonPinnedChunk<N, U> * keeper = new PythonPinnedChunk<N, U>(self);
+    PyObject * capsule = PyCapsule_New(keeper, 0, &PythonPinnedChunk_deleteCapsule<N, U>);
+    if(capsule == 0)
+        delete keeper;
+    pythonToCppException(capsule);
+    // PyArray_SetBaseObject() steals the reference to 'capsule'
+    pythonToCppException(PyArray_SetBaseObject((PyArrayObject *)array.get(), capsule) == 0);
+    return python::object(python::handle<>(array.release()));
+}
+
+template <unsigned int N, class T>
+python::object
+ChunkedArray_pinChunk(python::object array,
+                      TinyVector<MultiArrayIndex, N> const & chunk_index,
+                      bool writable)
+{
+    if(writable)
+    {
+        ChunkedArray<N, T> & self = python::extract<ChunkedArray<N, T> &>(array)();
+        PinnedChunk<N, T> chunk;
+        {
+            PyAllowThreads _pythread;
+            chunk = self.pinChunk(chunk_index);
+        }
+        return python::object(PythonPinnedChunk<N, T>(array, chunk));
+    }
+    else
+    {
+        ChunkedArray<N, T> const & self = python::extract<ChunkedArray<N, T> const &>(array)();
+        PinnedChunk<N, T const> chunk;
+        {
+            PyAllowThreads _pythread;
+            chunk = self.pinChunk(chunk_index);
+        }
+        return python::object(PythonPinnedChunk<N, T const>(array, chunk));
+    }
+}
+
+template <unsigned int N, class T>
+python::list
+ChunkedArray_chunkIndices(ChunkedArray<N, T> const & self,
+                          python::object pystart, python::object pystop)
+{
+    typedef TinyVector<MultiArrayIndex, N> Shape;
+
+    Shape start, stop(self.shape());
+    if(pystart != python::object())
+        start = python::extract<Shape>(pystart)();
+    if(pystop != python::object())
+        stop = python::extract<Shape>(pystop)();
+    vigra_precondition(allLessEqual(Shape(), start) && allLess(start, stop) &&
+                       allLessEqual(stop, self.shape()),
+        "ChunkedArray.chunkIndices(): invalid ROI.");
+
+    python::list res;
+    MultiCoordinateIterator<N> i(self.chunkStart(start), self.chunkStop(stop)),
+                               end(i.getEndIterator());
+    for(; i != end; ++i)
+        res.append(Shape(*i));
+    return res;
 }
 
 template <class Shape>
@@ -731,6 +886,38 @@ construct_ChunkedArrayHDF5id(hid_t file_id,
 
 #endif
 
+template <unsigned int N, class U>
+void definePinnedChunk()
+{
+    using namespace boost::python;
+
+    typedef PythonPinnedChunk<N, U> Chunk;
+    class_<Chunk>("ChunkHandle",
+         "\n"
+         "Handle of a single chunk of a chunked array, can only be created via\n"
+         ":meth:`~vigra.vigranumpycore.ChunkedArrayBase.pinChunk`. The chunk stays in\n"
+         "memory until the handle has been released and all numpy arrays returned\n"
+         "by 'view()' have been deleted.\n\n",
+         no_init)
+        .add_property("index", &PythonPinnedChunk_index<N, U>,
+             "\nindex of the chunk in the array of chunks.\n")
+        .add_property("start", &PythonPinnedChunk_start<N, U>,
+             "\ncoordinate of the chunk's first element in the chunked array.\n")
+        .add_property("stop", &PythonPinnedChunk_stop<N, U>,
+             "\ncoordinate beyond the chunk's last element in the chunked array.\n")
+        .add_property("writable", &PythonPinnedChunk_writable<N, U>,
+             "\n'True' if the views of this chunk can be modified.\n")
+        .add_property("valid", &PythonPinnedChunk_isValid<N, U>,
+             "\n'False' after 'release()' has been called.\n")
+        .def("view", &PythonPinnedChunk_view<N, U>,
+             "\n    view() => array\n\n"
+             "Return a numpy array that refers to the chunk's data without copying.\n")
+        .def("release", &PythonPinnedChunk_release<N, U>,
+             "\n    release()\n\n"
+             "Drop the handle's reference to the chunk.\n")
+        ;
+}
+
 template <unsigned int N, class T>
 void defineChunkedArrayImpl()
 {
@@ -775,11 +962,13 @@ void defineChunkedArrayImpl()
         .def("__str__", &ChunkedArray_str<N, T>)
         .def("checkoutSubarray",
              registerConverters(&ChunkedArray_checkoutSubarray<N, T>),
-             (arg("start"), arg("stop"), arg("out")=python::object()),
-             "\n    checkoutSubarray(start, stop, res=None) => array\n\n"
+             (arg("start"), arg("stop"), arg("out")=python::object(), arg("n_threads")=1),
+             "\n    checkoutSubarray(start, stop, res=None, n_threads=1) => array\n\n"
              "Obtain a copy of the subarray in the ROI '[start, stop)'.\n"
              "If 'res' is given, it must have matching shape and will be used\n"
-             "to store the data instead of allocating new storage for 'array'.\n\n"
+             "to store the data instead of allocating new storage for 'array'.\n"
+             "If 'n_threads' is not 1, the chunks in the ROI are copied concurrently\n"
+             "('n_threads=-1' uses all cores). The GIL is released during the copy.\n\n"
              "The index operator provides a shorthand for this function, e.g.\n"
              "for a 2-dimensional array you can equivalently write::\n\n"
              "    roi = chunked_array.checkoutSubarray((5,10), (12,19))\n"
@@ -789,9 +978,10 @@ void defineChunkedArrayImpl()
              "chunked array. Use 'commitSubarray()' to overwrite data.\n")
         .def("commitSubarray",
              registerConverters(&ChunkedArray_commitSubarray<N, T>),
-             (arg("start"), arg("array")),
-             "\n    commitSubarray(start, array)\n\n"
+             (arg("start"), arg("array"), arg("n_threads")=1),
+             "\n    commitSubarray(start, array, n_threads=1)\n\n"
              "Write the given 'array' at offset 'start'.\n"
+             "If 'n_threads' is not 1, the chunks in the ROI are written concurrently.\n"
              "The index operator provides a shorthand for this function, e.g.\n"
              "for a 2-dimensional array you can equivalently write::\n\n"
              "    chunked_array.commitSubarray((5,10), roi)\n"
@@ -802,6 +992,27 @@ void defineChunkedArrayImpl()
              (arg("start"), arg("stop"),arg("destroy")=false),
              "\n    releaseChunks(start, stop, destroy=False)\n\n"
              "\nrelease or destroy all chunks that are completely contained in [start, stop).\n")
+        .def("chunkIndices",
+             &ChunkedArray_chunkIndices<N, T>,
+             (arg("start")=python::object(), arg("stop")=python::object()),
+             "\n    chunkIndices(start=None, stop=None) => list\n\n"
+             "Return the indices of all chunks intersecting the ROI '[start, stop)'\n"
+             "(default: the entire array) in scan order. The indices refer to the\n"
+             "array of chunks (see 'chunk_array_shape') and can be passed to 'pinChunk()'.\n")
+        .def("pinChunk",
+             &ChunkedArray_pinChunk<N, T>,
+             (arg("chunk_index"), arg("writable")=false),
+             "\n    pinChunk(chunk_index, writable=False) => ChunkHandle\n\n"
+             "Activate the chunk with the given index and keep it in memory until\n"
+             "the returned handle is released. 'handle.view()' returns a numpy array\n"
+             "that refers directly to the chunk's data (no copy), e.g.::\n\n"
+             "    for index in chunked_array.chunkIndices():\n"
+             "        chunk = chunked_array.pinChunk(index, writable=True)\n"
+             "        v = chunk.view()\n"
+             "        v[...] = process(v)\n"
+             "        chunk.release()\n\n"
+             "Read-only views of chunks that have never been written refer to the\n"
+             "fill value, so that no memory is allocated for them.\n")
         .def("__getitem__", &ChunkedArray_getitem<N, T>,
              "\nRead data from a chunked array with the usual index or slicing syntax::\n\n"
              "    value = chunked_array[5, 20]\n"
@@ -815,6 +1026,9 @@ void defineChunkedArrayImpl()
              "    chunked_array[5:12, 10:19] = roi\n")
         ;
 
+    definePinnedChunk<N, T>();
+    definePinnedChunk<N, T const>();
+
 #ifdef HasHDF5
     typedef ChunkedArrayHDF5<N, T> ArrayHDF5;
     class_<ChunkedArrayHDF5<N, T>, bases<Array>, boost::noncopyable>(